@@ -0,0 +1,140 @@
+--
+-- Example kernel for the accelerator socket: copy with CRC-32
+--
+-- This kernel passes its input stream unchanged to its output stream
+-- and appends the CRC-32 of the data as an extra word after the last
+-- input word. The CRC is the standard CRC-32 (as in rvlib_crc32.h),
+-- computed over the bytes of each word in little-endian order.
+--
+-- When bit 0 of the kernel parameter is '1', the input data is not
+-- copied; the output stream then consists only of the CRC word.
+--
+-- The kernel processes one word per clock cycle.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+
+entity accel_crc32 is
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Kernel reset, active high.
+        rst:            in  std_logic;
+
+        -- Kernel parameter.
+        param:          in  std_logic_vector(31 downto 0);
+
+        -- Input stream.
+        in_valid:       in  std_logic;
+        in_ready:       out std_logic;
+        in_data:        in  std_logic_vector(31 downto 0);
+        in_last:        in  std_logic;
+
+        -- Output stream.
+        out_valid:      out std_logic;
+        out_ready:      in  std_logic;
+        out_data:       out std_logic_vector(31 downto 0);
+        out_last:       out std_logic
+    );
+
+end entity;
+
+architecture accel_crc32_arch of accel_crc32 is
+
+    -- Internal registers.
+    type regs_type is record
+        crc:            std_logic_vector(31 downto 0);
+        crc_pending:    std_logic;
+    end record;
+
+    constant regs_init: regs_type := (
+        crc             => (others => '1'),
+        crc_pending     => '0');
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    -- Update the (inverted) CRC with 32 data bits, least significant first.
+    function crc32_update(crc: std_logic_vector(31 downto 0);
+                          data: std_logic_vector(31 downto 0))
+        return std_logic_vector
+    is
+        constant poly: std_logic_vector(31 downto 0) := x"edb88320";
+        variable c: std_logic_vector(31 downto 0);
+    begin
+        c := crc;
+        for i in 0 to 31 loop
+            if (c(0) xor data(i)) = '1' then
+                c := ('0' & c(31 downto 1)) xor poly;
+            else
+                c := '0' & c(31 downto 1);
+            end if;
+        end loop;
+        return c;
+    end function;
+
+begin
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_in_ready:    std_logic;
+        variable v_out_valid:   std_logic;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+
+        if r.crc_pending = '1' then
+            -- Send the CRC word after the last input word.
+            v_in_ready  := '0';
+            v_out_valid := '1';
+            out_data    <= not r.crc;
+            out_last    <= '1';
+            if out_ready = '1' then
+                v.crc_pending := '0';
+                v.crc := (others => '1');
+            end if;
+        else
+            -- Pass input words to the output.
+            if param(0) = '1' then
+                v_in_ready  := '1';
+                v_out_valid := '0';
+            else
+                v_in_ready  := out_ready;
+                v_out_valid := in_valid;
+            end if;
+            out_data    <= in_data;
+            out_last    <= '0';
+            if (in_valid = '1') and (v_in_ready = '1') then
+                v.crc := crc32_update(r.crc, in_data);
+                v.crc_pending := in_last;
+            end if;
+        end if;
+
+        in_ready    <= v_in_ready;
+        out_valid   <= v_out_valid;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+end architecture;
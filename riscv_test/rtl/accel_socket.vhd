@@ -0,0 +1,453 @@
+--
+-- Accelerator socket for simple processor system
+--
+-- This peripheral connects a user-defined accelerator kernel to the
+-- processor system. The kernel sees two 32-bit data streams with
+-- valid/ready handshake and an end-of-job marker ("last"):
+--   - the input stream delivers the words of a source buffer in RAM;
+--   - the output stream collects result words into a destination buffer.
+-- A DMA engine moves the data between RAM and the stream FIFOs,
+-- so the CPU only sets up the job and waits for completion.
+--
+-- A job runs as follows:
+--   - Software writes the source and destination buffers, the kernel
+--     parameter, and then writes '1' to the start bit.
+--   - The socket pulses "krn_rst" to clear the kernel state, then reads
+--     the source buffer into the input FIFO. The last word of the source
+--     buffer is marked with "krn_in_last".
+--   - The kernel consumes input words and produces output words.
+--     It must mark its final output word with "krn_out_last".
+--   - The socket writes output words to the destination buffer.
+--     If the kernel produces more words than fit in the destination
+--     buffer, the excess words are discarded and the overflow flag is set.
+--   - After the last output word is written, the job ends. Any source words
+--     not consumed by the kernel are discarded. The done flag is set and
+--     an interrupt is raised if enabled.
+--
+-- The DMA port can only access the on-chip RAM. It has lower priority
+-- than the CPU data bus; the socket issues one read or write per cycle
+-- when the CPU does not access data RAM.
+--
+-- Buffer addresses and lengths must be multiples of 4 bytes and
+-- the source buffer must not be empty.
+-- Job registers must not be changed while a job is running.
+--
+-- Register map:
+--   address 0x00 (read):
+--     bit 0            = '1' while a job is running
+--     bit 1            = done flag, set when a job ends
+--     bit 2            = overflow flag, destination buffer was too small
+--     bits 31-16       = identification 0x4143
+--   address 0x00 (write):
+--     bit 0            = write '1' to start a job
+--     bit 1            = write '1' to abort the running job
+--     bit 2            = write '1' to clear the done flag
+--   address 0x04 (rw): source buffer address
+--   address 0x08 (rw): source buffer length in bytes (max 256 kByte - 4)
+--   address 0x0c (rw): destination buffer address
+--   address 0x10 (rw): destination buffer length in bytes (max 256 kByte - 4)
+--   address 0x14 (ro): number of bytes written to the destination buffer
+--   address 0x18 (rw): kernel parameter (drives "krn_param")
+--   address 0x1c (rw): bit 0 = interrupt enable (interrupt on done flag)
+--   address 0x20 (ro): number of clock cycles of the last job
+--   address 0x24 (ro): bits 3-0 = fifo_bits
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity accel_socket is
+
+    generic (
+        -- Size of the input and output FIFO as 2-log of the number of words.
+        fifo_bits: integer range 2 to 9
+    );
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Interrupt signal.
+        interrupt:      out std_logic;
+
+        -- Bus interface signals (control registers).
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type;
+
+        -- DMA port to on-chip RAM.
+        -- A command is accepted in each cycle where "cmd_valid" and
+        -- "cmd_ready" are both '1'. Read data is returned in order
+        -- via "rsp_valid" and "rsp_rdata".
+        dma_output:     out bus_slv_input_type;
+        dma_input:      in  bus_slv_output_type;
+
+        -- Kernel control.
+        -- "krn_rst" is active for one cycle at the start of each job.
+        krn_rst:        out std_logic;
+        krn_param:      out std_logic_vector(31 downto 0);
+
+        -- Input stream to the kernel.
+        krn_in_valid:   out std_logic;
+        krn_in_ready:   in  std_logic;
+        krn_in_data:    out std_logic_vector(31 downto 0);
+        krn_in_last:    out std_logic;
+
+        -- Output stream from the kernel.
+        krn_out_valid:  in  std_logic;
+        krn_out_ready:  out std_logic;
+        krn_out_data:   in  std_logic_vector(31 downto 0);
+        krn_out_last:   in  std_logic
+    );
+
+end entity;
+
+architecture accel_socket_arch of accel_socket is
+
+    constant fifo_size: integer := 2**fifo_bits;
+
+    -- Stream FIFOs hold a data word plus the "last" flag in bit 32.
+    type fifo_mem_type is array(0 to fifo_size - 1)
+        of std_logic_vector(32 downto 0);
+    signal inf_mem:     fifo_mem_type;
+    signal outf_mem:    fifo_mem_type;
+
+    -- Internal registers.
+    type regs_type is record
+        busy:           std_logic;
+        flag_done:      std_logic;
+        flag_overflow:  std_logic;
+        irq_enable:     std_logic;
+        reg_src_addr:   unsigned(29 downto 0);
+        reg_src_len:    unsigned(15 downto 0);
+        reg_dst_addr:   unsigned(29 downto 0);
+        reg_dst_len:    unsigned(15 downto 0);
+        reg_param:      std_logic_vector(31 downto 0);
+        job_cycles:     unsigned(31 downto 0);
+        rd_addr:        unsigned(29 downto 0);
+        rd_remain:      unsigned(15 downto 0);
+        rsp_remain:     unsigned(15 downto 0);
+        rd_pending:     unsigned(1 downto 0);
+        in_credit:      unsigned(fifo_bits downto 0);
+        out_count:      unsigned(15 downto 0);
+        out_done:       std_logic;
+        prefer_write:   std_logic;
+        dma_valid:      std_logic;
+        dma_write:      std_logic;
+        dma_addr:       unsigned(29 downto 0);
+        dma_wdata:      std_logic_vector(31 downto 0);
+        inf_rptr:       unsigned(fifo_bits downto 0);
+        inf_wptr:       unsigned(fifo_bits downto 0);
+        inf_wen:        std_logic;
+        inf_waddr:      unsigned(fifo_bits - 1 downto 0);
+        inf_wdata:      std_logic_vector(32 downto 0);
+        outf_rptr:      unsigned(fifo_bits downto 0);
+        outf_wptr:      unsigned(fifo_bits downto 0);
+        outf_wen:       std_logic;
+        outf_waddr:     unsigned(fifo_bits - 1 downto 0);
+        outf_wdata:     std_logic_vector(32 downto 0);
+        krn_rst:        std_logic;
+        interrupt_out:  std_logic;
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        busy            => '0',
+        flag_done       => '0',
+        flag_overflow   => '0',
+        irq_enable      => '0',
+        reg_src_addr    => (others => '0'),
+        reg_src_len     => (others => '0'),
+        reg_dst_addr    => (others => '0'),
+        reg_dst_len     => (others => '0'),
+        reg_param       => (others => '0'),
+        job_cycles      => (others => '0'),
+        rd_addr         => (others => '0'),
+        rd_remain       => (others => '0'),
+        rsp_remain      => (others => '0'),
+        rd_pending      => (others => '0'),
+        in_credit       => (others => '0'),
+        out_count       => (others => '0'),
+        out_done        => '0',
+        prefer_write    => '0',
+        dma_valid       => '0',
+        dma_write       => '0',
+        dma_addr        => (others => '0'),
+        dma_wdata       => (others => '0'),
+        inf_rptr        => (others => '0'),
+        inf_wptr        => (others => '0'),
+        inf_wen         => '0',
+        inf_waddr       => (others => '0'),
+        inf_wdata       => (others => '0'),
+        outf_rptr       => (others => '0'),
+        outf_wptr       => (others => '0'),
+        outf_wen        => '0',
+        outf_waddr      => (others => '0'),
+        outf_wdata      => (others => '0'),
+        krn_rst         => '1',
+        interrupt_out   => '0',
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0'));
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    signal s_job_active:    std_logic;
+    signal s_outf_level:    unsigned(fifo_bits downto 0);
+
+begin
+
+    -- Drive outputs.
+    interrupt   <= r.interrupt_out;
+    slv_output  <= ( cmd_ready => '1',
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+    dma_output  <= ( cmd_valid => r.dma_valid,
+                     cmd_addr  => std_logic_vector(r.dma_addr) & "00",
+                     cmd_write => r.dma_write,
+                     cmd_wdata => r.dma_wdata,
+                     cmd_wmask => "1111" );
+    krn_rst     <= r.krn_rst;
+    krn_param   <= r.reg_param;
+
+    -- Stream FIFOs are connected to the kernel while a job is running.
+    s_job_active <= r.busy and (not r.out_done);
+    s_outf_level <= r.outf_wptr - r.outf_rptr;
+
+    -- Head of the input FIFO to the kernel.
+    krn_in_valid <= s_job_active when r.inf_rptr /= r.inf_wptr else '0';
+    krn_in_data <= inf_mem(to_integer(r.inf_rptr(fifo_bits - 1 downto 0)))(31 downto 0);
+    krn_in_last <= inf_mem(to_integer(r.inf_rptr(fifo_bits - 1 downto 0)))(32);
+
+    -- Accept kernel output while the output FIFO is not full.
+    krn_out_ready <= s_job_active and (not s_outf_level(fifo_bits));
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_dma_free:    boolean;
+        variable v_can_read:    boolean;
+        variable v_can_write:   boolean;
+        variable v_out_head:    std_logic_vector(32 downto 0);
+        variable v_in_pop:      boolean;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+        v.inf_wen   := '0';
+        v.outf_wen  := '0';
+        v.krn_rst   := '0';
+
+        if r.busy = '1' then
+            v.job_cycles := r.job_cycles + 1;
+        end if;
+
+        -- DMA command handshake.
+        v_dma_free := (r.dma_valid = '0') or (dma_input.cmd_ready = '1');
+        if (r.dma_valid = '1') and (dma_input.cmd_ready = '1') and
+           (r.dma_write = '0') then
+            v.rd_pending := v.rd_pending + 1;
+        end if;
+        if v_dma_free then
+            v.dma_valid := '0';
+        end if;
+
+        -- Push DMA read data into the input FIFO.
+        if dma_input.rsp_valid = '1' then
+            v.rd_pending := v.rd_pending - 1;
+            if (r.busy = '1') and (r.out_done = '0') then
+                v.inf_wen   := '1';
+                v.inf_waddr := r.inf_wptr(fifo_bits - 1 downto 0);
+                v.inf_wdata(31 downto 0) := dma_input.rsp_rdata;
+                if r.rsp_remain = 1 then
+                    v.inf_wdata(32) := '1';
+                else
+                    v.inf_wdata(32) := '0';
+                end if;
+                v.inf_wptr  := r.inf_wptr + 1;
+                v.rsp_remain := r.rsp_remain - 1;
+            end if;
+        end if;
+
+        -- Kernel takes a word from the input FIFO.
+        v_in_pop := (krn_in_valid = '1') and (krn_in_ready = '1');
+        if v_in_pop then
+            v.inf_rptr  := r.inf_rptr + 1;
+            v.in_credit := v.in_credit - 1;
+        end if;
+
+        -- Kernel puts a word into the output FIFO.
+        if (krn_out_valid = '1') and (krn_out_ready = '1') then
+            v.outf_wen      := '1';
+            v.outf_waddr    := r.outf_wptr(fifo_bits - 1 downto 0);
+            v.outf_wdata    := krn_out_last & krn_out_data;
+            v.outf_wptr     := r.outf_wptr + 1;
+        end if;
+
+        -- Issue the next DMA command.
+        -- Reads are issued only when the input FIFO has room for the data.
+        -- Reads and writes alternate when both are possible.
+        v_can_write := (r.busy = '1') and (r.out_done = '0') and
+                       (r.outf_rptr /= r.outf_wptr);
+        v_can_read  := (r.busy = '1') and (r.out_done = '0') and
+                       (r.rd_remain /= 0) and (r.in_credit < fifo_size);
+
+        if v_dma_free and v_can_write and
+           ((r.prefer_write = '1') or (not v_can_read)) then
+            -- Take a word from the output FIFO.
+            v_out_head  := outf_mem(to_integer(r.outf_rptr(fifo_bits - 1 downto 0)));
+            v.outf_rptr := r.outf_rptr + 1;
+            if r.out_count < r.reg_dst_len then
+                v.dma_valid := '1';
+                v.dma_write := '1';
+                v.dma_addr  := r.reg_dst_addr + r.out_count;
+                v.dma_wdata := v_out_head(31 downto 0);
+                v.out_count := r.out_count + 1;
+            else
+                v.flag_overflow := '1';
+            end if;
+            if v_out_head(32) = '1' then
+                v.out_done  := '1';
+            end if;
+            v.prefer_write := '0';
+        elsif v_dma_free and v_can_read then
+            v.dma_valid := '1';
+            v.dma_write := '0';
+            v.dma_addr  := r.rd_addr;
+            v.rd_addr   := r.rd_addr + 1;
+            v.rd_remain := r.rd_remain - 1;
+            v.in_credit := v.in_credit + 1;
+            v.prefer_write := '1';
+        end if;
+
+        -- End the job when the last output word is written.
+        if (r.out_done = '1') and (r.dma_valid = '0') and (r.rd_pending = 0) then
+            v.busy      := '0';
+            v.out_done  := '0';
+            v.flag_done := '1';
+        end if;
+
+        -- Handle read transactions.
+        v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
+        v.rsp_rdata := (others => '0');
+        case slv_input.cmd_addr(5 downto 2) is
+            when "0000" =>
+                v.rsp_rdata(0)  := r.busy;
+                v.rsp_rdata(1)  := r.flag_done;
+                v.rsp_rdata(2)  := r.flag_overflow;
+                v.rsp_rdata(31 downto 16) := x"4143";
+            when "0001" =>
+                v.rsp_rdata := std_logic_vector(r.reg_src_addr) & "00";
+            when "0010" =>
+                v.rsp_rdata(17 downto 2) := std_logic_vector(r.reg_src_len);
+            when "0011" =>
+                v.rsp_rdata := std_logic_vector(r.reg_dst_addr) & "00";
+            when "0100" =>
+                v.rsp_rdata(17 downto 2) := std_logic_vector(r.reg_dst_len);
+            when "0101" =>
+                v.rsp_rdata(17 downto 2) := std_logic_vector(r.out_count);
+            when "0110" =>
+                v.rsp_rdata := r.reg_param;
+            when "0111" =>
+                v.rsp_rdata(0)  := r.irq_enable;
+            when "1000" =>
+                v.rsp_rdata := std_logic_vector(r.job_cycles);
+            when "1001" =>
+                v.rsp_rdata(3 downto 0) := std_logic_vector(to_unsigned(fifo_bits, 4));
+            when others =>
+                null;
+        end case;
+
+        -- Handle write transactions.
+        if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
+            case slv_input.cmd_addr(5 downto 2) is
+                when "0000" =>
+                    if slv_input.cmd_wdata(2) = '1' then
+                        v.flag_done := '0';
+                    end if;
+                    if (slv_input.cmd_wdata(1) = '1') or
+                       ((slv_input.cmd_wdata(0) = '1') and (r.busy = '0')) then
+                        -- Stop the running job (if any), flush the FIFOs
+                        -- and reset the kernel.
+                        v.busy      := '0';
+                        v.out_done  := '0';
+                        v.dma_valid := '0';
+                        v.rd_remain := (others => '0');
+                        v.in_credit := (others => '0');
+                        v.inf_rptr  := v.inf_wptr;
+                        v.outf_rptr := v.outf_wptr;
+                        v.krn_rst   := '1';
+                    end if;
+                    if (slv_input.cmd_wdata(1) = '0') and
+                       (slv_input.cmd_wdata(0) = '1') and (r.busy = '0') and
+                       (r.rd_pending = 0) then
+                        -- Start a new job.
+                        v.busy      := '1';
+                        v.flag_done := '0';
+                        v.flag_overflow := '0';
+                        v.job_cycles := (others => '0');
+                        v.rd_addr   := r.reg_src_addr;
+                        v.rd_remain := r.reg_src_len;
+                        v.rsp_remain := r.reg_src_len;
+                        v.out_count := (others => '0');
+                    end if;
+                when "0001" =>
+                    v.reg_src_addr  := unsigned(slv_input.cmd_wdata(31 downto 2));
+                when "0010" =>
+                    v.reg_src_len   := unsigned(slv_input.cmd_wdata(17 downto 2));
+                when "0011" =>
+                    v.reg_dst_addr  := unsigned(slv_input.cmd_wdata(31 downto 2));
+                when "0100" =>
+                    v.reg_dst_len   := unsigned(slv_input.cmd_wdata(17 downto 2));
+                when "0110" =>
+                    v.reg_param     := slv_input.cmd_wdata;
+                when "0111" =>
+                    v.irq_enable    := slv_input.cmd_wdata(0);
+                when others =>
+                    null;
+            end case;
+        end if;
+
+        -- Update interrupt output signal.
+        v.interrupt_out := v.flag_done and v.irq_enable;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+    -- FIFO memories.
+    -- Reads are asynchronous, such that the oldest entry is always visible.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if rnext.inf_wen = '1' then
+                inf_mem(to_integer(rnext.inf_waddr)) <= rnext.inf_wdata;
+            end if;
+            if rnext.outf_wen = '1' then
+                outf_mem(to_integer(rnext.outf_waddr)) <= rnext.outf_wdata;
+            end if;
+        end if;
+    end process;
+
+end architecture;
@@ -1,6 +1,34 @@
 --
 -- System bus controller for simple processor system
 --
+-- Optionally, the controller contains a bus monitor which counts
+-- transactions and wait cycles for each slave. The monitor is accessible
+-- through a separate 4 kByte register window, handled by the controller
+-- itself. The monitor uses 8 counters of 32 bits per slave.
+--
+-- Bus monitor register map (offsets within the monitor window):
+--   address 0x000 + 0x20 * N (read-only): counters for slave N
+--     +0x00 = number of read transactions
+--     +0x04 = number of write transactions
+--     +0x08 = total read latency (clock cycles from accepting the read
+--             command until the read response)
+--     +0x0c = stall cycles (clock cycles during which a command for
+--             this slave was waiting to be accepted)
+--     +0x10 = number of reads with latency 1 to 2 cycles
+--     +0x14 = number of reads with latency 3 to 4 cycles
+--     +0x18 = number of reads with latency 5 to 8 cycles
+--     +0x1c = number of reads with latency 9 cycles or more
+--   address 0x400 (read-write):
+--     bit 0 (rw)     = enable counting (enabled after reset)
+--     bit 1 (wo)     = write '1' to reset all counters to zero
+--     bits 11-8 (ro) = number of slaves
+--   address 0x404 (read-only):
+--     bits 31-0      = clock cycles counted since the counters were reset
+--
+-- Read latency is measured at the controller. Pipeline stages between
+-- the controller and the bus master add a constant number of cycles.
+-- Transactions to the monitor window itself are not counted.
+--
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -23,7 +51,13 @@ entity bus_ctrl is
         pipeline_cmd:   boolean;
 
         -- True to insert a pipeline stage in the response path.
-        pipeline_rsp:   boolean
+        pipeline_rsp:   boolean;
+
+        -- True to include the bus monitor (at most 14 slaves).
+        monitor:        boolean := false;
+
+        -- Start address of the 4 kByte bus monitor register window.
+        monitor_addr:   rvsys_addr_type := (others => '0')
     );
 
     port (
@@ -54,6 +88,14 @@ architecture bus_ctrl_arch of bus_ctrl is
 
     constant num_slv_idx_bits: integer := 4;
 
+    -- Slave index used for the bus monitor register window.
+    constant mon_slv_idx:   integer := 14;
+    constant mon_addr_size: unsigned(31 downto 0) := x"00001000";
+    constant mon_num_ctr:   integer := 8;
+
+    -- Bus monitor counters, 8 counters per slave.
+    type mon_counter_array is array(natural range <>) of unsigned(31 downto 0);
+
     -- Internal registers.
     type regs_type is record
         pending_read:   std_logic;
@@ -66,6 +108,13 @@ architecture bus_ctrl_arch of bus_ctrl is
         cmdpipe_slv_sel: std_logic_vector(num_slaves-1 downto 0);
         rsppipe_valid:  std_logic;
         rsppipe_rdata:  std_logic_vector(31 downto 0);
+        cmdpipe_mon_sel: std_logic;
+        mon_enable:     std_logic;
+        mon_counters:   mon_counter_array(0 to mon_num_ctr*num_slaves-1);
+        mon_cycles:     unsigned(31 downto 0);
+        mon_latency:    unsigned(15 downto 0);
+        mon_rsp_valid:  std_logic;
+        mon_rsp_rdata:  std_logic_vector(31 downto 0);
     end record;
 
     constant regs_init: regs_type := (
@@ -78,13 +127,24 @@ architecture bus_ctrl_arch of bus_ctrl is
         cmdpipe_wmask   => (others => '0'),
         cmdpipe_slv_sel => (others => '0'),
         rsppipe_valid   => '0',
-        rsppipe_rdata   => (others => '0'));
+        rsppipe_rdata   => (others => '0'),
+        cmdpipe_mon_sel => '0',
+        mon_enable      => '1',
+        mon_counters    => (others => (others => '0')),
+        mon_cycles      => (others => '0'),
+        mon_latency     => (others => '0'),
+        mon_rsp_valid   => '0',
+        mon_rsp_rdata   => (others => '0'));
 
     signal r: regs_type := regs_init;
     signal rnext: regs_type;
 
 begin
 
+    assert (not monitor) or (num_slaves <= mon_slv_idx)
+        report "bus_ctrl: bus monitor supports at most 14 slaves"
+        severity failure;
+
     -- Asynchronous process.
     process (all) is
         variable v: regs_type;
@@ -94,6 +154,13 @@ begin
         variable v_cmd_ready: std_logic;
         variable v_rsp_valid: std_logic;
         variable v_rsp_rdata: std_logic_vector(31 downto 0);
+        variable v_cmd_mon_sel: std_logic;
+        variable v_mon_valid: std_logic;
+        variable v_mon_addr:  rvsys_addr_type;
+        variable v_mon_write: std_logic;
+        variable v_mon_wdata: std_logic_vector(31 downto 0);
+        variable v_ctr_base:  integer range 0 to mon_num_ctr*num_slaves-1;
+        variable v_bucket:    integer range 0 to 3;
     begin
         -- By default, set next registers equal to current registers.
         v := r;
@@ -104,6 +171,16 @@ begin
         v_cmd_slv_sel   := (others => '0');
         v_cmd_slv_idx   := (others => '1');
         v_cmd_slv_ready := '1';
+        v_cmd_mon_sel   := '0';
+
+        -- Match address against the bus monitor window.
+        -- The monitor is always ready.
+        if monitor and
+           (unsigned(mst_cmd_addr) >= unsigned(monitor_addr)) and
+           (unsigned(mst_cmd_addr) <= unsigned(monitor_addr) + mon_addr_size - 1) then
+            v_cmd_mon_sel := mst_cmd_valid and (not r.pending_read);
+            v_cmd_slv_idx := to_unsigned(mon_slv_idx, num_slv_idx_bits);
+        end if;
 
         -- Match address against peripheral memory maps.
         for i in 0 to num_slaves - 1 loop
@@ -132,6 +209,7 @@ begin
             if r.cmdpipe_valid = '0' then
                 v.cmdpipe_valid := mst_cmd_valid and (not r.pending_read);
                 v.cmdpipe_slv_sel := v_cmd_slv_sel;
+                v.cmdpipe_mon_sel := v_cmd_mon_sel;
                 v.cmdpipe_addr  := mst_cmd_addr;
                 v.cmdpipe_write := mst_cmd_write;
                 v.cmdpipe_wdata := mst_cmd_wdata;
@@ -191,11 +269,123 @@ begin
             end if;
         end loop;
 
+        -- Handle read response from the bus monitor.
+        if monitor and (r.pending_slv_idx = mon_slv_idx) then
+            v_rsp_valid     := r.pending_read and r.mon_rsp_valid;
+            v_rsp_rdata     := r.mon_rsp_rdata;
+        end if;
+
         -- Clear pending read transaction when the response comes.
         if (r.pending_read = '1') and (v_rsp_valid = '1') then
             v.pending_read  := '0';
         end if;
 
+        -- Bus monitor.
+        if monitor then
+
+            -- Select the command that reaches the monitor in this cycle.
+            if pipeline_cmd then
+                v_mon_valid := r.cmdpipe_valid and r.cmdpipe_mon_sel;
+                v_mon_addr  := r.cmdpipe_addr;
+                v_mon_write := r.cmdpipe_write;
+                v_mon_wdata := r.cmdpipe_wdata;
+            else
+                v_mon_valid := v_cmd_mon_sel;
+                v_mon_addr  := mst_cmd_addr;
+                v_mon_write := mst_cmd_write;
+                v_mon_wdata := mst_cmd_wdata;
+            end if;
+
+            if r.mon_enable = '1' then
+                v.mon_cycles := r.mon_cycles + 1;
+
+                -- Count accepted commands.
+                if (mst_cmd_valid = '1') and (v_cmd_ready = '1') and
+                   (v_cmd_slv_idx < num_slaves) then
+                    v_ctr_base := mon_num_ctr * to_integer(v_cmd_slv_idx);
+                    if mst_cmd_write = '1' then
+                        v.mon_counters(v_ctr_base + 1) :=
+                            r.mon_counters(v_ctr_base + 1) + 1;
+                    else
+                        v.mon_counters(v_ctr_base) :=
+                            r.mon_counters(v_ctr_base) + 1;
+                    end if;
+                end if;
+
+                -- Count cycles where a command waits for the slave to
+                -- become ready.
+                for i in 0 to num_slaves - 1 loop
+                    if pipeline_cmd then
+                        if (r.cmdpipe_valid = '1') and
+                           (r.pending_slv_idx = i) and
+                           (slv_output(i).cmd_ready = '0') then
+                            v.mon_counters(mon_num_ctr * i + 3) :=
+                                r.mon_counters(mon_num_ctr * i + 3) + 1;
+                        end if;
+                    else
+                        if (v_cmd_slv_sel(i) = '1') and
+                           (slv_output(i).cmd_ready = '0') then
+                            v.mon_counters(mon_num_ctr * i + 3) :=
+                                r.mon_counters(mon_num_ctr * i + 3) + 1;
+                        end if;
+                    end if;
+                end loop;
+
+                -- Count read latency.
+                if (r.pending_read = '1') and (r.pending_slv_idx < num_slaves) then
+                    v_ctr_base := mon_num_ctr * to_integer(r.pending_slv_idx);
+                    v.mon_counters(v_ctr_base + 2) :=
+                        r.mon_counters(v_ctr_base + 2) + 1;
+                    if v_rsp_valid = '1' then
+                        if r.mon_latency <= 2 then
+                            v_bucket := 0;
+                        elsif r.mon_latency <= 4 then
+                            v_bucket := 1;
+                        elsif r.mon_latency <= 8 then
+                            v_bucket := 2;
+                        else
+                            v_bucket := 3;
+                        end if;
+                        v.mon_counters(v_ctr_base + 4 + v_bucket) :=
+                            r.mon_counters(v_ctr_base + 4 + v_bucket) + 1;
+                    end if;
+                end if;
+            end if;
+
+            -- Measure latency of the pending read transaction.
+            if (v_cmd_ready = '1') and (mst_cmd_valid = '1') then
+                v.mon_latency := to_unsigned(1, 16);
+            elsif (r.pending_read = '1') and (r.mon_latency /= x"ffff") then
+                v.mon_latency := r.mon_latency + 1;
+            end if;
+
+            -- Handle monitor register access.
+            v.mon_rsp_valid := v_mon_valid and (not v_mon_write);
+            v.mon_rsp_rdata := (others => '0');
+            if v_mon_addr(10) = '0' then
+                if to_integer(unsigned(v_mon_addr(9 downto 2))) < mon_num_ctr * num_slaves then
+                    v.mon_rsp_rdata := std_logic_vector(
+                        r.mon_counters(to_integer(unsigned(v_mon_addr(9 downto 2)))));
+                end if;
+            elsif v_mon_addr(2) = '0' then
+                v.mon_rsp_rdata(0) := r.mon_enable;
+                v.mon_rsp_rdata(11 downto 8) :=
+                    std_logic_vector(to_unsigned(num_slaves, 4));
+            else
+                v.mon_rsp_rdata := std_logic_vector(r.mon_cycles);
+            end if;
+
+            if (v_mon_valid = '1') and (v_mon_write = '1')
+               and (v_mon_addr(10) = '1') and (v_mon_addr(2) = '0') then
+                v.mon_enable := v_mon_wdata(0);
+                if v_mon_wdata(1) = '1' then
+                    v.mon_counters := (others => (others => '0'));
+                    v.mon_cycles   := (others => '0');
+                end if;
+            end if;
+
+        end if;
+
         if pipeline_rsp then
 
             -- Drive the pipelined read response to the master.
@@ -220,6 +410,11 @@ begin
             v.cmdpipe_valid := '0';
             v.cmdpipe_slv_sel := (others => '0');
             v.rsppipe_valid := '0';
+            v.cmdpipe_mon_sel := '0';
+            v.mon_enable    := '1';
+            v.mon_counters  := (others => (others => '0'));
+            v.mon_cycles    := (others => '0');
+            v.mon_rsp_valid := '0';
         end if;
 
         -- Drive ready signal to bus master.
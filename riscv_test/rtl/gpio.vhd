@@ -3,10 +3,56 @@
 --
 -- Partial-word writes (byte, half-word) are not supported.
 --
+-- The controller optionally contains an event scheduler which changes
+-- output signals at exact times. Software queues events, each consisting
+-- of a time, a mask and a value. The scheduler compares the time of the
+-- oldest queued event against the MTIME counter of the timer peripheral.
+-- When MTIME reaches the event time, the output channels selected by
+-- the mask take the new value. The new output state appears on the clock
+-- edge at which MTIME advances from the event time to the next count,
+-- independent of bus latency or interrupt latency. The timer and the GPIO
+-- controller must therefore run on the same clock.
+--
+-- Events must be queued in order of increasing time. The scheduler applies
+-- at most one event per clock cycle; changes that must happen at the same
+-- time must be combined into one event. An event whose time has already
+-- passed when it reaches the head of the queue is applied immediately
+-- and sets the LATE flag.
+--
+-- The event interrupt is active while the interrupt is enabled and
+-- the number of queued events is at most the interrupt threshold.
+-- This allows software to refill the queue from an interrupt handler
+-- while a long sequence plays out.
+--
 -- Register map:
---   address 0: (read-only)  captured input signals
---   address 4: (read-write) active output signals
---   address 8: (read-write) input/output direction flags (0=input, 1=output)
+--   address 0x00: (read-only)  captured input signals
+--   address 0x04: (read-write) active output signals
+--   address 0x08: (read-write) input/output direction flags (0=input, 1=output)
+--
+--   address 0x10 (read): Scheduler status
+--     bits  7-0  = Number of events in the queue.
+--     bits 15-8  = Capacity of the queue (0 if there is no scheduler).
+--     bit  16    = '1' if an event was applied after its time (LATE flag).
+--     bit  17    = '1' if an event was dropped because the queue was full
+--                  (OVERFLOW flag).
+--
+--   address 0x10 (write): Scheduler command
+--     bit  16    = '1' to clear the LATE flag.
+--     bit  17    = '1' to clear the OVERFLOW flag.
+--     bit  31    = '1' to discard all queued events.
+--
+--   address 0x14 (read-write): Scheduler control
+--     bits  7-0  = Interrupt threshold.
+--     bit  31    = '1' to enable the event interrupt.
+--
+--   address 0x18 (read-write): Bits 31-0 of the time of the next event.
+--   address 0x1c (read-write): Bits 63-32 of the time of the next event.
+--   address 0x20 (read-write): Mask of the next event.
+--   address 0x24 (read-write): Value of the next event.
+--     Writing this register queues an event with the time and mask
+--     from registers 0x18 - 0x20. Those registers keep their value,
+--     so consecutive events with the same mask or the same high time word
+--     need fewer register writes.
 --
 
 library ieee;
@@ -19,6 +65,14 @@ use work.rvsys.all;
 
 entity gpio is
 
+    generic (
+        -- True to include the event scheduler.
+        sched_enable:   boolean := false;
+
+        -- Size of the event queue as 2-log of the number of entries.
+        sched_bits:     integer range 2 to 7 := 4
+    );
+
     port (
         -- System clock.
         clk:            in  std_logic;
@@ -26,6 +80,12 @@ entity gpio is
         -- Synchronous reset, active high.
         rst:            in  std_logic;
 
+        -- Current value of the MTIME counter (used by the event scheduler).
+        mtime:          in  std_logic_vector(63 downto 0);
+
+        -- Event interrupt output, active high.
+        interrupt:      out std_logic;
+
         -- GPIO input/output/tri-state signals.
         gpio_i:         in  std_logic_vector(31 downto 0);
         gpio_o:         out std_logic_vector(31 downto 0);
@@ -40,11 +100,29 @@ end entity;
 
 architecture gpio_arch of gpio is
 
+    -- Event queue memory: time (127:64), mask (63:32), value (31:0).
+    type evq_mem_type is array(0 to 2**sched_bits-1) of std_logic_vector(127 downto 0);
+
+    signal evq_mem:     evq_mem_type;
+
     -- Internal registers.
     type regs_type is record
         reg_input:      std_logic_vector(31 downto 0);
         reg_output:     std_logic_vector(31 downto 0);
         reg_direction:  std_logic_vector(31 downto 0);
+        reg_evt_time:   std_logic_vector(63 downto 0);
+        reg_evt_mask:   std_logic_vector(31 downto 0);
+        reg_evt_value:  std_logic_vector(31 downto 0);
+        reg_threshold:  unsigned(7 downto 0);
+        reg_irq_enable: std_logic;
+        flag_late:      std_logic;
+        flag_overflow:  std_logic;
+        evq_rptr:       unsigned(sched_bits downto 0);
+        evq_wptr:       unsigned(sched_bits downto 0);
+        evq_wen:        std_logic;
+        evq_waddr:      unsigned(sched_bits-1 downto 0);
+        evq_wdata:      std_logic_vector(127 downto 0);
+        interrupt_out:  std_logic;
         rsp_valid:      std_logic;
         rsp_rdata:      std_logic_vector(31 downto 0);
     end record;
@@ -53,6 +131,19 @@ architecture gpio_arch of gpio is
         reg_input       => (others => '0'),
         reg_output      => (others => '0'),
         reg_direction   => (others => '0'),
+        reg_evt_time    => (others => '0'),
+        reg_evt_mask    => (others => '0'),
+        reg_evt_value   => (others => '0'),
+        reg_threshold   => (others => '0'),
+        reg_irq_enable  => '0',
+        flag_late       => '0',
+        flag_overflow   => '0',
+        evq_rptr        => (others => '0'),
+        evq_wptr        => (others => '0'),
+        evq_wen         => '0',
+        evq_waddr       => (others => '0'),
+        evq_wdata       => (others => '0'),
+        interrupt_out   => '0',
         rsp_valid       => '0',
         rsp_rdata       => (others => '0'));
 
@@ -64,6 +155,7 @@ begin
     -- Drive outputs.
     gpio_o      <= r.reg_output;
     gpio_t      <= not r.reg_direction;
+    interrupt   <= r.interrupt_out;
     slv_output  <= ( cmd_ready => '1',
                      rsp_valid => r.rsp_valid,
                      rsp_rdata => r.rsp_rdata );
@@ -71,34 +163,139 @@ begin
     -- Asynchronous process.
     process (all) is
         variable v: regs_type;
+        variable v_level:       unsigned(sched_bits downto 0);
+        variable v_full:        boolean;
+        variable v_head:        std_logic_vector(127 downto 0);
+        variable v_head_time:   unsigned(63 downto 0);
+        variable v_head_mask:   std_logic_vector(31 downto 0);
+        variable v_flush:       boolean;
     begin
         -- By default, set next registers equal to current registers.
         v := r;
+        v.evq_wen := '0';
+
+        -- Determine event queue status.
+        v_level     := r.evq_wptr - r.evq_rptr;
+        v_full      := (v_level(sched_bits) = '1');
+        v_head      := evq_mem(to_integer(r.evq_rptr(sched_bits-1 downto 0)));
+        v_head_time := unsigned(v_head(127 downto 64));
+        v_head_mask := v_head(63 downto 32);
+        v_flush     := false;
 
         -- Capture input signals.
         v.reg_input     := gpio_i;
 
         -- Handle write transactions.
         if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
-            if slv_input.cmd_addr(3 downto 2) = "01" then
-                -- addr 4 = output register
-                v.reg_output    := slv_input.cmd_wdata;
-            end if;
-            if slv_input.cmd_addr(3 downto 2) = "10" then
-                -- addr 8 = direction register
-                v.reg_direction := slv_input.cmd_wdata;
+            case slv_input.cmd_addr(5 downto 2) is
+                when "0001" =>
+                    -- addr 0x04 = output register
+                    v.reg_output    := slv_input.cmd_wdata;
+                when "0010" =>
+                    -- addr 0x08 = direction register
+                    v.reg_direction := slv_input.cmd_wdata;
+                when "0100" =>
+                    -- addr 0x10 = scheduler command
+                    if slv_input.cmd_wdata(16) = '1' then
+                        v.flag_late     := '0';
+                    end if;
+                    if slv_input.cmd_wdata(17) = '1' then
+                        v.flag_overflow := '0';
+                    end if;
+                    v_flush := (slv_input.cmd_wdata(31) = '1');
+                when "0101" =>
+                    -- addr 0x14 = scheduler control
+                    v.reg_threshold  := unsigned(slv_input.cmd_wdata(7 downto 0));
+                    v.reg_irq_enable := slv_input.cmd_wdata(31);
+                when "0110" =>
+                    -- addr 0x18 = low 32 bits of event time
+                    v.reg_evt_time(31 downto 0)  := slv_input.cmd_wdata;
+                when "0111" =>
+                    -- addr 0x1c = high 32 bits of event time
+                    v.reg_evt_time(63 downto 32) := slv_input.cmd_wdata;
+                when "1000" =>
+                    -- addr 0x20 = event mask
+                    v.reg_evt_mask  := slv_input.cmd_wdata;
+                when "1001" =>
+                    -- addr 0x24 = event value, queue event
+                    v.reg_evt_value := slv_input.cmd_wdata;
+                    if not sched_enable then
+                        -- no scheduler, ignore event
+                        null;
+                    elsif v_full then
+                        v.flag_overflow := '1';
+                    else
+                        v.evq_wen   := '1';
+                        v.evq_waddr := r.evq_wptr(sched_bits-1 downto 0);
+                        v.evq_wdata := r.reg_evt_time & r.reg_evt_mask &
+                                       slv_input.cmd_wdata;
+                        v.evq_wptr  := r.evq_wptr + 1;
+                    end if;
+                when others =>
+                    null;
+            end case;
+        end if;
+
+        -- Apply the oldest event when MTIME reaches its time.
+        -- This overrides a bus write to the output register in the same cycle.
+        if sched_enable and (r.evq_wptr /= r.evq_rptr)
+                and (unsigned(mtime) >= v_head_time) then
+            v.reg_output := (v.reg_output and (not v_head_mask)) or
+                            (v_head(31 downto 0) and v_head_mask);
+            if unsigned(mtime) /= v_head_time then
+                v.flag_late := '1';
             end if;
+            v.evq_rptr := r.evq_rptr + 1;
+        end if;
+
+        -- Discard all queued events.
+        if v_flush then
+            v.evq_rptr := v.evq_wptr;
+        end if;
+
+        -- Drive interrupt while the queue is at or below the threshold.
+        if sched_enable and (r.reg_irq_enable = '1') and
+                (v.evq_wptr - v.evq_rptr <= r.reg_threshold) then
+            v.interrupt_out := '1';
+        else
+            v.interrupt_out := '0';
         end if;
 
         -- Handle read transactions.
         v.rsp_valid     := slv_input.cmd_valid and (not slv_input.cmd_write);
-        case slv_input.cmd_addr(3 downto 2) is
-            when "01" =>
-                -- addr 4 = output register
+        case slv_input.cmd_addr(5 downto 2) is
+            when "0001" =>
+                -- addr 0x04 = output register
                 v.rsp_rdata     := r.reg_output;
-            when "10" =>
-                -- addr 8 = direction register
+            when "0010" =>
+                -- addr 0x08 = direction register
                 v.rsp_rdata     := r.reg_direction;
+            when "0100" =>
+                -- addr 0x10 = scheduler status
+                v.rsp_rdata     := (others => '0');
+                if sched_enable then
+                    v.rsp_rdata(7 downto 0)  := std_logic_vector(resize(v_level, 8));
+                    v.rsp_rdata(15 downto 8) := std_logic_vector(to_unsigned(2**sched_bits, 8));
+                end if;
+                v.rsp_rdata(16) := r.flag_late;
+                v.rsp_rdata(17) := r.flag_overflow;
+            when "0101" =>
+                -- addr 0x14 = scheduler control
+                v.rsp_rdata     := (others => '0');
+                v.rsp_rdata(7 downto 0) := std_logic_vector(r.reg_threshold);
+                v.rsp_rdata(31) := r.reg_irq_enable;
+            when "0110" =>
+                -- addr 0x18 = low 32 bits of event time
+                v.rsp_rdata     := r.reg_evt_time(31 downto 0);
+            when "0111" =>
+                -- addr 0x1c = high 32 bits of event time
+                v.rsp_rdata     := r.reg_evt_time(63 downto 32);
+            when "1000" =>
+                -- addr 0x20 = event mask
+                v.rsp_rdata     := r.reg_evt_mask;
+            when "1001" =>
+                -- addr 0x24 = event value
+                v.rsp_rdata     := r.reg_evt_value;
             when others =>
                 -- input register
                 v.rsp_rdata     := r.reg_input;
@@ -108,6 +305,14 @@ begin
         if rst = '1' then
             v.reg_output    := (others => '0');
             v.reg_direction := (others => '0');
+            v.reg_threshold := (others => '0');
+            v.reg_irq_enable := '0';
+            v.flag_late     := '0';
+            v.flag_overflow := '0';
+            v.evq_rptr      := (others => '0');
+            v.evq_wptr      := (others => '0');
+            v.evq_wen       := '0';
+            v.interrupt_out := '0';
             v.rsp_valid     := '0';
         end if;
 
@@ -124,4 +329,15 @@ begin
         end if;
     end process;
 
+    -- Event queue memory.
+    -- Reads are asynchronous, such that the oldest event is always visible.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if rnext.evq_wen = '1' then
+                evq_mem(to_integer(rnext.evq_waddr)) <= rnext.evq_wdata;
+            end if;
+        end if;
+    end process;
+
 end architecture;
@@ -0,0 +1,542 @@
+--
+-- I2C master for simple processor system
+--
+-- This controller executes a sequence of bus operations queued by software
+-- in a command FIFO: START (or repeated START), WRITE byte, READ byte with
+-- ACK or NACK, and STOP. Bytes read from the bus are stored in a read FIFO.
+-- A transaction of several bytes can thus be queued at once; software only
+-- needs to come back when the STOP has completed.
+--
+-- Each bit takes 4 quarter periods of the SCL clock. The quarter period
+-- is programmable, which supports standard mode (100 kHz), fast mode
+-- (400 kHz) and fast-plus mode (1 MHz). The controller supports clock
+-- stretching: while SCL is released, the bit timing waits until the SCL
+-- line is actually high.
+--
+-- If a slave does not acknowledge a written byte, the controller sets
+-- the NACK flag and discards all queued commands up to the next STOP.
+-- It then executes the STOP command to release the bus.
+--
+-- Between START and STOP, the controller holds SCL low while it waits
+-- for commands, or for space in the read FIFO before a READ command.
+-- It then reports a stall, so software can refill or drain the FIFOs
+-- of a transaction that does not fit in the FIFOs at once.
+--
+-- Only single-master operation is supported; there is no arbitration.
+--
+-- The SCL and SDA outputs are open-drain. When "scl_t" or "sda_t" is '1',
+-- the pin must be released (tri-state); when it is '0', the pin must be
+-- driven low. The "pin_enable" output tells the top level to connect
+-- the pins to this controller instead of to GPIO.
+--
+-- Register map:
+--
+--   address 0x00 (read): Status
+--     bit   0    = '1' while commands are pending or executing.
+--     bit   1    = '1' when the command FIFO can accept a new command.
+--     bit   2    = '1' when a byte is available in the read FIFO.
+--     bit   3    = '1' when a STOP command has completed (done flag).
+--     bit   4    = '1' when a slave did not acknowledge a byte (NACK flag).
+--     bit   5    = '1' when a transaction is stalled, waiting for commands
+--                  or for space in the read FIFO.
+--     bits 15-8  = Number of commands in the command FIFO.
+--     bits 23-16 = Number of bytes in the read FIFO.
+--
+--   address 0x00 (write): Clear flags
+--     bit   3    = '1' to clear the done flag.
+--     bit   4    = '1' to clear the NACK flag.
+--
+--   address 0x04 (when write): Queue command
+--     bits  7-0  = Data byte (for WRITE).
+--     bits 10-8  = Command code:
+--                    1 = START or repeated START
+--                    2 = STOP
+--                    3 = WRITE byte
+--                    4 = READ byte, then send ACK
+--                    5 = READ byte, then send NACK
+--       If bit 1 of register 0x00 is '0', writes to this register are ignored.
+--
+--   address 0x04 (when read): Read data
+--     bits  7-0  = Oldest byte from the read FIFO.
+--     bit   8    = '1' when returning valid data,
+--                  '0' if the read FIFO was empty.
+--       Reading from this register removes the byte from the read FIFO.
+--
+--   address 0x08 (read-write): Clock configuration
+--     bits 15-0  = SCL quarter period in system clock cycles (minimum 2).
+--                  (SCL frequency) = (system clock frequency) / (4 * N)
+--
+--   address 0x0c (read-write): Control
+--     bit   0    = '1' to connect the I2C pins to this controller.
+--     bit   1    = '1' to drive the interrupt output while the done flag
+--                  is set or a transaction is stalled.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity i2c_master is
+
+    generic (
+        -- Size of the command FIFO and read FIFO as 2-log of the number of entries.
+        fifo_bits:      integer range 2 to 7
+    );
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- I2C signals.
+        scl_i:          in  std_logic;
+        scl_t:          out std_logic;
+        sda_i:          in  std_logic;
+        sda_t:          out std_logic;
+
+        -- High to connect the I2C pins to this controller.
+        pin_enable:     out std_logic;
+
+        -- Interrupt output, active high.
+        interrupt:      out std_logic;
+
+        -- Bus interface signals.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
+    );
+
+end entity;
+
+architecture i2c_master_arch of i2c_master is
+
+    -- Command codes.
+    constant cmd_start:     std_logic_vector(2 downto 0) := "001";
+    constant cmd_stop:      std_logic_vector(2 downto 0) := "010";
+    constant cmd_write:     std_logic_vector(2 downto 0) := "011";
+    constant cmd_read_ack:  std_logic_vector(2 downto 0) := "100";
+    constant cmd_read_nack: std_logic_vector(2 downto 0) := "101";
+
+    -- FIFO memory types.
+    type cmd_fifo_mem_type is array(0 to 2**fifo_bits-1) of std_logic_vector(10 downto 0);
+    type read_fifo_mem_type is array(0 to 2**fifo_bits-1) of std_logic_vector(7 downto 0);
+
+    signal cmdf_mem:    cmd_fifo_mem_type;
+    signal rdf_mem:     read_fifo_mem_type;
+
+    -- Synchronized SCL and SDA inputs.
+    signal s_scl_sync:  std_logic;
+    signal s_sda_sync:  std_logic;
+
+    -- State machine.
+    type state_type is (State_Idle, State_Start, State_Stop, State_Bit);
+
+    -- Internal registers.
+    type regs_type is record
+        state:          state_type;
+        cmd:            std_logic_vector(2 downto 0);
+        phase:          unsigned(1 downto 0);
+        qcnt:           unsigned(15 downto 0);
+        bit_cnt:        unsigned(3 downto 0);
+        shift_reg:      std_logic_vector(7 downto 0);
+        flush:          std_logic;
+        bus_active:     std_logic;
+        cmdf_rptr:      unsigned(fifo_bits downto 0);
+        cmdf_wptr:      unsigned(fifo_bits downto 0);
+        cmdf_wen:       std_logic;
+        cmdf_waddr:     unsigned(fifo_bits-1 downto 0);
+        cmdf_wdata:     std_logic_vector(10 downto 0);
+        rdf_rptr:       unsigned(fifo_bits downto 0);
+        rdf_wptr:       unsigned(fifo_bits downto 0);
+        rdf_wen:        std_logic;
+        rdf_waddr:      unsigned(fifo_bits-1 downto 0);
+        rdf_wdata:      std_logic_vector(7 downto 0);
+        reg_quarter:    unsigned(15 downto 0);
+        reg_pin_enable: std_logic;
+        reg_irq_enable: std_logic;
+        flag_done:      std_logic;
+        flag_nack:      std_logic;
+        scl_t:          std_logic;
+        sda_t:          std_logic;
+        interrupt_out:  std_logic;
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        state           => State_Idle,
+        cmd             => (others => '0'),
+        phase           => (others => '0'),
+        qcnt            => (others => '0'),
+        bit_cnt         => (others => '0'),
+        shift_reg       => (others => '0'),
+        flush           => '0',
+        bus_active      => '0',
+        cmdf_rptr       => (others => '0'),
+        cmdf_wptr       => (others => '0'),
+        cmdf_wen        => '0',
+        cmdf_waddr      => (others => '0'),
+        cmdf_wdata      => (others => '0'),
+        rdf_rptr        => (others => '0'),
+        rdf_wptr        => (others => '0'),
+        rdf_wen         => '0',
+        rdf_waddr       => (others => '0'),
+        rdf_wdata       => (others => '0'),
+        reg_quarter     => to_unsigned(250, 16),
+        reg_pin_enable  => '0',
+        reg_irq_enable  => '0',
+        flag_done       => '0',
+        flag_nack       => '0',
+        scl_t           => '1',
+        sda_t           => '1',
+        interrupt_out   => '0',
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0')
+    );
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+begin
+
+    -- Synchronize inputs.
+    inst_sync_scl: entity work.syncdff
+        port map (
+            clk => clk,
+            di  => scl_i,
+            do  => s_scl_sync );
+
+    inst_sync_sda: entity work.syncdff
+        port map (
+            clk => clk,
+            di  => sda_i,
+            do  => s_sda_sync );
+
+    -- Drive outputs.
+    scl_t       <= r.scl_t;
+    sda_t       <= r.sda_t;
+    pin_enable  <= r.reg_pin_enable;
+    interrupt   <= r.interrupt_out;
+    slv_output  <= ( cmd_ready => '1',
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_cmd_level:   unsigned(fifo_bits downto 0);
+        variable v_cmd_empty:   boolean;
+        variable v_cmd_full:    boolean;
+        variable v_cmd_head:    std_logic_vector(10 downto 0);
+        variable v_read_level:  unsigned(fifo_bits downto 0);
+        variable v_read_empty:  boolean;
+        variable v_read_full:   boolean;
+        variable v_quarter_end: boolean;
+        variable v_stalled:     std_logic;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+        v.cmdf_wen := '0';
+        v.rdf_wen  := '0';
+
+        -- Determine FIFO status.
+        v_cmd_level  := r.cmdf_wptr - r.cmdf_rptr;
+        v_cmd_empty  := (r.cmdf_wptr = r.cmdf_rptr);
+        v_cmd_full   := (v_cmd_level(fifo_bits) = '1');
+        v_cmd_head   := cmdf_mem(to_integer(r.cmdf_rptr(fifo_bits-1 downto 0)));
+        v_read_level := r.rdf_wptr - r.rdf_rptr;
+        v_read_empty := (r.rdf_wptr = r.rdf_rptr);
+        v_read_full  := (v_read_level(fifo_bits) = '1');
+
+        v_stalled := '0';
+
+        -- Count down the current quarter period.
+        -- While SCL is released but still low, a slave is stretching
+        -- the clock and the quarter period does not start.
+        v_quarter_end := false;
+        if r.scl_t = '1' and s_scl_sync = '0' then
+            v.qcnt := r.reg_quarter - 1;
+        elsif r.qcnt = 0 then
+            v_quarter_end := true;
+            v.qcnt  := r.reg_quarter - 1;
+            v.phase := r.phase + 1;
+        else
+            v.qcnt := r.qcnt - 1;
+        end if;
+
+        -- State machine.
+        case r.state is
+
+            when State_Idle =>
+                -- Wait for next command.
+                v.phase := (others => '0');
+                v.qcnt  := r.reg_quarter - 1;
+
+                if v_cmd_empty then
+                    -- Waiting for commands in the middle of a transaction.
+                    v_stalled := r.bus_active;
+                else
+                    if r.flush = '1' and v_cmd_head(10 downto 8) /= cmd_stop then
+                        -- Discard commands after NACK until STOP.
+                        v.cmdf_rptr := r.cmdf_rptr + 1;
+                    elsif (v_cmd_head(10 downto 8) = cmd_read_ack
+                           or v_cmd_head(10 downto 8) = cmd_read_nack)
+                          and v_read_full then
+                        -- Wait for space in the read FIFO.
+                        v_stalled := r.bus_active;
+                    else
+                        v.cmdf_rptr := r.cmdf_rptr + 1;
+                        v.cmd       := v_cmd_head(10 downto 8);
+                        v.shift_reg := v_cmd_head(7 downto 0);
+                        v.bit_cnt   := (others => '0');
+                        case v_cmd_head(10 downto 8) is
+                            when cmd_start =>
+                                v.bus_active := '1';
+                                v.state := State_Start;
+                            when cmd_stop =>
+                                v.flush := '0';
+                                v.state := State_Stop;
+                            when cmd_write =>
+                                v.state := State_Bit;
+                            when cmd_read_ack | cmd_read_nack =>
+                                v.state := State_Bit;
+                            when others =>
+                                null;
+                        end case;
+                    end if;
+                end if;
+
+            when State_Start =>
+                -- (Repeated) START condition.
+                --   phase 0: release SDA
+                --   phase 1: release SCL, wait for SCL high
+                --   phase 2: pull SDA low (START condition)
+                --   phase 3: hold, then pull SCL low
+                case r.phase is
+                    when "00" =>
+                        v.sda_t := '1';
+                    when "01" =>
+                        v.scl_t := '1';
+                    when "10" =>
+                        v.sda_t := '0';
+                    when others =>
+                        null;
+                end case;
+                if v_quarter_end and r.phase = 3 then
+                    v.scl_t := '0';
+                    v.state := State_Idle;
+                end if;
+
+            when State_Stop =>
+                -- STOP condition.
+                --   phase 0: pull SDA low
+                --   phase 1: release SCL, wait for SCL high
+                --   phase 2: release SDA (STOP condition)
+                --   phase 3: bus free time
+                case r.phase is
+                    when "00" =>
+                        v.sda_t := '0';
+                    when "01" =>
+                        v.scl_t := '1';
+                    when "10" =>
+                        v.sda_t := '1';
+                    when others =>
+                        null;
+                end case;
+                if v_quarter_end and r.phase = 3 then
+                    v.flag_done  := '1';
+                    v.bus_active := '0';
+                    v.state      := State_Idle;
+                end if;
+
+            when State_Bit =>
+                -- Transfer one bit; 8 data bits followed by 1 ACK bit.
+                --   phase 0: SCL low
+                --   phase 1: drive SDA
+                --   phase 2: release SCL, wait for SCL high
+                --   phase 3: SCL high; sample SDA at the start of this phase,
+                --            pull SCL low at the end
+                case r.phase is
+                    when "00" =>
+                        v.scl_t := '0';
+                    when "01" =>
+                        if r.bit_cnt = 8 then
+                            -- ACK bit: master drives it only when reading.
+                            if r.cmd = cmd_read_ack then
+                                v.sda_t := '0';
+                            else
+                                v.sda_t := '1';
+                            end if;
+                        elsif r.cmd = cmd_write then
+                            v.sda_t := r.shift_reg(7);
+                        else
+                            -- Release SDA while reading.
+                            v.sda_t := '1';
+                        end if;
+                    when "10" =>
+                        v.scl_t := '1';
+                    when others =>
+                        null;
+                end case;
+
+                if v_quarter_end and r.phase = 2 then
+                    -- Sample SDA.
+                    if r.bit_cnt = 8 then
+                        if r.cmd = cmd_write then
+                            if s_sda_sync = '1' then
+                                -- Slave did not acknowledge.
+                                v.flag_nack := '1';
+                                v.flush     := '1';
+                            end if;
+                        else
+                            -- Store the received byte.
+                            v.rdf_wen   := '1';
+                            v.rdf_waddr := r.rdf_wptr(fifo_bits-1 downto 0);
+                            v.rdf_wdata := r.shift_reg;
+                            v.rdf_wptr  := r.rdf_wptr + 1;
+                        end if;
+                    else
+                        v.shift_reg := r.shift_reg(6 downto 0) & s_sda_sync;
+                    end if;
+                end if;
+
+                if v_quarter_end and r.phase = 3 then
+                    v.scl_t   := '0';
+                    v.bit_cnt := r.bit_cnt + 1;
+                    if r.bit_cnt = 8 then
+                        -- Keep SCL low and release SDA after the ACK bit.
+                        v.sda_t := '1';
+                        v.state := State_Idle;
+                    end if;
+                end if;
+
+        end case;
+
+        -- Drive interrupt output.
+        v.interrupt_out := (r.flag_done or v_stalled) and r.reg_irq_enable;
+
+        -- Answer read transactions after 1 clock cycle.
+        v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
+
+        -- Handle bus read transactions.
+        if slv_input.cmd_valid = '1' and slv_input.cmd_write = '0' then
+
+            -- By default return all zeros.
+            v.rsp_rdata := (others => '0');
+
+            case slv_input.cmd_addr(3 downto 2) is
+
+                when "00" =>
+                    -- address 0x00 = status register
+                    if r.state /= State_Idle or (not v_cmd_empty) then
+                        v.rsp_rdata(0) := '1';
+                    end if;
+                    if not v_cmd_full then
+                        v.rsp_rdata(1) := '1';
+                    end if;
+                    if not v_read_empty then
+                        v.rsp_rdata(2) := '1';
+                    end if;
+                    v.rsp_rdata(3) := r.flag_done;
+                    v.rsp_rdata(4) := r.flag_nack;
+                    v.rsp_rdata(5) := v_stalled;
+                    v.rsp_rdata(15 downto 8)  := std_logic_vector(resize(v_cmd_level, 8));
+                    v.rsp_rdata(23 downto 16) := std_logic_vector(resize(v_read_level, 8));
+
+                when "01" =>
+                    -- address 0x04 = read data
+                    if not v_read_empty then
+                        -- Pop data from read FIFO
+                        v.rsp_rdata(7 downto 0) :=
+                            rdf_mem(to_integer(r.rdf_rptr(fifo_bits-1 downto 0)));
+                        v.rsp_rdata(8) := '1';
+                        v.rdf_rptr := r.rdf_rptr + 1;
+                    end if;
+
+                when "10" =>
+                    -- address 0x08 = clock configuration
+                    v.rsp_rdata(15 downto 0) := std_logic_vector(r.reg_quarter);
+
+                when others =>
+                    -- address 0x0c = control register
+                    v.rsp_rdata(0) := r.reg_pin_enable;
+                    v.rsp_rdata(1) := r.reg_irq_enable;
+
+            end case;
+        end if;
+
+        -- Handle bus write transactions.
+        if slv_input.cmd_valid = '1' and slv_input.cmd_write = '1' then
+
+            case slv_input.cmd_addr(3 downto 2) is
+
+                when "00" =>
+                    -- address 0x00 = clear flags
+                    if slv_input.cmd_wdata(3) = '1' then
+                        v.flag_done := '0';
+                    end if;
+                    if slv_input.cmd_wdata(4) = '1' then
+                        v.flag_nack := '0';
+                    end if;
+
+                when "01" =>
+                    -- address 0x04 = queue command
+                    if not v_cmd_full then
+                        v.cmdf_wen   := '1';
+                        v.cmdf_waddr := r.cmdf_wptr(fifo_bits-1 downto 0);
+                        v.cmdf_wdata := slv_input.cmd_wdata(10 downto 0);
+                        v.cmdf_wptr  := r.cmdf_wptr + 1;
+                    end if;
+
+                when "10" =>
+                    -- address 0x08 = clock configuration
+                    if unsigned(slv_input.cmd_wdata(15 downto 0)) >= 2 then
+                        v.reg_quarter := unsigned(slv_input.cmd_wdata(15 downto 0));
+                    end if;
+
+                when others =>
+                    -- address 0x0c = control register
+                    v.reg_pin_enable := slv_input.cmd_wdata(0);
+                    v.reg_irq_enable := slv_input.cmd_wdata(1);
+
+            end case;
+        end if;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+    -- FIFO memories.
+    -- Reads are asynchronous, such that the oldest entry is always visible.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if rnext.cmdf_wen = '1' then
+                cmdf_mem(to_integer(rnext.cmdf_waddr)) <= rnext.cmdf_wdata;
+            end if;
+            if rnext.rdf_wen = '1' then
+                rdf_mem(to_integer(rnext.rdf_waddr)) <= rnext.rdf_wdata;
+            end if;
+        end if;
+    end process;
+
+end architecture;
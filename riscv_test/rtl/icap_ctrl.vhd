@@ -0,0 +1,183 @@
+--
+-- ICAPE2 configuration port controller for simple processor system
+--
+-- This peripheral gives software access to the internal configuration
+-- access port (ICAPE2) of the FPGA. Software can use it to read
+-- configuration registers (for example BOOTSTS), or to send an IPROG
+-- command which reloads the FPGA from a different bitstream in the
+-- configuration flash memory (multiboot).
+--
+-- The controller only transfers 32-bit words. Software is responsible
+-- for generating the complete configuration command sequence
+-- (dummy word, sync word, packet headers, etc).
+-- The bit order within each byte is swapped automatically, such that
+-- software can use the same word values as in a bitstream file.
+--
+-- Partial-word writes (byte, half-word) are not supported.
+--
+-- Register map:
+--   address 0 (read-write):
+--     bit 0 (rw)     = read mode (RDWRB): '0' = write, '1' = read
+--     bit 1 (rw)     = read select: when set in read mode, the ICAP
+--                      is selected and output words are captured
+--   address 4 (write):
+--     bits 31-0 (wo) = word to write to the ICAP (only in write mode)
+--   address 4 (read):
+--     bits 31-0 (ro) = last word captured from the ICAP in read mode
+--
+-- Software must not change the read mode bit while read select is active.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library unisim;
+use unisim.vcomponents.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity icap_ctrl is
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Bus interface signals.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
+    );
+
+end entity;
+
+architecture icap_ctrl_arch of icap_ctrl is
+
+    -- Reverse the bit order within each byte of a word.
+    function swap_bits_in_bytes(w: std_logic_vector(31 downto 0))
+        return std_logic_vector
+    is
+        variable y: std_logic_vector(31 downto 0);
+    begin
+        for i in 0 to 3 loop
+            for k in 0 to 7 loop
+                y(8*i + k) := w(8*i + 7 - k);
+            end loop;
+        end loop;
+        return y;
+    end function;
+
+    -- Internal registers.
+    type regs_type is record
+        read_mode:      std_logic;
+        read_select:    std_logic;
+        icap_csib:      std_logic;
+        icap_rdwrb:     std_logic;
+        icap_wdata:     std_logic_vector(31 downto 0);
+        icap_rdata:     std_logic_vector(31 downto 0);
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        read_mode       => '0',
+        read_select     => '0',
+        icap_csib       => '1',
+        icap_rdwrb      => '0',
+        icap_wdata      => (others => '0'),
+        icap_rdata      => (others => '0'),
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0'));
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    signal s_icap_o:    std_logic_vector(31 downto 0);
+
+begin
+
+    -- Drive outputs.
+    slv_output  <= ( cmd_ready => '1',
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+
+    -- Internal configuration access port.
+    inst_icape2: ICAPE2
+        generic map (
+            ICAP_WIDTH  => "X32" )
+        port map (
+            CLK         => clk,
+            CSIB        => r.icap_csib,
+            I           => r.icap_wdata,
+            O           => s_icap_o,
+            RDWRB       => r.icap_rdwrb );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+
+        -- Deselect ICAP by default.
+        v.icap_csib := '1';
+
+        -- Handle write transactions.
+        if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
+            if slv_input.cmd_addr(2) = '0' then
+                -- addr 0 = control register
+                v.read_mode   := slv_input.cmd_wdata(0);
+                v.read_select := slv_input.cmd_wdata(1);
+            elsif r.read_mode = '0' then
+                -- addr 4 = write data word to ICAP
+                v.icap_csib   := '0';
+                v.icap_wdata  := swap_bits_in_bytes(slv_input.cmd_wdata);
+            end if;
+        end if;
+
+        -- Drive ICAP read mode and select.
+        v.icap_rdwrb := r.read_mode;
+        if r.read_mode = '1' and r.read_select = '1' then
+            v.icap_csib := '0';
+        end if;
+
+        -- Capture ICAP output while selected in read mode.
+        if r.icap_csib = '0' and r.icap_rdwrb = '1' then
+            v.icap_rdata := swap_bits_in_bytes(s_icap_o);
+        end if;
+
+        -- Handle read transactions.
+        v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
+        v.rsp_rdata := (others => '0');
+        if slv_input.cmd_addr(2) = '0' then
+            -- addr 0 = control register
+            v.rsp_rdata(0) := r.read_mode;
+            v.rsp_rdata(1) := r.read_select;
+        else
+            -- addr 4 = captured ICAP word
+            v.rsp_rdata := r.icap_rdata;
+        end if;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+end architecture;
@@ -4,11 +4,12 @@
 -- This is a bridge between the JTAG port and the debug bus of the VexRiscv.
 -- The JTAG protocol is compatible with the VexRiscv port of OpenOCD.
 --
--- Two types of operations are supported:
+-- Three types of operations are supported:
 --  - Initiate a read or write transaction on the debug bus;
---  - Poll the result of the immediately preceding read transaction.
+--  - Poll the result of the immediately preceding read transaction;
+--  - Exchange data bytes with the console channel.
 --
--- Both operations are performed through the same JTAG instruction code.
+-- All operations are performed through the same JTAG instruction code.
 -- The instruction value is determined by the parameters of the BSCANE2
 -- instance.
 --
@@ -31,6 +32,45 @@
 --   bit  3     = (tdo) error flag (always '0')
 --   bits 35:4  = (tdo) 32-bit read result
 --
+-- The console channel is a pair of byte FIFOs between the JTAG port and
+-- the processor. The processor accesses the console through the device bus.
+-- The debugger exchanges up to 16 bytes in each direction per operation.
+--
+-- To exchange console data, the debugger goes through the Capture-DR state,
+-- then shifts 144 bits through the data register.
+-- The meaning of the bits is as follows:
+--   bits 1:0     = (tdi) "10" (console transfer)
+--   bits 6:2     = (tdi) number of bytes sent to the processor (0 to 16)
+--   bits 134:7   = (tdi) 16 data bytes sent to the processor
+--   bit  2       = (tdo) '1' if the following status and data are valid
+--   bits 7:3     = (tdo) number of bytes received from the processor (0 to 16)
+--   bits 15:8    = (tdo) free space in the receive FIFO of the processor
+--   bits 143:16  = (tdo) 16 data bytes received from the processor
+--
+-- Data bytes are shifted LSB first, the first byte in bits 14:7 (tdi)
+-- or bits 23:16 (tdo).
+--
+-- The debugger must not send more bytes than the free space reported
+-- by a preceding console operation, minus the number of bytes sent since
+-- that report was taken. Bytes that do not fit are silently discarded.
+-- The reported free space is a snapshot taken after the previous
+-- console operation started, before its data bytes arrived.
+--
+-- If the valid bit is '0', the console was not ready to report new data.
+-- In that case, no data bytes are returned, but data bytes sent by
+-- the debugger are still accepted.
+--
+-- Register map of the console channel on the device bus:
+--   address 0 (read):
+--     bits 7-0 (ro)  = received byte
+--     bit 16 (ro)    = '1' if byte received, '0' if no byte ready
+--   address 0 (write):
+--     bits 7-0 (wo)  = byte to transmit (ignored when the FIFO is full)
+--   address 4 (read):
+--     bit 0 (ro)     = '1' if the debugger polled the console recently
+--     bit 14 (ro)    = '1' when the transmit FIFO is full
+--     bit 15 (ro)    = '1' when the transmit FIFO is not empty
+--
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -41,6 +81,11 @@ use work.rvsys.all;
 
 entity jtag_dbg is
 
+    generic (
+        -- Size of the console FIFOs as a power of two (default 64 bytes).
+        console_fifo_bits: integer range 4 to 8 := 6
+    );
+
     port (
         -- System clock.
         clk:            in  std_logic;
@@ -61,7 +106,11 @@ entity jtag_dbg is
         dbg_cmd_write:  out std_logic;
         dbg_cmd_addr:   out std_logic_vector(31 downto 0);
         dbg_cmd_wdata:  out std_logic_vector(31 downto 0);
-        dbg_rsp_rdata:  in  std_logic_vector(31 downto 0)
+        dbg_rsp_rdata:  in  std_logic_vector(31 downto 0);
+
+        -- Bus interface signals for the console channel.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
     );
 
 end entity;
@@ -73,7 +122,13 @@ architecture jtag_dbg_arch of jtag_dbg is
         State_Header1,
         State_Header2,
         State_Command,
-        State_Read );
+        State_Read,
+        State_Console );
+
+    constant fifo_size: integer := 2**console_fifo_bits;
+
+    -- Console FIFO storage (inferred as distributed RAM).
+    type fifo_mem_type is array(0 to fifo_size-1) of std_logic_vector(7 downto 0);
 
     -- Internal registers, clocked on system clock.
     type regs_type is record
@@ -89,6 +144,25 @@ architecture jtag_dbg_arch of jtag_dbg is
         cmd_fire:       std_logic;
         rsp_valid:      std_logic;
         rsp_rdata:      std_logic_vector(31 downto 0);
+        con_take_prev:  std_logic;
+        con_active_cnt: unsigned(23 downto 0);
+        con_inhdr:      std_logic;
+        con_bitcnt:     unsigned(2 downto 0);
+        con_bytecnt:    unsigned(4 downto 0);
+        con_nbytes:     unsigned(4 downto 0);
+        con_shift:      std_logic_vector(7 downto 0);
+        con_filling:    std_logic;
+        con_publish:    std_logic;
+        con_stage_toggle: std_logic;
+        con_stage_cnt:  unsigned(4 downto 0);
+        con_stage_free: unsigned(7 downto 0);
+        con_stage_data: std_logic_vector(127 downto 0);
+        txf_rptr:       unsigned(console_fifo_bits downto 0);
+        txf_wptr:       unsigned(console_fifo_bits downto 0);
+        rxf_rptr:       unsigned(console_fifo_bits downto 0);
+        rxf_wptr:       unsigned(console_fifo_bits downto 0);
+        bus_rsp_valid:  std_logic;
+        bus_rsp_rdata:  std_logic_vector(31 downto 0);
     end record;
 
     constant regs_init: regs_type := (
@@ -103,7 +177,26 @@ architecture jtag_dbg_arch of jtag_dbg is
         cmd_wdata       => (others => '0'),
         cmd_fire        => '0',
         rsp_valid       => '0',
-        rsp_rdata       => (others => '0'));
+        rsp_rdata       => (others => '0'),
+        con_take_prev   => '0',
+        con_active_cnt  => (others => '0'),
+        con_inhdr       => '1',
+        con_bitcnt      => (others => '0'),
+        con_bytecnt     => (others => '0'),
+        con_nbytes      => (others => '0'),
+        con_shift       => (others => '0'),
+        con_filling     => '0',
+        con_publish     => '0',
+        con_stage_toggle => '0',
+        con_stage_cnt   => (others => '0'),
+        con_stage_free  => (others => '0'),
+        con_stage_data  => (others => '0'),
+        txf_rptr        => (others => '0'),
+        txf_wptr        => (others => '0'),
+        rxf_rptr        => (others => '0'),
+        rxf_wptr        => (others => '0'),
+        bus_rsp_valid   => '0',
+        bus_rsp_rdata   => (others => '0'));
 
     -- Internal registers, clocked on JTAG clock.
     type regs_jtag_type is record
@@ -112,8 +205,10 @@ architecture jtag_dbg_arch of jtag_dbg is
         cmd_init:       std_logic;
         cmd_toggle:     std_logic;
         cmd_databit:    std_logic;
+        cmd_console:    std_logic;
+        con_take:       std_logic;
         rsp_valid:      std_logic;
-        shift_read:     std_logic_vector(32 downto 0);
+        shift_read:     std_logic_vector(140 downto 0);
         tdo:            std_logic;
     end record;
 
@@ -123,6 +218,8 @@ architecture jtag_dbg_arch of jtag_dbg is
         cmd_init        => '0',
         cmd_toggle      => '0',
         cmd_databit     => '0',
+        cmd_console     => '0',
+        con_take        => '0',
         rsp_valid       => '0',
         shift_read      => (others => '0'),
         tdo             => '0' );
@@ -133,6 +230,11 @@ architecture jtag_dbg_arch of jtag_dbg is
     signal s_sync_cmd_init: std_logic;
     signal s_sync_cmd_toggle: std_logic;
     signal s_sync_cmd_databit: std_logic;
+    signal s_sync_cmd_console: std_logic;
+    signal s_sync_con_take: std_logic;
+
+    signal txf_mem: fifo_mem_type;
+    signal rxf_mem: fifo_mem_type;
 
 begin
 
@@ -155,12 +257,27 @@ begin
             di  => rjt.cmd_databit,
             do  => s_sync_cmd_databit );
 
+    sync_console: entity work.syncdff
+        port map (
+            clk => clk,
+            di  => rjt.cmd_console,
+            do  => s_sync_cmd_console );
+
+    sync_con_take: entity work.syncdff
+        port map (
+            clk => clk,
+            di  => rjt.con_take,
+            do  => s_sync_con_take );
+
     -- Drive outputs.
     jtag_tdo <= rjt.tdo;
     dbg_cmd_valid <= r.cmd_valid;
     dbg_cmd_write <= r.cmd_write;
     dbg_cmd_addr <= r.cmd_addr;
     dbg_cmd_wdata <= r.cmd_wdata;
+    slv_output  <= ( cmd_ready => '1',
+                     rsp_valid => r.bus_rsp_valid,
+                     rsp_rdata => r.bus_rsp_rdata );
 
     --
     -- Synchronous process in JTAG clock domain.
@@ -191,6 +308,7 @@ begin
                 -- Indicate start of new command to the fast clock domain.
                 vjt.cmd_init := '1';
                 vjt.cmd_toggle := '0';
+                vjt.cmd_console := '0';
 
             elsif jtag_shift = '1' then
 
@@ -211,7 +329,24 @@ begin
                             -- Prepare to shift "error" flag and 32 data bits to TDO.
                             vjt.state := State_Read;
                             vjt.tdo := rjt.rsp_valid;
-                            vjt.shift_read := r.rsp_rdata & "0";
+                            vjt.shift_read := (others => '0');
+                            vjt.shift_read(32 downto 0) := r.rsp_rdata & "0";
+                        elsif vjt.header = "10" then
+                            -- Prepare to exchange data with the console.
+                            -- Indicate console transfer to the fast clock domain.
+                            vjt.state := State_Console;
+                            vjt.cmd_console := '1';
+                            vjt.shift_read := (others => '0');
+                            if r.con_stage_toggle /= rjt.con_take then
+                                -- Take the staged console data from the
+                                -- fast clock domain. Output "valid" bit
+                                -- via TDO, then shift status and data.
+                                vjt.tdo := '1';
+                                vjt.shift_read := r.con_stage_data &
+                                                  std_logic_vector(r.con_stage_free) &
+                                                  std_logic_vector(r.con_stage_cnt);
+                                vjt.con_take := not rjt.con_take;
+                            end if;
                         else
                             -- Undefined header.
                             vjt.state := State_Idle;
@@ -227,6 +362,14 @@ begin
                         vjt.tdo := rjt.shift_read(0);
                         vjt.shift_read := "0" & rjt.shift_read(rjt.shift_read'high downto 1);
 
+                    when State_Console =>
+                        -- Push the next console bit from TDI to the fast clock domain.
+                        vjt.cmd_toggle := not rjt.cmd_toggle;
+                        vjt.cmd_databit := jtag_tdi;
+                        -- Shift the next console status/data bit to TDO.
+                        vjt.tdo := rjt.shift_read(0);
+                        vjt.shift_read := "0" & rjt.shift_read(rjt.shift_read'high downto 1);
+
                     when others =>
                         -- Got undefined command. Wait for next capture state.
                         vjt.state := State_Idle;
@@ -247,6 +390,12 @@ begin
     --
     process (clk) is
         variable v: regs_type;
+        variable v_txf_empty: boolean;
+        variable v_txf_full: boolean;
+        variable v_rxf_empty: boolean;
+        variable v_rxf_full: boolean;
+        variable v_rxf_free: unsigned(console_fifo_bits downto 0);
+        variable v_byte: std_logic_vector(7 downto 0);
     begin
         -- By default, set next registers equal to current registers.
         v := r;
@@ -257,10 +406,48 @@ begin
             v.jt_toggle := s_sync_cmd_toggle;
             v.shift_last := '0';
 
+            -- Determine console FIFO status.
+            v_txf_empty := (r.txf_wptr = r.txf_rptr);
+            v_txf_full  := (r.txf_wptr(console_fifo_bits-1 downto 0) = r.txf_rptr(console_fifo_bits-1 downto 0))
+                           and (r.txf_wptr(console_fifo_bits) /= r.txf_rptr(console_fifo_bits));
+            v_rxf_empty := (r.rxf_wptr = r.rxf_rptr);
+            v_rxf_full  := (r.rxf_wptr(console_fifo_bits-1 downto 0) = r.rxf_rptr(console_fifo_bits-1 downto 0))
+                           and (r.rxf_wptr(console_fifo_bits) /= r.rxf_rptr(console_fifo_bits));
+            v_rxf_free  := to_unsigned(fifo_size, console_fifo_bits + 1) - (r.rxf_wptr - r.rxf_rptr);
+
             if s_sync_cmd_init = '1' then
 
                 -- Reset bit stream from JTAG clock domain.
                 v.shift_cnt := (others => '0');
+                v.con_inhdr := '1';
+                v.con_bitcnt := (others => '0');
+                v.con_bytecnt := (others => '0');
+                v.con_nbytes := (others => '0');
+
+            elsif r.jt_toggle /= r.jt_toggle_prev and s_sync_cmd_console = '1' then
+
+                -- Capture console bit stream from JTAG clock domain.
+                v.con_bitcnt := r.con_bitcnt + 1;
+                if r.con_inhdr = '1' then
+                    -- Capture the number of valid data bytes.
+                    v.con_nbytes := s_sync_cmd_databit & r.con_nbytes(4 downto 1);
+                    if r.con_bitcnt = 4 then
+                        v.con_inhdr := '0';
+                        v.con_bitcnt := (others => '0');
+                    end if;
+                else
+                    -- Capture data bits.
+                    v_byte := s_sync_cmd_databit & r.con_shift(7 downto 1);
+                    v.con_shift := v_byte;
+                    if r.con_bitcnt = 7 and r.con_bytecnt < 16 then
+                        -- Push complete data byte into the receive FIFO.
+                        if r.con_bytecnt < r.con_nbytes and (not v_rxf_full) then
+                            rxf_mem(to_integer(r.rxf_wptr(console_fifo_bits-1 downto 0))) <= v_byte;
+                            v.rxf_wptr := r.rxf_wptr + 1;
+                        end if;
+                        v.con_bytecnt := r.con_bytecnt + 1;
+                    end if;
+                end if;
 
             elsif r.jt_toggle /= r.jt_toggle_prev then
 
@@ -296,6 +483,86 @@ begin
                 v.rsp_rdata := dbg_rsp_rdata;
             end if;
 
+            -- Keep track of recent console activity from the debugger.
+            v.con_take_prev := s_sync_con_take;
+            if s_sync_con_take /= r.con_take_prev then
+                v.con_active_cnt := (others => '1');
+            elsif r.con_active_cnt /= 0 then
+                v.con_active_cnt := r.con_active_cnt - 1;
+            end if;
+
+            -- Refill the console staging register after the JTAG clock
+            -- domain has taken the previous staged data.
+            -- The staged data must be stable for at least one clock cycle
+            -- before the stage toggle flips to make it available.
+            v.con_publish := '0';
+            if r.con_publish = '1' then
+                v.con_stage_toggle := not r.con_stage_toggle;
+            elsif r.con_filling = '1' then
+                if r.con_stage_cnt < 16 and (not v_txf_empty) then
+                    -- Move next byte from transmit FIFO to staging register.
+                    v.con_stage_data := txf_mem(to_integer(r.txf_rptr(console_fifo_bits-1 downto 0))) &
+                                        r.con_stage_data(127 downto 8);
+                    v.con_stage_cnt := r.con_stage_cnt + 1;
+                    v.txf_rptr := r.txf_rptr + 1;
+                else
+                    -- Align the first staged byte to the lowest position.
+                    for i in 0 to 15 loop
+                        if i >= r.con_stage_cnt then
+                            v.con_stage_data := x"00" & v.con_stage_data(127 downto 8);
+                        end if;
+                    end loop;
+                    if v_rxf_free > 255 then
+                        v.con_stage_free := to_unsigned(255, 8);
+                    else
+                        v.con_stage_free := resize(v_rxf_free, 8);
+                    end if;
+                    v.con_filling := '0';
+                    v.con_publish := '1';
+                end if;
+            elsif s_sync_con_take = r.con_stage_toggle then
+                -- Staged data was taken. Start refilling.
+                v.con_filling := '1';
+                v.con_stage_cnt := (others => '0');
+                v.con_stage_data := (others => '0');
+            end if;
+
+            -- Handle bus read transactions.
+            v.bus_rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
+            v.bus_rsp_rdata := (others => '0');
+            if slv_input.cmd_valid = '1' and slv_input.cmd_write = '0' then
+                if slv_input.cmd_addr(2) = '0' then
+                    -- addr 0 = received data
+                    if not v_rxf_empty then
+                        v.bus_rsp_rdata(7 downto 0) :=
+                            rxf_mem(to_integer(r.rxf_rptr(console_fifo_bits-1 downto 0)));
+                        v.bus_rsp_rdata(16) := '1';
+                        v.rxf_rptr := r.rxf_rptr + 1;
+                    end if;
+                else
+                    -- addr 4 = status register
+                    if r.con_active_cnt /= 0 then
+                        v.bus_rsp_rdata(0) := '1';
+                    end if;
+                    if v_txf_full then
+                        v.bus_rsp_rdata(14) := '1';
+                    end if;
+                    if not v_txf_empty then
+                        v.bus_rsp_rdata(15) := '1';
+                    end if;
+                end if;
+            end if;
+
+            -- Handle bus write transactions.
+            if slv_input.cmd_valid = '1' and slv_input.cmd_write = '1' then
+                if slv_input.cmd_addr(2) = '0' and (not v_txf_full) then
+                    -- addr 0 = transmit byte
+                    txf_mem(to_integer(r.txf_wptr(console_fifo_bits-1 downto 0))) <=
+                        slv_input.cmd_wdata(7 downto 0);
+                    v.txf_wptr := r.txf_wptr + 1;
+                end if;
+            end if;
+
             -- Synchronous reset of debug bus interface.
             if rst = '1' then
                 v := regs_init;
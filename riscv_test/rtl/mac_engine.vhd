@@ -0,0 +1,362 @@
+--
+-- Multiply-accumulate engine for simple processor system
+--
+-- This peripheral performs signed multiplications for fixed-point
+-- kernels, since the processor itself has no multiplier.
+-- The multiplier is inferred as DSP48 slices.
+--
+-- The engine contains a 64-bit accumulator ACC and a 32-bit operand
+-- register A. Writing an operand B to one of the MAC registers feeds
+-- a 3-stage multiplier pipeline; the pipeline accepts one operation
+-- per clock cycle. The accumulator is updated 3 cycles after the write.
+--
+-- The engine also computes FIR filters over a sample buffer in block RAM.
+-- Coefficients and samples are signed 16-bit values. Writing a sample to
+-- the FIR_SAMPLE register stores it in the circular sample buffer and sets
+-- ACC := sum(coef[i] * x[n-i], i = 0 .. ntaps-1), where x[n] is the new
+-- sample. This takes ntaps + 5 clock cycles.
+--
+-- Reads from any register are stalled until the pipeline is empty and
+-- the FIR computation is complete. Writes are stalled while the FIR
+-- computation runs, and writes that modify ACC directly are stalled
+-- until the pipeline is empty.
+--
+-- Register map:
+--   address 0x00 (read-write):
+--     bit 0 (wo)     = write '1' to clear ACC
+--     bits 12-8 (ro) = log2 of the sample buffer size
+--   address 0x04 (read-write): operand A (signed 32 bits)
+--   address 0x08 (write-only): MAC, ACC := ACC + A * data
+--   address 0x0c (write-only): MUL, ACC := A * data
+--   address 0x10 (write-only): MAC16, ACC := ACC + data(15:0) * data(31:16)
+--                              (both signed 16 bits)
+--   address 0x14 (read-write): bits 31-0 of ACC
+--   address 0x18 (read-write): bits 63-32 of ACC
+--   address 0x1c (read-write): number of FIR taps (0 to buffer size);
+--                              0 disables the FIR computation
+--   address 0x20 (read-write): coefficient index
+--   address 0x24 (write-only): write coefficient (bits 15-0) at the
+--                              coefficient index, then increment the index
+--   address 0x28 (write-only): store sample (bits 15-0) and run the FIR
+--   address 0x2c (write-only): store sample (bits 15-0) without running
+--                              the FIR (for example for decimation)
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity mac_engine is
+
+    generic (
+        -- Log2 of the size of the coefficient and sample buffers.
+        buf_bits:       integer range 4 to 10 );
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Bus interface signals.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
+    );
+
+end entity;
+
+architecture mac_engine_arch of mac_engine is
+
+    constant buf_size: integer := 2**buf_bits;
+
+    -- Coefficient and sample buffers in block RAM.
+    type mem_type is array(0 to buf_size-1) of std_logic_vector(15 downto 0);
+    signal coef_mem:    mem_type;
+    signal sample_mem:  mem_type;
+
+    type fir_state_type is (fir_idle, fir_wait, fir_run);
+
+    -- Internal registers.
+    type regs_type is record
+        reg_a:          signed(31 downto 0);
+        acc:            signed(63 downto 0);
+        -- Multiplier pipeline.
+        p1_valid:       std_logic;
+        p1_load:        std_logic;
+        p1_a:           signed(31 downto 0);
+        p1_b:           signed(31 downto 0);
+        p2_valid:       std_logic;
+        p2_load:        std_logic;
+        p2_prod:        signed(63 downto 0);
+        p3_valid:       std_logic;
+        p3_load:        std_logic;
+        p3_prod:        signed(63 downto 0);
+        -- FIR engine.
+        fir_state:      fir_state_type;
+        fir_ntaps:      unsigned(buf_bits downto 0);
+        fir_idx:        unsigned(buf_bits-1 downto 0);
+        fir_newest:     unsigned(buf_bits-1 downto 0);
+        sample_head:    unsigned(buf_bits-1 downto 0);
+        coef_index:     unsigned(buf_bits-1 downto 0);
+        -- Buffer writes.
+        coef_wen:       std_logic;
+        sample_wen:     std_logic;
+        mem_waddr:      unsigned(buf_bits-1 downto 0);
+        mem_wdata:      std_logic_vector(15 downto 0);
+        -- Bus response.
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        reg_a           => (others => '0'),
+        acc             => (others => '0'),
+        p1_valid        => '0',
+        p1_load         => '0',
+        p1_a            => (others => '0'),
+        p1_b            => (others => '0'),
+        p2_valid        => '0',
+        p2_load         => '0',
+        p2_prod         => (others => '0'),
+        p3_valid        => '0',
+        p3_load         => '0',
+        p3_prod         => (others => '0'),
+        fir_state       => fir_idle,
+        fir_ntaps       => to_unsigned(1, buf_bits + 1),
+        fir_idx         => (others => '0'),
+        fir_newest      => (others => '0'),
+        sample_head     => (others => '0'),
+        coef_index      => (others => '0'),
+        coef_wen        => '0',
+        sample_wen      => '0',
+        mem_waddr       => (others => '0'),
+        mem_wdata       => (others => '0'),
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0'));
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    signal s_cmd_ready:     std_logic;
+    signal s_coef_rdata:    std_logic_vector(15 downto 0);
+    signal s_sample_rdata:  std_logic_vector(15 downto 0);
+
+begin
+
+    -- Drive outputs.
+    slv_output  <= ( cmd_ready => s_cmd_ready,
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_pipe_busy:   std_logic;
+        variable v_mac_write:   std_logic;
+        variable v_cmd_ready:   std_logic;
+        variable v_accept:      std_logic;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+
+        v_pipe_busy := r.p1_valid or r.p2_valid or r.p3_valid;
+
+        -- Writes to A and the MAC registers go through the pipeline
+        -- in order and need not wait until it is empty.
+        v_mac_write := '0';
+        if (slv_input.cmd_write = '1') and
+           (slv_input.cmd_addr(5 downto 2) = "0001" or
+            slv_input.cmd_addr(5 downto 2) = "0010" or
+            slv_input.cmd_addr(5 downto 2) = "0011" or
+            slv_input.cmd_addr(5 downto 2) = "0100") then
+            v_mac_write := '1';
+        end if;
+
+        if r.fir_state /= fir_idle then
+            v_cmd_ready := '0';
+        elsif (v_pipe_busy = '1') and (v_mac_write = '0') then
+            v_cmd_ready := '0';
+        else
+            v_cmd_ready := '1';
+        end if;
+
+        v_accept := slv_input.cmd_valid and v_cmd_ready;
+
+        -- Accumulate the result of the multiplier pipeline.
+        if r.p3_valid = '1' then
+            if r.p3_load = '1' then
+                v.acc := r.p3_prod;
+            else
+                v.acc := r.acc + r.p3_prod;
+            end if;
+        end if;
+
+        -- Multiplier pipeline stages 2 and 3.
+        v.p2_valid  := r.p1_valid;
+        v.p2_load   := r.p1_load;
+        v.p2_prod   := r.p1_a * r.p1_b;
+        v.p3_valid  := r.p2_valid;
+        v.p3_load   := r.p2_load;
+        v.p3_prod   := r.p2_prod;
+
+        -- Multiplier pipeline stage 1 and buffer writes default to idle.
+        v.p1_valid  := '0';
+        v.coef_wen  := '0';
+        v.sample_wen := '0';
+
+        -- FIR engine.
+        case r.fir_state is
+            when fir_wait =>
+                -- Wait until the new sample is written to the buffer.
+                v.fir_state := fir_run;
+                v.fir_idx   := (others => '0');
+            when fir_run =>
+                -- Buffer data for index fir_idx is available now.
+                v.p1_valid  := '1';
+                if r.fir_idx = 0 then
+                    v.p1_load := '1';
+                else
+                    v.p1_load := '0';
+                end if;
+                v.p1_a      := resize(signed(s_coef_rdata), 32);
+                v.p1_b      := resize(signed(s_sample_rdata), 32);
+                v.fir_idx   := r.fir_idx + 1;
+                if resize(r.fir_idx, buf_bits + 1) + 1 >= r.fir_ntaps then
+                    v.fir_state := fir_idle;
+                end if;
+            when others =>
+                null;
+        end case;
+
+        -- Handle write transactions.
+        if (v_accept = '1') and (slv_input.cmd_write = '1') then
+            case slv_input.cmd_addr(5 downto 2) is
+                when "0000" =>
+                    -- addr 0x00 = control
+                    if slv_input.cmd_wdata(0) = '1' then
+                        v.acc := (others => '0');
+                    end if;
+                when "0001" =>
+                    -- addr 0x04 = operand A
+                    v.reg_a := signed(slv_input.cmd_wdata);
+                when "0010" | "0011" =>
+                    -- addr 0x08 = MAC, addr 0x0c = MUL
+                    v.p1_valid  := '1';
+                    v.p1_load   := slv_input.cmd_addr(2);
+                    v.p1_a      := r.reg_a;
+                    v.p1_b      := signed(slv_input.cmd_wdata);
+                when "0100" =>
+                    -- addr 0x10 = MAC16
+                    v.p1_valid  := '1';
+                    v.p1_load   := '0';
+                    v.p1_a      := resize(signed(slv_input.cmd_wdata(15 downto 0)), 32);
+                    v.p1_b      := resize(signed(slv_input.cmd_wdata(31 downto 16)), 32);
+                when "0101" =>
+                    -- addr 0x14 = low 32 bits of ACC
+                    v.acc(31 downto 0) := signed(slv_input.cmd_wdata);
+                when "0110" =>
+                    -- addr 0x18 = high 32 bits of ACC
+                    v.acc(63 downto 32) := signed(slv_input.cmd_wdata);
+                when "0111" =>
+                    -- addr 0x1c = number of FIR taps
+                    if unsigned(slv_input.cmd_wdata) > buf_size then
+                        v.fir_ntaps := to_unsigned(buf_size, buf_bits + 1);
+                    else
+                        v.fir_ntaps := unsigned(slv_input.cmd_wdata(buf_bits downto 0));
+                    end if;
+                when "1000" =>
+                    -- addr 0x20 = coefficient index
+                    v.coef_index := unsigned(slv_input.cmd_wdata(buf_bits-1 downto 0));
+                when "1001" =>
+                    -- addr 0x24 = write coefficient
+                    v.coef_wen  := '1';
+                    v.mem_waddr := r.coef_index;
+                    v.mem_wdata := slv_input.cmd_wdata(15 downto 0);
+                    v.coef_index := r.coef_index + 1;
+                when "1010" | "1011" =>
+                    -- addr 0x28 = store sample and run FIR,
+                    -- addr 0x2c = store sample only
+                    v.sample_wen := '1';
+                    v.mem_waddr := r.sample_head;
+                    v.mem_wdata := slv_input.cmd_wdata(15 downto 0);
+                    v.fir_newest := r.sample_head;
+                    v.sample_head := r.sample_head + 1;
+                    if (slv_input.cmd_addr(2) = '0') and (r.fir_ntaps /= 0) then
+                        v.fir_state := fir_wait;
+                    end if;
+                when others =>
+                    null;
+            end case;
+        end if;
+
+        -- Handle read transactions.
+        v.rsp_valid := v_accept and (not slv_input.cmd_write);
+        case slv_input.cmd_addr(5 downto 2) is
+            when "0000" =>
+                -- addr 0x00 = status
+                v.rsp_rdata := (others => '0');
+                v.rsp_rdata(12 downto 8) := std_logic_vector(to_unsigned(buf_bits, 5));
+            when "0001" =>
+                -- addr 0x04 = operand A
+                v.rsp_rdata := std_logic_vector(r.reg_a);
+            when "0101" =>
+                -- addr 0x14 = low 32 bits of ACC
+                v.rsp_rdata := std_logic_vector(r.acc(31 downto 0));
+            when "0110" =>
+                -- addr 0x18 = high 32 bits of ACC
+                v.rsp_rdata := std_logic_vector(r.acc(63 downto 32));
+            when "0111" =>
+                -- addr 0x1c = number of FIR taps
+                v.rsp_rdata := std_logic_vector(resize(r.fir_ntaps, 32));
+            when "1000" =>
+                -- addr 0x20 = coefficient index
+                v.rsp_rdata := std_logic_vector(resize(r.coef_index, 32));
+            when others =>
+                v.rsp_rdata := (others => '0');
+        end case;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+            v_cmd_ready := '0';
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+        s_cmd_ready <= v_cmd_ready;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+    -- Block RAM.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            -- Write in the same cycle as the new register values,
+            -- such that a new sample is visible to the FIR engine.
+            if rnext.coef_wen = '1' then
+                coef_mem(to_integer(rnext.mem_waddr)) <= rnext.mem_wdata;
+            end if;
+            if rnext.sample_wen = '1' then
+                sample_mem(to_integer(rnext.mem_waddr)) <= rnext.mem_wdata;
+            end if;
+            -- Read at the next FIR index, such that the data is
+            -- available in the cycle after the index changes.
+            s_coef_rdata <= coef_mem(to_integer(rnext.fir_idx));
+            s_sample_rdata <= sample_mem(to_integer(rnext.fir_newest - rnext.fir_idx));
+        end if;
+    end process;
+
+end architecture;
@@ -7,9 +7,18 @@
 -- Input/output ports:
 --   FTDI(2) = TX = pin 5 on the FTDI header: RS232 output, 115200 bps.
 --   FTDI(1) = RX = pin 4 on the FTDI header: RS232 input.
+--   FTDI(0) = RTS output to CTS# on pin 2 of the FTDI header.
+--   FTDI(3) = CTS input from RTS# on pin 6 of the FTDI header.
+--             RTS/CTS flow control is off after reset.
+--             The UART debug bridge (if enabled) decodes the RX stream and
+--             can take over TX to give the host direct bus access.
 --   LED1, LED2:    Controlled by software via GPIO.
 --   PORT_A..D:     Controlled by software via GPIO1.
 --   PORT_E..H:     Controlled by software via GPIO2.
+--                  GPIO1 and GPIO2 can also change outputs at exact
+--                  MTIME values from their event queues.
+--   PORT_H(6..7):  I2C SCL and SDA when enabled in the I2C controller.
+--   JTAG USER1:    VexRiscv debug port and console channel.
 --
 
 library ieee;
@@ -47,6 +56,22 @@ end entity;
 
 architecture arch_top of riscv_test_top is
 
+    -- Set to true to include the UART debug bridge.
+    -- The bridge gives unauthenticated access to the whole system bus.
+    -- Even when included, it stays inactive until software enables it
+    -- through the UART controller (see uart.vhd and uart_dbg.vhd).
+    constant uart_dbg_enable:       boolean := false;
+
+    -- Set to true to include the peripheral bus monitor.
+    -- The monitor keeps 8 counters of 32 bits for each of the 13 device
+    -- bus slaves. Its registers in bus_ctrl.vhd add up to 3411 flip-flops
+    -- (3328 counter bits, the 32-bit cycle counter, a 16-bit latency
+    -- counter and 35 bits of control and read data), 11.7% of the
+    -- 29200 flip-flops of the XC7S25. The LUT count for the adders and
+    -- read multiplexer is not known without a synthesis report.
+    -- When excluded, the monitor window reads as zero.
+    constant busmon_enable:         boolean := false;
+
     signal clk_main:                std_logic;
     signal s_mmcm_fb:               std_logic;
     signal s_mmcm_clkout0:          std_logic;
@@ -65,6 +90,9 @@ architecture arch_top of riscv_test_top is
     signal s_cpu_ibus_rsp_rdata:    std_logic_vector(31 downto 0);
     signal s_cpu_int_external:      std_logic;
     signal s_cpu_int_soft:          std_logic;
+    signal s_cpu_retire_valid:      std_logic;
+    signal s_cpu_retire_pc:         unsigned(31 downto 0);
+    signal s_cpu_retire_insn:       std_logic_vector(31 downto 0);
     signal s_cpu_dbus_cmd_valid:    std_logic;
     signal s_cpu_dbus_cmd_ready:    std_logic;
     signal s_cpu_dbus_cmd_write:    std_logic;
@@ -82,11 +110,30 @@ architecture arch_top of riscv_test_top is
     signal s_cpu_dbg_rsp_rdata:     std_logic_vector(31 downto 0);
     signal s_cpu_dbg_reset_out:     std_logic;
     signal s_sysbus_wmask:          std_logic_vector(3 downto 0);
+    signal s_sysmst_dbg_sel:        std_logic;
+    signal s_sysmst_cmd_valid:      std_logic;
+    signal s_sysmst_cmd_ready:      std_logic;
+    signal s_sysmst_cmd_addr:       rvsys_addr_type;
+    signal s_sysmst_cmd_write:      std_logic;
+    signal s_sysmst_cmd_wdata:      std_logic_vector(31 downto 0);
+    signal s_sysmst_cmd_wmask:      std_logic_vector(3 downto 0);
+    signal s_sysmst_rsp_valid:      std_logic;
+    signal s_sysmst_rsp_rdata:      std_logic_vector(31 downto 0);
+    signal r_sysmst_rsp_dbg:        std_logic;
     signal r_sysbus_bram_rsp_valid: std_logic;
     signal s_sysbus_slv_input:      bus_slv_input_array(0 to 1);
     signal s_sysbus_slv_output:     bus_slv_output_array(0 to 1);
-    signal s_devbus_slv_input:      bus_slv_input_array(0 to 5);
-    signal s_devbus_slv_output:     bus_slv_output_array(0 to 5);
+    signal s_devbus_slv_input:      bus_slv_input_array(0 to 12);
+    signal s_devbus_slv_output:     bus_slv_output_array(0 to 12);
+
+    signal s_ram_en_a:              std_logic;
+    signal s_ram_wr_a:              std_logic;
+    signal s_ram_addr_a:            std_logic_vector(13 downto 0);
+    signal s_ram_wdata_a:           std_logic_vector(31 downto 0);
+    signal s_ram_wmask_a:           std_logic_vector(3 downto 0);
+    signal s_ram_rdata_a:           std_logic_vector(31 downto 0);
+    signal s_dma_grant:             std_logic;
+    signal r_dma_rsp_valid:         std_logic;
 
     signal s_gpio_led_o:            std_logic_vector(31 downto 0);
     signal s_gpio1_i:               std_logic_vector(31 downto 0);
@@ -95,16 +142,49 @@ architecture arch_top of riscv_test_top is
     signal s_gpio2_i:               std_logic_vector(31 downto 0);
     signal s_gpio2_o:               std_logic_vector(31 downto 0);
     signal s_gpio2_t:               std_logic_vector(31 downto 0);
+    signal s_gpio1_interrupt:       std_logic;
+    signal s_gpio2_interrupt:       std_logic;
+    signal s_port2_o:               std_logic_vector(31 downto 0);
+    signal s_port2_t:               std_logic_vector(31 downto 0);
 
     signal s_uart_tx:               std_logic;
     signal s_uart_rx:               std_logic;
+    signal s_uart_rts_n:            std_logic;
+    signal s_uart_rts_t:            std_logic;
+    signal s_uart_cts_n:            std_logic;
     signal s_uart_interrupt:        std_logic;
+    signal s_uart_ctl_tx:           std_logic;
+    signal s_uart_dbg_enable:       std_logic;
+    signal s_uart_ctl_rx:           std_logic;
+    signal s_uart_dbg_mst_output:   bus_slv_input_type;
+    signal s_uart_dbg_mst_input:    bus_slv_output_type;
     signal s_timer_interrupt:       std_logic;
+    signal s_mtime:                 std_logic_vector(63 downto 0);
 
     signal s_spi_clk:               std_logic;
     signal s_spi_cs:                std_logic;
     signal s_spi_mosi:              std_logic;
     signal s_spi_miso:              std_logic;
+    signal s_spiflash_interrupt:    std_logic;
+
+    signal s_i2c_scl_t:             std_logic;
+    signal s_i2c_sda_t:             std_logic;
+    signal s_i2c_pin_enable:        std_logic;
+    signal s_i2c_interrupt:         std_logic;
+
+    signal s_accel_dma_output:      bus_slv_input_type;
+    signal s_accel_dma_input:       bus_slv_output_type;
+    signal s_accel_interrupt:       std_logic;
+    signal s_krn_rst:               std_logic;
+    signal s_krn_param:             std_logic_vector(31 downto 0);
+    signal s_krn_in_valid:          std_logic;
+    signal s_krn_in_ready:          std_logic;
+    signal s_krn_in_data:           std_logic_vector(31 downto 0);
+    signal s_krn_in_last:           std_logic;
+    signal s_krn_out_valid:         std_logic;
+    signal s_krn_out_ready:         std_logic;
+    signal s_krn_out_data:          std_logic_vector(31 downto 0);
+    signal s_krn_out_last:          std_logic;
 
     signal s_jtag_drck:             std_logic;
     signal s_jtag_capture:          std_logic;
@@ -154,7 +234,12 @@ begin
     inst_obuf_uartrx: IBUF
         port map ( I => ftdi(1), O => s_uart_rx );
 
-    ftdi(0) <= 'Z';
+    inst_obuft_uartrts: OBUFT
+        port map ( I => s_uart_rts_n, T => s_uart_rts_t, O => ftdi(0) );
+
+    inst_ibuf_uartcts: IBUF
+        port map ( I => ftdi(3), O => s_uart_cts_n );
+
     ftdi(1) <= 'Z';
     ftdi(3) <= 'Z';
 
@@ -168,15 +253,23 @@ begin
         inst_iobuf_gpio_d: IOBUF
             port map ( I => s_gpio1_o(i+24), T => s_gpio1_t(i+24), O => s_gpio1_i(i+24), IO => port_d(i) );
         inst_iobuf_gpio_e: IOBUF
-            port map ( I => s_gpio2_o(i), T => s_gpio2_t(i), O => s_gpio2_i(i), IO => port_e(i) );
+            port map ( I => s_port2_o(i), T => s_port2_t(i), O => s_gpio2_i(i), IO => port_e(i) );
         inst_iobuf_gpio_f: IOBUF
-            port map ( I => s_gpio2_o(i+8), T => s_gpio2_t(i+8), O => s_gpio2_i(i+8), IO => port_f(i) );
+            port map ( I => s_port2_o(i+8), T => s_port2_t(i+8), O => s_gpio2_i(i+8), IO => port_f(i) );
         inst_iobuf_gpio_g: IOBUF
-            port map ( I => s_gpio2_o(i+16), T => s_gpio2_t(i+16), O => s_gpio2_i(i+16), IO => port_g(i) );
+            port map ( I => s_port2_o(i+16), T => s_port2_t(i+16), O => s_gpio2_i(i+16), IO => port_g(i) );
         inst_iobuf_gpio_h: IOBUF
-            port map ( I => s_gpio2_o(i+24), T => s_gpio2_t(i+24), O => s_gpio2_i(i+24), IO => port_h(i) );
+            port map ( I => s_port2_o(i+24), T => s_port2_t(i+24), O => s_gpio2_i(i+24), IO => port_h(i) );
     end generate;
 
+    -- PORT_H(6) = SCL and PORT_H(7) = SDA are taken over by the I2C controller
+    -- when it is enabled. Both are open-drain: drive low or tri-state.
+    s_port2_o(29 downto 0) <= s_gpio2_o(29 downto 0);
+    s_port2_t(29 downto 0) <= s_gpio2_t(29 downto 0);
+    s_port2_o(31 downto 30) <= "00" when s_i2c_pin_enable = '1' else s_gpio2_o(31 downto 30);
+    s_port2_t(31 downto 30) <= (s_i2c_sda_t & s_i2c_scl_t) when s_i2c_pin_enable = '1'
+                               else s_gpio2_t(31 downto 30);
+
     -- SPI clock is connected to the CCLK pin.
     -- This pin is not directly accessible as a user I/O, only via STARTUPE2.
     -- Note: the first 3 clock cycles on USRCCLKO will not be passed through to CCLK.
@@ -250,6 +343,9 @@ begin
             debug_bus_cmd_payload_data    => s_cpu_dbg_cmd_wdata,
             debug_bus_rsp_data            => s_cpu_dbg_rsp_rdata,
             debug_resetOut          => s_cpu_dbg_reset_out,
+            retire_valid            => s_cpu_retire_valid,
+            retire_pc               => s_cpu_retire_pc,
+            retire_insn             => s_cpu_retire_insn,
             dBus_cmd_valid          => s_cpu_dbus_cmd_valid,
             dBus_cmd_ready          => s_cpu_dbus_cmd_ready,
             dBus_cmd_payload_wr     => s_cpu_dbus_cmd_write,
@@ -267,6 +363,11 @@ begin
     s_cpu_ibus_rsp_error <= '0';
     s_cpu_dbus_rsp_error <= '0';
 
+    -- External interrupt from peripherals.
+    s_cpu_int_external <= s_spiflash_interrupt or s_i2c_interrupt or
+                          s_accel_interrupt or s_gpio1_interrupt or
+                          s_gpio2_interrupt;
+
     --
     -- On-chip RAM
     --
@@ -280,20 +381,39 @@ begin
             init_file   => "../sw/bootmon.hex" )
         port map (
             clk         => clk_main,
-            en_a        => s_sysbus_slv_input(0).cmd_valid,
+            en_a        => s_ram_en_a,
             en_b        => s_cpu_ibus_cmd_valid,
-            wr_a        => s_sysbus_slv_input(0).cmd_write,
-            addr_a      => s_sysbus_slv_input(0).cmd_addr(15 downto 2),
+            wr_a        => s_ram_wr_a,
+            addr_a      => s_ram_addr_a,
             addr_b      => std_logic_vector(s_cpu_ibus_cmd_addr(15 downto 2)),
-            wdata_a     => s_sysbus_slv_input(0).cmd_wdata,
-            wmask_a     => s_sysbus_slv_input(0).cmd_wmask,
-            rdata_a     => s_sysbus_slv_output(0).rsp_rdata,
+            wdata_a     => s_ram_wdata_a,
+            wmask_a     => s_ram_wmask_a,
+            rdata_a     => s_ram_rdata_a,
             rdata_b     => s_cpu_ibus_rsp_rdata );
 
+    -- Port A is shared between the data bus and the accelerator DMA.
+    -- The data bus has priority; DMA gets the cycles where the CPU
+    -- does not access data RAM.
+    s_dma_grant     <= not s_sysbus_slv_input(0).cmd_valid;
+    s_ram_en_a      <= s_sysbus_slv_input(0).cmd_valid or
+                       s_accel_dma_output.cmd_valid;
+    s_ram_wr_a      <= s_sysbus_slv_input(0).cmd_write when s_dma_grant = '0'
+                       else s_accel_dma_output.cmd_write;
+    s_ram_addr_a    <= s_sysbus_slv_input(0).cmd_addr(15 downto 2) when s_dma_grant = '0'
+                       else s_accel_dma_output.cmd_addr(15 downto 2);
+    s_ram_wdata_a   <= s_sysbus_slv_input(0).cmd_wdata when s_dma_grant = '0'
+                       else s_accel_dma_output.cmd_wdata;
+    s_ram_wmask_a   <= s_sysbus_slv_input(0).cmd_wmask when s_dma_grant = '0'
+                       else s_accel_dma_output.cmd_wmask;
+
     -- On-chip memory is always ready.
     s_cpu_ibus_cmd_ready <= '1';
     s_sysbus_slv_output(0).cmd_ready <= '1';
     s_sysbus_slv_output(0).rsp_valid <= r_sysbus_bram_rsp_valid;
+    s_sysbus_slv_output(0).rsp_rdata <= s_ram_rdata_a;
+    s_accel_dma_input <= ( cmd_ready => s_dma_grant,
+                           rsp_valid => r_dma_rsp_valid,
+                           rsp_rdata => s_ram_rdata_a );
 
     -- On-chip memory has 1 cycle read response latency.
     process (clk_main) is
@@ -302,6 +422,8 @@ begin
             r_cpu_ibus_rsp_valid <= s_cpu_ibus_cmd_valid;
             r_sysbus_bram_rsp_valid <= s_sysbus_slv_input(0).cmd_valid and
                                        (not s_sysbus_slv_input(0).cmd_write);
+            r_dma_rsp_valid <= s_accel_dma_output.cmd_valid and s_dma_grant and
+                               (not s_accel_dma_output.cmd_write);
         end if;
     end process;
 
@@ -325,35 +447,75 @@ begin
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
-            mst_cmd_valid => s_cpu_dbus_cmd_valid,
-            mst_cmd_ready => s_cpu_dbus_cmd_ready,
-            mst_cmd_addr  => std_logic_vector(s_cpu_dbus_cmd_addr),
-            mst_cmd_write => s_cpu_dbus_cmd_write,
-            mst_cmd_wdata => s_cpu_dbus_cmd_wdata,
-            mst_cmd_wmask => s_sysbus_wmask,
-            mst_rsp_valid => s_cpu_dbus_rsp_valid,
-            mst_rsp_rdata => s_cpu_dbus_rsp_rdata,
+            mst_cmd_valid => s_sysmst_cmd_valid,
+            mst_cmd_ready => s_sysmst_cmd_ready,
+            mst_cmd_addr  => s_sysmst_cmd_addr,
+            mst_cmd_write => s_sysmst_cmd_write,
+            mst_cmd_wdata => s_sysmst_cmd_wdata,
+            mst_cmd_wmask => s_sysmst_cmd_wmask,
+            mst_rsp_valid => s_sysmst_rsp_valid,
+            mst_rsp_rdata => s_sysmst_rsp_rdata,
             slv_input     => s_sysbus_slv_input,
             slv_output    => s_sysbus_slv_output );
 
     s_sysbus_wmask <= bus_transaction_address_to_write_mask(s_cpu_dbus_cmd_addr,
                                                             s_cpu_dbus_cmd_size);
 
+    -- The main data bus is shared between the processor and the UART
+    -- debug bridge. The debug bridge has priority; it issues at most
+    -- one transaction per received or transmitted word.
+    -- The bus controller accepts no new command while a read is pending,
+    -- so the read response goes to the master of the last accepted read.
+    s_sysmst_dbg_sel    <= s_uart_dbg_mst_output.cmd_valid;
+    s_sysmst_cmd_valid  <= s_cpu_dbus_cmd_valid or s_sysmst_dbg_sel;
+    s_sysmst_cmd_addr   <= s_uart_dbg_mst_output.cmd_addr when s_sysmst_dbg_sel = '1'
+                           else std_logic_vector(s_cpu_dbus_cmd_addr);
+    s_sysmst_cmd_write  <= s_uart_dbg_mst_output.cmd_write when s_sysmst_dbg_sel = '1'
+                           else s_cpu_dbus_cmd_write;
+    s_sysmst_cmd_wdata  <= s_uart_dbg_mst_output.cmd_wdata when s_sysmst_dbg_sel = '1'
+                           else s_cpu_dbus_cmd_wdata;
+    s_sysmst_cmd_wmask  <= s_uart_dbg_mst_output.cmd_wmask when s_sysmst_dbg_sel = '1'
+                           else s_sysbus_wmask;
+    s_cpu_dbus_cmd_ready <= s_sysmst_cmd_ready and (not s_sysmst_dbg_sel);
+    s_cpu_dbus_rsp_valid <= s_sysmst_rsp_valid and (not r_sysmst_rsp_dbg);
+    s_cpu_dbus_rsp_rdata <= s_sysmst_rsp_rdata;
+    s_uart_dbg_mst_input <= ( cmd_ready => s_sysmst_cmd_ready,
+                              rsp_valid => s_sysmst_rsp_valid and r_sysmst_rsp_dbg,
+                              rsp_rdata => s_sysmst_rsp_rdata );
+
+    process (clk_main) is
+    begin
+        if rising_edge(clk_main) then
+            if (s_sysmst_cmd_valid = '1') and (s_sysmst_cmd_ready = '1') and
+               (s_sysmst_cmd_write = '0') then
+                r_sysmst_rsp_dbg <= s_sysmst_dbg_sel;
+            end if;
+        end if;
+    end process;
+
     --
     -- Peripheral data bus controller.
     --
     -- Memory map:
     --   0xf0000000 = GPIO controller for on-board LEDs
     --   0xf0001000 = GPIO controller for pins A..D
-    --   0xf0002000 = GPIO controller for pins E..F
+    --   0xf0002000 = GPIO controller for pins E..H
     --   0xf0004000 = SPI flash controller
     --   0xf0008000 = Timer controller
     --   0xf0010000 = UART controller
+    --   0xf0020000 = JTAG console channel
+    --   0xf0040000 = ICAP configuration port controller
+    --   0xf0080000 = Instruction trace buffer
+    --   0xf0100000 = Peripheral bus monitor (if busmon_enable)
+    --   0xf0200000 = Multiply-accumulate engine
+    --   0xf0400000 = SHA-256 hash engine
+    --   0xf0800000 = I2C master
+    --   0xf1000000 = Accelerator socket
     --
 
     inst_devbus_ctrl: entity work.bus_ctrl
         generic map (
-            num_slaves    => 6,
+            num_slaves    => 13,
             slv_info      => ( 0 => ( addr_start => rvsys_addr_leds,
                                       addr_size  => x"00001000" ),
                                1 => ( addr_start => rvsys_addr_gpio1,
@@ -365,9 +527,25 @@ begin
                                4 => ( addr_start => rvsys_addr_timer,
                                       addr_size  => x"00001000" ),
                                5 => ( addr_start => rvsys_addr_spimem,
+                                      addr_size  => x"00001000" ),
+                               6 => ( addr_start => rvsys_addr_jtagcon,
+                                      addr_size  => x"00001000" ),
+                               7 => ( addr_start => rvsys_addr_icap,
+                                      addr_size  => x"00001000" ),
+                               8 => ( addr_start => rvsys_addr_trace,
+                                      addr_size  => x"00001000" ),
+                               9 => ( addr_start => rvsys_addr_mac,
+                                      addr_size  => x"00001000" ),
+                              10 => ( addr_start => rvsys_addr_sha256,
+                                      addr_size  => x"00001000" ),
+                              11 => ( addr_start => rvsys_addr_i2c,
+                                      addr_size  => x"00001000" ),
+                              12 => ( addr_start => rvsys_addr_accel,
                                       addr_size  => x"00001000" )),
             pipeline_cmd  => true,
-            pipeline_rsp  => true )
+            pipeline_rsp  => true,
+            monitor       => busmon_enable,
+            monitor_addr  => rvsys_addr_busmon )
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
@@ -385,11 +563,16 @@ begin
     --
     -- GPIO.
     --
+    -- GPIO1 and GPIO2 have an event scheduler which compares against
+    -- MTIME from the timer.
+    --
 
     inst_gpio_led: entity work.gpio
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
+            mtime         => (others => '0'),
+            interrupt     => open,
             gpio_i        => (others => '0'),
             gpio_o        => s_gpio_led_o,
             gpio_t        => open,
@@ -397,9 +580,14 @@ begin
             slv_output    => s_devbus_slv_output(0) );
 
     inst_gpio1: entity work.gpio
+        generic map (
+            sched_enable  => true,
+            sched_bits    => 5 )
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
+            mtime         => s_mtime,
+            interrupt     => s_gpio1_interrupt,
             gpio_i        => s_gpio1_i,
             gpio_o        => s_gpio1_o,
             gpio_t        => s_gpio1_t,
@@ -407,9 +595,14 @@ begin
             slv_output    => s_devbus_slv_output(1) );
 
     inst_gpio2: entity work.gpio
+        generic map (
+            sched_enable  => true,
+            sched_bits    => 5 )
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
+            mtime         => s_mtime,
+            interrupt     => s_gpio2_interrupt,
             gpio_i        => s_gpio2_i,
             gpio_o        => s_gpio2_o,
             gpio_t        => s_gpio2_t,
@@ -422,16 +615,53 @@ begin
 
     inst_uart: entity work.uart
         generic map (
-            bit_period    => 868 )  -- 115200 bps at 100 MHz
+            bit_period    => 868,   -- 115200 bps at 100 MHz
+            rx_fifo_bits  => 6 )
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
-            uart_rx       => s_uart_rx,
-            uart_tx       => s_uart_tx,
+            uart_rx       => s_uart_ctl_rx,
+            uart_tx       => s_uart_ctl_tx,
+            uart_cts_n    => s_uart_cts_n,
+            uart_rts_n    => s_uart_rts_n,
+            uart_rts_t    => s_uart_rts_t,
             interrupt     => s_uart_interrupt,
+            dbg_enable    => s_uart_dbg_enable,
             slv_input     => s_devbus_slv_input(3),
             slv_output    => s_devbus_slv_output(3));
 
+    --
+    -- UART debug bridge.
+    --
+
+    gen_uart_dbg: if uart_dbg_enable generate
+        inst_uart_dbg: entity work.uart_dbg
+            generic map (
+                bit_period    => 868,   -- 115200 bps at 100 MHz
+                timeout_bits  => 27 )   -- return to normal mode after 1.3 s
+            port map (
+                clk           => clk_main,
+                rst           => r_sys_reset,
+                enable        => s_uart_dbg_enable,
+                uart_rx       => s_uart_rx,
+                uart_tx       => s_uart_tx,
+                ctl_rx        => s_uart_ctl_rx,
+                ctl_tx        => s_uart_ctl_tx,
+                active        => open,
+                mst_output    => s_uart_dbg_mst_output,
+                mst_input     => s_uart_dbg_mst_input );
+    end generate;
+
+    gen_no_uart_dbg: if not uart_dbg_enable generate
+        s_uart_ctl_rx <= s_uart_rx;
+        s_uart_tx     <= s_uart_ctl_tx;
+        s_uart_dbg_mst_output <= ( cmd_valid => '0',
+                                   cmd_addr  => (others => '0'),
+                                   cmd_write => '0',
+                                   cmd_wdata => (others => '0'),
+                                   cmd_wmask => (others => '0') );
+    end generate;
+
     --
     -- Timer.
     --
@@ -441,6 +671,8 @@ begin
             clk           => clk_main,
             rst           => r_sys_reset,
             interrupt     => s_timer_interrupt,
+            soft_interrupt => s_cpu_int_soft,
+            mtime         => s_mtime,
             slv_input     => s_devbus_slv_input(4),
             slv_output    => s_devbus_slv_output(4));
 
@@ -450,8 +682,10 @@ begin
 
     inst_spiflash: entity work.spiflash
         generic map (
-            clk_half_period => 2,   -- 25 MHz SPI clock
-            deselect_time   => 5 )  -- 50 ns minimum deselect
+            clk_half_period => 2,   -- 25 MHz SPI clock after reset
+            deselect_time   => 5,   -- 50 ns minimum deselect
+            cmd_fifo_bits   => 8,   -- 256 entries
+            read_fifo_bits  => 9 )  -- 512 entries
         port map (
             clk           => clk_main,
             rst           => r_sys_reset,
@@ -459,14 +693,17 @@ begin
             spi_cs        => s_spi_cs,
             spi_mosi      => s_spi_mosi,
             spi_miso      => s_spi_miso,
+            interrupt     => s_spiflash_interrupt,
             slv_input     => s_devbus_slv_input(5),
             slv_output    => s_devbus_slv_output(5));
 
     --
-    -- JTAG debug bridge.
+    -- JTAG debug bridge and console channel.
     --
 
     inst_jtag_dbg: entity work.jtag_dbg
+        generic map (
+            console_fifo_bits => 8 )  -- 256-byte console FIFOs
         port map (
             clk           => clk_main,
             rst           => r_reset,
@@ -480,7 +717,121 @@ begin
             dbg_cmd_write => s_cpu_dbg_cmd_write,
             dbg_cmd_addr  => s_cpu_dbg_cmd_addr,
             dbg_cmd_wdata => s_cpu_dbg_cmd_wdata,
-            dbg_rsp_rdata => s_cpu_dbg_rsp_rdata );
+            dbg_rsp_rdata => s_cpu_dbg_rsp_rdata,
+            slv_input     => s_devbus_slv_input(6),
+            slv_output    => s_devbus_slv_output(6) );
+
+    --
+    -- ICAP configuration port (multiboot reconfiguration).
+    --
+
+    inst_icap_ctrl: entity work.icap_ctrl
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            slv_input     => s_devbus_slv_input(7),
+            slv_output    => s_devbus_slv_output(7) );
+
+    --
+    -- Instruction trace buffer.
+    --
+
+    inst_trace_buf: entity work.trace_buf
+        generic map (
+            depth_bits    => 10,    -- 1024 records
+            trap_vector   => x"80000020" )
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            retire_valid  => s_cpu_retire_valid,
+            retire_pc     => std_logic_vector(s_cpu_retire_pc),
+            retire_insn   => s_cpu_retire_insn,
+            slv_input     => s_devbus_slv_input(8),
+            slv_output    => s_devbus_slv_output(8) );
+
+    --
+    -- Multiply-accumulate engine.
+    --
+
+    inst_mac_engine: entity work.mac_engine
+        generic map (
+            buf_bits      => 8 )    -- 256 taps
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            slv_input     => s_devbus_slv_input(9),
+            slv_output    => s_devbus_slv_output(9) );
+
+    --
+    -- SHA-256 hash engine.
+    --
+
+    inst_sha256: entity work.sha256
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            slv_input     => s_devbus_slv_input(10),
+            slv_output    => s_devbus_slv_output(10) );
+
+    --
+    -- I2C master.
+    --
+
+    inst_i2c_master: entity work.i2c_master
+        generic map (
+            fifo_bits     => 5 )    -- 32-entry command and read FIFOs
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            scl_i         => s_gpio2_i(30),
+            scl_t         => s_i2c_scl_t,
+            sda_i         => s_gpio2_i(31),
+            sda_t         => s_i2c_sda_t,
+            pin_enable    => s_i2c_pin_enable,
+            interrupt     => s_i2c_interrupt,
+            slv_input     => s_devbus_slv_input(11),
+            slv_output    => s_devbus_slv_output(11) );
+
+    --
+    -- Accelerator socket with example kernel.
+    --
+
+    inst_accel_socket: entity work.accel_socket
+        generic map (
+            fifo_bits     => 5 )    -- 32-word input and output FIFOs
+        port map (
+            clk           => clk_main,
+            rst           => r_sys_reset,
+            interrupt     => s_accel_interrupt,
+            slv_input     => s_devbus_slv_input(12),
+            slv_output    => s_devbus_slv_output(12),
+            dma_output    => s_accel_dma_output,
+            dma_input     => s_accel_dma_input,
+            krn_rst       => s_krn_rst,
+            krn_param     => s_krn_param,
+            krn_in_valid  => s_krn_in_valid,
+            krn_in_ready  => s_krn_in_ready,
+            krn_in_data   => s_krn_in_data,
+            krn_in_last   => s_krn_in_last,
+            krn_out_valid => s_krn_out_valid,
+            krn_out_ready => s_krn_out_ready,
+            krn_out_data  => s_krn_out_data,
+            krn_out_last  => s_krn_out_last );
+
+    -- Replace this entity to build a different accelerator.
+    inst_accel_kernel: entity work.accel_crc32
+        port map (
+            clk           => clk_main,
+            rst           => s_krn_rst,
+            param         => s_krn_param,
+            in_valid      => s_krn_in_valid,
+            in_ready      => s_krn_in_ready,
+            in_data       => s_krn_in_data,
+            in_last       => s_krn_in_last,
+            out_valid     => s_krn_out_valid,
+            out_ready     => s_krn_out_ready,
+            out_data      => s_krn_out_data,
+            out_last      => s_krn_out_last );
 
     --
     -- Reset generator.
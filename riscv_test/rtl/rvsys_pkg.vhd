@@ -18,6 +18,14 @@ package rvsys is
     constant rvsys_addr_spimem:  rvsys_addr_type := x"f0004000";
     constant rvsys_addr_timer:   rvsys_addr_type := x"f0008000";
     constant rvsys_addr_uart:    rvsys_addr_type := x"f0010000";
+    constant rvsys_addr_jtagcon: rvsys_addr_type := x"f0020000";
+    constant rvsys_addr_icap:    rvsys_addr_type := x"f0040000";
+    constant rvsys_addr_trace:   rvsys_addr_type := x"f0080000";
+    constant rvsys_addr_busmon:  rvsys_addr_type := x"f0100000";
+    constant rvsys_addr_mac:     rvsys_addr_type := x"f0200000";
+    constant rvsys_addr_sha256:  rvsys_addr_type := x"f0400000";
+    constant rvsys_addr_i2c:     rvsys_addr_type := x"f0800000";
+    constant rvsys_addr_accel:   rvsys_addr_type := x"f1000000";
 
     -- Compile-time description of a bus peripheral device.
     type bus_slv_info_type is record
@@ -0,0 +1,249 @@
+--
+-- SHA-256 hash engine for simple processor system
+--
+-- This peripheral computes the SHA-256 compression function.
+-- Software writes the message in 32-bit words and handles padding
+-- (see rvlib_sha256.h). After every 16th word, the engine processes
+-- the 64-byte block in 64 rounds of one clock cycle each, then adds
+-- the result to the hash state H0 .. H7.
+--
+-- Message words are written as read from memory by the little-endian
+-- processor; the engine swaps the byte order to the big-endian word
+-- order of SHA-256. The hash state registers hold the numeric values
+-- of H0 .. H7 as defined by the standard.
+--
+-- Writes are stalled while the engine processes a block, and reads are
+-- stalled until the engine is idle. Software does not need to poll.
+--
+-- Register map:
+--   address 0x00 (read-write):
+--     bit 0 (wo)       = write '1' to load the initial hash value
+--                        and reset the word counter
+--     bits 31-16 (ro)  = identification 0x5348
+--   address 0x04 (write-only): next message word
+--   address 0x20 .. 0x3c (read-write): hash state H0 .. H7
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity sha256 is
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Bus interface signals.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
+    );
+
+end entity;
+
+architecture sha256_arch of sha256 is
+
+    type word_array is array(natural range <>) of unsigned(31 downto 0);
+
+    constant sha_iv: word_array(0 to 7) := (
+        x"6a09e667", x"bb67ae85", x"3c6ef372", x"a54ff53a",
+        x"510e527f", x"9b05688c", x"1f83d9ab", x"5be0cd19" );
+
+    constant sha_k: word_array(0 to 63) := (
+        x"428a2f98", x"71374491", x"b5c0fbcf", x"e9b5dba5",
+        x"3956c25b", x"59f111f1", x"923f82a4", x"ab1c5ed5",
+        x"d807aa98", x"12835b01", x"243185be", x"550c7dc3",
+        x"72be5d74", x"80deb1fe", x"9bdc06a7", x"c19bf174",
+        x"e49b69c1", x"efbe4786", x"0fc19dc6", x"240ca1cc",
+        x"2de92c6f", x"4a7484aa", x"5cb0a9dc", x"76f988da",
+        x"983e5152", x"a831c66d", x"b00327c8", x"bf597fc7",
+        x"c6e00bf3", x"d5a79147", x"06ca6351", x"14292967",
+        x"27b70a85", x"2e1b2138", x"4d2c6dfc", x"53380d13",
+        x"650a7354", x"766a0abb", x"81c2c92e", x"92722c85",
+        x"a2bfe8a1", x"a81a664b", x"c24b8b70", x"c76c51a3",
+        x"d192e819", x"d6990624", x"f40e3585", x"106aa070",
+        x"19a4c116", x"1e376c08", x"2748774c", x"34b0bcb5",
+        x"391c0cb3", x"4ed8aa4a", x"5b9cca4f", x"682e6ff3",
+        x"748f82ee", x"78a5636f", x"84c87814", x"8cc70208",
+        x"90befffa", x"a4506ceb", x"bef9a3f7", x"c67178f2" );
+
+    type state_type is (st_idle, st_round, st_final);
+
+    -- Internal registers.
+    type regs_type is record
+        state:          state_type;
+        nword:          unsigned(3 downto 0);
+        round:          unsigned(5 downto 0);
+        w:              word_array(0 to 15);
+        h:              word_array(0 to 7);
+        a:              word_array(0 to 7);
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        state           => st_idle,
+        nword           => (others => '0'),
+        round           => (others => '0'),
+        w               => (others => (others => '0')),
+        h               => sha_iv,
+        a               => (others => (others => '0')),
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0'));
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    signal s_cmd_ready: std_logic;
+
+    function bsig0(x: unsigned(31 downto 0)) return unsigned is
+    begin
+        return rotate_right(x, 2) xor rotate_right(x, 13) xor rotate_right(x, 22);
+    end function;
+
+    function bsig1(x: unsigned(31 downto 0)) return unsigned is
+    begin
+        return rotate_right(x, 6) xor rotate_right(x, 11) xor rotate_right(x, 25);
+    end function;
+
+    function ssig0(x: unsigned(31 downto 0)) return unsigned is
+    begin
+        return rotate_right(x, 7) xor rotate_right(x, 18) xor shift_right(x, 3);
+    end function;
+
+    function ssig1(x: unsigned(31 downto 0)) return unsigned is
+    begin
+        return rotate_right(x, 17) xor rotate_right(x, 19) xor shift_right(x, 10);
+    end function;
+
+begin
+
+    -- Drive outputs.
+    slv_output  <= ( cmd_ready => s_cmd_ready,
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_cmd_ready:   std_logic;
+        variable v_accept:      std_logic;
+        variable v_word:        unsigned(31 downto 0);
+        variable v_t1:          unsigned(31 downto 0);
+        variable v_t2:          unsigned(31 downto 0);
+        variable v_idx:         integer range 0 to 7;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+
+        if r.state = st_idle then
+            v_cmd_ready := '1';
+        else
+            v_cmd_ready := '0';
+        end if;
+
+        v_accept := slv_input.cmd_valid and v_cmd_ready;
+        v_idx := to_integer(unsigned(slv_input.cmd_addr(4 downto 2)));
+
+        case r.state is
+            when st_round =>
+                -- One round of the compression function.
+                -- w(0) holds W[t]; the shift register computes W[t+16].
+                v_t1 := r.a(7) + bsig1(r.a(4))
+                        + ((r.a(4) and r.a(5)) xor ((not r.a(4)) and r.a(6)))
+                        + sha_k(to_integer(r.round)) + r.w(0);
+                v_t2 := bsig0(r.a(0))
+                        + ((r.a(0) and r.a(1)) xor (r.a(0) and r.a(2))
+                           xor (r.a(1) and r.a(2)));
+                v.a(7) := r.a(6);
+                v.a(6) := r.a(5);
+                v.a(5) := r.a(4);
+                v.a(4) := r.a(3) + v_t1;
+                v.a(3) := r.a(2);
+                v.a(2) := r.a(1);
+                v.a(1) := r.a(0);
+                v.a(0) := v_t1 + v_t2;
+                v.w(0 to 14) := r.w(1 to 15);
+                v.w(15) := ssig1(r.w(14)) + r.w(9) + ssig0(r.w(1)) + r.w(0);
+                v.round := r.round + 1;
+                if r.round = 63 then
+                    v.state := st_final;
+                end if;
+            when st_final =>
+                -- Add the compressed block to the hash state.
+                for i in 0 to 7 loop
+                    v.h(i) := r.h(i) + r.a(i);
+                end loop;
+                v.state := st_idle;
+            when others =>
+                null;
+        end case;
+
+        -- Handle write transactions.
+        if (v_accept = '1') and (slv_input.cmd_write = '1') then
+            if slv_input.cmd_addr(5) = '1' then
+                -- addr 0x20 .. 0x3c = hash state
+                v.h(v_idx) := unsigned(slv_input.cmd_wdata);
+            elsif slv_input.cmd_addr(4 downto 2) = "000" then
+                -- addr 0x00 = control
+                if slv_input.cmd_wdata(0) = '1' then
+                    v.h := sha_iv;
+                    v.nword := (others => '0');
+                end if;
+            elsif slv_input.cmd_addr(4 downto 2) = "001" then
+                -- addr 0x04 = message word, convert to big-endian
+                v_word := unsigned(slv_input.cmd_wdata(7 downto 0)
+                                   & slv_input.cmd_wdata(15 downto 8)
+                                   & slv_input.cmd_wdata(23 downto 16)
+                                   & slv_input.cmd_wdata(31 downto 24));
+                v.w(to_integer(r.nword)) := v_word;
+                v.nword := r.nword + 1;
+                if r.nword = 15 then
+                    -- Start processing the block.
+                    v.state := st_round;
+                    v.round := (others => '0');
+                    v.a := r.h;
+                end if;
+            end if;
+        end if;
+
+        -- Handle read transactions.
+        v.rsp_valid := v_accept and (not slv_input.cmd_write);
+        if slv_input.cmd_addr(5) = '1' then
+            -- addr 0x20 .. 0x3c = hash state
+            v.rsp_rdata := std_logic_vector(r.h(v_idx));
+        elsif slv_input.cmd_addr(4 downto 2) = "000" then
+            -- addr 0x00 = identification
+            v.rsp_rdata := x"53480000";
+        else
+            v.rsp_rdata := (others => '0');
+        end if;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+            v_cmd_ready := '0';
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+        s_cmd_ready <= v_cmd_ready;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+end architecture;
@@ -6,13 +6,38 @@
 -- Output (MOSI) is updated simultaneous to the falling edge of the SPI clock.
 -- The clock signal stays high when the clock is idle and/or slave deselected.
 --
+-- The SPI clock divider can be changed at run time. At high SPI clock
+-- frequencies, the round trip delay through STARTUPE2, the flash and
+-- the board traces can exceed one SPI clock period. The MISO sample point
+-- can therefore be delayed by a number of system clock cycles after
+-- the nominal capture edge. Software finds a working delay by reading
+-- known data (calibration).
+--
+-- The auto-poll engine waits for completion of a program or erase operation
+-- without software involvement. It repeatedly sends a status command
+-- (for example READ FLAG STATUS) and reads one status byte, until the
+-- status byte matches the expected ready value. It then sets the done flag
+-- and optionally raises an interrupt.
+--
+-- Commands and captured data pass through two FIFOs. The command FIFO
+-- holds byte transfers queued by software. The read FIFO holds captured
+-- MISO bytes until software fetches them. The depth of each FIFO is set
+-- by a generic. The FIFOs are built from distributed RAM.
+--
+-- For bulk reads, software can write a byte count to the read burst
+-- register instead of queueing one capture command per byte. The controller
+-- then generates that number of capture transfers (sending 0x00) as soon
+-- as the command FIFO is empty, pausing whenever the read FIFO is full.
+-- Captured data can be fetched four bytes per bus read via register 0x20.
+--
 -- Register map:
 --
 --   address 0x00 (read-only): Status
 --     bit   0    = '1' when the controller is processing commands,
 --                  '0' when all previous commands have completed.
---     bit   1    = '1' when the controller is ready for a new command.
+--     bit   1    = '1' when the command FIFO can accept a new command.
 --     bit   2    = '1' when a read result byte is available.
+--       While the auto-poll engine is active, bit 0 is '1' and bit 1 is '0'.
 --
 --   address 0x04 (read-write): Slave select status
 --     bit   0    = '1' to select slave, '0' to deselect slave.
@@ -23,9 +48,9 @@
 --   address 0x08 (when write): Start byte transfer
 --     bits  7-0  = Data bits to write to MOSI.
 --     bit   8    = '1' to capture MISO data, '0' to ignore MISO data.
---       Writing to this register adds an 8-bit transfer to the command queue.
+--       Writing to this register adds an 8-bit transfer to the command FIFO.
 --       The slave will become selected if it was deselected.
---       If bit 1 of register 0x04 is '0', writes to this register are ignored.
+--       If bit 1 of register 0x00 is '0', writes to this register are ignored.
 --
 --   address 0x08 (when read): Read captured MISO data.
 --     bits  7-0  = Captured MISO byte from the read FIFO.
@@ -33,9 +58,69 @@
 --                  '0' if the read FIFO was empty.
 --       Reading from this register returns the oldest captured data byte and
 --       removes it from the read FIFO.
---       If bit 2 of register 0x04 is '0', reading this register will
+--       If bit 2 of register 0x00 is '0', reading this register will
 --       return 0x0000 and have no other effect.
 --
+--   address 0x0c (when write): Auto-poll command
+--     bits  7-0  = Status command opcode.
+--     bits 15-8  = Ready mask.
+--     bits 23-16 = Ready value. Polling stops when (status and mask) = value.
+--     bit  29    = '1' to stop polling after the current status read.
+--     bit  30    = '1' to clear the done flag.
+--     bit  31    = '1' to start polling (ignored if polling is active).
+--       Start polling only when all commands have completed and the slave
+--       is deselected. While polling, writes to 0x04, 0x08 and 0x24
+--       are ignored.
+--
+--   address 0x0c (when read): Auto-poll status
+--     bit   0    = '1' while polling is active.
+--     bit   1    = '1' when polling has stopped (done flag).
+--     bits 15-8  = Last status byte read by the auto-poll engine.
+--
+--   address 0x10 (read-write): Auto-poll interval
+--     bits 19-0  = Number of system clock cycles between status reads.
+--
+--   address 0x14 (read-write): Interrupt enable
+--     bit   0    = '1' to enable the auto-poll done interrupt.
+--     bit   1    = '1' to enable the command FIFO low interrupt.
+--     bit   2    = '1' to enable the read FIFO high interrupt.
+--     bits 10-8  = Current state of the three interrupt conditions
+--                  (read-only, independent of the enable bits).
+--       The interrupt output is active while any enabled condition is true:
+--         bit 0: the auto-poll done flag is set;
+--         bit 1: command FIFO level <= command threshold;
+--         bit 2: read FIFO level >= read threshold, or the read FIFO is
+--                not empty and all commands have completed.
+--
+--   address 0x18 (read-only): FIFO levels
+--     bits  9-0  = Number of commands in the command FIFO.
+--     bits 15-12 = Command FIFO size as log2(entries).
+--     bits 25-16 = Number of bytes in the read FIFO.
+--     bits 31-28 = Read FIFO size as log2(entries).
+--
+--   address 0x1c (read-write): Interrupt thresholds
+--     bits  9-0  = Command FIFO low threshold.
+--     bits 25-16 = Read FIFO high threshold.
+--
+--   address 0x20 (read-only): Read 4 captured bytes.
+--     bits 31-0  = Next 4 bytes from the read FIFO, oldest byte in bits 7-0.
+--       If the read FIFO holds at least 4 bytes, reading this register
+--       removes 4 bytes from the FIFO. Otherwise it returns 0x00000000 and
+--       has no other effect. Check the FIFO level before reading.
+--
+--   address 0x24 (read-write): Read burst count
+--     bits 23-0  = Number of capture transfers still to be generated.
+--       Writing adds the written value to the remaining count.
+--       Burst transfers start only when the command FIFO is empty.
+--       Do not queue further commands before the burst is complete.
+--
+--   address 0x28 (read-write): SPI clock configuration
+--     bits  2-0  = SPI clock half-period minus 1, in system clock cycles.
+--                  (SPI clock frequency) = (system clock frequency) / (2 * (N + 1))
+--     bits 10-8  = MISO sample delay in system clock cycles.
+--       Each transfer takes an additional (sample delay) cycles.
+--       Write this register only when all commands have completed.
+--
 
 
 library ieee;
@@ -49,12 +134,18 @@ use work.rvsys.all;
 entity spiflash is
 
     generic (
-        -- SPI clock half-period in units of system clock cycles.
+        -- SPI clock half-period after reset in units of system clock cycles.
         -- (SPI clock frequency) = (system clock frequency) / (2 * clk_period)
         clk_half_period: integer range 1 to 8;
 
         -- Minimum slave deselect time in system clock cycles.
-        deselect_time: integer range 1 to 7
+        deselect_time: integer range 1 to 7;
+
+        -- Command FIFO size as 2-log of the number of entries.
+        cmd_fifo_bits:  integer range 1 to 9;
+
+        -- Read FIFO size as 2-log of the number of entries.
+        read_fifo_bits: integer range 2 to 9
     );
 
     port (
@@ -70,6 +161,9 @@ entity spiflash is
         spi_mosi:       out std_logic;
         spi_miso:       in  std_logic;
 
+        -- Interrupt output, active high.
+        interrupt:      out std_logic;
+
         -- Bus interface signals.
         slv_input:      in  bus_slv_input_type;
         slv_output:     out bus_slv_output_type
@@ -80,7 +174,18 @@ end entity;
 architecture spiflash_arch of spiflash is
 
     -- State machine.
-    type state_type is (State_Idle, State_Deselect, State_Transfer, State_LastBit);
+    type state_type is (State_Idle, State_Deselect, State_Transfer, State_LastBit,
+                        State_Finish);
+
+    -- Auto-poll state machine.
+    type poll_state_type is (Poll_Off, Poll_Wait, Poll_Cmd, Poll_Read);
+
+    -- FIFO memory types.
+    type cmd_fifo_mem_type is array(0 to 2**cmd_fifo_bits-1) of std_logic_vector(8 downto 0);
+    type read_fifo_mem_type is array(0 to 2**read_fifo_bits-1) of std_logic_vector(7 downto 0);
+
+    signal cmdf_mem:    cmd_fifo_mem_type;
+    signal rdf_mem:     read_fifo_mem_type;
 
     -- Internal registers.
     type regs_type is record
@@ -89,13 +194,37 @@ architecture spiflash_arch of spiflash is
         clk_fall:       std_logic;
         clk_level:      std_logic;
         shift_reg:      std_logic_vector(7 downto 0);
+        rx_shift:       std_logic_vector(7 downto 0);
+        rx_strobe:      std_logic_vector(7 downto 0);
+        clk_div:        unsigned(2 downto 0);
+        sample_delay:   unsigned(2 downto 0);
         shift_cnt:      unsigned(2 downto 0);
         shift_capture:  std_logic;
-        tx_fifo_data:   std_logic_vector(8 downto 0);
-        tx_fifo_valid:  std_logic;
-        rx_fifo_data:   std_logic_vector(7 downto 0);
-        rx_fifo_valid:  std_logic;
+        cmdf_rptr:      unsigned(cmd_fifo_bits downto 0);
+        cmdf_wptr:      unsigned(cmd_fifo_bits downto 0);
+        cmdf_wen:       std_logic;
+        cmdf_waddr:     unsigned(cmd_fifo_bits-1 downto 0);
+        cmdf_wdata:     std_logic_vector(8 downto 0);
+        rdf_rptr:       unsigned(read_fifo_bits downto 0);
+        rdf_wptr:       unsigned(read_fifo_bits downto 0);
+        rdf_wen:        std_logic;
+        rdf_waddr:      unsigned(read_fifo_bits-1 downto 0);
+        rdf_wdata:      std_logic_vector(7 downto 0);
+        burst_cnt:      unsigned(23 downto 0);
+        cmd_thresh:     unsigned(9 downto 0);
+        read_thresh:    unsigned(9 downto 0);
         reg_slvsel:     std_logic;
+        poll_state:     poll_state_type;
+        poll_opcode:    std_logic_vector(7 downto 0);
+        poll_mask:      std_logic_vector(7 downto 0);
+        poll_value:     std_logic_vector(7 downto 0);
+        poll_flags:     std_logic_vector(7 downto 0);
+        poll_stop:      std_logic;
+        poll_done:      std_logic;
+        poll_interval:  unsigned(19 downto 0);
+        poll_cnt:       unsigned(19 downto 0);
+        irq_enable:     std_logic_vector(2 downto 0);
+        interrupt_out:  std_logic;
         spi_clk:        std_logic;
         spi_cs:         std_logic;
         spi_mosi:       std_logic;
@@ -109,13 +238,37 @@ architecture spiflash_arch of spiflash is
         clk_fall        => '0',
         clk_level       => '1',
         shift_reg       => (others => '0'),
+        rx_shift        => (others => '0'),
+        rx_strobe       => (others => '0'),
+        clk_div         => to_unsigned(clk_half_period - 1, 3),
+        sample_delay    => (others => '0'),
         shift_cnt       => (others => '0'),
         shift_capture   => '0',
-        tx_fifo_data    => (others => '0'),
-        tx_fifo_valid   => '0',
-        rx_fifo_data    => (others => '0'),
-        rx_fifo_valid   => '0',
+        cmdf_rptr       => (others => '0'),
+        cmdf_wptr       => (others => '0'),
+        cmdf_wen        => '0',
+        cmdf_waddr      => (others => '0'),
+        cmdf_wdata      => (others => '0'),
+        rdf_rptr        => (others => '0'),
+        rdf_wptr        => (others => '0'),
+        rdf_wen         => '0',
+        rdf_waddr       => (others => '0'),
+        rdf_wdata       => (others => '0'),
+        burst_cnt       => (others => '0'),
+        cmd_thresh      => (others => '0'),
+        read_thresh     => (others => '0'),
         reg_slvsel      => '0',
+        poll_state      => Poll_Off,
+        poll_opcode     => (others => '0'),
+        poll_mask       => (others => '0'),
+        poll_value      => (others => '0'),
+        poll_flags      => (others => '0'),
+        poll_stop       => '0',
+        poll_done       => '0',
+        poll_interval   => to_unsigned(1000, 20),
+        poll_cnt        => (others => '0'),
+        irq_enable      => (others => '0'),
+        interrupt_out   => '0',
         spi_clk         => '1',
         spi_cs          => '1',
         spi_mosi        => '0',
@@ -132,6 +285,7 @@ begin
     spi_clk     <= r.spi_clk;
     spi_cs      <= r.spi_cs;
     spi_mosi    <= r.spi_mosi;
+    interrupt   <= r.interrupt_out;
     slv_output  <= ( cmd_ready => '1',
                      rsp_valid => r.rsp_valid,
                      rsp_rdata => r.rsp_rdata );
@@ -139,9 +293,29 @@ begin
     -- Asynchronous process.
     process (all) is
         variable v: regs_type;
+        variable v_cmd_level:   unsigned(cmd_fifo_bits downto 0);
+        variable v_cmd_empty:   boolean;
+        variable v_cmd_full:    boolean;
+        variable v_cmd_head:    std_logic_vector(8 downto 0);
+        variable v_read_level:  unsigned(read_fifo_bits downto 0);
+        variable v_read_empty:  boolean;
+        variable v_read_full:   boolean;
+        variable v_irq_cond:    std_logic_vector(2 downto 0);
+        variable v_strobe:      std_logic_vector(8 downto 0);
     begin
         -- By default, set next registers equal to current registers.
         v := r;
+        v.cmdf_wen := '0';
+        v.rdf_wen  := '0';
+
+        -- Determine FIFO status.
+        v_cmd_level  := r.cmdf_wptr - r.cmdf_rptr;
+        v_cmd_empty  := (r.cmdf_wptr = r.cmdf_rptr);
+        v_cmd_full   := (v_cmd_level(cmd_fifo_bits) = '1');
+        v_cmd_head   := cmdf_mem(to_integer(r.cmdf_rptr(cmd_fifo_bits-1 downto 0)));
+        v_read_level := r.rdf_wptr - r.rdf_rptr;
+        v_read_empty := (r.rdf_wptr = r.rdf_rptr);
+        v_read_full  := (v_read_level(read_fifo_bits) = '1');
 
         -- Update SPI clock output signal.
         v.spi_clk := r.clk_level;
@@ -151,7 +325,7 @@ begin
             -- Prepare clock edge and reload counter.
             v.clk_level := not r.clk_level;
             v.clk_fall  := r.clk_level;
-            v.clk_cnt   := to_unsigned(clk_half_period - 1, v.clk_cnt'length);
+            v.clk_cnt   := r.clk_div;
         else
             -- Count down until next clock edge.
             v.clk_fall  := '0';
@@ -167,23 +341,34 @@ begin
                 -- Keep clock idle high.
                 v.clk_level := '1';
                 v.clk_fall  := '1';
-                v.clk_cnt   := to_unsigned(clk_half_period - 1, v.clk_cnt'length);
+                v.clk_cnt   := r.clk_div;
 
                 -- Offload captured data.
-                if r.shift_capture = '1' and r.rx_fifo_valid = '0' then
-                    v.rx_fifo_data  := r.shift_reg;
-                    v.rx_fifo_valid := '1';
+                -- Status bytes read by the auto-poll engine are handled below.
+                if r.shift_capture = '1' and (not v_read_full)
+                   and r.poll_state /= Poll_Read then
+                    v.rdf_wen       := '1';
+                    v.rdf_waddr     := r.rdf_wptr(read_fifo_bits-1 downto 0);
+                    v.rdf_wdata     := r.rx_shift;
+                    v.rdf_wptr      := r.rdf_wptr + 1;
                     v.shift_capture := '0';
                 end if;
 
-                if r.shift_capture = '0' or r.rx_fifo_valid = '0' then
+                if r.shift_capture = '0' or (not v_read_full) then
                     -- Capture buffer is empty or will be offloaded this cycle.
 
-                    if r.tx_fifo_valid = '1' then
+                    if (not v_cmd_empty) or r.burst_cnt /= 0 then
                         -- Start new transfer.
-                        v.tx_fifo_valid := '0';
-                        v.shift_reg     := r.tx_fifo_data(7 downto 0);
-                        v.shift_capture := r.tx_fifo_data(8);
+                        -- Queued commands go before burst transfers.
+                        if not v_cmd_empty then
+                            v.cmdf_rptr     := r.cmdf_rptr + 1;
+                            v.shift_reg     := v_cmd_head(7 downto 0);
+                            v.shift_capture := v_cmd_head(8);
+                        else
+                            v.burst_cnt     := r.burst_cnt - 1;
+                            v.shift_reg     := x"00";
+                            v.shift_capture := '1';
+                        end if;
                         v.shift_cnt     := to_unsigned(7, v.shift_cnt'length);
                         -- Select slave.
                         v.reg_slvsel    := '1';
@@ -223,9 +408,9 @@ begin
                     -- all occur on the same system clock edge:
                     --     spi_clk      <= '0'
                     --     spi_mosi     <= shift_reg(7)
-                    --     shift_reg(0) <= spi_miso
+                    --     rx_shift(0)  <= spi_miso  (when sample_delay = 0)
                     v.spi_mosi  := r.shift_reg(r.shift_reg'high);
-                    v.shift_reg := r.shift_reg(r.shift_reg'high-1 downto 0) & spi_miso;
+                    v.shift_reg := r.shift_reg(r.shift_reg'high-1 downto 0) & '0';
                     v.shift_cnt := r.shift_cnt - 1;
 
                     if r.shift_cnt = 0 then
@@ -245,12 +430,116 @@ begin
                 -- Capture the last MISO bit.
                 if r.clk_fall = '1' then
                     v.spi_mosi  := '0';
-                    v.shift_reg := r.shift_reg(r.shift_reg'high-1 downto 0) & spi_miso;
-                    v.state     := State_Idle;
+                    if r.sample_delay = 0 then
+                        v.state := State_Idle;
+                    else
+                        -- Wait until the delayed sample point.
+                        v.clk_cnt := r.sample_delay - 1;
+                        v.state   := State_Finish;
+                    end if;
+                end if;
+
+            when State_Finish =>
+                -- Wait until the last MISO bit is captured.
+
+                -- Keep clock idle high.
+                v.clk_level := '1';
+
+                if r.clk_cnt = 0 then
+                    v.state := State_Idle;
+                end if;
+
+        end case;
+
+        -- Capture MISO bits "sample_delay" cycles after each falling edge
+        -- of the SPI clock. Bit N of v_strobe is set if the falling edge
+        -- occurred N cycles ago.
+        v_strobe := r.rx_strobe & '0';
+        if (r.state = State_Transfer or r.state = State_LastBit)
+           and r.clk_fall = '1' then
+            v_strobe(0) := '1';
+        end if;
+        v.rx_strobe := v_strobe(7 downto 0);
+        if v_strobe(to_integer(r.sample_delay)) = '1' then
+            v.rx_shift := r.rx_shift(r.rx_shift'high-1 downto 0) & spi_miso;
+        end if;
+
+        -- Auto-poll engine.
+        -- It uses the command FIFO in the same way as software.
+        case r.poll_state is
+
+            when Poll_Wait =>
+                -- Wait for the poll interval and for the end of the previous
+                -- transaction, then send the status command.
+                if r.poll_cnt /= 0 then
+                    v.poll_cnt := r.poll_cnt - 1;
+                elsif r.poll_stop = '1' then
+                    v.poll_state := Poll_Off;
+                    v.poll_done  := '1';
+                elsif r.state = State_Idle and r.spi_cs = '1' and v_cmd_empty then
+                    v.cmdf_wen   := '1';
+                    v.cmdf_waddr := r.cmdf_wptr(cmd_fifo_bits-1 downto 0);
+                    v.cmdf_wdata := '0' & r.poll_opcode;
+                    v.cmdf_wptr  := r.cmdf_wptr + 1;
+                    v.poll_state := Poll_Cmd;
+                end if;
+
+            when Poll_Cmd =>
+                -- Queue a read of the status byte.
+                if not v_cmd_full then
+                    v.cmdf_wen   := '1';
+                    v.cmdf_waddr := r.cmdf_wptr(cmd_fifo_bits-1 downto 0);
+                    v.cmdf_wdata := '1' & x"00";
+                    v.cmdf_wptr  := r.cmdf_wptr + 1;
+                    v.poll_state := Poll_Read;
                 end if;
 
+            when Poll_Read =>
+                -- Wait until the status byte is captured, then end
+                -- the transaction and check the status.
+                if r.state = State_Idle and v_cmd_empty
+                   and r.shift_capture = '1' then
+                    v.shift_capture := '0';
+                    v.reg_slvsel    := '0';
+                    v.poll_flags    := r.rx_shift;
+                    if (r.rx_shift and r.poll_mask) = r.poll_value
+                       or r.poll_stop = '1' then
+                        v.poll_state := Poll_Off;
+                        v.poll_done  := '1';
+                    else
+                        v.poll_cnt   := r.poll_interval;
+                        v.poll_state := Poll_Wait;
+                    end if;
+                end if;
+
+            when others =>
+                null;
+
         end case;
 
+        -- Determine interrupt conditions.
+        v_irq_cond(0) := r.poll_done;
+        if resize(v_cmd_level, 10) <= r.cmd_thresh then
+            v_irq_cond(1) := '1';
+        else
+            v_irq_cond(1) := '0';
+        end if;
+        if (not v_read_empty)
+           and (resize(v_read_level, 10) >= r.read_thresh
+                or (r.state = State_Idle and v_cmd_empty
+                    and r.burst_cnt = 0 and r.shift_capture = '0')) then
+            v_irq_cond(2) := '1';
+        else
+            v_irq_cond(2) := '0';
+        end if;
+
+        -- Drive interrupt output.
+        if (v_irq_cond and r.irq_enable) /= "000" then
+            v.interrupt_out := '1';
+        else
+            v.interrupt_out := '0';
+        end if;
+
         -- Answer read transactions after 1 clock cycle.
         v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
 
@@ -260,29 +549,84 @@ begin
             -- By default return all zeros.
             v.rsp_rdata := (others => '0');
 
-            case slv_input.cmd_addr(3 downto 2) is
+            case slv_input.cmd_addr(5 downto 2) is
 
-                when "00" =>
+                when "0000" =>
                     -- address 0x00 = status register
-                    if r.state /= State_Idle or r.tx_fifo_valid = '1' then
+                    if r.state /= State_Idle or (not v_cmd_empty)
+                       or r.burst_cnt /= 0 or r.poll_state /= Poll_Off then
                         v.rsp_rdata(0) := '1';
                     end if;
-                    v.rsp_rdata(1) := not r.tx_fifo_valid;
-                    v.rsp_rdata(2) := r.rx_fifo_valid;
+                    if (not v_cmd_full) and r.poll_state = Poll_Off then
+                        v.rsp_rdata(1) := '1';
+                    end if;
+                    if not v_read_empty then
+                        v.rsp_rdata(2) := '1';
+                    end if;
 
-                when "01" =>
+                when "0001" =>
                     -- address 0x04 = slave select register
                     v.rsp_rdata(0) := r.reg_slvsel;
 
-                when "10" =>
+                when "0010" =>
                     -- address 0x08 = read data
-                    v.rsp_rdata(7 downto 0) := r.rx_fifo_data;
-                    v.rsp_rdata(8) := r.rx_fifo_valid;
-                    if r.rx_fifo_valid = '1' then
+                    if not v_read_empty then
                         -- Pop data from read FIFO
-                        v.rx_fifo_valid := '0';
+                        v.rsp_rdata(7 downto 0) :=
+                            rdf_mem(to_integer(r.rdf_rptr(read_fifo_bits-1 downto 0)));
+                        v.rsp_rdata(8) := '1';
+                        v.rdf_rptr := r.rdf_rptr + 1;
+                    end if;
+
+                when "0011" =>
+                    -- address 0x0c = auto-poll status
+                    if r.poll_state /= Poll_Off then
+                        v.rsp_rdata(0) := '1';
+                    end if;
+                    v.rsp_rdata(1) := r.poll_done;
+                    v.rsp_rdata(15 downto 8) := r.poll_flags;
+
+                when "0100" =>
+                    -- address 0x10 = auto-poll interval
+                    v.rsp_rdata(19 downto 0) := std_logic_vector(r.poll_interval);
+
+                when "0101" =>
+                    -- address 0x14 = interrupt enable
+                    v.rsp_rdata(2 downto 0)  := r.irq_enable;
+                    v.rsp_rdata(10 downto 8) := v_irq_cond;
+
+                when "0110" =>
+                    -- address 0x18 = FIFO levels
+                    v.rsp_rdata(9 downto 0)   := std_logic_vector(resize(v_cmd_level, 10));
+                    v.rsp_rdata(15 downto 12) := std_logic_vector(to_unsigned(cmd_fifo_bits, 4));
+                    v.rsp_rdata(25 downto 16) := std_logic_vector(resize(v_read_level, 10));
+                    v.rsp_rdata(31 downto 28) := std_logic_vector(to_unsigned(read_fifo_bits, 4));
+
+                when "0111" =>
+                    -- address 0x1c = interrupt thresholds
+                    v.rsp_rdata(9 downto 0)   := std_logic_vector(r.cmd_thresh);
+                    v.rsp_rdata(25 downto 16) := std_logic_vector(r.read_thresh);
+
+                when "1000" =>
+                    -- address 0x20 = read 4 bytes
+                    if v_read_level >= 4 then
+                        -- Pop 4 bytes from read FIFO
+                        for i in 0 to 3 loop
+                            v.rsp_rdata(8*i+7 downto 8*i) :=
+                                rdf_mem(to_integer(r.rdf_rptr(read_fifo_bits-1 downto 0) + i));
+                        end loop;
+                        v.rdf_rptr := r.rdf_rptr + 4;
                     end if;
 
+                when "1001" =>
+                    -- address 0x24 = read burst count
+                    v.rsp_rdata(23 downto 0) := std_logic_vector(r.burst_cnt);
+
+                when "1010" =>
+                    -- address 0x28 = SPI clock configuration
+                    v.rsp_rdata(2 downto 0)  := std_logic_vector(r.clk_div);
+                    v.rsp_rdata(10 downto 8) := std_logic_vector(r.sample_delay);
+
                 when others =>
                     null;
 
@@ -292,18 +636,65 @@ begin
         -- Handle bus write transactions.
         if slv_input.cmd_valid = '1' and slv_input.cmd_write = '1' then
 
-            case slv_input.cmd_addr(3 downto 2) is
+            case slv_input.cmd_addr(5 downto 2) is
 
-                when "01" =>
+                when "0001" =>
                     -- address 0x04 = slave select register
-                    v.reg_slvsel := slv_input.cmd_wdata(0);
+                    if r.poll_state = Poll_Off then
+                        v.reg_slvsel := slv_input.cmd_wdata(0);
+                    end if;
 
-                when "10" =>
+                when "0010" =>
                     -- address 0x08 = transfer command register
-                    if r.tx_fifo_valid = '0' then
-                        v.tx_fifo_data := slv_input.cmd_wdata(8 downto 0);
-                        v.tx_fifo_valid := '1';
+                    if (not v_cmd_full) and r.poll_state = Poll_Off then
+                        v.cmdf_wen   := '1';
+                        v.cmdf_waddr := r.cmdf_wptr(cmd_fifo_bits-1 downto 0);
+                        v.cmdf_wdata := slv_input.cmd_wdata(8 downto 0);
+                        v.cmdf_wptr  := r.cmdf_wptr + 1;
+                    end if;
+
+                when "0011" =>
+                    -- address 0x0c = auto-poll command
+                    if slv_input.cmd_wdata(30) = '1' then
+                        v.poll_done := '0';
                     end if;
+                    if slv_input.cmd_wdata(29) = '1' then
+                        v.poll_stop := '1';
+                    end if;
+                    if slv_input.cmd_wdata(31) = '1' and r.poll_state = Poll_Off then
+                        v.poll_opcode := slv_input.cmd_wdata(7 downto 0);
+                        v.poll_mask   := slv_input.cmd_wdata(15 downto 8);
+                        v.poll_value  := slv_input.cmd_wdata(23 downto 16);
+                        v.poll_stop   := '0';
+                        v.poll_done   := '0';
+                        v.poll_cnt    := (others => '0');
+                        v.poll_state  := Poll_Wait;
+                    end if;
+
+                when "0100" =>
+                    -- address 0x10 = auto-poll interval
+                    v.poll_interval := unsigned(slv_input.cmd_wdata(19 downto 0));
+
+                when "0101" =>
+                    -- address 0x14 = interrupt enable
+                    v.irq_enable := slv_input.cmd_wdata(2 downto 0);
+
+                when "0111" =>
+                    -- address 0x1c = interrupt thresholds
+                    v.cmd_thresh  := unsigned(slv_input.cmd_wdata(9 downto 0));
+                    v.read_thresh := unsigned(slv_input.cmd_wdata(25 downto 16));
+
+                when "1001" =>
+                    -- address 0x24 = read burst count
+                    -- Add to the count, which may be decremented in this cycle.
+                    if r.poll_state = Poll_Off then
+                        v.burst_cnt := v.burst_cnt + unsigned(slv_input.cmd_wdata(23 downto 0));
+                    end if;
+
+                when "1010" =>
+                    -- address 0x28 = SPI clock configuration
+                    v.clk_div      := unsigned(slv_input.cmd_wdata(2 downto 0));
+                    v.sample_delay := unsigned(slv_input.cmd_wdata(10 downto 8));
 
                 when others =>
                     null;
@@ -315,9 +706,24 @@ begin
         if rst = '1' then
             v.state         := State_Idle;
             v.clk_level     := '1';
-            v.tx_fifo_valid := '0';
-            v.rx_fifo_valid := '0';
+            v.cmdf_rptr     := (others => '0');
+            v.cmdf_wptr     := (others => '0');
+            v.cmdf_wen      := '0';
+            v.rdf_rptr      := (others => '0');
+            v.rdf_wptr      := (others => '0');
+            v.rdf_wen       := '0';
+            v.burst_cnt     := (others => '0');
+            v.cmd_thresh    := (others => '0');
+            v.read_thresh   := (others => '0');
+            v.rx_strobe     := (others => '0');
+            v.clk_div       := regs_init.clk_div;
+            v.sample_delay  := (others => '0');
             v.reg_slvsel    := '0';
+            v.poll_state    := Poll_Off;
+            v.poll_done     := '0';
+            v.poll_interval := regs_init.poll_interval;
+            v.irq_enable    := (others => '0');
+            v.interrupt_out := '0';
             v.spi_clk       := '1';
             v.spi_cs        := '1';
             v.spi_mosi      := '0';
@@ -337,4 +743,20 @@ begin
         end if;
     end process;
 
+    -- FIFO memories.
+    -- Reads are asynchronous, such that the oldest entry is always visible.
+    -- Register 0x20 reads 4 entries at once, which makes the synthesis tool
+    -- replicate the read FIFO memory.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if rnext.cmdf_wen = '1' then
+                cmdf_mem(to_integer(rnext.cmdf_waddr)) <= rnext.cmdf_wdata;
+            end if;
+            if rnext.rdf_wen = '1' then
+                rdf_mem(to_integer(rnext.rdf_waddr)) <= rnext.rdf_wdata;
+            end if;
+        end if;
+    end process;
+
 end architecture;
@@ -5,6 +5,14 @@
 -- The 64-bit register MTIMECMP marks the time of the next interrupt.
 -- The interrupt signal is high whenever MTIME >= MTIMECMP.
 --
+-- The MSIP register drives the software interrupt of the processor.
+-- Software can set this bit to trigger an interrupt, for example to
+-- defer work to a low-priority interrupt handler.
+--
+-- The current value of MTIME is also available as an output signal,
+-- so that other peripherals in the same clock domain can act at exact
+-- times (see the event scheduler in the GPIO controller).
+--
 -- The 64-bit registers are accessed as two 32-bit words.
 -- Partial-word writes (byte, half-word) are not supported.
 --
@@ -17,6 +25,7 @@
 --   address  4 (read-write): Bits 63-32 of the MTIME register.
 --   address  8 (read-write): Bits 31-0 of the MTIMECMP register.
 --   address 12 (read-write): Bits 63-32 of the MTIMECMP register.
+--   address 16 (read-write): Bit 0 is the MSIP register.
 --
 
 library ieee;
@@ -39,6 +48,12 @@ entity timer is
         -- Interrupt signal.
         interrupt:      out std_logic;
 
+        -- Software interrupt signal.
+        soft_interrupt: out std_logic;
+
+        -- Current value of the MTIME register.
+        mtime:          out std_logic_vector(63 downto 0);
+
         -- Bus interface signals.
         slv_input:      in  bus_slv_input_type;
         slv_output:     out bus_slv_output_type
@@ -53,6 +68,7 @@ architecture timer_arch of timer is
         reg_mtime:      std_logic_vector(63 downto 0);
         reg_mtimecmp:   std_logic_vector(63 downto 0);
         interrupt_out:  std_logic;
+        reg_msip:       std_logic;
         rsp_valid:      std_logic;
         rsp_rdata:      std_logic_vector(31 downto 0);
     end record;
@@ -61,6 +77,7 @@ architecture timer_arch of timer is
         reg_mtime       => (others => '0'),
         reg_mtimecmp    => (others => '1'),
         interrupt_out   => '0',
+        reg_msip        => '0',
         rsp_valid       => '0',
         rsp_rdata       => (others => '0'));
 
@@ -71,6 +88,8 @@ begin
 
     -- Drive outputs.
     interrupt   <= r.interrupt_out;
+    soft_interrupt <= r.reg_msip;
+    mtime       <= r.reg_mtime;
     slv_output  <= ( cmd_ready => '1',
                      rsp_valid => r.rsp_valid,
                      rsp_rdata => r.rsp_rdata );
@@ -87,37 +106,43 @@ begin
 
         -- Handle write transactions.
         if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
-            case slv_input.cmd_addr(3 downto 2) is
-                when "00" =>
+            case slv_input.cmd_addr(4 downto 2) is
+                when "000" =>
                     -- addr 0 = low 32 bits of MTIME
                     v.reg_mtime(31 downto 0) := slv_input.cmd_wdata;
-                when "01" =>
+                when "001" =>
                     -- addr 4 = high 32 bits of MTIME
                     v.reg_mtime(63 downto 32) := slv_input.cmd_wdata;
-                when "10" =>
+                when "010" =>
                     -- addr 8 = low 32 bits of MTIMECMP
                     v.reg_mtimecmp(31 downto 0) := slv_input.cmd_wdata;
-                when others =>
+                when "011" =>
                     -- addr 12 = high 32 bits of MTIMECMP
                     v.reg_mtimecmp(63 downto 32) := slv_input.cmd_wdata;
+                when others =>
+                    -- addr 16 = MSIP
+                    v.reg_msip := slv_input.cmd_wdata(0);
             end case;
         end if;
 
         -- Handle read transactions.
         v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
-        case slv_input.cmd_addr(3 downto 2) is
-            when "00" =>
+        case slv_input.cmd_addr(4 downto 2) is
+            when "000" =>
                 -- addr 0 = low 32 bits of MTIME
                 v.rsp_rdata := r.reg_mtime(31 downto 0);
-            when "01" =>
+            when "001" =>
                 -- addr 4 = high 32 bits of MTIME
                 v.rsp_rdata := r.reg_mtime(63 downto 32);
-            when "10" =>
+            when "010" =>
                 -- addr 8 = low 32 bits of MTIMECMP
                 v.rsp_rdata := r.reg_mtimecmp(31 downto 0);
-            when others =>
+            when "011" =>
                 -- addr 12 = high 32 bits of MTIMECMP
                 v.rsp_rdata := r.reg_mtimecmp(63 downto 32);
+            when others =>
+                -- addr 16 = MSIP
+                v.rsp_rdata := (0 => r.reg_msip, others => '0');
         end case;
 
         -- Time comparison and interrupt output signal.
@@ -0,0 +1,439 @@
+--
+-- Instruction trace buffer for simple processor system
+--
+-- This peripheral watches the instructions retired by the processor
+-- and records a compressed history of the program flow into a circular
+-- buffer in block RAM. Together with the program image, the history is
+-- enough to reconstruct the exact sequence of executed instructions.
+--
+-- Sequential instructions and direct jumps (JAL) are not recorded.
+-- Each conditional branch takes only one bit (taken or not taken).
+-- Indirect jumps (JALR, MRET) record their target address.
+-- Entry into the trap handler records the address of the last
+-- instruction that retired before the trap.
+--
+-- Each record consists of two 32-bit words:
+--   word 0: bits 1-0 = record type
+--             "00" = indirect jump, bits 31-2 = target address
+--             "01" = branch history, bits 6-2 = number of branches (1 to 25),
+--                    bits 31-7 = branch outcomes ('1' = taken),
+--                    starting with the oldest branch in bit 7
+--             "10" = trap, bits 31-2 = address of the last instruction
+--                    retired before entering the trap handler
+--             "11" = sync, bits 31-2 = address of the first instruction
+--                    after starting the trace, or after an unexpected
+--                    change of the program counter (for example by
+--                    the debugger)
+--   word 1: timestamp (clock cycles since the buffer was cleared);
+--           for branch history records, the time of the last branch
+--
+-- A trap is recognized when the processor retires an instruction at
+-- the trap vector address, other than after an indirect jump.
+--
+-- Register map:
+--   address 0x00 (read-write):
+--     bit 0 (rw)     = enable tracing
+--     bit 1 (rw)     = stop when full: '0' = overwrite oldest records,
+--                      '1' = stop recording when the buffer is full
+--     bit 2 (wo)     = write '1' to clear the buffer and the timestamp
+--     bit 3 (ro)     = '1' if the buffer has been filled completely
+--     bit 4 (ro)     = '1' if records were lost due to internal overflow
+--     bits 12-8 (ro) = log2 of the buffer size (number of records)
+--   address 0x04 (read-only):
+--     bits 31-0      = write index (position of the next record)
+--   address 0x08 (read-write):
+--     bits 31-0      = read index
+--   address 0x0c (read-only):
+--     bits 31-0      = word 0 of the record at the read index
+--   address 0x10 (read-only):
+--     bits 31-0      = word 1 of the record at the read index;
+--                      reading this register increments the read index
+--   address 0x14 (read-only):
+--     bits 31-0      = current timestamp
+--
+-- When tracing is disabled, pending branch history is written
+-- to the buffer. Software should stop tracing before reading records.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity trace_buf is
+
+    generic (
+        -- Log2 of the number of records in the buffer.
+        depth_bits:     integer range 4 to 16;
+
+        -- Address of the trap handler (mtvec).
+        trap_vector:    std_logic_vector(31 downto 0) );
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Retired instructions from the processor.
+        retire_valid:   in  std_logic;
+        retire_pc:      in  std_logic_vector(31 downto 0);
+        retire_insn:    in  std_logic_vector(31 downto 0);
+
+        -- Bus interface signals.
+        slv_input:      in  bus_slv_input_type;
+        slv_output:     out bus_slv_output_type
+    );
+
+end entity;
+
+architecture trace_buf_arch of trace_buf is
+
+    constant buf_size: integer := 2**depth_bits;
+    constant max_branches: integer := 25;
+
+    -- Record types.
+    constant rec_target: std_logic_vector(1 downto 0) := "00";
+    constant rec_branch: std_logic_vector(1 downto 0) := "01";
+    constant rec_trap:   std_logic_vector(1 downto 0) := "10";
+    constant rec_sync:   std_logic_vector(1 downto 0) := "11";
+
+    -- Instruction classes.
+    type insn_class_type is (insn_other, insn_branch, insn_jal, insn_indirect);
+
+    -- Record buffer in block RAM.
+    type mem_type is array(0 to buf_size-1) of std_logic_vector(63 downto 0);
+    signal mem: mem_type;
+
+    -- Internal registers.
+    type regs_type is record
+        enable:         std_logic;
+        stop_full:      std_logic;
+        full:           std_logic;
+        overflow:       std_logic;
+        prev_valid:     std_logic;
+        prev_pc:        unsigned(31 downto 0);
+        prev_class:     insn_class_type;
+        br_count:       unsigned(4 downto 0);
+        br_bits:        std_logic_vector(max_branches-1 downto 0);
+        br_time:        std_logic_vector(31 downto 0);
+        hold_valid:     std_logic;
+        hold_data:      std_logic_vector(63 downto 0);
+        timestamp:      unsigned(31 downto 0);
+        wr_index:       unsigned(depth_bits-1 downto 0);
+        rd_index:       unsigned(depth_bits-1 downto 0);
+        mem_wen:        std_logic;
+        mem_waddr:      unsigned(depth_bits-1 downto 0);
+        mem_wdata:      std_logic_vector(63 downto 0);
+        rsp_valid:      std_logic;
+        rsp_rdata:      std_logic_vector(31 downto 0);
+    end record;
+
+    constant regs_init: regs_type := (
+        enable          => '0',
+        stop_full       => '0',
+        full            => '0',
+        overflow        => '0',
+        prev_valid      => '0',
+        prev_pc         => (others => '0'),
+        prev_class      => insn_other,
+        br_count        => (others => '0'),
+        br_bits         => (others => '0'),
+        br_time         => (others => '0'),
+        hold_valid      => '0',
+        hold_data       => (others => '0'),
+        timestamp       => (others => '0'),
+        wr_index        => (others => '0'),
+        rd_index        => (others => '0'),
+        mem_wen         => '0',
+        mem_waddr       => (others => '0'),
+        mem_wdata       => (others => '0'),
+        rsp_valid       => '0',
+        rsp_rdata       => (others => '0'));
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+    signal s_mem_rdata: std_logic_vector(63 downto 0);
+
+    -- Determine the class of an instruction word.
+    function insn_class(insn: std_logic_vector(31 downto 0))
+        return insn_class_type
+    is
+    begin
+        case insn(6 downto 0) is
+            when "1100011" =>
+                return insn_branch;
+            when "1101111" =>
+                return insn_jal;
+            when "1100111" =>
+                return insn_indirect;
+            when "1110011" =>
+                -- MRET (and other privileged instructions)
+                if insn(14 downto 12) = "000" then
+                    return insn_indirect;
+                else
+                    return insn_other;
+                end if;
+            when others =>
+                return insn_other;
+        end case;
+    end function;
+
+    -- Build the branch history record.
+    function branch_record(count: unsigned(4 downto 0);
+                           bits: std_logic_vector(max_branches-1 downto 0);
+                           tstamp: std_logic_vector(31 downto 0))
+        return std_logic_vector
+    is
+    begin
+        return tstamp & bits & std_logic_vector(count) & rec_branch;
+    end function;
+
+begin
+
+    -- Drive outputs.
+    slv_output  <= ( cmd_ready => '1',
+                     rsp_valid => r.rsp_valid,
+                     rsp_rdata => r.rsp_rdata );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_nrec: integer range 0 to 2;
+        variable v_rec0: std_logic_vector(63 downto 0);
+        variable v_rec1: std_logic_vector(63 downto 0);
+        variable v_event: std_logic;
+        variable v_event_rec: std_logic_vector(63 downto 0);
+        variable v_pc: unsigned(31 downto 0);
+        variable v_write: std_logic;
+        variable v_wdata: std_logic_vector(63 downto 0);
+        variable v_clear: std_logic;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+
+        -- Count clock cycles.
+        v.timestamp := r.timestamp + 1;
+
+        -- Collect up to two new records in this cycle.
+        v_nrec  := 0;
+        v_rec0  := (others => '0');
+        v_rec1  := (others => '0');
+        v_event := '0';
+        v_event_rec := (others => '0');
+        v_clear := '0';
+
+        -- Watch retired instructions.
+        if (r.enable = '1') and (retire_valid = '1') then
+            v_pc := unsigned(retire_pc);
+
+            if r.prev_valid = '0' then
+                -- First instruction after starting the trace.
+                v_event := '1';
+                v_event_rec := std_logic_vector(r.timestamp)
+                               & retire_pc(31 downto 2) & rec_sync;
+            elsif (retire_pc = trap_vector)
+                  and (r.prev_class /= insn_indirect) then
+                -- Entering the trap handler.
+                v_event := '1';
+                v_event_rec := std_logic_vector(r.timestamp)
+                               & std_logic_vector(r.prev_pc(31 downto 2))
+                               & rec_trap;
+            else
+                case r.prev_class is
+                    when insn_branch =>
+                        -- Add branch outcome to the history.
+                        if v_pc = r.prev_pc + 4 then
+                            v.br_bits(to_integer(r.br_count)) := '0';
+                        else
+                            v.br_bits(to_integer(r.br_count)) := '1';
+                        end if;
+                        v.br_count := r.br_count + 1;
+                        v.br_time  := std_logic_vector(r.timestamp);
+                        if r.br_count = max_branches - 1 then
+                            v_nrec := 1;
+                            v_rec0 := branch_record(v.br_count, v.br_bits, v.br_time);
+                            v.br_count := (others => '0');
+                        end if;
+                    when insn_jal =>
+                        -- Direct jump, target is known from the program.
+                        null;
+                    when insn_indirect =>
+                        -- Record target of indirect jump.
+                        v_event := '1';
+                        v_event_rec := std_logic_vector(r.timestamp)
+                                       & retire_pc(31 downto 2) & rec_target;
+                    when others =>
+                        -- Unexpected change of program counter.
+                        if v_pc /= r.prev_pc + 4 then
+                            v_event := '1';
+                            v_event_rec := std_logic_vector(r.timestamp)
+                                           & retire_pc(31 downto 2) & rec_sync;
+                        end if;
+                end case;
+            end if;
+
+            v.prev_valid := '1';
+            v.prev_pc    := v_pc;
+            v.prev_class := insn_class(retire_insn);
+        end if;
+
+        -- Pending branch history must be written before other records.
+        if v_event = '1' then
+            if r.br_count /= 0 then
+                v_nrec := 2;
+                v_rec0 := branch_record(r.br_count, r.br_bits, r.br_time);
+                v_rec1 := v_event_rec;
+                v.br_count := (others => '0');
+            else
+                v_nrec := 1;
+                v_rec0 := v_event_rec;
+            end if;
+        end if;
+
+        -- Handle write transactions.
+        if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
+            case slv_input.cmd_addr(4 downto 2) is
+                when "000" =>
+                    -- addr 0x00 = control register
+                    v.enable    := slv_input.cmd_wdata(0);
+                    v.stop_full := slv_input.cmd_wdata(1);
+                    if (r.enable = '1') and (slv_input.cmd_wdata(0) = '0')
+                       and (v.br_count /= 0) then
+                        -- Flush pending branch history when stopping.
+                        v_nrec := 1;
+                        v_rec0 := branch_record(v.br_count, v.br_bits, v.br_time);
+                        v.br_count := (others => '0');
+                    end if;
+                    if (r.enable = '0') and (slv_input.cmd_wdata(0) = '1') then
+                        -- Start with a sync record.
+                        v.prev_valid := '0';
+                        v.br_count   := (others => '0');
+                    end if;
+                    v_clear := slv_input.cmd_wdata(2);
+                when "010" =>
+                    -- addr 0x08 = read index
+                    v.rd_index  := unsigned(slv_input.cmd_wdata(depth_bits-1 downto 0));
+                when others =>
+                    null;
+            end case;
+        end if;
+
+        -- Select record to write in this cycle; keep one record on hold.
+        v_write := '0';
+        v_wdata := (others => '0');
+        if r.hold_valid = '1' then
+            v_write := '1';
+            v_wdata := r.hold_data;
+            v.hold_valid := '0';
+            if v_nrec >= 1 then
+                v.hold_valid := '1';
+                v.hold_data  := v_rec0;
+            end if;
+            if v_nrec = 2 then
+                v.overflow := '1';
+            end if;
+        elsif v_nrec >= 1 then
+            v_write := '1';
+            v_wdata := v_rec0;
+            if v_nrec = 2 then
+                v.hold_valid := '1';
+                v.hold_data  := v_rec1;
+            end if;
+        end if;
+
+        -- Write record to the buffer.
+        v.mem_wen := '0';
+        if (v_write = '1') and ((r.stop_full = '0') or (r.full = '0')) then
+            v.mem_wen   := '1';
+            v.mem_waddr := r.wr_index;
+            v.mem_wdata := v_wdata;
+            v.wr_index  := r.wr_index + 1;
+            if r.wr_index = buf_size - 1 then
+                v.full  := '1';
+            end if;
+        end if;
+
+        -- Clear the buffer.
+        if v_clear = '1' then
+            v.full       := '0';
+            v.overflow   := '0';
+            v.prev_valid := '0';
+            v.br_count   := (others => '0');
+            v.hold_valid := '0';
+            v.mem_wen    := '0';
+            v.wr_index   := (others => '0');
+            v.rd_index   := (others => '0');
+            v.timestamp  := (others => '0');
+        end if;
+
+        -- Handle read transactions.
+        v.rsp_valid := slv_input.cmd_valid and (not slv_input.cmd_write);
+        v.rsp_rdata := (others => '0');
+        case slv_input.cmd_addr(4 downto 2) is
+            when "000" =>
+                -- addr 0x00 = control register
+                v.rsp_rdata(0) := r.enable;
+                v.rsp_rdata(1) := r.stop_full;
+                v.rsp_rdata(3) := r.full;
+                v.rsp_rdata(4) := r.overflow;
+                v.rsp_rdata(12 downto 8) := std_logic_vector(to_unsigned(depth_bits, 5));
+            when "001" =>
+                -- addr 0x04 = write index
+                v.rsp_rdata(depth_bits-1 downto 0) := std_logic_vector(r.wr_index);
+            when "010" =>
+                -- addr 0x08 = read index
+                v.rsp_rdata(depth_bits-1 downto 0) := std_logic_vector(r.rd_index);
+            when "011" =>
+                -- addr 0x0c = word 0 of record
+                v.rsp_rdata := s_mem_rdata(31 downto 0);
+            when "100" =>
+                -- addr 0x10 = word 1 of record
+                v.rsp_rdata := s_mem_rdata(63 downto 32);
+                if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '0') then
+                    v.rd_index := r.rd_index + 1;
+                end if;
+            when "101" =>
+                -- addr 0x14 = current timestamp
+                v.rsp_rdata := std_logic_vector(r.timestamp);
+            when others =>
+                null;
+        end case;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+    -- Block RAM.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if r.mem_wen = '1' then
+                mem(to_integer(r.mem_waddr)) <= r.mem_wdata;
+            end if;
+            -- Read at the next read index, such that the record is
+            -- available in the cycle after the index changes.
+            s_mem_rdata <= mem(to_integer(rnext.rd_index));
+        end if;
+    end process;
+
+end architecture;
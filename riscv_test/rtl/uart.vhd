@@ -1,29 +1,52 @@
 --
 -- UART controller for simple processor system
 --
--- The UART transmits and receives at a fixed baud rate.
--- A single-byte transmit buffer and single-byte receive buffer are used.
--- A receive interrupt can optionally be generated when the receive buffer
+-- The UART transmits and receives at a programmable baud rate.
+-- A single-byte transmit buffer and a receive FIFO are used.
+-- A receive interrupt can optionally be generated when the receive FIFO
 -- is not empty.
 -- A transmit interrupt can optionally be generated when the transmit buffer
 -- is empty.
 --
+-- Optional RTS/CTS hardware flow control can be enabled by software.
+-- When enabled, RTS is asserted (driven low) while the receive FIFO has
+-- room for at least a quarter of its size. This leaves room for bytes
+-- that the remote side sends before it reacts to RTS. The transmitter
+-- does not start a new byte while CTS is deasserted (high).
+-- When flow control is disabled, the RTS output is released (rts_t = '1')
+-- and CTS is ignored.
+--
+-- The "dbg_enable" output arms the UART debug bridge (uart_dbg.vhd),
+-- if the system has one. It is '0' after reset. Software sets it only
+-- while the UART carries text, and may lock it to '0' until the next
+-- reset, for example before starting a verified boot.
+--
 -- Partial-word writes (byte, half-word) are not supported.
 --
 -- Register map:
 --   address 0 (read):
---     bits 7-0 (ro)  = received byte
+--     bits 7-0 (ro)  = received byte (removed from the receive FIFO)
 --     bit 16 (ro)    = '1' if byte received, '0' if no byte ready
 --     bit 17 (ro)    = receiver frame error (cleared by reading)
---     bit 18 (ro)    = receive buffer overrun (cleared by reading)
+--     bit 18 (ro)    = receive FIFO overrun (cleared by reading)
 --   address 0 (write):
 --     bits 7-0 (wo)  = byte to transmit
 --   address 4:
 --     bit 0 (rw)     = transmit interrupt enable
 --     bit 1 (rw)     = receive interrupt enable
+--     bit 2 (rw)     = RTS/CTS flow control enable
 --     bit 8 (ro)     = transmit interrupt pending
 --     bit 9 (ro)     = receive interrupt pending
+--     bit 14 (ro)    = '1' when CTS is asserted by the remote side
 --     bit 15 (ro)    = '1' when transmit buffer not empty
+--     bits 25-16 (ro) = number of bytes in the receive FIFO
+--     bits 31-28 (ro) = rx_fifo_bits (log2 of receive FIFO size)
+--   address 8:
+--     bits 14-0 (rw) = bit period in clock cycles (minimum 8)
+--   address 12:
+--     bit 0 (rw)     = debug bridge enable (forced to '0' when locked)
+--     bit 1 (rw1)    = debug bridge lock (write '1' to set; cleared only
+--                      by reset)
 --
 
 library ieee;
@@ -37,9 +60,12 @@ use work.rvsys.all;
 entity uart is
 
     generic (
-        -- Number of clock cycles per bit period.
+        -- Number of clock cycles per bit period after reset.
         -- The effective baud rate is (clk_freq / bit_period).
-        bit_period: integer range 8 to 32766
+        bit_period: integer range 8 to 32766;
+
+        -- Size of the receive FIFO as 2-log of the number of bytes.
+        rx_fifo_bits: integer range 2 to 9
     );
 
     port (
@@ -53,9 +79,18 @@ entity uart is
         uart_rx:        in  std_logic;
         uart_tx:        out std_logic;
 
+        -- Flow control signals (active low).
+        -- Release the RTS pin when "uart_rts_t" is '1'.
+        uart_cts_n:     in  std_logic;
+        uart_rts_n:     out std_logic;
+        uart_rts_t:     out std_logic;
+
         -- Interrupt signal.
         interrupt:      out std_logic;
 
+        -- Debug bridge enable.
+        dbg_enable:     out std_logic;
+
         -- Bus interface signals.
         slv_input:      in  bus_slv_input_type;
         slv_output:     out bus_slv_output_type
@@ -65,8 +100,14 @@ end entity;
 
 architecture uart_arch of uart is
 
+    -- Receive FIFO.
+    type rxf_mem_type is array(0 to 2**rx_fifo_bits - 1)
+        of std_logic_vector(7 downto 0);
+    signal rxf_mem: rxf_mem_type;
+
     -- Internal registers.
     type regs_type is record
+        bitper:         unsigned(14 downto 0);
         rxtimer:        unsigned(14 downto 0);
         rxstate:        unsigned(3 downto 0);
         rxshift:        std_logic_vector(7 downto 0);
@@ -74,22 +115,31 @@ architecture uart_arch of uart is
         txstate:        unsigned(3 downto 0);
         txshift:        std_logic_vector(7 downto 0);
         txvalid:        std_logic;
-        rxvalid:        std_logic;
         errframe:       std_logic;
         erroverrun:     std_logic;
         txbuf:          std_logic_vector(7 downto 0);
-        rxbuf:          std_logic_vector(7 downto 0);
+        rxf_rptr:       unsigned(rx_fifo_bits downto 0);
+        rxf_wptr:       unsigned(rx_fifo_bits downto 0);
+        rxf_wen:        std_logic;
+        rxf_waddr:      unsigned(rx_fifo_bits - 1 downto 0);
+        rxf_wdata:      std_logic_vector(7 downto 0);
         tx_int_en:      std_logic;
         rx_int_en:      std_logic;
+        flowctl_en:     std_logic;
+        dbg_en:         std_logic;
+        dbg_lock:       std_logic;
         rxdeglitch:     std_logic_vector(3 downto 0);
+        ctssync:        std_logic_vector(1 downto 0);
         uart_rx:        std_logic;
         uart_tx:        std_logic;
+        uart_rts:       std_logic;
         interrupt_out:  std_logic;
         rsp_valid:      std_logic;
         rsp_rdata:      std_logic_vector(31 downto 0);
     end record;
 
     constant regs_init: regs_type := (
+        bitper          => to_unsigned(bit_period, 15),
         rxtimer         => (others => '0'),
         rxstate         => (others => '0'),
         rxshift         => (others => '0'),
@@ -97,16 +147,24 @@ architecture uart_arch of uart is
         txstate         => (others => '0'),
         txshift         => (others => '0'),
         txvalid         => '0',
-        rxvalid         => '0',
         errframe        => '0',
         erroverrun      => '0',
         txbuf           => (others => '0'),
-        rxbuf           => (others => '0'),
+        rxf_rptr        => (others => '0'),
+        rxf_wptr        => (others => '0'),
+        rxf_wen         => '0',
+        rxf_waddr       => (others => '0'),
+        rxf_wdata       => (others => '0'),
         tx_int_en       => '0',
         rx_int_en       => '0',
+        flowctl_en      => '0',
+        dbg_en          => '0',
+        dbg_lock        => '0',
         rxdeglitch      => (others => '1'),
+        ctssync         => (others => '1'),
         uart_rx         => '1',
         uart_tx         => '1',
+        uart_rts        => '1',
         interrupt_out   => '0',
         rsp_valid       => '0',
         rsp_rdata       => (others => '0'));
@@ -118,7 +176,10 @@ begin
 
     -- Drive outputs.
     uart_tx     <= r.uart_tx;
+    uart_rts_n  <= r.uart_rts;
+    uart_rts_t  <= not r.flowctl_en;
     interrupt   <= r.interrupt_out;
+    dbg_enable  <= r.dbg_en;
     slv_output  <= ( cmd_ready => '1',
                      rsp_valid => r.rsp_valid,
                      rsp_rdata => r.rsp_rdata );
@@ -126,34 +187,56 @@ begin
     -- Asynchronous process.
     process (all) is
         variable v: regs_type;
+        variable v_rx_level: unsigned(rx_fifo_bits downto 0);
     begin
         -- By default, set next registers equal to current registers.
         v := r;
+        v.rxf_wen := '0';
 
         -- Handle read transactions.
-        -- Read transactions can cause the RX buffer to become empty
+        -- Read transactions can cause the RX FIFO to become empty
         -- or error flags to become cleared. Therefore this needs to
         -- be handled before we push new data into these flags below.
         v.rsp_valid     := slv_input.cmd_valid and (not slv_input.cmd_write);
         v.rsp_rdata     := (others => '0');
         if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '0') then
-            if slv_input.cmd_addr(2) = '0' then
-                -- addr 0 = received data
-                v.rsp_rdata(7 downto 0) := r.rxbuf;
-                v.rsp_rdata(16) := r.rxvalid;
-                v.rsp_rdata(17) := r.errframe;
-                v.rsp_rdata(18) := r.erroverrun;
-                v.rxvalid   := '0';
-                v.errframe  := '0';
-                v.erroverrun := '0';
-            else
-                -- addr 4 = status register
-                v.rsp_rdata(0) := r.tx_int_en;
-                v.rsp_rdata(1) := r.rx_int_en;
-                v.rsp_rdata(8) := (not r.txvalid) and r.tx_int_en;
-                v.rsp_rdata(9) := r.rxvalid and r.rx_int_en;
-                v.rsp_rdata(15) := r.txvalid;
-            end if;
+            case slv_input.cmd_addr(3 downto 2) is
+                when "00" =>
+                    -- addr 0 = received data
+                    if r.rxf_rptr /= r.rxf_wptr then
+                        v.rsp_rdata(7 downto 0) :=
+                            rxf_mem(to_integer(r.rxf_rptr(rx_fifo_bits - 1 downto 0)));
+                        v.rsp_rdata(16) := '1';
+                        v.rxf_rptr  := r.rxf_rptr + 1;
+                    end if;
+                    v.rsp_rdata(17) := r.errframe;
+                    v.rsp_rdata(18) := r.erroverrun;
+                    v.errframe  := '0';
+                    v.erroverrun := '0';
+                when "01" =>
+                    -- addr 4 = status register
+                    v_rx_level := r.rxf_wptr - r.rxf_rptr;
+                    v.rsp_rdata(0) := r.tx_int_en;
+                    v.rsp_rdata(1) := r.rx_int_en;
+                    v.rsp_rdata(2) := r.flowctl_en;
+                    v.rsp_rdata(8) := (not r.txvalid) and r.tx_int_en;
+                    if r.rxf_rptr /= r.rxf_wptr then
+                        v.rsp_rdata(9) := r.rx_int_en;
+                    end if;
+                    v.rsp_rdata(14) := not r.ctssync(0);
+                    v.rsp_rdata(15) := r.txvalid;
+                    v.rsp_rdata(16 + rx_fifo_bits downto 16) :=
+                        std_logic_vector(v_rx_level);
+                    v.rsp_rdata(31 downto 28) :=
+                        std_logic_vector(to_unsigned(rx_fifo_bits, 4));
+                when "10" =>
+                    -- addr 8 = bit period
+                    v.rsp_rdata(14 downto 0) := std_logic_vector(r.bitper);
+                when others =>
+                    -- addr 12 = debug bridge control
+                    v.rsp_rdata(0) := r.dbg_en;
+                    v.rsp_rdata(1) := r.dbg_lock;
+            end case;
         end if;
 
         -- Capture and deglitch input signal.
@@ -164,6 +247,9 @@ begin
             v.uart_rx       := '1';
         end if;
 
+        -- Synchronize CTS input.
+        v.ctssync       := uart_cts_n & r.ctssync(1);
+
         -- UART receive channel.
         v.rxtimer       := r.rxtimer - 1;
         if r.rxstate = 0 then
@@ -172,8 +258,7 @@ begin
                 v.rxstate       := "1011";
             end if;
             -- Start capturing data 0.5 bit period after edge of start bit.
-            v.rxtimer       := to_unsigned(bit_period / 2 - 1,
-                                           v.rxtimer'length);
+            v.rxtimer       := shift_right(r.bitper, 1) - 1;
         elsif r.rxstate = 1 then
             -- Got frame error; now wait until line idle.
             if r.uart_rx = '1' then
@@ -183,7 +268,7 @@ begin
             -- Capture next bit.
             v.rxshift       := r.uart_rx & r.rxshift(7 downto 1);
             v.rxstate       := r.rxstate - 1;
-            v.rxtimer       := to_unsigned(bit_period - 1, v.rxtimer'length);
+            v.rxtimer       := r.bitper - 1;
             if r.rxstate = 11 then
                 -- Check start bit.
                 if r.uart_rx = '1' then
@@ -197,10 +282,17 @@ begin
                 -- Check stop bit.
                 if r.uart_rx = '1' then
                     -- Got valid stop bit.
-                    -- Push the received byte to the RX buffer.
-                    v.erroverrun    := v.rxvalid;
-                    v.rxvalid       := '1';
-                    v.rxbuf         := r.rxshift;
+                    -- Push the received byte to the RX FIFO,
+                    -- or discard it and flag overrun if the FIFO is full.
+                    v_rx_level      := v.rxf_wptr - v.rxf_rptr;
+                    if v_rx_level(rx_fifo_bits) = '1' then
+                        v.erroverrun    := '1';
+                    else
+                        v.rxf_wen       := '1';
+                        v.rxf_waddr     := r.rxf_wptr(rx_fifo_bits - 1 downto 0);
+                        v.rxf_wdata     := r.rxshift;
+                        v.rxf_wptr      := r.rxf_wptr + 1;
+                    end if;
                     v.rxstate       := "0000";
                 else
                     -- Got bad stop bit.
@@ -210,12 +302,21 @@ begin
             end if;
         end if;
 
+        -- Assert RTS while the RX FIFO is less than 3/4 full.
+        v_rx_level      := v.rxf_wptr - v.rxf_rptr;
+        if (r.flowctl_en = '1') and (v_rx_level < 3 * 2**(rx_fifo_bits - 2)) then
+            v.uart_rts      := '0';
+        else
+            v.uart_rts      := '1';
+        end if;
+
         -- UART transmit channel.
         v.txtimer       := r.txtimer - 1;
         if r.txstate = 0 then
-            -- Idle. Ready to start next byte.
-            v.txtimer       := to_unsigned(bit_period - 1, v.txtimer'length);
-            if r.txvalid = '1' then
+            -- Idle. Ready to start next byte, unless CTS holds us back.
+            v.txtimer       := r.bitper - 1;
+            if (r.txvalid = '1') and
+               ((r.flowctl_en = '0') or (r.ctssync(0) = '0')) then
                 v.txshift       := r.txbuf;
                 v.txvalid       := '0';
                 v.uart_tx       := '0';  -- start bit
@@ -226,12 +327,11 @@ begin
             v.uart_tx       := r.txshift(0);
             v.txshift       := "1" & r.txshift(7 downto 1);
             v.txstate       := r.txstate - 1;
-            v.txtimer       := to_unsigned(bit_period - 1, v.txtimer'length);
+            v.txtimer       := r.bitper - 1;
             if r.txstate = 2 then
                 -- Finished stop bit.
                 -- Add another 0.5 stop bit period for reliability.
-                v.txtimer       := to_unsigned(bit_period / 2 - 1,
-                                               v.txtimer'length);
+                v.txtimer       := shift_right(r.bitper, 1) - 1;
             end if;
         end if;
 
@@ -240,35 +340,37 @@ begin
         -- therefore this needs to be handled after the UART which
         -- may have emptied the TX buffer in the same cycle.
         if (slv_input.cmd_valid = '1') and (slv_input.cmd_write = '1') then
-            if slv_input.cmd_addr(2) = '0' then
-                -- addr 0 = transmit byte
-                v.txbuf         := slv_input.cmd_wdata(7 downto 0);
-                v.txvalid       := '1';
-            end if;
-            if slv_input.cmd_addr(2) = '1' then
-                -- addr 4 = interrupt control
-                v.tx_int_en     := slv_input.cmd_wdata(0);
-                v.rx_int_en     := slv_input.cmd_wdata(1);
-            end if;
+            case slv_input.cmd_addr(3 downto 2) is
+                when "00" =>
+                    -- addr 0 = transmit byte
+                    v.txbuf         := slv_input.cmd_wdata(7 downto 0);
+                    v.txvalid       := '1';
+                when "01" =>
+                    -- addr 4 = interrupt and flow control
+                    v.tx_int_en     := slv_input.cmd_wdata(0);
+                    v.rx_int_en     := slv_input.cmd_wdata(1);
+                    v.flowctl_en    := slv_input.cmd_wdata(2);
+                when "10" =>
+                    -- addr 8 = bit period
+                    if unsigned(slv_input.cmd_wdata(14 downto 0)) >= 8 then
+                        v.bitper        := unsigned(slv_input.cmd_wdata(14 downto 0));
+                    end if;
+                when others =>
+                    -- addr 12 = debug bridge control
+                    v.dbg_lock      := r.dbg_lock or slv_input.cmd_wdata(1);
+                    v.dbg_en        := slv_input.cmd_wdata(0) and (not v.dbg_lock);
+            end case;
         end if;
 
         -- Update interrupt output signal.
-        v.interrupt_out := ((not v.txvalid) and v.tx_int_en) or
-                           (v.rxvalid and v.rx_int_en);
+        v.interrupt_out := (not v.txvalid) and v.tx_int_en;
+        if v.rxf_rptr /= v.rxf_wptr then
+            v.interrupt_out := v.interrupt_out or v.rx_int_en;
+        end if;
 
         -- Synchronous reset.
         if rst = '1' then
-            v.rxstate       := (others => '0');
-            v.txstate       := (others => '0');
-            v.txvalid       := '0';
-            v.rxvalid       := '0';
-            v.errframe      := '0';
-            v.erroverrun    := '0';
-            v.tx_int_en     := '0';
-            v.rx_int_en     := '0';
-            v.uart_tx       := '1';
-            v.interrupt_out := '0';
-            v.rsp_valid     := '0';
+            v := regs_init;
         end if;
 
         -- Drive new register values to synchronous process.
@@ -284,4 +386,14 @@ begin
         end if;
     end process;
 
+    -- FIFO memory.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if rnext.rxf_wen = '1' then
+                rxf_mem(to_integer(rnext.rxf_waddr)) <= rnext.rxf_wdata;
+            end if;
+        end if;
+    end process;
+
 end architecture;
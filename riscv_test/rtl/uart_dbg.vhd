@@ -0,0 +1,494 @@
+--
+-- UART debug bridge
+--
+-- This module sits between the UART pins and the UART controller.
+-- It gives a host computer direct read/write access to the system bus
+-- via the serial port, without help from the processor. This works
+-- even when the processor is stopped or stuck in a loop.
+--
+-- In normal mode, the bridge passes the RX and TX signals unchanged
+-- between the pins and the UART controller, but it also decodes the
+-- received bytes. When it receives the escape sequence
+--   0x1b 0x00 0x44 0x42 0x47 0x00  (ESC NUL "DBG" NUL)
+-- it switches to bridge mode. The bytes of the escape sequence are also
+-- received by the UART controller.
+--
+-- In bridge mode, the RX input of the UART controller is held idle.
+-- The bridge waits until the UART controller is between two bytes, then
+-- takes over the TX pin and sends 0xa5. Bytes that the UART controller
+-- sends while the bridge is in bridge mode are lost.
+--
+-- In bridge mode, the host sends commands. Each command starts with
+-- a command byte:
+--   bits 3-0 = opcode
+--   bit 4    = '1' to keep the address fixed during a burst
+--              (for example to read a FIFO register),
+--              '0' to increment the address by 4 after each word
+--
+-- Commands (multi-byte fields are little-endian):
+--   0x00 NOP:   no parameters; response 0x80
+--   0x01 WRITE: 4-byte address, 2-byte count N, then 4*(N+1) data bytes;
+--               writes N+1 words; response 0x81 after the last write
+--   0x02 READ:  4-byte address, 2-byte count N;
+--               reads N+1 words; response 0x82 followed by 4*(N+1) data bytes
+--   0x03 EXIT:  no parameters; response 0x83, then back to normal mode
+--   others:     response 0xff
+--
+-- All transfers are 32-bit words; address bits 1-0 are ignored.
+-- The host must wait for the response before sending the next command.
+-- Read data is sent at full wire speed: the next word is read from the
+-- bus while the last byte of the current word is transmitted.
+--
+-- The bridge returns to normal mode when no byte is received and no byte
+-- is transmitted for 2**timeout_bits clock cycles.
+--
+-- The escape sequence is only recognized while the "enable" input is '1'.
+-- The enable comes from a register in the UART controller, which is
+-- cleared on reset and can be locked by software (see uart.vhd).
+-- Software enables the bridge only while the UART carries text. It must
+-- disable it before binary transfers, because binary data may contain
+-- the escape sequence. When "enable" drops while the bridge is in bridge
+-- mode, the bridge returns to normal mode as soon as no bus transaction
+-- is in progress.
+--
+-- The bridge does not authenticate the host. While it is enabled, anyone
+-- with access to the serial port can read and write the whole system bus.
+-- Software that verifies a signed program must lock the bridge before
+-- it loads the program.
+--
+-- The bridge uses a fixed baud rate (the "bit_period" generic). It does not
+-- follow changes to the baud rate of the UART controller.
+--
+-- The bridge is a bus master. It is meant to share the system bus with
+-- the processor data bus, with priority over the processor.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity uart_dbg is
+
+    generic (
+        -- Number of clock cycles per bit period.
+        bit_period:     integer range 8 to 32766;
+
+        -- Return to normal mode after 2**timeout_bits idle cycles.
+        timeout_bits:   integer range 8 to 31
+    );
+
+    port (
+        -- System clock.
+        clk:            in  std_logic;
+
+        -- Synchronous reset, active high.
+        rst:            in  std_logic;
+
+        -- Recognize the escape sequence only while "enable" is '1'.
+        enable:         in  std_logic;
+
+        -- UART pins.
+        uart_rx:        in  std_logic;
+        uart_tx:        out std_logic;
+
+        -- Signals to and from the UART controller.
+        ctl_rx:         out std_logic;
+        ctl_tx:         in  std_logic;
+
+        -- '1' while in bridge mode.
+        active:         out std_logic;
+
+        -- Bus master interface.
+        mst_output:     out bus_slv_input_type;
+        mst_input:      in  bus_slv_output_type
+    );
+
+end entity;
+
+architecture uart_dbg_arch of uart_dbg is
+
+    type byte_array is array(natural range <>) of std_logic_vector(7 downto 0);
+
+    constant esc_seq: byte_array(0 to 5) := (
+        x"1b", x"00", x"44", x"42", x"47", x"00" );
+
+    constant bitper: unsigned(14 downto 0) := to_unsigned(bit_period, 15);
+
+    -- Length of a complete byte frame from the UART controller.
+    constant frame_cycles: integer := 10 * bit_period;
+
+    type state_type is (
+        st_cmd, st_addr, st_count, st_wdata, st_wbus,
+        st_rbus, st_rdata, st_exit );
+
+    -- Internal registers.
+    type regs_type is record
+        rxdeglitch:     std_logic_vector(3 downto 0);
+        rx_line:        std_logic;
+        rxtimer:        unsigned(14 downto 0);
+        rxstate:        unsigned(3 downto 0);
+        rxshift:        std_logic_vector(7 downto 0);
+        txtimer:        unsigned(14 downto 0);
+        txstate:        unsigned(3 downto 0);
+        txshift:        std_logic_vector(7 downto 0);
+        txbuf:          std_logic_vector(7 downto 0);
+        txvalid:        std_logic;
+        tx_line:        std_logic;
+        ctl_frame:      unsigned(18 downto 0);
+        escidx:         integer range 0 to 5;
+        active:         std_logic;
+        takeover:       std_logic;
+        state:          state_type;
+        cmd:            std_logic_vector(7 downto 0);
+        bytecnt:        unsigned(1 downto 0);
+        word:           std_logic_vector(31 downto 0);
+        addr:           unsigned(29 downto 0);
+        count:          unsigned(15 downto 0);
+        mst_valid:      std_logic;
+        mst_write:      std_logic;
+        idletimer:      unsigned(timeout_bits - 1 downto 0);
+        uart_tx:        std_logic;
+    end record;
+
+    constant regs_init: regs_type := (
+        rxdeglitch      => (others => '1'),
+        rx_line         => '1',
+        rxtimer         => (others => '0'),
+        rxstate         => (others => '0'),
+        rxshift         => (others => '0'),
+        txtimer         => (others => '0'),
+        txstate         => (others => '0'),
+        txshift         => (others => '0'),
+        txbuf           => (others => '0'),
+        txvalid         => '0',
+        tx_line         => '1',
+        ctl_frame       => (others => '0'),
+        escidx          => 0,
+        active          => '0',
+        takeover        => '0',
+        state           => st_cmd,
+        cmd             => (others => '0'),
+        bytecnt         => (others => '0'),
+        word            => (others => '0'),
+        addr            => (others => '0'),
+        count           => (others => '0'),
+        mst_valid       => '0',
+        mst_write       => '0',
+        idletimer       => (others => '1'),
+        uart_tx         => '1');
+
+    signal r: regs_type := regs_init;
+    signal rnext: regs_type;
+
+begin
+
+    -- Drive outputs.
+    uart_tx     <= r.uart_tx;
+    ctl_rx      <= uart_rx when r.active = '0' else '1';
+    active      <= r.active;
+    mst_output  <= ( cmd_valid => r.mst_valid,
+                     cmd_addr  => std_logic_vector(r.addr) & "00",
+                     cmd_write => r.mst_write,
+                     cmd_wdata => r.word,
+                     cmd_wmask => "1111" );
+
+    -- Asynchronous process.
+    process (all) is
+        variable v: regs_type;
+        variable v_rx_valid: std_logic;
+        variable v_rx_byte:  std_logic_vector(7 downto 0);
+        variable v_next_word: std_logic;
+    begin
+        -- By default, set next registers equal to current registers.
+        v := r;
+        v_rx_valid  := '0';
+        v_rx_byte   := r.rxshift;
+        v_next_word := '0';
+
+        -- Capture and deglitch input signal.
+        v.rxdeglitch    := uart_rx & r.rxdeglitch(3 downto 1);
+        if r.rxdeglitch = "0000" then
+            v.rx_line       := '0';
+        elsif r.rxdeglitch = "1111" then
+            v.rx_line       := '1';
+        end if;
+
+        -- UART receive channel.
+        v.rxtimer       := r.rxtimer - 1;
+        if r.rxstate = 0 then
+            -- Idle. Wait for next start bit.
+            if r.rx_line = '0' then
+                v.rxstate       := "1011";
+            end if;
+            -- Start capturing data 0.5 bit period after edge of start bit.
+            v.rxtimer       := shift_right(bitper, 1) - 1;
+        elsif r.rxstate = 1 then
+            -- Got frame error; now wait until line idle.
+            if r.rx_line = '1' then
+                v.rxstate       := "0000";
+            end if;
+        elsif r.rxtimer = 0 then
+            -- Capture next bit.
+            v.rxshift       := r.rx_line & r.rxshift(7 downto 1);
+            v.rxstate       := r.rxstate - 1;
+            v.rxtimer       := bitper - 1;
+            if (r.rxstate = 11) and (r.rx_line = '1') then
+                -- Bad start bit.
+                v.rxstate       := "0000";
+            end if;
+            if r.rxstate = 2 then
+                -- Check stop bit; discard the byte if it is bad.
+                v_rx_valid      := r.rx_line;
+                if r.rx_line = '1' then
+                    v.rxstate       := "0000";
+                end if;
+            end if;
+        end if;
+
+        -- Keep track of byte frames sent by the UART controller.
+        -- The bridge only takes over the TX pin between two frames.
+        if r.ctl_frame /= 0 then
+            v.ctl_frame     := r.ctl_frame - 1;
+        elsif ctl_tx = '0' then
+            v.ctl_frame     := to_unsigned(frame_cycles - 1, 19);
+        end if;
+
+        if r.active = '0' then
+
+            -- Normal mode. Look for the escape sequence.
+            v.state         := st_cmd;
+            v.txvalid       := '0';
+
+            -- Release the TX pin between two frames.
+            if (r.ctl_frame = 0) and (ctl_tx = '1') and (r.txstate = 0) then
+                v.takeover      := '0';
+            end if;
+
+            v.idletimer     := (others => '1');
+            if enable = '0' then
+                v.escidx        := 0;
+            elsif v_rx_valid = '1' then
+                if v_rx_byte = esc_seq(r.escidx) then
+                    if r.escidx = esc_seq'high then
+                        -- Switch to bridge mode.
+                        v.active        := '1';
+                        v.escidx        := 0;
+                        v.txbuf         := x"a5";
+                        v.txvalid       := '1';
+                    else
+                        v.escidx        := r.escidx + 1;
+                    end if;
+                elsif v_rx_byte = esc_seq(0) then
+                    v.escidx        := 1;
+                else
+                    v.escidx        := 0;
+                end if;
+            end if;
+
+        else
+
+            -- Bridge mode.
+
+            -- Take over the TX pin between two frames.
+            if (r.ctl_frame = 0) and (ctl_tx = '1') then
+                v.takeover      := '1';
+            end if;
+
+            case r.state is
+
+                when st_cmd =>
+                    -- Wait for command byte.
+                    v.bytecnt       := "00";
+                    if v_rx_valid = '1' then
+                        v.cmd           := v_rx_byte;
+                        case v_rx_byte(3 downto 0) is
+                            when x"0" =>
+                                v.txbuf         := x"80";
+                                v.txvalid       := '1';
+                            when x"1" | x"2" =>
+                                v.state         := st_addr;
+                            when x"3" =>
+                                v.txbuf         := x"83";
+                                v.txvalid       := '1';
+                                v.state         := st_exit;
+                            when others =>
+                                v.txbuf         := x"ff";
+                                v.txvalid       := '1';
+                        end case;
+                    end if;
+
+                when st_addr =>
+                    -- Receive 4 address bytes.
+                    if v_rx_valid = '1' then
+                        v.word          := v_rx_byte & r.word(31 downto 8);
+                        v.bytecnt       := r.bytecnt + 1;
+                        if r.bytecnt = 3 then
+                            v.addr          := unsigned(v.word(31 downto 2));
+                            v.state         := st_count;
+                        end if;
+                    end if;
+
+                when st_count =>
+                    -- Receive 2 count bytes.
+                    if v_rx_valid = '1' then
+                        v.count         := unsigned(v_rx_byte) & r.count(15 downto 8);
+                        v.bytecnt       := r.bytecnt + 1;
+                        if r.bytecnt = 1 then
+                            v.bytecnt       := "00";
+                            if r.cmd(1) = '1' then
+                                -- Send response header and start the first read.
+                                v.txbuf         := x"82";
+                                v.txvalid       := '1';
+                                v.mst_valid     := '1';
+                                v.mst_write     := '0';
+                                v.state         := st_rbus;
+                            else
+                                v.state         := st_wdata;
+                            end if;
+                        end if;
+                    end if;
+
+                when st_wdata =>
+                    -- Receive 4 data bytes, then write them to the bus.
+                    if v_rx_valid = '1' then
+                        v.word          := v_rx_byte & r.word(31 downto 8);
+                        v.bytecnt       := r.bytecnt + 1;
+                        if r.bytecnt = 3 then
+                            v.mst_valid     := '1';
+                            v.mst_write     := '1';
+                            v.state         := st_wbus;
+                        end if;
+                    end if;
+
+                when st_wbus =>
+                    -- Wait until the write is accepted.
+                    if mst_input.cmd_ready = '1' then
+                        v.mst_valid     := '0';
+                        v_next_word     := '1';
+                        if r.count = 0 then
+                            v.txbuf         := x"81";
+                            v.txvalid       := '1';
+                            v.state         := st_cmd;
+                        else
+                            v.state         := st_wdata;
+                        end if;
+                    end if;
+
+                when st_rbus =>
+                    -- Wait for the read response.
+                    if mst_input.cmd_ready = '1' then
+                        v.mst_valid     := '0';
+                    end if;
+                    if mst_input.rsp_valid = '1' then
+                        v.word          := mst_input.rsp_rdata;
+                        v.state         := st_rdata;
+                    end if;
+
+                when st_rdata =>
+                    -- Send 4 data bytes.
+                    if r.txvalid = '0' then
+                        v.txbuf         := r.word(7 downto 0);
+                        v.txvalid       := '1';
+                        v.word          := x"00" & r.word(31 downto 8);
+                        v.bytecnt       := r.bytecnt + 1;
+                        if r.bytecnt = 3 then
+                            -- Last byte of this word is queued.
+                            -- Start reading the next word.
+                            v_next_word     := '1';
+                            if r.count = 0 then
+                                v.state         := st_cmd;
+                            else
+                                v.mst_valid     := '1';
+                                v.mst_write     := '0';
+                                v.state         := st_rbus;
+                            end if;
+                        end if;
+                    end if;
+
+                when st_exit =>
+                    -- Return to normal mode after sending the response.
+                    if (r.txvalid = '0') and (r.txstate = 0) then
+                        v.active        := '0';
+                    end if;
+
+            end case;
+
+            -- Advance to the next word of a burst.
+            if v_next_word = '1' then
+                if r.cmd(4) = '0' then
+                    v.addr          := r.addr + 1;
+                end if;
+                v.count         := r.count - 1;
+            end if;
+
+            -- Return to normal mode when idle for too long.
+            v.idletimer     := r.idletimer - 1;
+            if (v_rx_valid = '1') or (r.txvalid = '1') or (r.txstate /= 0) then
+                v.idletimer     := (others => '1');
+            elsif r.idletimer = 0 then
+                v.active        := '0';
+                v.mst_valid     := '0';
+            end if;
+
+            -- Return to normal mode when disabled by software,
+            -- but not in the middle of a bus transaction.
+            if (enable = '0') and (r.mst_valid = '0') and (r.state /= st_rbus) then
+                v.active        := '0';
+            end if;
+
+        end if;
+
+        -- UART transmit channel, only used while the TX pin is taken over.
+        v.txtimer       := r.txtimer - 1;
+        if r.txstate = 0 then
+            -- Idle. Ready to start next byte.
+            v.txtimer       := bitper - 1;
+            if (r.txvalid = '1') and (r.takeover = '1') then
+                v.txshift       := r.txbuf;
+                v.txvalid       := '0';
+                v.tx_line       := '0';  -- start bit
+                v.txstate       := "1011";
+            end if;
+        elsif r.txtimer = 0 then
+            -- Shift out next bit.
+            v.tx_line       := r.txshift(0);
+            v.txshift       := "1" & r.txshift(7 downto 1);
+            v.txstate       := r.txstate - 1;
+            v.txtimer       := bitper - 1;
+            if r.txstate = 2 then
+                -- Finished stop bit.
+                -- Add another 0.5 stop bit period for reliability.
+                v.txtimer       := shift_right(bitper, 1) - 1;
+            end if;
+        end if;
+
+        -- Select the TX pin source.
+        if r.takeover = '1' then
+            v.uart_tx       := r.tx_line;
+        else
+            v.uart_tx       := ctl_tx;
+        end if;
+
+        -- Synchronous reset.
+        if rst = '1' then
+            v := regs_init;
+        end if;
+
+        -- Drive new register values to synchronous process.
+        rnext <= v;
+
+    end process;
+
+    -- Synchronous process.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= rnext;
+        end if;
+    end process;
+
+end architecture;
@@ -0,0 +1,330 @@
+--
+-- Test bench for the accelerator socket with the CRC-32 example kernel.
+--
+-- The test bench connects the socket to a RAM model. Port A of the RAM
+-- is shared between the DMA and a load generator that models CPU data
+-- accesses, with the same priority rule as in the top-level design.
+--
+-- The simulated CPU only writes the job registers and then waits for
+-- the interrupt. The test runs these jobs:
+--   - CRC of "12345678" (known result 0x9ae0daaf);
+--   - copy and CRC of 2048 words with the CPU idle;
+--   - CRC only of 2048 words;
+--   - copy and CRC of 2048 words while the CPU uses 50% of RAM cycles;
+--   - copy into a destination buffer that is too small (overflow).
+-- It checks the destination buffer after each job and reports the
+-- number of clock cycles per job.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity tb_accel_socket is
+end entity;
+
+architecture sim of tb_accel_socket is
+
+    constant clk_period:    time := 10 ns;
+    constant num_words:     integer := 2048;
+
+    -- Word addresses of the test buffers in the RAM model.
+    constant src_base:      integer := 16#0100#;
+    constant dst_base:      integer := 16#1000#;
+
+    type ram_type is array(0 to 8191) of std_logic_vector(31 downto 0);
+
+    signal clk:             std_logic := '0';
+    signal rst:             std_logic := '1';
+    signal interrupt:       std_logic;
+    signal slv_input:       bus_slv_input_type := (
+                                cmd_valid => '0',
+                                cmd_addr  => (others => '0'),
+                                cmd_write => '0',
+                                cmd_wdata => (others => '0'),
+                                cmd_wmask => "1111" );
+    signal slv_output:      bus_slv_output_type;
+    signal dma_output:      bus_slv_input_type;
+    signal dma_input:       bus_slv_output_type;
+
+    signal krn_rst:         std_logic;
+    signal krn_param:       std_logic_vector(31 downto 0);
+    signal krn_in_valid:    std_logic;
+    signal krn_in_ready:    std_logic;
+    signal krn_in_data:     std_logic_vector(31 downto 0);
+    signal krn_in_last:     std_logic;
+    signal krn_out_valid:   std_logic;
+    signal krn_out_ready:   std_logic;
+    signal krn_out_data:    std_logic_vector(31 downto 0);
+    signal krn_out_last:    std_logic;
+
+    -- RAM contents, written by the DMA and by the simulated CPU.
+    signal ram:             ram_type := (others => (others => '0'));
+    signal tb_ram_wen:      std_logic := '0';
+    signal tb_ram_addr:     integer range 0 to 8191 := 0;
+    signal tb_ram_wdata:    std_logic_vector(31 downto 0) := (others => '0');
+
+    -- RAM accesses by the load generator.
+    signal cpu_load:        boolean := false;
+    signal cpu_ram_valid:   std_logic := '0';
+    signal dma_grant:       std_logic;
+    signal dma_rsp_valid:   std_logic := '0';
+    signal dma_rsp_rdata:   std_logic_vector(31 downto 0) := (others => '0');
+
+    signal sim_done:        boolean := false;
+
+    -- Reference CRC-32, computed byte by byte.
+    function crc32_ref(crc_in: std_logic_vector(31 downto 0);
+                       word: std_logic_vector(31 downto 0))
+        return std_logic_vector
+    is
+        variable crc: std_logic_vector(31 downto 0);
+    begin
+        crc := crc_in;
+        for b in 0 to 3 loop
+            crc(7 downto 0) := crc(7 downto 0) xor word(8*b+7 downto 8*b);
+            for k in 0 to 7 loop
+                if crc(0) = '1' then
+                    crc := ('0' & crc(31 downto 1)) xor x"edb88320";
+                else
+                    crc := '0' & crc(31 downto 1);
+                end if;
+            end loop;
+        end loop;
+        return crc;
+    end function;
+
+begin
+
+    -- Generate clock.
+    clk <= (not clk) after clk_period / 2 when not sim_done else '0';
+
+    -- Instantiate accelerator socket.
+    inst_socket: entity work.accel_socket
+        generic map (
+            fifo_bits       => 5 )
+        port map (
+            clk             => clk,
+            rst             => rst,
+            interrupt       => interrupt,
+            slv_input       => slv_input,
+            slv_output      => slv_output,
+            dma_output      => dma_output,
+            dma_input       => dma_input,
+            krn_rst         => krn_rst,
+            krn_param       => krn_param,
+            krn_in_valid    => krn_in_valid,
+            krn_in_ready    => krn_in_ready,
+            krn_in_data     => krn_in_data,
+            krn_in_last     => krn_in_last,
+            krn_out_valid   => krn_out_valid,
+            krn_out_ready   => krn_out_ready,
+            krn_out_data    => krn_out_data,
+            krn_out_last    => krn_out_last );
+
+    -- Instantiate example kernel.
+    inst_kernel: entity work.accel_crc32
+        port map (
+            clk             => clk,
+            rst             => krn_rst,
+            param           => krn_param,
+            in_valid        => krn_in_valid,
+            in_ready        => krn_in_ready,
+            in_data         => krn_in_data,
+            in_last         => krn_in_last,
+            out_valid       => krn_out_valid,
+            out_ready       => krn_out_ready,
+            out_data        => krn_out_data,
+            out_last        => krn_out_last );
+
+    -- CPU data accesses have priority over DMA.
+    dma_grant <= not cpu_ram_valid;
+    dma_input <= ( cmd_ready => dma_grant,
+                   rsp_valid => dma_rsp_valid,
+                   rsp_rdata => dma_rsp_rdata );
+
+    -- RAM port A model.
+    process (clk) is
+        variable v_addr: integer;
+    begin
+        if rising_edge(clk) then
+            dma_rsp_valid <= '0';
+            if (dma_output.cmd_valid = '1') and (dma_grant = '1') then
+                v_addr := to_integer(unsigned(dma_output.cmd_addr(14 downto 2)));
+                if dma_output.cmd_write = '1' then
+                    ram(v_addr) <= dma_output.cmd_wdata;
+                else
+                    dma_rsp_valid <= '1';
+                    dma_rsp_rdata <= ram(v_addr);
+                end if;
+            end if;
+            if tb_ram_wen = '1' then
+                ram(tb_ram_addr) <= tb_ram_wdata;
+            end if;
+        end if;
+    end process;
+
+    -- Load generator: occupy every other RAM cycle when enabled.
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            if cpu_load then
+                cpu_ram_valid <= not cpu_ram_valid;
+            else
+                cpu_ram_valid <= '0';
+            end if;
+        end if;
+    end process;
+
+    -- Simulated CPU.
+    process is
+
+        procedure bus_write(addr: in integer; data: in std_logic_vector(31 downto 0)) is
+        begin
+            slv_input.cmd_valid <= '1';
+            slv_input.cmd_write <= '1';
+            slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            slv_input.cmd_wdata <= data;
+            wait until rising_edge(clk);
+            slv_input.cmd_valid <= '0';
+            slv_input.cmd_write <= '0';
+        end procedure;
+
+        procedure bus_read(addr: in integer; data: out std_logic_vector(31 downto 0)) is
+        begin
+            slv_input.cmd_valid <= '1';
+            slv_input.cmd_write <= '0';
+            slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            wait until rising_edge(clk);
+            slv_input.cmd_valid <= '0';
+            wait until rising_edge(clk);
+            assert slv_output.rsp_valid = '1' report "no bus response" severity failure;
+            data := slv_output.rsp_rdata;
+        end procedure;
+
+        procedure ram_write(addr: in integer; data: in std_logic_vector(31 downto 0)) is
+        begin
+            tb_ram_wen   <= '1';
+            tb_ram_addr  <= addr;
+            tb_ram_wdata <= data;
+            wait until rising_edge(clk);
+            tb_ram_wen   <= '0';
+        end procedure;
+
+        -- Run a job and wait for the interrupt.
+        procedure run_job(name: in string;
+                          src_words: in integer;
+                          dst_words: in integer;
+                          param: in std_logic_vector(31 downto 0);
+                          status: out std_logic_vector(31 downto 0);
+                          out_words: out integer) is
+            variable v_data: std_logic_vector(31 downto 0);
+        begin
+            for i in 0 to dst_words loop
+                ram_write(dst_base + i, x"00000000");
+            end loop;
+            bus_write(16#04#, std_logic_vector(to_unsigned(4 * src_base, 32)));
+            bus_write(16#08#, std_logic_vector(to_unsigned(4 * src_words, 32)));
+            bus_write(16#0c#, std_logic_vector(to_unsigned(4 * dst_base, 32)));
+            bus_write(16#10#, std_logic_vector(to_unsigned(4 * dst_words, 32)));
+            bus_write(16#18#, param);
+            bus_write(16#00#, x"00000001");
+            wait until interrupt = '1';
+            wait until rising_edge(clk);
+            bus_read(16#00#, status);
+            bus_write(16#00#, x"00000004");
+            bus_read(16#14#, v_data);
+            out_words := to_integer(unsigned(v_data)) / 4;
+            bus_read(16#20#, v_data);
+            report name & ": " & integer'image(src_words) & " words in "
+                   & integer'image(to_integer(unsigned(v_data))) & " cycles";
+        end procedure;
+
+        variable v_data:    std_logic_vector(31 downto 0);
+        variable v_status:  std_logic_vector(31 downto 0);
+        variable v_count:   integer;
+        variable v_crc:     std_logic_vector(31 downto 0);
+        variable v_x:       unsigned(31 downto 0);
+
+    begin
+
+        -- Reset.
+        wait until rising_edge(clk);
+        wait until rising_edge(clk);
+        rst <= '0';
+        wait until rising_edge(clk);
+
+        bus_read(16#00#, v_data);
+        assert v_data(31 downto 16) = x"4143"
+            report "wrong identification" severity failure;
+        bus_write(16#1c#, x"00000001");
+
+        -- Known CRC.
+        ram_write(src_base,     x"34333231");   -- "1234"
+        ram_write(src_base + 1, x"38373635");   -- "5678"
+        run_job("CRC of 12345678", 2, 4, x"00000001", v_status, v_count);
+        assert (v_status(2 downto 0) = "010") and (v_count = 1) and
+               (ram(dst_base) = x"9ae0daaf")
+            report "wrong CRC of 12345678" severity failure;
+
+        -- Fill the source buffer with a pseudo-random pattern.
+        v_x := to_unsigned(1, 32);
+        v_crc := (others => '1');
+        for i in 0 to num_words - 1 loop
+            v_x := resize(v_x * to_unsigned(1664525, 32), 32)
+                   + to_unsigned(1013904223, 32);
+            ram_write(src_base + i, std_logic_vector(v_x));
+            v_crc := crc32_ref(v_crc, std_logic_vector(v_x));
+        end loop;
+        v_crc := not v_crc;
+
+        -- Copy and CRC, CPU idle.
+        run_job("copy and CRC, CPU idle", num_words, num_words + 1,
+                x"00000000", v_status, v_count);
+        assert (v_status(2 downto 0) = "010") and (v_count = num_words + 1)
+            report "copy job failed" severity failure;
+        for i in 0 to num_words - 1 loop
+            assert ram(dst_base + i) = ram(src_base + i)
+                report "wrong copy at word " & integer'image(i) severity failure;
+        end loop;
+        assert ram(dst_base + num_words) = v_crc
+            report "wrong CRC after copy" severity failure;
+
+        -- CRC only.
+        run_job("CRC only, CPU idle", num_words, 1,
+                x"00000001", v_status, v_count);
+        assert (v_status(2 downto 0) = "010") and (v_count = 1) and
+               (ram(dst_base) = v_crc)
+            report "CRC job failed" severity failure;
+
+        -- Copy and CRC while the CPU uses half of the RAM cycles.
+        cpu_load <= true;
+        run_job("copy and CRC, CPU load 50%", num_words, num_words + 1,
+                x"00000000", v_status, v_count);
+        cpu_load <= false;
+        assert (v_status(2 downto 0) = "010") and (v_count = num_words + 1)
+            report "copy job under load failed" severity failure;
+        for i in 0 to num_words - 1 loop
+            assert ram(dst_base + i) = ram(src_base + i)
+                report "wrong copy under load at word " & integer'image(i)
+                severity failure;
+        end loop;
+        assert ram(dst_base + num_words) = v_crc
+            report "wrong CRC after copy under load" severity failure;
+
+        -- Destination buffer too small.
+        run_job("overflow", num_words, 100, x"00000000", v_status, v_count);
+        assert (v_status(2 downto 0) = "110") and (v_count = 100) and
+               (ram(dst_base + 100) = x"00000000")
+            report "overflow job failed" severity failure;
+
+        report "PASS";
+        sim_done <= true;
+        wait;
+    end process;
+
+end architecture;
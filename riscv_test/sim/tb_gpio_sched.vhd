@@ -0,0 +1,323 @@
+--
+-- Test bench for the GPIO event scheduler.
+--
+-- The test bench connects a GPIO controller with event scheduler to
+-- the MTIME output of a timer peripheral. A monitor records every change
+-- of the GPIO outputs together with the MTIME value at which it happened.
+-- The event queue holds 4 events.
+--
+-- The test checks that:
+--   - each event changes exactly the masked outputs, on the clock edge
+--     at which MTIME advances from the event time to the next count;
+--   - events one cycle apart are applied in consecutive cycles;
+--   - an event with a time in the past is applied at once and sets
+--     the LATE flag;
+--   - a write to a full queue sets the OVERFLOW flag and is dropped,
+--     and a flushed queue changes no outputs;
+--   - a sequence of 40 events, much longer than the queue, plays out
+--     with exact timing while the queue is refilled on the interrupt.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity tb_gpio_sched is
+end entity;
+
+architecture sim of tb_gpio_sched is
+
+    constant clk_period:    time := 10 ns;
+    constant sched_bits:    integer := 2;
+
+    -- Sequence played with interrupt-driven refill.
+    constant seq_length:    integer := 40;
+    constant seq_interval:  integer := 25;
+
+    type time_array is array(natural range <>) of unsigned(63 downto 0);
+    type word_array is array(natural range <>) of std_logic_vector(31 downto 0);
+
+    signal clk:             std_logic := '0';
+    signal rst:             std_logic := '1';
+
+    signal mtime:           std_logic_vector(63 downto 0);
+    signal timer_interrupt: std_logic;
+    signal timer_soft_int:  std_logic;
+    signal timer_slv_input: bus_slv_input_type := (
+                                cmd_valid => '0',
+                                cmd_addr  => (others => '0'),
+                                cmd_write => '0',
+                                cmd_wdata => (others => '0'),
+                                cmd_wmask => "1111" );
+    signal timer_slv_output: bus_slv_output_type;
+
+    signal gpio_interrupt:  std_logic;
+    signal gpio_o:          std_logic_vector(31 downto 0);
+    signal gpio_t:          std_logic_vector(31 downto 0);
+    signal gpio_slv_input:  bus_slv_input_type := (
+                                cmd_valid => '0',
+                                cmd_addr  => (others => '0'),
+                                cmd_write => '0',
+                                cmd_wdata => (others => '0'),
+                                cmd_wmask => "1111" );
+    signal gpio_slv_output: bus_slv_output_type;
+
+    -- Output changes seen by the monitor.
+    signal log_time:        time_array(0 to 255);
+    signal log_value:       word_array(0 to 255);
+    signal log_count:       integer := 0;
+
+    signal sim_done:        boolean := false;
+
+begin
+
+    -- Generate clock.
+    clk <= (not clk) after clk_period / 2 when not sim_done else '0';
+
+    -- Instantiate timer.
+    inst_timer: entity work.timer
+        port map (
+            clk             => clk,
+            rst             => rst,
+            interrupt       => timer_interrupt,
+            soft_interrupt  => timer_soft_int,
+            mtime           => mtime,
+            slv_input       => timer_slv_input,
+            slv_output      => timer_slv_output );
+
+    -- Instantiate GPIO controller with event scheduler.
+    inst_gpio: entity work.gpio
+        generic map (
+            sched_enable    => true,
+            sched_bits      => sched_bits )
+        port map (
+            clk             => clk,
+            rst             => rst,
+            mtime           => mtime,
+            interrupt       => gpio_interrupt,
+            gpio_i          => gpio_o,
+            gpio_o          => gpio_o,
+            gpio_t          => gpio_t,
+            slv_input       => gpio_slv_input,
+            slv_output      => gpio_slv_output );
+
+    -- Monitor output changes.
+    -- At a rising edge, "gpio_o" and "mtime" still show the values
+    -- registered at the previous edge. An event for time T takes effect
+    -- together with MTIME advancing to T + 1, so the event time is
+    -- recorded as (mtime - 1).
+    process (clk) is
+        variable v_prev: std_logic_vector(31 downto 0) := (others => '0');
+    begin
+        if rising_edge(clk) then
+            if gpio_o /= v_prev then
+                log_time(log_count)  <= unsigned(mtime) - 1;
+                log_value(log_count) <= gpio_o;
+                log_count <= log_count + 1;
+            end if;
+            v_prev := gpio_o;
+        end if;
+    end process;
+
+    -- Simulated CPU.
+    process is
+
+        procedure gpio_write(addr: in integer; data: in std_logic_vector(31 downto 0)) is
+        begin
+            gpio_slv_input.cmd_valid <= '1';
+            gpio_slv_input.cmd_write <= '1';
+            gpio_slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            gpio_slv_input.cmd_wdata <= data;
+            wait until rising_edge(clk);
+            gpio_slv_input.cmd_valid <= '0';
+            gpio_slv_input.cmd_write <= '0';
+        end procedure;
+
+        procedure gpio_read(addr: in integer; data: out std_logic_vector(31 downto 0)) is
+        begin
+            gpio_slv_input.cmd_valid <= '1';
+            gpio_slv_input.cmd_write <= '0';
+            gpio_slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            wait until rising_edge(clk);
+            gpio_slv_input.cmd_valid <= '0';
+            wait until rising_edge(clk);
+            assert gpio_slv_output.rsp_valid = '1' report "no bus response" severity failure;
+            data := gpio_slv_output.rsp_rdata;
+        end procedure;
+
+        -- Read the low word of MTIME (the high word stays 0 in this test).
+        procedure read_mtime(t: out unsigned(63 downto 0)) is
+        begin
+            timer_slv_input.cmd_valid <= '1';
+            timer_slv_input.cmd_write <= '0';
+            timer_slv_input.cmd_addr  <= (others => '0');
+            wait until rising_edge(clk);
+            timer_slv_input.cmd_valid <= '0';
+            wait until rising_edge(clk);
+            assert timer_slv_output.rsp_valid = '1' report "no timer response" severity failure;
+            t := resize(unsigned(timer_slv_output.rsp_rdata), 64);
+        end procedure;
+
+        procedure queue_event(t: in unsigned(63 downto 0);
+                              mask: in std_logic_vector(31 downto 0);
+                              value: in std_logic_vector(31 downto 0)) is
+        begin
+            gpio_write(16#18#, std_logic_vector(t(31 downto 0)));
+            gpio_write(16#1c#, std_logic_vector(t(63 downto 32)));
+            gpio_write(16#20#, mask);
+            gpio_write(16#24#, value);
+        end procedure;
+
+        -- Wait until the monitor has recorded "n" output changes.
+        procedure wait_log(n: in integer; max_cycles: in integer) is
+        begin
+            if log_count < n then
+                wait until log_count >= n for max_cycles * clk_period;
+            end if;
+            assert log_count >= n
+                report "expected output change did not happen" severity failure;
+        end procedure;
+
+        -- Check a recorded output change.
+        procedure check_log(idx: in integer;
+                            t: in unsigned(63 downto 0);
+                            value: in std_logic_vector(31 downto 0)) is
+        begin
+            assert log_value(idx) = value
+                report "wrong output value at change " & integer'image(idx)
+                severity failure;
+            assert log_time(idx) = t
+                report "output change " & integer'image(idx) & " at MTIME "
+                       & integer'image(to_integer(log_time(idx)(30 downto 0)))
+                       & ", expected "
+                       & integer'image(to_integer(t(30 downto 0)))
+                severity failure;
+        end procedure;
+
+        variable v_data:    std_logic_vector(31 downto 0);
+        variable v_now:     unsigned(63 downto 0);
+        variable v_t0:      unsigned(63 downto 0);
+        variable v_base:    integer;
+        variable v_queued:  integer;
+        variable v_free:    integer;
+        variable v_value:   std_logic_vector(31 downto 0);
+
+    begin
+
+        -- Reset.
+        wait until rising_edge(clk);
+        wait until rising_edge(clk);
+        rst <= '0';
+        wait until rising_edge(clk);
+
+        -- Check queue capacity.
+        gpio_read(16#10#, v_data);
+        assert v_data = x"00000400"
+            report "wrong scheduler status after reset" severity failure;
+        gpio_write(16#08#, x"ffffffff");
+
+        -- Exact timing, including events in consecutive cycles.
+        v_base := log_count;
+        read_mtime(v_now);
+        v_t0 := v_now + 100;
+        queue_event(v_t0,     x"00000001", x"00000001");
+        queue_event(v_t0 + 1, x"00000002", x"ffffffff");
+        queue_event(v_t0 + 7, x"00000003", x"00000000");
+        wait_log(v_base + 3, 200);
+        check_log(v_base,     v_t0,     x"00000001");
+        check_log(v_base + 1, v_t0 + 1, x"00000003");
+        check_log(v_base + 2, v_t0 + 7, x"00000000");
+        gpio_read(16#10#, v_data);
+        assert v_data(17 downto 16) = "00" and v_data(7 downto 0) = x"00"
+            report "unexpected scheduler status after exact events"
+            severity failure;
+        report "exact timing: OK";
+
+        -- Late event.
+        v_base := log_count;
+        read_mtime(v_now);
+        queue_event(v_now - 10, x"00000010", x"00000010");
+        wait_log(v_base + 1, 10);
+        assert log_value(v_base) = x"00000010"
+            report "wrong output value after late event" severity failure;
+        gpio_read(16#10#, v_data);
+        assert v_data(16) = '1'
+            report "LATE flag not set" severity failure;
+        gpio_write(16#10#, x"00010000");
+        gpio_read(16#10#, v_data);
+        assert v_data(16) = '0'
+            report "LATE flag not cleared" severity failure;
+        report "late event: OK";
+
+        -- Overflow and flush.
+        v_base := log_count;
+        read_mtime(v_now);
+        for i in 0 to 4 loop
+            queue_event(v_now + 500 + i, x"00000100", x"00000100");
+        end loop;
+        gpio_read(16#10#, v_data);
+        assert v_data(17) = '1' and v_data(7 downto 0) = x"04"
+            report "OVERFLOW flag not set" severity failure;
+        gpio_write(16#10#, x"80020000");
+        gpio_read(16#10#, v_data);
+        assert v_data(17) = '0' and v_data(7 downto 0) = x"00"
+            report "queue not flushed" severity failure;
+        for i in 0 to 599 loop
+            wait until rising_edge(clk);
+        end loop;
+        assert log_count = v_base
+            report "flushed event changed outputs" severity failure;
+        report "overflow and flush: OK";
+
+        -- Long sequence, refilled on the interrupt.
+        -- Mask and high time word are written once, like the driver does.
+        v_base := log_count;
+        gpio_write(16#20#, x"00001000");
+        gpio_write(16#1c#, x"00000000");
+        gpio_write(16#14#, x"80000001");
+        read_mtime(v_now);
+        v_t0 := v_now + 50;
+        v_queued := 0;
+        v_value := (others => '0');
+        while v_queued < seq_length loop
+            if gpio_interrupt /= '1' then
+                wait until gpio_interrupt = '1' for 1000 * clk_period;
+                assert gpio_interrupt = '1'
+                    report "no refill interrupt" severity failure;
+            end if;
+            gpio_read(16#10#, v_data);
+            v_free := 2**sched_bits - to_integer(unsigned(v_data(7 downto 0)));
+            for i in 1 to v_free loop
+                if v_queued < seq_length then
+                    v_value := not v_value;
+                    gpio_write(16#18#, std_logic_vector(
+                        resize(v_t0 + v_queued * seq_interval, 32)));
+                    gpio_write(16#24#, v_value);
+                    v_queued := v_queued + 1;
+                end if;
+            end loop;
+        end loop;
+        wait_log(v_base + seq_length, (2**sched_bits + 1) * seq_interval);
+        v_value := (others => '0');
+        for i in 0 to seq_length - 1 loop
+            v_value(12) := not v_value(12);
+            check_log(v_base + i, v_t0 + i * seq_interval,
+                      log_value(v_base - 1)(31 downto 13) & v_value(12) &
+                      log_value(v_base - 1)(11 downto 0));
+        end loop;
+        gpio_read(16#10#, v_data);
+        assert v_data(17 downto 16) = "00"
+            report "LATE or OVERFLOW during refilled sequence" severity failure;
+        gpio_write(16#14#, x"00000000");
+        report "refilled sequence: OK";
+
+        report "PASS";
+        sim_done <= true;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,481 @@
+--
+-- Test bench for the UART debug bridge.
+--
+-- The bridge sits between a simulated host and a UART controller, and
+-- masters a RAM model with random wait states. The UART runs at
+-- 16 clock cycles per bit.
+--
+-- The test checks that:
+--   - bytes pass through to the UART controller in normal mode;
+--   - the escape sequence is ignored until software enables the bridge
+--     through the UART controller;
+--   - the escape sequence switches to bridge mode while the UART
+--     controller transmits continuously, and the host receives only
+--     complete frames (no frame errors when the TX pin changes owner);
+--   - write bursts, read bursts and fixed-address bursts access the
+--     right words;
+--   - read data arrives back-to-back at full wire speed;
+--   - the UART controller receives nothing while in bridge mode;
+--   - EXIT and the idle timeout both return to normal mode;
+--   - disabling the bridge returns to normal mode, and a locked bridge
+--     can not be enabled again.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity tb_uart_dbg is
+end entity;
+
+architecture sim of tb_uart_dbg is
+
+    constant clk_period:    time := 10 ns;
+    constant bit_period:    integer := 16;
+    constant bit_time:      time := bit_period * clk_period;
+    constant byte_time:     time := 10 * bit_time;
+    constant timeout_bits:  integer := 12;
+
+    -- Bytes sent by the bridge have 1.5 stop bits, followed by
+    -- one idle clock cycle before the next start bit.
+    constant frame_time:    time := 21 * bit_time / 2 + clk_period;
+
+    type byte_array is array(natural range <>) of std_logic_vector(7 downto 0);
+    type time_array is array(natural range <>) of time;
+    type mem_type is array(0 to 255) of std_logic_vector(31 downto 0);
+
+    constant esc_seq: byte_array(0 to 5) := (
+        x"1b", x"00", x"44", x"42", x"47", x"00" );
+
+    signal clk:             std_logic := '0';
+    signal rst:             std_logic := '1';
+
+    signal host_tx:         std_logic := '1';
+    signal pin_tx:          std_logic;
+    signal ctl_rx:          std_logic;
+    signal ctl_tx:          std_logic;
+    signal active:          std_logic;
+    signal mst_output:      bus_slv_input_type;
+    signal mst_input:       bus_slv_output_type;
+
+    signal uart_slv_input:  bus_slv_input_type := (
+                                cmd_valid => '0',
+                                cmd_addr  => (others => '0'),
+                                cmd_write => '0',
+                                cmd_wdata => (others => '0'),
+                                cmd_wmask => "1111" );
+    signal uart_slv_output: bus_slv_output_type;
+    signal uart_rts_n:      std_logic;
+    signal uart_rts_t:      std_logic;
+    signal uart_interrupt:  std_logic;
+    signal dbg_enable:      std_logic;
+
+    -- RAM model.
+    signal mem:             mem_type := (others => (others => '0'));
+    signal mem_ready:       std_logic := '1';
+    signal mem_rsp_valid:   std_logic := '0';
+    signal mem_rsp_rdata:   std_logic_vector(31 downto 0) := (others => '0');
+
+    -- Bytes received by the host.
+    signal host_rx_buf:     byte_array(0 to 1023);
+    signal host_rx_time:    time_array(0 to 1023);
+    signal host_rx_count:   integer := 0;
+
+    -- UART controller activity.
+    signal ctl_spam:        boolean := false;
+    signal ctl_rx_count:    integer := 0;
+    signal ctl_rx_last:     std_logic_vector(7 downto 0) := (others => '0');
+
+    -- Requests to write the debug bridge control register.
+    signal ctl_dbg_req:     integer := 0;
+    signal ctl_dbg_done:    integer := 0;
+    signal ctl_dbg_value:   std_logic_vector(31 downto 0) := (others => '0');
+
+    signal sim_done:        boolean := false;
+
+    -- Test pattern.
+    function pattern(i: integer) return std_logic_vector is
+    begin
+        return std_logic_vector(to_unsigned(i mod 256, 8)) & x"5a"
+               & std_logic_vector(to_unsigned(255 - i mod 256, 8)) & x"c3";
+    end function;
+
+begin
+
+    -- Generate clock.
+    clk <= (not clk) after clk_period / 2 when not sim_done else '0';
+
+    -- Instantiate debug bridge.
+    inst_uart_dbg: entity work.uart_dbg
+        generic map (
+            bit_period      => bit_period,
+            timeout_bits    => timeout_bits )
+        port map (
+            clk             => clk,
+            rst             => rst,
+            enable          => dbg_enable,
+            uart_rx         => host_tx,
+            uart_tx         => pin_tx,
+            ctl_rx          => ctl_rx,
+            ctl_tx          => ctl_tx,
+            active          => active,
+            mst_output      => mst_output,
+            mst_input       => mst_input );
+
+    -- Instantiate UART controller.
+    inst_uart: entity work.uart
+        generic map (
+            bit_period      => bit_period,
+            rx_fifo_bits    => 4 )
+        port map (
+            clk             => clk,
+            rst             => rst,
+            uart_rx         => ctl_rx,
+            uart_tx         => ctl_tx,
+            uart_cts_n      => '0',
+            uart_rts_n      => uart_rts_n,
+            uart_rts_t      => uart_rts_t,
+            interrupt       => uart_interrupt,
+            dbg_enable      => dbg_enable,
+            slv_input       => uart_slv_input,
+            slv_output      => uart_slv_output );
+
+    -- RAM model with random wait states and 1 cycle read latency.
+    mst_input <= ( cmd_ready => mem_ready,
+                   rsp_valid => mem_rsp_valid,
+                   rsp_rdata => mem_rsp_rdata );
+
+    process (clk) is
+        variable v_lfsr: std_logic_vector(15 downto 0) := x"ace1";
+        variable v_addr: integer;
+    begin
+        if rising_edge(clk) then
+            mem_rsp_valid <= '0';
+            if (mst_output.cmd_valid = '1') and (mem_ready = '1') then
+                v_addr := to_integer(unsigned(mst_output.cmd_addr(9 downto 2)));
+                if mst_output.cmd_write = '1' then
+                    mem(v_addr) <= mst_output.cmd_wdata;
+                else
+                    mem_rsp_valid <= '1';
+                    mem_rsp_rdata <= mem(v_addr);
+                end if;
+            end if;
+            v_lfsr := v_lfsr(14 downto 0) & (v_lfsr(15) xor v_lfsr(13) xor
+                                              v_lfsr(12) xor v_lfsr(10));
+            mem_ready <= v_lfsr(0) or v_lfsr(1);
+        end if;
+    end process;
+
+    -- Host receiver.
+    process is
+        variable v_byte: std_logic_vector(7 downto 0);
+    begin
+        loop
+            wait until falling_edge(pin_tx);
+            wait for bit_time / 2;
+            assert pin_tx = '0' report "host: bad start bit" severity failure;
+            for b in 0 to 7 loop
+                wait for bit_time;
+                v_byte(b) := pin_tx;
+            end loop;
+            wait for bit_time;
+            assert pin_tx = '1' report "host: bad stop bit" severity failure;
+            host_rx_buf(host_rx_count) <= v_byte;
+            host_rx_time(host_rx_count) <= now;
+            host_rx_count <= host_rx_count + 1;
+        end loop;
+    end process;
+
+    -- Simulated CPU that drives the UART controller.
+    process is
+
+        procedure bus_write(addr: in integer; data: in std_logic_vector(31 downto 0)) is
+        begin
+            uart_slv_input.cmd_valid <= '1';
+            uart_slv_input.cmd_write <= '1';
+            uart_slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            uart_slv_input.cmd_wdata <= data;
+            wait until rising_edge(clk);
+            uart_slv_input.cmd_valid <= '0';
+            uart_slv_input.cmd_write <= '0';
+        end procedure;
+
+        procedure bus_read(addr: in integer; data: out std_logic_vector(31 downto 0)) is
+        begin
+            uart_slv_input.cmd_valid <= '1';
+            uart_slv_input.cmd_write <= '0';
+            uart_slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            wait until rising_edge(clk);
+            uart_slv_input.cmd_valid <= '0';
+            wait until rising_edge(clk);
+            data := uart_slv_output.rsp_rdata;
+        end procedure;
+
+        variable v_data: std_logic_vector(31 downto 0);
+
+    begin
+        wait until rst = '0';
+        wait until rising_edge(clk);
+        loop
+            -- Write the debug bridge control register on request.
+            if ctl_dbg_done /= ctl_dbg_req then
+                bus_write(12, ctl_dbg_value);
+                ctl_dbg_done <= ctl_dbg_req;
+            end if;
+            -- Transmit 0x55 continuously when enabled.
+            if ctl_spam then
+                bus_read(4, v_data);
+                if v_data(15) = '0' then
+                    bus_write(0, x"00000055");
+                end if;
+            end if;
+            -- Collect received bytes.
+            bus_read(0, v_data);
+            assert v_data(17) = '0' report "UART controller: frame error" severity failure;
+            if v_data(16) = '1' then
+                ctl_rx_last  <= v_data(7 downto 0);
+                ctl_rx_count <= ctl_rx_count + 1;
+            end if;
+        end loop;
+    end process;
+
+    -- Simulated host.
+    process is
+
+        variable v_rx_pos: integer := 0;
+
+        procedure host_send(b: in std_logic_vector(7 downto 0)) is
+        begin
+            host_tx <= '0';
+            wait for bit_time;
+            for i in 0 to 7 loop
+                host_tx <= b(i);
+                wait for bit_time;
+            end loop;
+            host_tx <= '1';
+            wait for bit_time;
+        end procedure;
+
+        procedure host_send_word(w: in std_logic_vector(31 downto 0)) is
+        begin
+            for i in 0 to 3 loop
+                host_send(w(8*i+7 downto 8*i));
+            end loop;
+        end procedure;
+
+        procedure host_send_cmd(cmd: in std_logic_vector(7 downto 0);
+                                addr: in integer;
+                                nwords: in integer) is
+        begin
+            host_send(cmd);
+            host_send_word(std_logic_vector(to_unsigned(addr, 32)));
+            host_send(std_logic_vector(to_unsigned((nwords - 1) mod 256, 8)));
+            host_send(std_logic_vector(to_unsigned((nwords - 1) / 256, 8)));
+        end procedure;
+
+        procedure host_recv(b: out std_logic_vector(7 downto 0)) is
+        begin
+            if host_rx_count <= v_rx_pos then
+                wait until host_rx_count > v_rx_pos for 100 * byte_time;
+            end if;
+            assert host_rx_count > v_rx_pos
+                report "host: timeout waiting for response" severity failure;
+            b := host_rx_buf(v_rx_pos);
+            v_rx_pos := v_rx_pos + 1;
+        end procedure;
+
+        procedure host_expect(b: in std_logic_vector(7 downto 0)) is
+            variable v_b: std_logic_vector(7 downto 0);
+        begin
+            host_recv(v_b);
+            assert v_b = b
+                report "host: expected 0x" & to_hstring(b)
+                       & " but got 0x" & to_hstring(v_b)
+                severity failure;
+        end procedure;
+
+        procedure host_expect_word(w: in std_logic_vector(31 downto 0)) is
+        begin
+            for i in 0 to 3 loop
+                host_expect(w(8*i+7 downto 8*i));
+            end loop;
+        end procedure;
+
+        procedure ctl_set_dbg(value: in std_logic_vector(31 downto 0)) is
+        begin
+            ctl_dbg_value <= value;
+            ctl_dbg_req <= ctl_dbg_req + 1;
+            wait until ctl_dbg_done = ctl_dbg_req for 100 * clk_period;
+            assert ctl_dbg_done = ctl_dbg_req
+                report "UART controller did not write debug control" severity failure;
+            wait until rising_edge(clk);
+        end procedure;
+
+        procedure ctl_expect(n: in integer; b: in std_logic_vector(7 downto 0)) is
+        begin
+            if ctl_rx_count /= n then
+                wait until ctl_rx_count = n for 10 * byte_time;
+            end if;
+            assert (ctl_rx_count = n) and (ctl_rx_last = b)
+                report "UART controller did not receive 0x" & to_hstring(b)
+                severity failure;
+        end procedure;
+
+        variable v_b:       std_logic_vector(7 downto 0);
+        variable v_ctl:     integer;
+        variable v_t0:      time;
+        variable v_t1:      time;
+
+    begin
+
+        -- Reset.
+        wait until rising_edge(clk);
+        wait until rising_edge(clk);
+        rst <= '0';
+        wait until rising_edge(clk);
+
+        -- Normal mode: bytes pass through to the UART controller.
+        host_send(x"41");
+        ctl_expect(1, x"41");
+        assert active = '0' report "bridge active after reset" severity failure;
+
+        -- The escape sequence is ignored while the bridge is disabled.
+        for i in esc_seq'range loop
+            host_send(esc_seq(i));
+        end loop;
+        ctl_expect(1 + esc_seq'length, x"00");
+        wait for 2 * byte_time;
+        assert active = '0' report "bridge active while disabled" severity failure;
+        assert host_rx_count = 0 report "host received data while disabled" severity failure;
+        ctl_set_dbg(x"00000001");
+
+        -- Enter bridge mode while the UART controller transmits.
+        ctl_spam <= true;
+        wait for 3 * byte_time;
+        for i in esc_seq'range loop
+            host_send(esc_seq(i));
+        end loop;
+        for i in 0 to 20 loop
+            host_recv(v_b);
+            exit when v_b = x"a5";
+            assert v_b = x"55" report "host: unexpected byte 0x" & to_hstring(v_b)
+                severity failure;
+        end loop;
+        assert v_b = x"a5" report "host: no acknowledge of escape" severity failure;
+        assert active = '1' report "bridge not active" severity failure;
+        ctl_expect(1 + 2 * esc_seq'length, x"00");
+        v_ctl := ctl_rx_count;
+
+        -- NOP.
+        host_send(x"00");
+        host_expect(x"80");
+
+        -- Write burst of 32 words at 0x40.
+        host_send_cmd(x"01", 16#40#, 32);
+        for i in 0 to 31 loop
+            host_send_word(pattern(i));
+        end loop;
+        host_expect(x"81");
+        for i in 0 to 31 loop
+            assert mem(16 + i) = pattern(i)
+                report "wrong RAM data after write at word " & integer'image(i)
+                severity failure;
+        end loop;
+        assert mem(15) = x"00000000" and mem(48) = x"00000000"
+            report "write burst outside range" severity failure;
+
+        -- Read burst of 32 words at 0x40.
+        host_send_cmd(x"02", 16#40#, 32);
+        host_expect(x"82");
+        v_t0 := host_rx_time(v_rx_pos - 1);
+        for i in 0 to 31 loop
+            host_expect_word(pattern(i));
+        end loop;
+        v_t1 := host_rx_time(v_rx_pos - 1);
+        report "read burst: 128 bytes in " & time'image(v_t1 - v_t0)
+               & " (" & time'image(128 * frame_time) & " at wire speed)";
+        assert v_t1 - v_t0 <= 128 * frame_time + bit_time
+            report "read burst slower than wire speed" severity failure;
+
+        -- Fixed-address read.
+        host_send_cmd(x"12", 16#44#, 4);
+        host_expect(x"82");
+        for i in 0 to 3 loop
+            host_expect_word(pattern(1));
+        end loop;
+
+        -- Fixed-address write.
+        host_send_cmd(x"11", 16#200#, 3);
+        host_send_word(x"11111111");
+        host_send_word(x"22222222");
+        host_send_word(x"33333333");
+        host_expect(x"81");
+        assert (mem(128) = x"33333333") and (mem(129) = x"00000000")
+            report "wrong fixed-address write" severity failure;
+
+        -- Unknown command.
+        host_send(x"07");
+        host_expect(x"ff");
+
+        -- The UART controller must not have received anything.
+        assert ctl_rx_count = v_ctl
+            report "UART controller received data in bridge mode" severity failure;
+
+        -- Exit.
+        host_send(x"03");
+        host_expect(x"83");
+        wait for byte_time;
+        assert active = '0' report "bridge still active after EXIT" severity failure;
+        wait for 3 * byte_time;
+        ctl_spam <= false;
+        wait for 4 * byte_time;
+        v_rx_pos := host_rx_count;
+        host_send(x"42");
+        ctl_expect(v_ctl + 1, x"42");
+
+        -- Idle timeout in the middle of a command.
+        for i in esc_seq'range loop
+            host_send(esc_seq(i));
+        end loop;
+        host_expect(x"a5");
+        host_send(x"01");
+        host_send(x"00");
+        wait for (2**timeout_bits + 100) * clk_period;
+        assert active = '0' report "bridge did not time out" severity failure;
+        v_ctl := ctl_rx_count;
+        host_send(x"43");
+        ctl_expect(v_ctl + 1, x"43");
+
+        -- Disable by software while in bridge mode.
+        for i in esc_seq'range loop
+            host_send(esc_seq(i));
+        end loop;
+        host_expect(x"a5");
+        host_send(x"00");
+        host_expect(x"80");
+        ctl_set_dbg(x"00000000");
+        wait for 4 * clk_period;
+        assert active = '0' report "bridge still active after disable" severity failure;
+
+        -- Lock; a locked bridge can not be enabled.
+        ctl_set_dbg(x"00000003");
+        ctl_set_dbg(x"00000001");
+        assert dbg_enable = '0' report "locked bridge enabled" severity failure;
+        v_ctl := ctl_rx_count;
+        for i in esc_seq'range loop
+            host_send(esc_seq(i));
+        end loop;
+        ctl_expect(v_ctl + esc_seq'length, x"00");
+        wait for 2 * byte_time;
+        assert active = '0' report "locked bridge entered bridge mode" severity failure;
+
+        report "PASS";
+        sim_done <= true;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,305 @@
+--
+-- Test bench for UART RTS/CTS flow control.
+--
+-- The UART runs at 4 Mbaud (25 clock cycles per bit at 100 MHz).
+--
+-- Receive direction:
+--   A remote transmitter sends a stream of bytes back-to-back while
+--   a simulated CPU reads the receive FIFO with long stalls.
+--   The remote side reacts to RTS only after a delay of several byte
+--   times, to model the latency of a USB serial converter.
+--   The first pass runs without flow control and shows that the stalls
+--   cause receive overruns. The second pass enables flow control and
+--   checks that every byte arrives in order and the overrun flag stays
+--   clear.
+--
+-- Transmit direction:
+--   The CPU writes a stream of bytes while the remote receiver
+--   periodically deasserts CTS. The test checks that the UART does not
+--   start a byte while CTS is deasserted, and that all bytes arrive
+--   in order.
+--
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.rvsys.all;
+
+
+entity tb_uart_flowctl is
+end entity;
+
+architecture sim of tb_uart_flowctl is
+
+    constant clk_period:    time := 10 ns;
+    constant bit_period:    integer := 25;
+    constant bit_time:      time := bit_period * clk_period;
+    constant byte_time:     time := 10 * bit_time;
+    constant rx_fifo_bits:  integer := 5;
+
+    -- Number of bytes per pass.
+    constant num_bytes_noflow:  integer := 400;
+    constant num_bytes:         integer := 4000;
+
+    -- Delay before the remote transmitter reacts to a change of RTS.
+    constant remote_latency:    time := 3 * byte_time;
+
+    -- The UART may start a byte until CTS has passed its synchronizer.
+    constant cts_latency:       time := 4 * clk_period;
+
+    signal clk:             std_logic := '0';
+    signal rst:             std_logic := '1';
+    signal uart_rx:         std_logic := '1';
+    signal uart_tx:         std_logic;
+    signal uart_cts_n:      std_logic := '0';
+    signal uart_rts_n:      std_logic;
+    signal uart_rts_t:      std_logic;
+    signal interrupt:       std_logic;
+    signal slv_input:       bus_slv_input_type := (
+                                cmd_valid => '0',
+                                cmd_addr  => (others => '0'),
+                                cmd_write => '0',
+                                cmd_wdata => (others => '0'),
+                                cmd_wmask => "1111" );
+    signal slv_output:      bus_slv_output_type;
+
+    -- RTS as seen by the remote transmitter.
+    signal remote_rts_n:    std_logic;
+
+    -- Control of the remote transmitter.
+    signal remote_tx_count: integer := 0;
+    signal remote_tx_flow:  boolean := false;
+    signal remote_tx_start: boolean := false;
+    signal remote_tx_busy:  boolean := false;
+
+    -- Number of bytes received by the remote receiver.
+    signal remote_rx_count: integer := 0;
+
+    signal sim_done:        boolean := false;
+
+    -- Test pattern.
+    function pattern(i: integer) return std_logic_vector is
+    begin
+        return std_logic_vector(to_unsigned((i * 37 + 11) mod 256, 8));
+    end function;
+
+begin
+
+    -- Generate clock.
+    clk <= (not clk) after clk_period / 2 when not sim_done else '0';
+
+    -- Instantiate UART.
+    inst_uart: entity work.uart
+        generic map (
+            bit_period      => bit_period,
+            rx_fifo_bits    => rx_fifo_bits )
+        port map (
+            clk             => clk,
+            rst             => rst,
+            uart_rx         => uart_rx,
+            uart_tx         => uart_tx,
+            uart_cts_n      => uart_cts_n,
+            uart_rts_n      => uart_rts_n,
+            uart_rts_t      => uart_rts_t,
+            interrupt       => interrupt,
+            dbg_enable      => open,
+            slv_input       => slv_input,
+            slv_output      => slv_output );
+
+    -- Delayed RTS seen by the remote side.
+    remote_rts_n <= transport (uart_rts_n or uart_rts_t) after remote_latency;
+
+    -- Remote transmitter.
+    process is
+    begin
+        loop
+            wait until remote_tx_start;
+            remote_tx_busy <= true;
+            for i in 0 to remote_tx_count - 1 loop
+                if remote_tx_flow and (remote_rts_n /= '0') then
+                    wait until remote_rts_n = '0';
+                end if;
+                uart_rx <= '0';
+                wait for bit_time;
+                for b in 0 to 7 loop
+                    uart_rx <= pattern(i)(b);
+                    wait for bit_time;
+                end loop;
+                uart_rx <= '1';
+                wait for bit_time;
+            end loop;
+            remote_tx_busy <= false;
+            wait until not remote_tx_start;
+        end loop;
+    end process;
+
+    -- Remote receiver.
+    process is
+        variable v_byte: std_logic_vector(7 downto 0);
+    begin
+        loop
+            wait until falling_edge(uart_tx);
+
+            -- The UART must not start a byte while CTS is deasserted.
+            assert (uart_cts_n = '0') or (uart_cts_n'last_event < cts_latency)
+                report "UART started a byte while CTS deasserted"
+                severity failure;
+
+            wait for bit_time / 2;
+            assert uart_tx = '0' report "bad start bit" severity failure;
+            for b in 0 to 7 loop
+                wait for bit_time;
+                v_byte(b) := uart_tx;
+            end loop;
+            wait for bit_time;
+            assert uart_tx = '1' report "bad stop bit" severity failure;
+            assert v_byte = pattern(remote_rx_count)
+                report "remote receiver got wrong data at byte "
+                       & integer'image(remote_rx_count)
+                severity failure;
+            remote_rx_count <= remote_rx_count + 1;
+
+            -- Stall: deassert CTS for a while after every 50 bytes.
+            if remote_rx_count mod 50 = 49 then
+                uart_cts_n <= '1';
+                wait for 30 us;
+                uart_cts_n <= '0';
+            end if;
+        end loop;
+    end process;
+
+    -- Simulated CPU.
+    process is
+
+        procedure bus_write(addr: in integer; data: in std_logic_vector(31 downto 0)) is
+        begin
+            slv_input.cmd_valid <= '1';
+            slv_input.cmd_write <= '1';
+            slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            slv_input.cmd_wdata <= data;
+            wait until rising_edge(clk);
+            slv_input.cmd_valid <= '0';
+            slv_input.cmd_write <= '0';
+        end procedure;
+
+        procedure bus_read(addr: in integer; data: out std_logic_vector(31 downto 0)) is
+        begin
+            slv_input.cmd_valid <= '1';
+            slv_input.cmd_write <= '0';
+            slv_input.cmd_addr  <= std_logic_vector(to_unsigned(addr, 32));
+            wait until rising_edge(clk);
+            slv_input.cmd_valid <= '0';
+            wait until rising_edge(clk);
+            assert slv_output.rsp_valid = '1' report "no bus response" severity failure;
+            data := slv_output.rsp_rdata;
+        end procedure;
+
+        -- Stall the CPU after some bytes, for a varying time
+        -- of 16 to 64 byte times.
+        procedure stall(count: in integer) is
+        begin
+            if count mod 97 = 96 then
+                wait for ((count / 97) mod 4 + 1) * 16 * byte_time;
+                wait until rising_edge(clk);
+            end if;
+        end procedure;
+
+        variable v_data:        std_logic_vector(31 downto 0);
+        variable v_count:       integer;
+        variable v_overruns:    integer;
+        variable v_t0:          time;
+
+    begin
+
+        -- Reset.
+        wait until rising_edge(clk);
+        wait until rising_edge(clk);
+        rst <= '0';
+        wait until rising_edge(clk);
+
+        bus_read(4, v_data);
+        assert unsigned(v_data(31 downto 28)) = rx_fifo_bits
+            report "wrong FIFO size in status register" severity failure;
+        assert uart_rts_t = '1'
+            report "RTS driven while flow control disabled" severity failure;
+
+        -- Pass 1: receive without flow control.
+        remote_tx_count <= num_bytes_noflow;
+        remote_tx_flow  <= false;
+        remote_tx_start <= true;
+        wait until remote_tx_busy;
+        remote_tx_start <= false;
+
+        v_count := 0;
+        v_overruns := 0;
+        loop
+            bus_read(0, v_data);
+            if v_data(18) = '1' then
+                v_overruns := v_overruns + 1;
+            end if;
+            if v_data(16) = '1' then
+                v_count := v_count + 1;
+                stall(v_count);
+            elsif not remote_tx_busy then
+                exit;
+            end if;
+        end loop;
+
+        report "without flow control: received " & integer'image(v_count)
+               & " of " & integer'image(num_bytes_noflow) & " bytes, "
+               & integer'image(v_overruns) & " overruns";
+        assert v_overruns > 0
+            report "expected overruns without flow control" severity failure;
+
+        -- Pass 2: receive with flow control.
+        bus_write(4, x"00000004");
+        remote_tx_count <= num_bytes;
+        remote_tx_flow  <= true;
+        remote_tx_start <= true;
+        wait until remote_tx_busy;
+        remote_tx_start <= false;
+        v_t0 := now;
+
+        v_count := 0;
+        while v_count < num_bytes loop
+            bus_read(0, v_data);
+            assert v_data(18 downto 17) = "00"
+                report "overrun or frame error at byte " & integer'image(v_count)
+                severity failure;
+            if v_data(16) = '1' then
+                assert v_data(7 downto 0) = pattern(v_count)
+                    report "wrong data at byte " & integer'image(v_count)
+                    severity failure;
+                v_count := v_count + 1;
+                stall(v_count);
+            end if;
+        end loop;
+
+        report "with flow control: received " & integer'image(num_bytes)
+               & " bytes without overrun in " & time'image(now - v_t0)
+               & " (" & time'image(num_bytes * byte_time) & " at line rate)";
+
+        -- Pass 3: transmit with CTS stalls from the remote receiver.
+        v_t0 := now;
+        for i in 0 to num_bytes - 1 loop
+            loop
+                bus_read(4, v_data);
+                exit when v_data(15) = '0';
+            end loop;
+            bus_write(0, x"000000" & pattern(i));
+        end loop;
+        if remote_rx_count /= num_bytes then
+            wait until remote_rx_count = num_bytes;
+        end if;
+
+        report "transmit with CTS stalls: " & integer'image(num_bytes)
+               & " bytes in " & time'image(now - v_t0);
+
+        report "PASS";
+        sim_done <= true;
+        wait;
+    end process;
+
+end architecture;
@@ -26,14 +26,41 @@
 #include "rvlib_gpio.h"
 #include "rvlib_uart.h"
 #include "rvlib_spiflash.h"
+#include "rvlib_crc32.h"
+#include "rvlib_icap.h"
+#include "rvlib_busmon.h"
+#include "rvlib_sha256.h"
+#include "bootmon_key.h"
+#include "gdbstub.h"
+
+
+/*
+ * Update images are accepted and booted only with a valid HMAC-SHA256
+ * tag. The key is generated by the Makefile (bootmon.key) and is not
+ * part of the source tree.
+ *
+ * Programs loaded via the serial port ("hexboot", "gdb" and the UART
+ * debug bridge) are never verified. Build with BOOTMON_REQUIRE_SIGNED=1
+ * to disable those commands and lock the debug bridge, so that only
+ * signed update images can run.
+ */
+#ifndef BOOTMON_REQUIRE_SIGNED
+#define BOOTMON_REQUIRE_SIGNED  0
+#endif
 
 
 /* Hexboot helper function (written in assembler). */
 extern void bootmon_hexboot_helper(uint32_t uart_base_addr);
 
+/* Start GDB stub (written in assembler). */
+extern void bootmon_gdbstub_start(void) __attribute__ ((noreturn));
+
 
 static char scratchbuf[40];
 
+/* Echo received characters while reading a command. */
+static int cmd_echo = 1;
+
 
 /*
  * Print a string to the console.
@@ -104,6 +131,24 @@ static void print_endln(void)
 }
 
 
+/*
+ * Match a complete word at the start of a command string.
+ * Return the length of the word if it is followed by a space or
+ * end of string, otherwise return 0.
+ */
+static size_t match_word(const char *s, const char *word)
+{
+    size_t n = 0;
+    while (word[n] != '\0') {
+        if (s[n] != word[n]) {
+            return 0;
+        }
+        n++;
+    }
+    return (s[n] == ' ' || s[n] == '\0') ? n : 0;
+}
+
+
 /* Parse decimal or hexadecimal number. */
 static int parse_uint(const char *s, uint32_t *val)
 {
@@ -430,14 +475,34 @@ void test_mem_access(void)
 }
 
 
+/*
+ * Invalidate the magic word of a GDB stub left in RAM by an earlier
+ * "gdb" command. A program loaded later may overwrite the stub area.
+ */
+static void clear_gdbstub_magic(void)
+{
+    *(volatile uint32_t *)(GDBSTUB_ADDR + GDBSTUB_OFS_MAGIC) = 0;
+}
+
+
 /* Load and execute HEX file. */
 void do_hexboot(void)
 {
+    clear_gdbstub_magic();
     print_str("Reading HEX data ... ");
     bootmon_hexboot_helper(RVSYS_ADDR_UART);
 }
 
 
+/* Start the GDB stub. */
+void do_gdbstub(void)
+{
+    print_str("Starting GDB stub, connect via serial port\r\n");
+    usleep(2000);
+    bootmon_gdbstub_start();
+}
+
+
 /* Handle "led ..." subcommand. */
 static int set_led_subcommand(const char *cmdbuf)
 {
@@ -725,6 +790,743 @@ static int spiflash_subcommand(const char *cmdbuf)
 }
 
 
+/*
+ * Descriptor of a verified update bitstream.
+ * Stored at the start of the descriptor sector in flash.
+ */
+#define FPGA_UPDATE_MAGIC       0x32555652
+#define FPGA_UPDATE_CHUNK_SIZE  4096
+#define FPGA_UPDATE_TIMEOUT_US  (5 * 1000 * 1000UL)
+
+/* Flags in the update descriptor. */
+#define FPGA_UPDATE_FLAG_SIGNED 0x01
+
+struct fpga_update_desc {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t flags;
+    uint8_t  tag[RVLIB_SHA256_DIGEST_SIZE];     // HMAC-SHA256 of the image
+    uint32_t desc_crc;
+};
+
+static unsigned char fpga_update_buf[FPGA_UPDATE_CHUNK_SIZE];
+
+
+/* Print elapsed time in milliseconds. */
+static void print_elapsed_ms(const char *msg, uint64_t cycles)
+{
+    print_str(msg);
+    print_uint64(cycles / (RVLIB_CPU_FREQ_MHZ * 1000));
+    print_str(" ms\r\n");
+}
+
+
+/* Print error code of a failed flash operation. */
+static void print_flash_error(const char *msg, int status)
+{
+    print_str("ERROR: ");
+    print_str(msg);
+    print_str(" failed, code -");
+    print_uint(-status);
+    print_endln();
+}
+
+
+/* Read the update descriptor. Return 0 if it is valid. */
+static int fpga_read_update_desc(struct fpga_update_desc *desc)
+{
+    rvlib_spiflash_read_mem(RVSYS_FLASH_UPDATE_DESC_ADDR,
+                            (unsigned char *)desc,
+                            sizeof(*desc));
+    if (desc->magic != FPGA_UPDATE_MAGIC
+            || desc->size == 0
+            || desc->size > RVSYS_FLASH_UPDATE_MAX_SIZE
+            || desc->desc_crc != rvlib_crc32(0, (const unsigned char *)desc,
+                                             offsetof(struct fpga_update_desc,
+                                                      desc_crc))) {
+        return -1;
+    }
+    return 0;
+}
+
+
+/* Calculate the CRC of a flash memory area. */
+static uint32_t fpga_flash_crc(uint32_t addr, uint32_t len)
+{
+    unsigned char buf[256];
+    uint32_t crc = 0;
+
+    rvlib_spiflash_read_start(addr);
+    while (len > 0) {
+        size_t n = (len > sizeof(buf)) ? sizeof(buf) : len;
+        rvlib_spiflash_read_continue(buf, n);
+        crc = rvlib_crc32(crc, buf, n);
+        len -= n;
+    }
+    rvlib_spiflash_read_end();
+
+    return crc;
+}
+
+
+/*
+ * Check the CRC and, if "tag" is not NULL, the HMAC-SHA256 tag
+ * of the image in the update slot. Both are calculated in one pass.
+ *
+ * Return 0 if the image is valid, -1 if the CRC does not match,
+ * -2 if the tag does not match.
+ */
+static int fpga_flash_check(uint32_t len, uint32_t expect_crc, const uint8_t *tag)
+{
+    struct rvlib_hmac_sha256_ctx hmac;
+    uint8_t mac[RVLIB_SHA256_DIGEST_SIZE];
+    unsigned char buf[256];
+    uint32_t addr = RVSYS_FLASH_UPDATE_ADDR;
+    uint32_t crc = 0;
+
+    if (tag != NULL) {
+        rvlib_sha256_init_hw(1);
+        rvlib_hmac_sha256_init(&hmac, bootmon_hmac_key, sizeof(bootmon_hmac_key));
+    }
+
+    rvlib_spiflash_read_start(addr);
+    while (len > 0) {
+        size_t n = (len > sizeof(buf)) ? sizeof(buf) : len;
+        rvlib_spiflash_read_continue(buf, n);
+        crc = rvlib_crc32(crc, buf, n);
+        if (tag != NULL) {
+            rvlib_hmac_sha256_update(&hmac, buf, n);
+        }
+        len -= n;
+    }
+    rvlib_spiflash_read_end();
+
+    if (crc != expect_crc) {
+        return -1;
+    }
+    if (tag != NULL) {
+        rvlib_hmac_sha256_final(&hmac, mac);
+        if (rvlib_sha256_compare(mac, tag) != 0) {
+            return -2;
+        }
+    }
+    return 0;
+}
+
+
+/* Print the result of fpga_flash_check(). */
+static void print_check_error(int status)
+{
+    if (status == -2) {
+        print_str("ERROR: authentication tag mismatch\r\n");
+    } else {
+        print_str("ERROR: CRC mismatch in flash memory\r\n");
+    }
+}
+
+
+/* Receive bytes from the serial port with timeout. */
+static int fpga_recv_bytes(unsigned char *buf, size_t len)
+{
+    for (size_t p = 0; p < len; p++) {
+        uint64_t end_time = get_cycle_counter();
+        end_time += RVLIB_CPU_FREQ_MHZ * (uint64_t)FPGA_UPDATE_TIMEOUT_US;
+        int c;
+        while ((c = rvlib_uart_recv_byte(RVLIB_DEFAULT_UART_ADDR)) < 0) {
+            if (get_cycle_counter() > end_time) {
+                return -1;
+            }
+        }
+        buf[p] = c;
+    }
+    return 0;
+}
+
+
+/* Check that the start of an image looks like a bitstream. */
+static int fpga_check_sync_word(const unsigned char *buf, uint32_t n)
+{
+    static const unsigned char sync_word[4] = { 0xaa, 0x99, 0x55, 0x66 };
+
+    for (uint32_t i = 0; i + 4 <= n && i < 256; i++) {
+        if (memcmp(buf + i, sync_word, 4) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Program a chunk of data into flash, one page at a time. */
+static int fpga_program_chunk(uint32_t addr, const unsigned char *buf, uint32_t n)
+{
+    for (uint32_t p = 0; p < n; p += 256) {
+        uint32_t k = (n - p > 256) ? 256 : (n - p);
+        int status = rvlib_spiflash_page_program(addr + p, buf + p, k);
+        if (status < 0) {
+            return status;
+        }
+    }
+    return 0;
+}
+
+
+/* Write the descriptor to mark the update image as valid. */
+static int fpga_write_update_desc(uint32_t len, uint32_t crc, const uint8_t *tag)
+{
+    struct fpga_update_desc desc;
+
+    desc.magic = FPGA_UPDATE_MAGIC;
+    desc.size = len;
+    desc.crc = crc;
+    desc.flags = 0;
+    memset(desc.tag, 0, sizeof(desc.tag));
+    if (tag != NULL) {
+        desc.flags = FPGA_UPDATE_FLAG_SIGNED;
+        memcpy(desc.tag, tag, sizeof(desc.tag));
+    }
+    desc.desc_crc = rvlib_crc32(0, (const unsigned char *)&desc,
+                                offsetof(struct fpga_update_desc, desc_crc));
+    return rvlib_spiflash_page_program(RVSYS_FLASH_UPDATE_DESC_ADDR,
+                                       (const unsigned char *)&desc,
+                                       sizeof(desc));
+}
+
+
+/* Show FPGA configuration status and update image. */
+static void fpga_status(void)
+{
+    struct fpga_update_desc desc;
+
+    uint32_t bootsts = rvlib_icap_read_config_reg(RVLIB_ICAP_CFGREG_BOOTSTS);
+    uint32_t wbstar = rvlib_icap_read_config_reg(RVLIB_ICAP_CFGREG_WBSTAR);
+
+    print_str("FPGA configuration status:\r\n");
+    print_str("  BOOTSTS = 0x");
+    print_uint_hex(bootsts, 8);
+    print_endln();
+    print_str("  WBSTAR  = 0x");
+    print_uint_hex(wbstar, 8);
+    print_endln();
+    if ((bootsts & (1 << RVLIB_ICAP_BOOTSTS_FALLBACK)) != 0) {
+        print_str("  Running golden image after failed update image\r\n");
+    } else if ((bootsts & (1 << RVLIB_ICAP_BOOTSTS_IPROG)) != 0) {
+        print_str("  Running image loaded via IPROG\r\n");
+    }
+
+    rvlib_spiflash_init();
+    if (fpga_read_update_desc(&desc) == 0) {
+        print_str("  Update image: ");
+        print_uint(desc.size);
+        print_str(" bytes, CRC 0x");
+        print_uint_hex(desc.crc, 8);
+        if ((desc.flags & FPGA_UPDATE_FLAG_SIGNED) != 0) {
+            print_str(", signed");
+        } else {
+            print_str(", unsigned");
+        }
+        print_endln();
+    } else {
+        print_str("  No valid update image\r\n");
+    }
+}
+
+
+/* Check image parameters before starting an update. */
+static int fpga_check_update_args(uint32_t len, const uint8_t *tag)
+{
+    if (len == 0 || len > RVSYS_FLASH_UPDATE_MAX_SIZE) {
+        print_str("ERROR: invalid image size\r\n");
+        return -1;
+    }
+    if (tag == NULL) {
+        print_str("ERROR: image must be signed\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+
+/*
+ * Receive a bitstream via the serial port and program it
+ * into the update slot.
+ *
+ * The host sends the image in chunks of 4096 bytes.
+ * Before each chunk, the boot monitor sends a '+' character
+ * to indicate that it is ready to receive the chunk.
+ *
+ * If "tag" is not NULL, the image must match this HMAC-SHA256 tag.
+ */
+static int fpga_update(uint32_t len, uint32_t expect_crc, const uint8_t *tag)
+{
+    int status;
+
+    if (fpga_check_update_args(len, tag) != 0) {
+        return 0;
+    }
+
+    rvlib_spiflash_init();
+
+    /* Erase descriptor and update slot. */
+    print_str("Erasing update slot ");
+    uint64_t t_start = get_cycle_counter();
+    status = rvlib_spiflash_sector_erase(RVSYS_FLASH_UPDATE_DESC_ADDR);
+    for (uint32_t p = 0; status == 0 && p < len; p += RVLIB_SPIFLASH_SECTOR_SIZE) {
+        rvlib_putchar('.');
+        status = rvlib_spiflash_sector_erase(RVSYS_FLASH_UPDATE_ADDR + p);
+    }
+    print_endln();
+    if (status < 0) {
+        print_flash_error("erase", status);
+        return 0;
+    }
+    uint64_t t_erased = get_cycle_counter();
+
+    /* Receive and program the image. */
+    print_str("Send data\r\n");
+    uint32_t crc = 0;
+    for (uint32_t pos = 0; pos < len; pos += FPGA_UPDATE_CHUNK_SIZE) {
+        uint32_t n = len - pos;
+        if (n > FPGA_UPDATE_CHUNK_SIZE) {
+            n = FPGA_UPDATE_CHUNK_SIZE;
+        }
+
+        rvlib_putchar('+');
+        if (fpga_recv_bytes(fpga_update_buf, n) != 0) {
+            print_str("\r\nERROR: timeout while receiving data\r\n");
+            return 0;
+        }
+
+        /* Check that the image looks like a bitstream. */
+        if (pos == 0 && !fpga_check_sync_word(fpga_update_buf, n)) {
+            print_str("\r\nERROR: no sync word, not a bitstream\r\n");
+            return 0;
+        }
+
+        crc = rvlib_crc32(crc, fpga_update_buf, n);
+
+        status = fpga_program_chunk(RVSYS_FLASH_UPDATE_ADDR + pos,
+                                    fpga_update_buf, n);
+        if (status < 0) {
+            print_endln();
+            print_flash_error("program", status);
+            return 0;
+        }
+    }
+    print_endln();
+    uint64_t t_programmed = get_cycle_counter();
+
+    if (crc != expect_crc) {
+        print_str("ERROR: CRC mismatch in received data\r\n");
+        return 0;
+    }
+
+    /* Verify the programmed image. */
+    print_str("Verifying ...\r\n");
+    status = fpga_flash_check(len, expect_crc, tag);
+    if (status != 0) {
+        print_check_error(status);
+        return 0;
+    }
+    uint64_t t_verified = get_cycle_counter();
+
+    /* Write descriptor to mark the update image as valid. */
+    status = fpga_write_update_desc(len, expect_crc, tag);
+    if (status < 0) {
+        print_flash_error("program", status);
+        return 0;
+    }
+    uint64_t t_end = get_cycle_counter();
+
+    print_elapsed_ms("  erase:    ", t_erased - t_start);
+    print_elapsed_ms("  transfer: ", t_programmed - t_erased);
+    print_elapsed_ms("  verify:   ", t_verified - t_programmed);
+    print_elapsed_ms("  total:    ", t_end - t_start);
+
+    return 1;
+}
+
+
+/*
+ * Incrementally update the image in the update slot via the serial port.
+ *
+ * The boot monitor first sends the CRC-32 of each 4096-byte block of
+ * the current contents of the update slot. The host compares these
+ * against its new image and sends only the blocks that differ.
+ *
+ * Before each block, the boot monitor sends a '+' character.
+ * The host replies with a 4-byte block index (little endian) followed
+ * by the block data, or with index 0xffffffff to finish.
+ * Each received block is erased and programmed as a 4 kByte subsector.
+ * Finally the whole image is verified against the expected CRC
+ * and, if "tag" is not NULL, against the HMAC-SHA256 tag.
+ */
+static int fpga_sync(uint32_t len, uint32_t expect_crc, const uint8_t *tag)
+{
+    uint32_t nblocks = (len + FPGA_UPDATE_CHUNK_SIZE - 1) / FPGA_UPDATE_CHUNK_SIZE;
+    uint32_t nchanged = 0;
+    int status;
+
+    if (fpga_check_update_args(len, tag) != 0) {
+        return 0;
+    }
+
+    rvlib_spiflash_init();
+
+    /* Invalidate the descriptor while the image is being modified. */
+    uint64_t t_start = get_cycle_counter();
+    status = rvlib_spiflash_sector_erase(RVSYS_FLASH_UPDATE_DESC_ADDR);
+    if (status < 0) {
+        print_flash_error("erase", status);
+        return 0;
+    }
+
+    /* Report block checksums of the current flash contents. */
+    print_str("Block CRCs ");
+    print_uint(nblocks);
+    print_endln();
+    for (uint32_t blk = 0; blk < nblocks; blk++) {
+        uint32_t pos = blk * FPGA_UPDATE_CHUNK_SIZE;
+        uint32_t n = len - pos;
+        if (n > FPGA_UPDATE_CHUNK_SIZE) {
+            n = FPGA_UPDATE_CHUNK_SIZE;
+        }
+        print_uint_hex(fpga_flash_crc(RVSYS_FLASH_UPDATE_ADDR + pos, n), 8);
+        if (blk % 8 == 7 || blk + 1 == nblocks) {
+            print_endln();
+        } else {
+            rvlib_putchar(' ');
+        }
+    }
+    uint64_t t_hashed = get_cycle_counter();
+
+    /* Receive and program changed blocks. */
+    print_str("Send blocks\r\n");
+    while (1) {
+        uint32_t blk;
+
+        rvlib_putchar('+');
+        if (fpga_recv_bytes((unsigned char *)&blk, 4) != 0) {
+            print_str("\r\nERROR: timeout while receiving data\r\n");
+            return 0;
+        }
+        if (blk == 0xffffffff) {
+            break;
+        }
+        if (blk >= nblocks) {
+            print_str("\r\nERROR: invalid block index\r\n");
+            return 0;
+        }
+
+        uint32_t pos = blk * FPGA_UPDATE_CHUNK_SIZE;
+        uint32_t n = len - pos;
+        if (n > FPGA_UPDATE_CHUNK_SIZE) {
+            n = FPGA_UPDATE_CHUNK_SIZE;
+        }
+        if (fpga_recv_bytes(fpga_update_buf, n) != 0) {
+            print_str("\r\nERROR: timeout while receiving data\r\n");
+            return 0;
+        }
+
+        /* Check that the image looks like a bitstream. */
+        if (pos == 0 && !fpga_check_sync_word(fpga_update_buf, n)) {
+            print_str("\r\nERROR: no sync word, not a bitstream\r\n");
+            return 0;
+        }
+
+        status = rvlib_spiflash_subsector_erase(RVSYS_FLASH_UPDATE_ADDR + pos);
+        if (status < 0) {
+            print_endln();
+            print_flash_error("erase", status);
+            return 0;
+        }
+        status = fpga_program_chunk(RVSYS_FLASH_UPDATE_ADDR + pos,
+                                    fpga_update_buf, n);
+        if (status < 0) {
+            print_endln();
+            print_flash_error("program", status);
+            return 0;
+        }
+        nchanged++;
+    }
+    print_endln();
+    uint64_t t_programmed = get_cycle_counter();
+
+    /* Verify the complete image. */
+    print_str("Verifying ...\r\n");
+    status = fpga_flash_check(len, expect_crc, tag);
+    if (status != 0) {
+        print_check_error(status);
+        return 0;
+    }
+    uint64_t t_verified = get_cycle_counter();
+
+    status = fpga_write_update_desc(len, expect_crc, tag);
+    if (status < 0) {
+        print_flash_error("program", status);
+        return 0;
+    }
+    uint64_t t_end = get_cycle_counter();
+
+    print_str("  changed blocks: ");
+    print_uint(nchanged);
+    print_str(" of ");
+    print_uint(nblocks);
+    print_endln();
+    print_elapsed_ms("  checksum: ", t_hashed - t_start);
+    print_elapsed_ms("  transfer: ", t_programmed - t_hashed);
+    print_elapsed_ms("  verify:   ", t_verified - t_programmed);
+    print_elapsed_ms("  total:    ", t_end - t_start);
+
+    return 1;
+}
+
+
+/* Reboot the FPGA from the golden image or the update image. */
+static int fpga_boot(int use_update)
+{
+    struct fpga_update_desc desc;
+    uint32_t addr = RVSYS_FLASH_GOLDEN_ADDR;
+
+    if (use_update) {
+        rvlib_spiflash_init();
+        if (fpga_read_update_desc(&desc) != 0) {
+            print_str("ERROR: no valid update image\r\n");
+            return 0;
+        }
+        if ((desc.flags & FPGA_UPDATE_FLAG_SIGNED) == 0) {
+            print_str("ERROR: update image is not signed\r\n");
+            return 0;
+        }
+
+        /*
+         * Lock the UART debug bridge until the FPGA reboots,
+         * so the host can not change the flash after the check.
+         */
+        rvlib_uart_lock_debug_bridge(RVSYS_ADDR_UART);
+
+        /* Verify the complete image before booting it. */
+        uint64_t t_start = get_cycle_counter();
+        int status = fpga_flash_check(desc.size, desc.crc, desc.tag);
+        uint64_t t_end = get_cycle_counter();
+        if (status != 0) {
+            print_check_error(status);
+            return 0;
+        }
+        print_elapsed_ms("Image CRC and tag OK, ", t_end - t_start);
+        addr = RVSYS_FLASH_UPDATE_ADDR;
+    }
+
+    print_str("Rebooting FPGA ...\r\n");
+    usleep(10000);
+    rvlib_icap_reboot(addr);
+}
+
+
+/*
+ * Parse an optional authentication tag of 64 hex digits.
+ * Return 1 if a tag was parsed, 0 if there is no tag, -1 on error.
+ */
+static int parse_update_tag(const char *s, uint8_t *tag)
+{
+    while (*s == ' ') {
+        s++;
+    }
+    if (*s == '\0') {
+        return 0;
+    }
+
+    for (int i = 0; i < 2 * RVLIB_SHA256_DIGEST_SIZE; i++) {
+        char c = s[i];
+        uint8_t d;
+        if (c >= '0' && c <= '9') {
+            d = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            d = c - 'a' + 10;
+        } else {
+            return -1;
+        }
+        if (i % 2 == 0) {
+            tag[i / 2] = d << 4;
+        } else {
+            tag[i / 2] |= d;
+        }
+    }
+
+    return (s[2 * RVLIB_SHA256_DIGEST_SIZE] == '\0') ? 1 : -1;
+}
+
+
+/* Handle "fpga ..." subcommand. */
+static int fpga_subcommand(const char *cmdbuf)
+{
+    const char *pcmd = cmdbuf;
+
+    while (*pcmd == ' ') {
+        pcmd++;
+    }
+
+    if (*pcmd == '\0' || strncmp(pcmd, "help", 5) == 0) {
+        print_str(
+            "fpga subcommands:\r\n"
+            "  fpga status                       - Show configuration status\r\n"
+            "  fpga update <len> <crc32> <tag>   - Receive update image via serial port\r\n"
+            "  fpga sync <len> <crc32> <tag>     - Receive changed blocks of update image\r\n"
+            "  fpga boot {golden|update}         - Reconfigure FPGA from flash\r\n"
+            "\r\n"
+            "  <tag> is the HMAC-SHA256 of the image as 64 hex digits.\r\n"
+            "  \"fpga sync\" only helps with uncompressed bitstreams;\r\n"
+            "  a small change to a compressed bitstream shifts all later blocks.\r\n"
+            "  Write update images with vivado/write_update_bitstream.tcl.\r\n"
+            "\r\n");
+        return 0;
+    }
+
+    if (strncmp(pcmd, "status", 7) == 0) {
+        fpga_status();
+        return 0;
+    } else if (match_word(pcmd, "update")) {
+        uint32_t len, crc;
+        uint8_t tag[RVLIB_SHA256_DIGEST_SIZE];
+        pcmd += 6;
+        int ret = parse_uint(pcmd, &len);
+        if (ret < 0) {
+            return ret;
+        }
+        pcmd += ret;
+        ret = parse_uint(pcmd, &crc);
+        if (ret < 0) {
+            return ret;
+        }
+        pcmd += ret;
+        ret = parse_update_tag(pcmd, tag);
+        if (ret < 0) {
+            return ret;
+        }
+        return fpga_update(len, crc, (ret > 0) ? tag : NULL);
+    } else if (match_word(pcmd, "sync")) {
+        uint32_t len, crc;
+        uint8_t tag[RVLIB_SHA256_DIGEST_SIZE];
+        pcmd += 4;
+        int ret = parse_uint(pcmd, &len);
+        if (ret < 0) {
+            return ret;
+        }
+        pcmd += ret;
+        ret = parse_uint(pcmd, &crc);
+        if (ret < 0) {
+            return ret;
+        }
+        pcmd += ret;
+        ret = parse_update_tag(pcmd, tag);
+        if (ret < 0) {
+            return ret;
+        }
+        return fpga_sync(len, crc, (ret > 0) ? tag : NULL);
+    } else if (strncmp(pcmd, "boot golden", 12) == 0) {
+        return fpga_boot(0);
+    } else if (strncmp(pcmd, "boot update", 12) == 0) {
+        return fpga_boot(1);
+    } else {
+        return -1;
+    }
+}
+
+
+/* Names of the peripheral bus slaves, indexed by RVSYS_DEVBUS_xxx. */
+static const char * const busstat_slave_names[] = {
+    "leds", "gpio1", "gpio2", "uart", "timer",
+    "spiflash", "jtagcon", "icap", "trace", "mac", "sha256", "i2c",
+    "accel" };
+
+#define BUSSTAT_NUM_NAMES \
+    (sizeof(busstat_slave_names) / sizeof(busstat_slave_names[0]))
+
+
+/* Print a decimal number right-aligned in a column of the specified width. */
+static void print_uint_column(unsigned int val, unsigned int width)
+{
+    unsigned int ndigits = 1;
+    for (unsigned int t = val; t >= 10; t /= 10) {
+        ndigits++;
+    }
+    while (width > ndigits) {
+        rvlib_putchar(' ');
+        width--;
+    }
+    print_uint(val);
+}
+
+
+/* Print the peripheral bus monitor counters. */
+static void show_busstat(void)
+{
+    struct rvlib_busmon_counters ctr;
+
+    rvlib_busmon_enable(0);
+
+    print_str("cycles: ");
+    print_uint(rvlib_busmon_cycles());
+    print_endln();
+    print_str("slave        reads   writes  rd_cycles    stall"
+              "   lat1-2   lat3-4   lat5-8    lat9+\r\n");
+
+    unsigned int nslaves = rvlib_busmon_num_slaves();
+    for (unsigned int i = 0; i < nslaves; i++) {
+        rvlib_busmon_read(i, &ctr);
+        if (ctr.reads == 0 && ctr.writes == 0 && ctr.stall_cycles == 0) {
+            continue;
+        }
+        const char *name = (i < BUSSTAT_NUM_NAMES) ? busstat_slave_names[i] : "?";
+        print_str(name);
+        for (size_t n = strnlen_s(name, 9); n < 9; n++) {
+            rvlib_putchar(' ');
+        }
+        print_uint_column(ctr.reads, 9);
+        print_uint_column(ctr.writes, 9);
+        print_uint_column(ctr.read_cycles, 11);
+        print_uint_column(ctr.stall_cycles, 9);
+        for (int k = 0; k < RVLIB_BUSMON_NUM_BUCKETS; k++) {
+            print_uint_column(ctr.hist[k], 9);
+        }
+        print_endln();
+    }
+
+    rvlib_busmon_reset();
+}
+
+
+static int run_command(const char *cmdbuf);
+
+/*
+ * Handle "busstat" command.
+ *
+ * Without argument, show the bus monitor counters since the previous
+ * "busstat" command. With a command as argument, reset the counters,
+ * run the command, then show the counters for just that command.
+ */
+static int busstat_command(const char *cmdbuf)
+{
+    int ret = 0;
+    if (!rvlib_busmon_present()) {
+        print_str("ERROR: bus monitor not present\r\n");
+        return 0;
+    }
+    if (*cmdbuf == ' ') {
+        rvlib_busmon_reset();
+        ret = run_command(cmdbuf + 1);
+        if (ret < 0) {
+            return ret;
+        }
+    } else if (*cmdbuf != '\0') {
+        return -1;
+    }
+    show_busstat();
+    return ret;
+}
+
+
 void show_help(void)
 {
     print_str(
@@ -739,15 +1541,85 @@ void show_help(void)
         "  testgpio                 - Test GPIO input/output\r\n"
         "  testmem                  - Test simple memory access\r\n"
         "  spiflash ...             - SPI flash command\r\n"
+        "  fpga ...                 - FPGA configuration and update command\r\n"
         "  hexboot                  - Load and execute HEX file\r\n"
+        "  gdb                      - Start GDB remote stub\r\n"
+        "  busstat [command]        - Show peripheral bus statistics\r\n"
         "\r\n");
 }
 
 
+/*
+ * Execute a command.
+ * Return 1 to report OK, -1 if the command is unknown, 0 otherwise.
+ */
+static int run_command(const char *cmdbuf)
+{
+    int ret = 0;
+
+    if (strncmp(cmdbuf, "help", 5) == 0) {
+        show_help();
+    } else if (strncmp(cmdbuf, "echo on", 8) == 0) {
+        cmd_echo = 1;
+        ret = 1;
+    } else if (strncmp(cmdbuf, "echo off", 9) == 0) {
+        cmd_echo = 0;
+        ret = 1;
+    } else if (strncmp(cmdbuf, "led ", 4) == 0) {
+        ret = set_led_subcommand(cmdbuf + 4);
+    } else if (strncmp(cmdbuf, "rdcycle", 8) == 0) {
+        show_rdcycle();
+    } else if (strncmp(cmdbuf, "getgpio", 8) == 0) {
+        show_gpio_input();
+    } else if (strncmp(cmdbuf, "watchgpio", 10) == 0) {
+        watch_gpio_input();
+    } else if (strncmp(cmdbuf, "setgpio", 7) == 0) {
+        ret = set_gpio_subcommand(cmdbuf + 7);
+    } else if (strncmp(cmdbuf, "testgpio", 9) == 0) {
+        test_gpio_inout();
+    } else if (strncmp(cmdbuf, "testmem", 8) == 0) {
+        test_mem_access();
+    } else if (strncmp(cmdbuf, "spiflash", 8) == 0) {
+        ret = spiflash_subcommand(cmdbuf + 8);
+    } else if (strncmp(cmdbuf, "fpga", 4) == 0) {
+        ret = fpga_subcommand(cmdbuf + 4);
+    } else if (BOOTMON_REQUIRE_SIGNED
+               && (strncmp(cmdbuf, "hexboot", 8) == 0
+                   || strncmp(cmdbuf, "gdb", 4) == 0)) {
+        print_str("ERROR: disabled, only signed images are accepted\r\n");
+    } else if (strncmp(cmdbuf, "hexboot", 8) == 0) {
+        do_hexboot();
+    } else if (strncmp(cmdbuf, "gdb", 4) == 0) {
+        do_gdbstub();
+    } else if (strncmp(cmdbuf, "busstat", 7) == 0) {
+        ret = busstat_command(cmdbuf + 7);
+    } else if (cmdbuf[0] != '\0') {
+        ret = -1;
+    }
+
+    return ret;
+}
+
+
+/*
+ * Enable or disable the UART debug bridge.
+ *
+ * The bridge is enabled only while the boot monitor waits for a command.
+ * Commands may transfer binary data which could contain the escape
+ * sequence of the bridge. A boot monitor that requires signed images
+ * locks the bridge at startup instead.
+ */
+static void set_debug_bridge(int enable)
+{
+    if (!BOOTMON_REQUIRE_SIGNED) {
+        rvlib_uart_set_debug_bridge(RVSYS_ADDR_UART, enable);
+    }
+}
+
+
 void command_loop(void)
 {
-    static char cmdbuf[80];
-    int cmd_echo = 1;
+    static char cmdbuf[160];
 
     while (1) {
 
@@ -755,7 +1627,9 @@ void command_loop(void)
         print_str(">> ");
 
         // Read command.
+        set_debug_bridge(1);
         read_command(cmdbuf, sizeof(cmdbuf), cmd_echo);
+        set_debug_bridge(0);
         if (cmd_echo) {
             print_endln();
         }
@@ -763,37 +1637,7 @@ void command_loop(void)
         // Process command.
         simplify_command(cmdbuf);
 
-        int ret = 0;
-
-        if (strncmp(cmdbuf, "help", sizeof(cmdbuf)) == 0) {
-            show_help();
-        } else if (strncmp(cmdbuf, "echo on", sizeof(cmdbuf)) == 0) {
-            cmd_echo = 1;
-            ret = 1;
-        } else if (strncmp(cmdbuf, "echo off", sizeof(cmdbuf)) == 0) {
-            cmd_echo = 0;
-            ret = 1;
-        } else if (strncmp(cmdbuf, "led ", 4) == 0) {
-            ret = set_led_subcommand(cmdbuf + 4);
-        } else if (strncmp(cmdbuf, "rdcycle", sizeof(cmdbuf)) == 0) {
-            show_rdcycle();
-        } else if (strncmp(cmdbuf, "getgpio", sizeof(cmdbuf)) == 0) {
-            show_gpio_input();
-        } else if (strncmp(cmdbuf, "watchgpio", sizeof(cmdbuf)) == 0) {
-            watch_gpio_input();
-        } else if (strncmp(cmdbuf, "setgpio", 7) == 0) {
-            ret = set_gpio_subcommand(cmdbuf + 7);
-        } else if (strncmp(cmdbuf, "testgpio", sizeof(cmdbuf)) == 0) {
-            test_gpio_inout();
-        } else if (strncmp(cmdbuf, "testmem", sizeof(cmdbuf)) == 0) {
-            test_mem_access();
-        } else if (strncmp(cmdbuf, "spiflash", 8) == 0) {
-            ret = spiflash_subcommand(cmdbuf + 8);
-        } else if (strncmp(cmdbuf, "hexboot", sizeof(cmdbuf)) == 0) {
-            do_hexboot();
-        } else if (cmdbuf[0] != '\0') {
-            ret = -1;
-        }
+        int ret = run_command(cmdbuf);
 
         if (ret < 0) {
             print_str("ERROR: unknown command\r\n");
@@ -811,6 +1655,12 @@ int main(void)
     usleep(10000);
     rvlib_set_red_led(0);
 
+    clear_gdbstub_magic();
+
+    if (BOOTMON_REQUIRE_SIGNED) {
+        rvlib_uart_lock_debug_bridge(RVSYS_ADDR_UART);
+    }
+
     show_help();
     command_loop();
 
@@ -0,0 +1,747 @@
+/*
+ * GDB remote serial protocol stub.
+ *
+ * This program lets GDB load, run and debug programs via the serial port,
+ * without JTAG and without OpenOCD. The boot monitor contains a binary
+ * copy of the stub and starts it with the "gdb" command.
+ *
+ * The stub runs from the last 8 kByte of RAM (see "gdbstub.h").
+ * Programs must be linked such that they leave this area free.
+ *
+ * Supported packets:
+ *   ?, g, G, p, P, m, M, X, c, s, Z0, z0, D, k, H,
+ *   qSupported, qAttached, QStartNoAckMode
+ *
+ * Software breakpoints use a misaligned load instruction, because
+ * this processor sends EBREAK to the JTAG debug plugin.
+ * Single-step is implemented by placing temporary breakpoints on
+ * all possible next instructions.
+ *
+ * Breakpoints only work if traps in the debugged program reach the stub.
+ * That happens through the default "handle_unexpected_trap" in rvlib,
+ * or through the dummy trap vector of a program without trap handling,
+ * which the stub redirects to itself.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_uart.h"
+#include "gdbstub.h"
+
+
+/* Maximum packet size (data between '$' and '#'). */
+#define PACKET_SIZE     1024
+
+/* Maximum number of breakpoints, including temporary breakpoints. */
+#define MAX_BREAKPOINTS 16
+
+/* Register numbers as used by GDB: x0 ... x31, pc. */
+#define NUM_REGS        33
+#define REG_PC          32
+
+/* Signal numbers reported to GDB. */
+#define SIGNAL_INT      2
+#define SIGNAL_ILL      4
+#define SIGNAL_TRAP     5
+#define SIGNAL_BUS      10
+
+/* End of RAM (the stub area is at the end of RAM). */
+#define RAM_END         (GDBSTUB_ADDR + GDBSTUB_SIZE)
+
+/* Dummy trap vector "j ." of a program without trap handling. */
+#define TRAP_VECTOR_ADDR        (RVSYS_ADDR_FASTRAM + 0x20)
+#define TRAP_VECTOR_DUMMY_INSN  0x0000006f
+
+
+/* Registers of the debugged program (saved by "gdbstub_entry.S"). */
+uint32_t gdbstub_regs[NUM_REGS];
+
+struct breakpoint {
+    uint32_t addr;
+    uint32_t insn;
+    uint8_t  used;
+    uint8_t  temporary;
+};
+
+static struct breakpoint breakpoints[MAX_BREAKPOINTS];
+
+static char packet_buf[PACKET_SIZE + 1];
+static int ack_mode;
+static int last_signal;
+
+static const char hexdigits[] = "0123456789abcdef";
+
+
+/* Send a byte to the serial port. */
+static void put_byte(int c)
+{
+    rvlib_uart_send_byte(RVSYS_ADDR_UART, c);
+}
+
+
+/* Wait for a byte from the serial port. */
+static int get_byte(void)
+{
+    int c;
+    do {
+        c = rvlib_uart_recv_byte(RVSYS_ADDR_UART);
+    } while (c < 0);
+    return c;
+}
+
+
+/* Return value of hex digit, or -1 if not a hex digit. */
+static int hexval(int c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else {
+        return -1;
+    }
+}
+
+
+/*
+ * Parse a hex number. Update *p to point after the number.
+ * Return 0 if there were no hex digits.
+ */
+static int parse_hex(const char **p, uint32_t *val)
+{
+    const char *s = *p;
+    uint32_t v = 0;
+    int h;
+    while ((h = hexval(*s)) >= 0) {
+        v = (v << 4) | h;
+        s++;
+    }
+    *val = v;
+    int ok = (s != *p);
+    *p = s;
+    return ok;
+}
+
+
+/* Write a 32-bit value as 8 hex digits in little-endian byte order. */
+static char * put_hex_le32(char *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        *p++ = hexdigits[(v >> 4) & 15];
+        *p++ = hexdigits[v & 15];
+        v >>= 8;
+    }
+    return p;
+}
+
+
+/* Parse 8 hex digits as a 32-bit value in little-endian byte order. */
+static int parse_hex_le32(const char **p, uint32_t *val)
+{
+    const char *s = *p;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        int h1 = hexval(s[0]);
+        int h2 = (h1 < 0) ? -1 : hexval(s[1]);
+        if (h2 < 0) {
+            return 0;
+        }
+        v |= (uint32_t)((h1 << 4) | h2) << (8 * i);
+        s += 2;
+    }
+    *val = v;
+    *p = s;
+    return 1;
+}
+
+
+/*
+ * Receive a packet into packet_buf.
+ * Send acknowledgement (when enabled) and return the packet length.
+ */
+static size_t recv_packet(void)
+{
+    while (1) {
+
+        // Wait for start of packet; ignore everything else.
+        int c;
+        do {
+            c = get_byte();
+        } while (c != '$');
+
+        // Receive packet data and calculate checksum.
+        size_t len = 0;
+        uint8_t csum = 0;
+        while (1) {
+            c = get_byte();
+            if (c == '#' || c == '$') {
+                break;
+            }
+            csum += c;
+            if (len < PACKET_SIZE) {
+                packet_buf[len] = c;
+            }
+            len++;
+        }
+        if (c == '$') {
+            // Restart of packet; drop partial data.
+            continue;
+        }
+
+        // Receive checksum.
+        int h1 = hexval(get_byte());
+        int h2 = hexval(get_byte());
+
+        if (!ack_mode) {
+            if (len <= PACKET_SIZE) {
+                packet_buf[len] = '\0';
+                return len;
+            }
+            continue;
+        }
+
+        if (h1 < 0 || h2 < 0 || ((h1 << 4) | h2) != csum
+                || len > PACKET_SIZE) {
+            put_byte('-');
+            continue;
+        }
+
+        put_byte('+');
+        packet_buf[len] = '\0';
+        return len;
+    }
+}
+
+
+/* Send a packet and wait for acknowledgement (when enabled). */
+static void send_packet(const char *data, size_t len)
+{
+    while (1) {
+        uint8_t csum = 0;
+        put_byte('$');
+        for (size_t i = 0; i < len; i++) {
+            put_byte(data[i]);
+            csum += data[i];
+        }
+        put_byte('#');
+        put_byte(hexdigits[csum >> 4]);
+        put_byte(hexdigits[csum & 15]);
+
+        if (!ack_mode) {
+            return;
+        }
+
+        // Wait for acknowledgement; retransmit on '-'.
+        int c;
+        do {
+            c = get_byte();
+        } while (c != '+' && c != '-');
+        if (c == '+') {
+            return;
+        }
+    }
+}
+
+
+static void send_str(const char *s)
+{
+    size_t len = 0;
+    while (s[len] != '\0') {
+        len++;
+    }
+    send_packet(s, len);
+}
+
+
+/* Send stop reply "Sxx". */
+static void send_stop_reply(void)
+{
+    char buf[3];
+    buf[0] = 'S';
+    buf[1] = hexdigits[(last_signal >> 4) & 15];
+    buf[2] = hexdigits[last_signal & 15];
+    send_packet(buf, 3);
+}
+
+
+/* Return 1 if the address range is in RAM and may be read. */
+static int mem_readable(uint32_t addr, uint32_t len)
+{
+    return (addr >= RVSYS_ADDR_FASTRAM)
+           && (addr <= RAM_END)
+           && (len <= RAM_END - addr);
+}
+
+
+/* Return 1 if the address range is in RAM and outside the stub area. */
+static int mem_writable(uint32_t addr, uint32_t len)
+{
+    return (addr >= RVSYS_ADDR_FASTRAM)
+           && (addr <= GDBSTUB_ADDR)
+           && (len <= GDBSTUB_ADDR - addr);
+}
+
+
+/* Find breakpoint at the specified address, or return NULL. */
+static struct breakpoint * find_breakpoint(uint32_t addr)
+{
+    for (int i = 0; i < MAX_BREAKPOINTS; i++) {
+        if (breakpoints[i].used && breakpoints[i].addr == addr) {
+            return &breakpoints[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*
+ * Insert a breakpoint.
+ * Return 0 if OK, -1 if the breakpoint can not be inserted.
+ */
+static int insert_breakpoint(uint32_t addr, int temporary)
+{
+    if ((addr & 3) != 0 || !mem_writable(addr, 4)) {
+        return -1;
+    }
+
+    struct breakpoint *bp = find_breakpoint(addr);
+    if (bp != NULL) {
+        // A temporary breakpoint becomes permanent when GDB inserts it.
+        if (!temporary) {
+            bp->temporary = 0;
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < MAX_BREAKPOINTS; i++) {
+        bp = &breakpoints[i];
+        if (!bp->used) {
+            volatile uint32_t *p = (volatile uint32_t *)addr;
+            bp->addr = addr;
+            bp->insn = *p;
+            bp->used = 1;
+            bp->temporary = temporary;
+            *p = GDBSTUB_BREAK_INSN;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+
+/* Remove a breakpoint and restore the original instruction. */
+static void remove_breakpoint(struct breakpoint *bp)
+{
+    volatile uint32_t *p = (volatile uint32_t *)bp->addr;
+    if (*p == GDBSTUB_BREAK_INSN) {
+        *p = bp->insn;
+    }
+    bp->used = 0;
+}
+
+
+/* Remove temporary breakpoints, or all breakpoints. */
+static void remove_breakpoints(int all)
+{
+    for (int i = 0; i < MAX_BREAKPOINTS; i++) {
+        struct breakpoint *bp = &breakpoints[i];
+        if (bp->used && (all || bp->temporary)) {
+            remove_breakpoint(bp);
+        }
+    }
+}
+
+
+/* Sign-extend the lowest "bits" bits of a value. */
+static uint32_t sign_extend(uint32_t v, int bits)
+{
+    uint32_t m = (uint32_t)1 << (bits - 1);
+    v &= (m << 1) - 1;
+    return (v ^ m) - m;
+}
+
+
+/*
+ * Place temporary breakpoints on the instructions that may execute after
+ * the instruction at the current program counter.
+ */
+static void prepare_single_step(void)
+{
+    uint32_t pc = gdbstub_regs[REG_PC];
+    uint32_t insn = *(volatile uint32_t *)pc;
+    uint32_t opcode = insn & 0x7f;
+    uint32_t rs1 = (insn >> 15) & 31;
+
+    if (opcode == 0x6f) {
+        // JAL
+        uint32_t imm = ((insn >> 11) & 0x100000)
+                       | (insn & 0xff000)
+                       | ((insn >> 9) & 0x800)
+                       | ((insn >> 20) & 0x7fe);
+        insert_breakpoint(pc + sign_extend(imm, 21), 1);
+    } else if (opcode == 0x67) {
+        // JALR
+        uint32_t imm = sign_extend(insn >> 20, 12);
+        insert_breakpoint((gdbstub_regs[rs1] + imm) & ~(uint32_t)1, 1);
+    } else if (opcode == 0x63) {
+        // Conditional branch.
+        uint32_t imm = ((insn >> 19) & 0x1000)
+                       | ((insn << 4) & 0x800)
+                       | ((insn >> 20) & 0x7e0)
+                       | ((insn >> 7) & 0x1e);
+        insert_breakpoint(pc + sign_extend(imm, 13), 1);
+        insert_breakpoint(pc + 4, 1);
+    } else {
+        insert_breakpoint(pc + 4, 1);
+    }
+}
+
+
+/*
+ * Redirect the dummy trap vector of the program to the stub,
+ * so that breakpoints work in programs without trap handling.
+ */
+static void redirect_trap_vector(void)
+{
+    volatile uint32_t *p = (volatile uint32_t *)TRAP_VECTOR_ADDR;
+    if (*p == TRAP_VECTOR_DUMMY_INSN) {
+        uint32_t off = GDBSTUB_ADDR + GDBSTUB_OFS_RAWTRAP - TRAP_VECTOR_ADDR;
+        *p = ((off & 0x100000) << 11)
+             | ((off & 0x7fe) << 20)
+             | ((off & 0x800) << 9)
+             | (off & 0xff000)
+             | 0x6f;
+    }
+}
+
+
+/* Handle "g": read all registers. */
+static void cmd_read_regs(void)
+{
+    char *p = packet_buf;
+    for (int i = 0; i < NUM_REGS; i++) {
+        p = put_hex_le32(p, gdbstub_regs[i]);
+    }
+    send_packet(packet_buf, p - packet_buf);
+}
+
+
+/* Handle "G": write all registers. */
+static void cmd_write_regs(const char *p)
+{
+    uint32_t v[NUM_REGS];
+    for (int i = 0; i < NUM_REGS; i++) {
+        if (!parse_hex_le32(&p, &v[i])) {
+            send_str("E01");
+            return;
+        }
+    }
+    for (int i = 1; i < NUM_REGS; i++) {
+        gdbstub_regs[i] = v[i];
+    }
+    send_str("OK");
+}
+
+
+/* Handle "p n": read one register. */
+static void cmd_read_reg(const char *p)
+{
+    uint32_t n;
+    if (!parse_hex(&p, &n)) {
+        send_str("E01");
+        return;
+    }
+    if (n < NUM_REGS) {
+        char *q = put_hex_le32(packet_buf, gdbstub_regs[n]);
+        send_packet(packet_buf, q - packet_buf);
+    } else {
+        // Register not available (CSR, FPU).
+        send_str("xxxxxxxx");
+    }
+}
+
+
+/* Handle "P n=v": write one register. */
+static void cmd_write_reg(const char *p)
+{
+    uint32_t n, v;
+    if (!parse_hex(&p, &n) || *p != '=') {
+        send_str("E01");
+        return;
+    }
+    p++;
+    if (n >= NUM_REGS || !parse_hex_le32(&p, &v)) {
+        send_str("E01");
+        return;
+    }
+    if (n != 0) {
+        gdbstub_regs[n] = v;
+    }
+    send_str("OK");
+}
+
+
+/* Handle "m addr,len": read memory. */
+static void cmd_read_mem(const char *p)
+{
+    uint32_t addr, len;
+    if (!parse_hex(&p, &addr) || *p++ != ','
+            || !parse_hex(&p, &len)) {
+        send_str("E01");
+        return;
+    }
+    if (len > PACKET_SIZE / 2) {
+        len = PACKET_SIZE / 2;
+    }
+    if (!mem_readable(addr, len)) {
+        send_str("E02");
+        return;
+    }
+    const volatile uint8_t *src = (const volatile uint8_t *)addr;
+    char *q = packet_buf;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t b = src[i];
+        *q++ = hexdigits[b >> 4];
+        *q++ = hexdigits[b & 15];
+    }
+    send_packet(packet_buf, q - packet_buf);
+}
+
+
+/* Handle "M addr,len:data" (hex) or "X addr,len:data" (binary). */
+static void cmd_write_mem(const char *p, const char *end, int binary)
+{
+    uint32_t addr, len;
+    if (!parse_hex(&p, &addr) || *p++ != ','
+            || !parse_hex(&p, &len) || *p++ != ':') {
+        send_str("E01");
+        return;
+    }
+    if (!mem_writable(addr, len)) {
+        send_str("E02");
+        return;
+    }
+
+    volatile uint8_t *dst = (volatile uint8_t *)addr;
+    for (uint32_t i = 0; i < len; i++) {
+        int b;
+        if (binary) {
+            if (p >= end) {
+                break;
+            }
+            b = (uint8_t)*p++;
+            if (b == 0x7d && p < end) {
+                // Escaped byte.
+                b = (uint8_t)*p++ ^ 0x20;
+            }
+        } else {
+            int h1 = (p + 1 < end) ? hexval(p[0]) : -1;
+            int h2 = (h1 < 0) ? -1 : hexval(p[1]);
+            if (h2 < 0) {
+                break;
+            }
+            b = (h1 << 4) | h2;
+            p += 2;
+        }
+        dst[i] = b;
+    }
+
+    send_str("OK");
+}
+
+
+/* Handle "Z0,addr,kind" or "z0,addr,kind". */
+static void cmd_breakpoint(const char *p, int insert)
+{
+    uint32_t type, addr;
+    if (!parse_hex(&p, &type) || *p++ != ','
+            || !parse_hex(&p, &addr)) {
+        send_str("E01");
+        return;
+    }
+    if (type != 0) {
+        // Only software breakpoints are supported.
+        send_str("");
+        return;
+    }
+
+    if (insert) {
+        if (insert_breakpoint(addr, 0) != 0) {
+            send_str("E02");
+            return;
+        }
+    } else {
+        struct breakpoint *bp = find_breakpoint(addr);
+        if (bp != NULL) {
+            remove_breakpoint(bp);
+        }
+    }
+    send_str("OK");
+}
+
+
+/* Return 1 if the packet starts with the specified string. */
+static int packet_is(const char *p, const char *s)
+{
+    while (*s != '\0') {
+        if (*p != *s) {
+            return 0;
+        }
+        p++;
+        s++;
+    }
+    return 1;
+}
+
+
+/* Handle "q..." and "Q..." packets. */
+static void cmd_query(const char *p)
+{
+    if (packet_is(p, "qSupported")) {
+        send_str("PacketSize=400;QStartNoAckMode+");
+    } else if (packet_is(p, "qAttached")) {
+        // The program existed before GDB connected.
+        send_str("1");
+    } else if (packet_is(p, "QStartNoAckMode")) {
+        send_str("OK");
+        ack_mode = 0;
+    } else {
+        send_str("");
+    }
+}
+
+
+/*
+ * Process GDB commands until GDB tells the program to continue.
+ * Then return to let the entry code resume the program.
+ */
+static void command_loop(void)
+{
+    while (1) {
+        size_t len = recv_packet();
+        const char *p = packet_buf;
+        const char *end = packet_buf + len;
+        char cmd = *p++;
+
+        switch (cmd) {
+            case '?':
+                send_stop_reply();
+                break;
+            case 'g':
+                cmd_read_regs();
+                break;
+            case 'G':
+                cmd_write_regs(p);
+                break;
+            case 'p':
+                cmd_read_reg(p);
+                break;
+            case 'P':
+                cmd_write_reg(p);
+                break;
+            case 'm':
+                cmd_read_mem(p);
+                break;
+            case 'M':
+                cmd_write_mem(p, end, 0);
+                break;
+            case 'X':
+                cmd_write_mem(p, end, 1);
+                break;
+            case 'Z':
+                cmd_breakpoint(p, 1);
+                break;
+            case 'z':
+                cmd_breakpoint(p, 0);
+                break;
+            case 'H':
+                send_str("OK");
+                break;
+            case 'q':
+            case 'Q':
+                cmd_query(p - 1);
+                break;
+            case 'c':
+            case 's': {
+                uint32_t addr;
+                if (parse_hex(&p, &addr)) {
+                    gdbstub_regs[REG_PC] = addr;
+                }
+                if (cmd == 's') {
+                    prepare_single_step();
+                }
+                redirect_trap_vector();
+                return;
+            }
+            case 'D':
+                send_str("OK");
+                remove_breakpoints(1);
+                ack_mode = 1;
+                return;
+            case 'k':
+                // Forget the program state; wait for a new session.
+                remove_breakpoints(1);
+                for (int i = 0; i < NUM_REGS; i++) {
+                    gdbstub_regs[i] = 0;
+                }
+                gdbstub_regs[REG_PC] = RVSYS_ADDR_FASTRAM;
+                ack_mode = 1;
+                break;
+            default:
+                // Unsupported packet; includes "v..." packets.
+                send_str("");
+                break;
+        }
+    }
+}
+
+
+/* Called from the entry code when the debugged program traps. */
+void gdbstub_handle_trap(uint32_t cause, uint32_t badaddr)
+{
+    uint32_t pc = gdbstub_regs[REG_PC];
+    (void)badaddr;
+
+    if ((cause & 0x80000000) != 0) {
+        // Unhandled interrupt.
+        last_signal = SIGNAL_INT;
+    } else if (cause == GDBSTUB_CAUSE_LOAD_MISALIGNED
+               && mem_readable(pc, 4)
+               && *(volatile uint32_t *)pc == GDBSTUB_BREAK_INSN) {
+        last_signal = SIGNAL_TRAP;
+    } else if (cause == 2) {
+        last_signal = SIGNAL_ILL;
+    } else if (cause == 0 || cause == 4 || cause == 6) {
+        last_signal = SIGNAL_BUS;
+    } else {
+        last_signal = SIGNAL_TRAP;
+    }
+
+    remove_breakpoints(0);
+    send_stop_reply();
+    command_loop();
+}
+
+
+/* Called from the entry code when the boot monitor starts the stub. */
+void gdbstub_main(void)
+{
+    gdbstub_regs[REG_PC] = RVSYS_ADDR_FASTRAM;
+    ack_mode = 1;
+    last_signal = SIGNAL_TRAP;
+    command_loop();
+}
+
+/* end */
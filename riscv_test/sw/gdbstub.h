@@ -0,0 +1,52 @@
+/*
+ * Definitions shared between the GDB stub and the programs it debugs.
+ *
+ * The GDB stub runs from a fixed area at the end of RAM. Programs that
+ * are loaded and debugged via the stub must leave this area free,
+ * for example by linking with "-Wl,--defsym=__ram_size=56k".
+ *
+ * This file is included from C and assembler code.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef GDBSTUB_H_
+#define GDBSTUB_H_
+
+/* Memory area reserved for the GDB stub (code, data and stack). */
+#define GDBSTUB_ADDR            0x8000e000
+#define GDBSTUB_SIZE            0x2000
+
+/*
+ * Layout of the start of the GDB stub area:
+ *   GDBSTUB_ADDR + 0:  entry point used by the boot monitor
+ *   GDBSTUB_ADDR + 4:  magic word GDBSTUB_MAGIC while the stub is resident;
+ *                      the boot monitor clears it before loading other programs
+ *   GDBSTUB_ADDR + 8:  trap entry, called from "handle_unexpected_trap"
+ *                      with the caller-save registers pushed on the stack
+ *   GDBSTUB_ADDR + 12: raw trap entry, jumped to from the trap vector
+ */
+#define GDBSTUB_MAGIC           0x42444752
+#define GDBSTUB_OFS_MAGIC       4
+#define GDBSTUB_OFS_TRAP        8
+#define GDBSTUB_OFS_RAWTRAP     12
+
+/*
+ * Software breakpoint instruction: "lw x0, 1(x0)".
+ *
+ * The processor sends EBREAK to the JTAG debug plugin, and it does not
+ * trap illegal instructions. A misaligned load does trap via mtvec,
+ * so the stub uses that as its breakpoint instruction.
+ */
+#define GDBSTUB_BREAK_INSN      0x00102003
+
+/* Trap cause for a misaligned load. */
+#define GDBSTUB_CAUSE_LOAD_MISALIGNED   4
+
+#endif  // GDBSTUB_H_
@@ -18,6 +18,10 @@
 #include <cmath>
 #include <vector>
 
+extern "C" {
+#include "rvlib_time.h"
+}
+
 using namespace std;
 
 
@@ -92,7 +96,11 @@ Circle circle(9);
 
 int main()
 {
+    uint32_t main_cycle = get_cycle_counter();
+
     printf("RISC-V test with C++\n");
+    printf("cycles from reset to main: %lu\n",
+           (unsigned long)(main_cycle - rvlib_start_cycle));
 
     // Fun with classes.
     Rectangle rect(4, 5);
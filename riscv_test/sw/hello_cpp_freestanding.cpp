@@ -0,0 +1,215 @@
+/*
+ * Test program for C++ on RISC-V without PicoLibC.
+ *
+ * This is the same test as "hello_cpp.cpp", but built in freestanding
+ * mode with the minimal C++ runtime from "rvlib_cxx.h". It does not use
+ * the C++ standard library, RTTI or floating point formatting.
+ *
+ * The program reports the number of clock cycles from reset to main().
+ * Compare with "hello_cpp.elf" to see the cost of PicoLibC:
+ *   riscv32-none-elf-size hello_cpp.elf hello_cpp_freestanding.elf
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_cxx.h"
+
+extern "C" {
+#include "rvlib_heap.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+}
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char buf[12];
+    char *p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+static void print_hex(uintptr_t val)
+{
+    print_str("0x");
+    for (int i = 28; i >= 0; i -= 4) {
+        rvlib_putchar("0123456789abcdef"[(val >> i) & 15]);
+    }
+}
+
+
+class Shape {
+  public:
+    Shape();
+    virtual ~Shape();
+    virtual unsigned int area() const = 0;
+    virtual const char * name() const = 0;
+};
+
+
+class Rectangle : public Shape {
+  public:
+    Rectangle(int length, int width);
+    virtual unsigned int area() const;
+    virtual const char * name() const;
+  private:
+    int _length, _width;
+};
+
+
+class Circle : public Shape {
+  public:
+    Circle(int radius);
+    virtual unsigned int area() const;
+    virtual const char * name() const;
+  private:
+    int _radius;
+};
+
+
+Shape::Shape()
+{
+    print_str("constructing shape at ");
+    print_hex((uintptr_t)this);
+    print_str("\r\n");
+}
+
+
+Shape::~Shape()
+{
+    print_str("destructing shape at ");
+    print_hex((uintptr_t)this);
+    print_str("\r\n");
+}
+
+
+Rectangle::Rectangle(int length, int width)
+  : _length(length)
+  , _width(width)
+{
+    print_str("constructing ");
+    print_uint(_length);
+    print_str("x");
+    print_uint(_width);
+    print_str(" rectangle\r\n");
+}
+
+
+unsigned int Rectangle::area() const
+{
+    return _length * _width;
+}
+
+
+const char * Rectangle::name() const
+{
+    return "rectangle";
+}
+
+
+Circle::Circle(int radius)
+  : _radius(radius)
+{
+    print_str("constructing circle R=");
+    print_uint(_radius);
+    print_str("\r\n");
+}
+
+
+unsigned int Circle::area() const
+{
+    // Approximate pi as 355/113.
+    return (355 * _radius * _radius + 56) / 113;
+}
+
+
+const char * Circle::name() const
+{
+    return "circle";
+}
+
+
+// Test static initialization.
+Circle circle(9);
+
+
+// Test function-local static object (guard variable).
+static Shape& unit_square()
+{
+    static Rectangle square(1, 1);
+    return square;
+}
+
+
+int main()
+{
+    uint32_t main_cycle = get_cycle_counter();
+
+    print_str("RISC-V test with freestanding C++\r\n");
+    print_str("cycles from reset to main: ");
+    print_uint(main_cycle - rvlib_start_cycle);
+    print_str("\r\n");
+
+    // Fun with classes.
+    Rectangle rect(4, 5);
+    print_str("area of rectangle = ");
+    print_uint(rect.area());
+    print_str("\r\n");
+
+    // Try new and delete.
+    Shape *shapes[2];
+    shapes[0] = new Circle(5);
+    shapes[1] = new Rectangle(3, 8);
+
+    for (Shape *shape : shapes) {
+        print_str("area of ");
+        print_str(shape->name());
+        print_str(" = ");
+        print_uint(shape->area());
+        print_str("\r\n");
+    }
+
+    for (Shape *shape : shapes) {
+        delete shape;
+    }
+
+    // The unit square is constructed only once.
+    for (int i = 0; i < 2; i++) {
+        print_str("area of unit square = ");
+        print_uint(unit_square().area());
+        print_str("\r\n");
+    }
+
+    print_str("free heap: ");
+    print_uint(rvlib_heap_free_bytes());
+    print_str(" bytes\r\n");
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
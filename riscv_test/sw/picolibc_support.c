@@ -70,21 +70,21 @@ ssize_t write(int fd, const void *buf, size_t count)
 
 #ifdef RVLIB_DEFAULT_UART_ADDR
 
-/* Write character to serial port. */
+/* Write character to the console. */
 static int my_stdio_putc(char c, FILE *file)
 {
     if (c == '\n')
-        rvlib_uart_send_byte(RVLIB_DEFAULT_UART_ADDR, '\r');
-    rvlib_uart_send_byte(RVLIB_DEFAULT_UART_ADDR, c);
+        rvlib_putchar('\r');
+    rvlib_putchar(c);
     return c;
 }
 
-/* Read character from serial port. */
+/* Read character from the console. */
 static int my_stdio_getc(FILE *file)
 {
     int c;
     do {
-        c = rvlib_uart_recv_byte(RVLIB_DEFAULT_UART_ADDR);
+        c = rvlib_getchar();
     } while (c < 0);
     return c;
 }
@@ -0,0 +1,112 @@
+/*
+ * Accelerator socket driver.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_accel.h"
+
+
+/* Check that the accelerator socket is present. */
+int rvlib_accel_init(void)
+{
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL);
+    if ((status >> 16) != RVLIB_ACCEL_ID) {
+        return RVLIB_ACCEL_ERR_NOTREADY;
+    }
+    return 0;
+}
+
+
+/* Start a job. */
+int rvlib_accel_submit(const struct rvlib_accel_job *job)
+{
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL);
+    if ((status & RVLIB_ACCEL_STATUS_BUSY) != 0) {
+        return RVLIB_ACCEL_ERR_NOTREADY;
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_SRC_ADDR,
+                       (uint32_t)job->src);
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_SRC_LEN,
+                       job->src_len);
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_DST_ADDR,
+                       (uint32_t)job->dst);
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_DST_LEN,
+                       job->dst_len);
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_PARAM,
+                       job->param);
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL,
+                       RVLIB_ACCEL_CTRL_START);
+
+    return 0;
+}
+
+
+/* Check whether the current job has ended. */
+int rvlib_accel_finish(size_t *out_len)
+{
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL);
+    if ((status & RVLIB_ACCEL_STATUS_BUSY) != 0) {
+        return RVLIB_ACCEL_BUSY;
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL,
+                       RVLIB_ACCEL_CTRL_CLEARDONE);
+
+    if (out_len != NULL) {
+        *out_len = rvlib_hw_read_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_DST_COUNT);
+    }
+
+    if ((status & RVLIB_ACCEL_STATUS_OVERFLOW) != 0) {
+        return RVLIB_ACCEL_ERR_OVERFLOW;
+    }
+    return 0;
+}
+
+
+/* Run a job and wait until it ends. */
+int rvlib_accel_run(const struct rvlib_accel_job *job, size_t *out_len)
+{
+    int status = rvlib_accel_submit(job);
+    if (status != 0) {
+        return status;
+    }
+    do {
+        status = rvlib_accel_finish(out_len);
+    } while (status == RVLIB_ACCEL_BUSY);
+    return status;
+}
+
+
+/* Abort the running job. */
+void rvlib_accel_abort(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CTRL,
+                       RVLIB_ACCEL_CTRL_ABORT | RVLIB_ACCEL_CTRL_CLEARDONE);
+}
+
+
+/* Return the number of clock cycles used by the last job. */
+uint32_t rvlib_accel_job_cycles(void)
+{
+    return rvlib_hw_read_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_CYCLES);
+}
+
+
+/* Enable or disable the interrupt of the accelerator socket. */
+void rvlib_accel_enable_interrupt(int enable)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_ACCEL + RVLIB_ACCEL_REG_IRQ, enable ? 1 : 0);
+}
+
+/* end */
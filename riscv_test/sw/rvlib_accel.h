@@ -0,0 +1,122 @@
+/*
+ * Accelerator socket driver.
+ *
+ * The accelerator socket runs jobs on a hardware kernel. A job reads
+ * a source buffer from RAM via DMA, streams it through the kernel,
+ * and writes the kernel output to a destination buffer in RAM.
+ * The CPU is free while the job runs.
+ *
+ * Buffers must be word-aligned, must be in on-chip RAM, and must have
+ * a length that is a multiple of 4 bytes. The source buffer must not
+ * be empty. The buffers must not be accessed until the job ends.
+ *
+ * The kernel in the default design is "accel_crc32": it copies its input
+ * and appends the CRC-32 of the data (see RVLIB_ACCEL_CRC32_xxx).
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_ACCEL_H_
+#define RVLIB_ACCEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Accelerator socket registers. */
+#define RVLIB_ACCEL_REG_CTRL        0x00
+#define RVLIB_ACCEL_REG_SRC_ADDR    0x04
+#define RVLIB_ACCEL_REG_SRC_LEN     0x08
+#define RVLIB_ACCEL_REG_DST_ADDR    0x0c
+#define RVLIB_ACCEL_REG_DST_LEN     0x10
+#define RVLIB_ACCEL_REG_DST_COUNT   0x14
+#define RVLIB_ACCEL_REG_PARAM       0x18
+#define RVLIB_ACCEL_REG_IRQ         0x1c
+#define RVLIB_ACCEL_REG_CYCLES      0x20
+#define RVLIB_ACCEL_REG_INFO        0x24
+
+/* Bits in the control register. */
+#define RVLIB_ACCEL_CTRL_START      0x01
+#define RVLIB_ACCEL_CTRL_ABORT      0x02
+#define RVLIB_ACCEL_CTRL_CLEARDONE  0x04
+#define RVLIB_ACCEL_STATUS_BUSY     0x01
+#define RVLIB_ACCEL_STATUS_DONE     0x02
+#define RVLIB_ACCEL_STATUS_OVERFLOW 0x04
+#define RVLIB_ACCEL_ID              0x4143
+
+/* Kernel parameter bits for the accel_crc32 example kernel. */
+#define RVLIB_ACCEL_CRC32_NOCOPY    0x01
+
+/* Job status. */
+#define RVLIB_ACCEL_BUSY            1
+#define RVLIB_ACCEL_ERR_OVERFLOW    (-1)
+#define RVLIB_ACCEL_ERR_NOTREADY    (-2)
+
+
+/* Description of a job. */
+struct rvlib_accel_job {
+    const void  *src;       // source buffer
+    size_t      src_len;    // source length in bytes
+    void        *dst;       // destination buffer
+    size_t      dst_len;    // destination buffer size in bytes
+    uint32_t    param;      // kernel parameter
+};
+
+
+/*
+ * Check that the accelerator socket is present.
+ *
+ * Return 0 if present, RVLIB_ACCEL_ERR_NOTREADY if not present.
+ */
+int rvlib_accel_init(void);
+
+/*
+ * Start a job.
+ *
+ * Return 0 if the job has started,
+ * RVLIB_ACCEL_ERR_NOTREADY if another job is still running.
+ */
+int rvlib_accel_submit(const struct rvlib_accel_job *job);
+
+/*
+ * Check whether the current job has ended.
+ *
+ * If the job has ended, clear the done flag (and thus the interrupt)
+ * and store the number of bytes written to the destination buffer
+ * in "*out_len" (if "out_len" is not NULL).
+ * This function does not wait. It may be called from an interrupt handler.
+ *
+ * Return RVLIB_ACCEL_BUSY while the job runs,
+ * 0 if the job ended successfully,
+ * RVLIB_ACCEL_ERR_OVERFLOW if the destination buffer was too small.
+ */
+int rvlib_accel_finish(size_t *out_len);
+
+/*
+ * Run a job and wait until it ends.
+ *
+ * Return 0 on success or a negative error code.
+ */
+int rvlib_accel_run(const struct rvlib_accel_job *job, size_t *out_len);
+
+/* Abort the running job. */
+void rvlib_accel_abort(void);
+
+/* Return the number of clock cycles used by the last job. */
+uint32_t rvlib_accel_job_cycles(void);
+
+/*
+ * Enable or disable the interrupt of the accelerator socket.
+ *
+ * When enabled, the socket raises an external interrupt when a job ends.
+ * The interrupt handler must call rvlib_accel_finish().
+ */
+void rvlib_accel_enable_interrupt(int enable);
+
+#endif  // RVLIB_ACCEL_H_
@@ -0,0 +1,32 @@
+/*
+ * Driver for the peripheral bus monitor.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_busmon.h"
+
+
+/* Read the counters of the specified slave. */
+void rvlib_busmon_read(unsigned int slave,
+                       struct rvlib_busmon_counters *ctr)
+{
+    uint32_t addr = RVSYS_ADDR_BUSMON + RVLIB_BUSMON_REG_SLAVE(slave);
+    ctr->reads          = rvlib_hw_read_reg(addr + 0x00);
+    ctr->writes         = rvlib_hw_read_reg(addr + 0x04);
+    ctr->read_cycles    = rvlib_hw_read_reg(addr + 0x08);
+    ctr->stall_cycles   = rvlib_hw_read_reg(addr + 0x0c);
+    for (int i = 0; i < RVLIB_BUSMON_NUM_BUCKETS; i++) {
+        ctr->hist[i] = rvlib_hw_read_reg(addr + 0x10 + 4 * i);
+    }
+}
+
+/* end */
@@ -0,0 +1,103 @@
+/*
+ * Driver for the peripheral bus monitor.
+ *
+ * The bus controller of the peripheral bus counts transactions for each
+ * slave: reads, writes, total read latency, stall cycles and a small
+ * histogram of read latencies. Latencies are measured in clock cycles
+ * at the bus controller, from accepting the command to the read response.
+ *
+ * Slave indices follow the order of the peripheral bus controller
+ * in the top-level design (see RVSYS_DEVBUS_xxx).
+ *
+ * The monitor is optional in the FPGA design (busmon_enable in
+ * riscv_test_top.vhd, off by default). Without it, all registers read
+ * as zero and rvlib_busmon_present() returns 0.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_BUSMON_H_
+#define RVLIB_BUSMON_H_
+
+#include <stdint.h>
+#include "rvlib_hardware.h"
+
+
+/* Bus monitor registers. */
+#define RVLIB_BUSMON_REG_SLAVE(n)       (0x20 * (n))
+#define RVLIB_BUSMON_REG_CTRL           0x400
+#define RVLIB_BUSMON_REG_CYCLES         0x404
+
+/* Bits in the control register. */
+#define RVLIB_BUSMON_CTRL_ENABLE        0x01
+#define RVLIB_BUSMON_CTRL_CLEAR         0x02
+
+/* Number of latency histogram buckets. */
+#define RVLIB_BUSMON_NUM_BUCKETS        4
+
+
+/* Counters for one slave. */
+struct rvlib_busmon_counters {
+    uint32_t reads;             // number of read transactions
+    uint32_t writes;            // number of write transactions
+    uint32_t read_cycles;       // sum of read latencies in clock cycles
+    uint32_t stall_cycles;      // cycles waiting for the slave to accept
+    uint32_t hist[RVLIB_BUSMON_NUM_BUCKETS];
+                                // reads with latency 1-2, 3-4, 5-8, 9+
+};
+
+
+/* Reset all counters to zero and start counting. */
+static inline void rvlib_busmon_reset(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_BUSMON + RVLIB_BUSMON_REG_CTRL,
+                       RVLIB_BUSMON_CTRL_ENABLE | RVLIB_BUSMON_CTRL_CLEAR);
+}
+
+/* Stop or resume counting. Counter values are kept. */
+static inline void rvlib_busmon_enable(int enable)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_BUSMON + RVLIB_BUSMON_REG_CTRL,
+                       enable ? RVLIB_BUSMON_CTRL_ENABLE : 0);
+}
+
+/*
+ * Return the number of slaves on the monitored bus,
+ * or 0 if the bus monitor is not present.
+ */
+static inline unsigned int rvlib_busmon_num_slaves(void)
+{
+    uint32_t ctrl =
+        rvlib_hw_read_reg(RVSYS_ADDR_BUSMON + RVLIB_BUSMON_REG_CTRL);
+    return (ctrl >> 8) & 0x0f;
+}
+
+/* Return non-zero if the bus monitor is present in the FPGA design. */
+static inline int rvlib_busmon_present(void)
+{
+    return rvlib_busmon_num_slaves() != 0;
+}
+
+/* Return the number of clock cycles counted since the last reset. */
+static inline uint32_t rvlib_busmon_cycles(void)
+{
+    return rvlib_hw_read_reg(RVSYS_ADDR_BUSMON + RVLIB_BUSMON_REG_CYCLES);
+}
+
+/*
+ * Read the counters of the specified slave.
+ *
+ * Counting continues while the counters are read, so values of
+ * different counters may be slightly inconsistent. Call
+ * rvlib_busmon_enable(0) first to get a consistent snapshot.
+ */
+void rvlib_busmon_read(unsigned int slave,
+                       struct rvlib_busmon_counters *ctr);
+
+#endif  // RVLIB_BUSMON_H_
@@ -0,0 +1,864 @@
+/*
+ * Fixed-capacity containers for C++ programs.
+ *
+ * These containers store their elements inside the container object.
+ * The capacity is a template parameter; the containers never allocate
+ * memory from the heap. Operations that would exceed the capacity fail
+ * and return false (or NULL), since exceptions are not available.
+ *
+ * Containers:
+ *   rvlib::static_vector<T, N>      - vector with at most N elements
+ *   rvlib::ring_buffer<T, N>        - FIFO queue with at most N elements
+ *   rvlib::intrusive_list<T>        - doubly linked list of objects
+ *                                     derived from rvlib::list_node
+ *   rvlib::hash_map<K, V, N>        - open-addressing hash table with
+ *                                     N slots (N must be a power of 2)
+ *   rvlib::small_string<N>          - string of at most N characters
+ *
+ * The containers support move semantics: moving a container moves
+ * its elements one by one (there is no heap buffer to steal).
+ *
+ * This header only needs the freestanding C++ headers <new>, <utility>
+ * and <type_traits>. It works with PicoLibC as well as with the minimal
+ * runtime of "rvlib_cxx.h", and can also be compiled on the host.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_CONTAINERS_H_
+#define RVLIB_CONTAINERS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace rvlib {
+
+
+/*
+ * Uninitialized storage for N objects of type T.
+ */
+template <typename T, size_t N>
+class raw_storage
+{
+  public:
+    T * ptr(size_t i) { return reinterpret_cast<T *>(m_buf) + i; }
+    const T * ptr(size_t i) const
+    {
+        return reinterpret_cast<const T *>(m_buf) + i;
+    }
+
+  private:
+    alignas(T) unsigned char m_buf[(N > 0 ? N : 1) * sizeof(T)];
+};
+
+
+/*
+ * Vector with fixed capacity N.
+ *
+ * Elements are stored contiguously. Iterators are plain pointers.
+ */
+template <typename T, size_t N>
+class static_vector
+{
+  public:
+    typedef T value_type;
+    typedef T * iterator;
+    typedef const T * const_iterator;
+
+    static_vector() : m_size(0) { }
+
+    static_vector(const static_vector& other) : m_size(0)
+    {
+        for (const T& v : other) {
+            new (m_data.ptr(m_size)) T(v);
+            m_size++;
+        }
+    }
+
+    static_vector(static_vector&& other) : m_size(0)
+    {
+        for (T& v : other) {
+            new (m_data.ptr(m_size)) T(std::move(v));
+            m_size++;
+        }
+        other.clear();
+    }
+
+    ~static_vector() { clear(); }
+
+    static_vector& operator=(const static_vector& other)
+    {
+        if (this != &other) {
+            clear();
+            for (const T& v : other) {
+                new (m_data.ptr(m_size)) T(v);
+                m_size++;
+            }
+        }
+        return *this;
+    }
+
+    static_vector& operator=(static_vector&& other)
+    {
+        if (this != &other) {
+            clear();
+            for (T& v : other) {
+                new (m_data.ptr(m_size)) T(std::move(v));
+                m_size++;
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == N; }
+
+    T * data() { return m_data.ptr(0); }
+    const T * data() const { return m_data.ptr(0); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + m_size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + m_size; }
+
+    T& operator[](size_t i) { return *m_data.ptr(i); }
+    const T& operator[](size_t i) const { return *m_data.ptr(i); }
+
+    T& front() { return *m_data.ptr(0); }
+    const T& front() const { return *m_data.ptr(0); }
+    T& back() { return *m_data.ptr(m_size - 1); }
+    const T& back() const { return *m_data.ptr(m_size - 1); }
+
+    /* Append an element. Return false if the vector is full. */
+    bool push_back(const T& v) { return emplace_back(v); }
+    bool push_back(T&& v) { return emplace_back(std::move(v)); }
+
+    /* Construct an element at the end. Return false if full. */
+    template <typename... Args>
+    bool emplace_back(Args&&... args)
+    {
+        if (m_size == N) {
+            return false;
+        }
+        new (m_data.ptr(m_size)) T(std::forward<Args>(args)...);
+        m_size++;
+        return true;
+    }
+
+    /* Remove the last element. The vector must not be empty. */
+    void pop_back()
+    {
+        m_size--;
+        m_data.ptr(m_size)->~T();
+    }
+
+    /*
+     * Remove the element at "pos", shifting the following elements.
+     * Return an iterator to the element after the removed element.
+     */
+    iterator erase(iterator pos)
+    {
+        iterator last = end() - 1;
+        for (iterator p = pos; p != last; ++p) {
+            *p = std::move(*(p + 1));
+        }
+        pop_back();
+        return pos;
+    }
+
+    /*
+     * Remove the element at "pos" by moving the last element into its
+     * place. Faster than erase() but does not preserve the order.
+     */
+    void erase_unordered(iterator pos)
+    {
+        iterator last = end() - 1;
+        if (pos != last) {
+            *pos = std::move(*last);
+        }
+        pop_back();
+    }
+
+    /* Remove all elements. */
+    void clear()
+    {
+        while (m_size > 0) {
+            pop_back();
+        }
+    }
+
+  private:
+    raw_storage<T, N> m_data;
+    size_t m_size;
+};
+
+
+/*
+ * FIFO ring buffer with fixed capacity N.
+ *
+ * Element 0 is the oldest element (the next one to be popped).
+ * The buffer is not safe for concurrent use by an interrupt handler
+ * and the main program.
+ */
+template <typename T, size_t N>
+class ring_buffer
+{
+  public:
+    typedef T value_type;
+
+    ring_buffer() : m_head(0), m_size(0) { }
+
+    ring_buffer(const ring_buffer& other) : m_head(0), m_size(0)
+    {
+        for (size_t i = 0; i < other.m_size; i++) {
+            push(other[i]);
+        }
+    }
+
+    ring_buffer(ring_buffer&& other) : m_head(0), m_size(0)
+    {
+        for (size_t i = 0; i < other.m_size; i++) {
+            push(std::move(other[i]));
+        }
+        other.clear();
+    }
+
+    ~ring_buffer() { clear(); }
+
+    ring_buffer& operator=(const ring_buffer& other)
+    {
+        if (this != &other) {
+            clear();
+            for (size_t i = 0; i < other.m_size; i++) {
+                push(other[i]);
+            }
+        }
+        return *this;
+    }
+
+    ring_buffer& operator=(ring_buffer&& other)
+    {
+        if (this != &other) {
+            clear();
+            for (size_t i = 0; i < other.m_size; i++) {
+                push(std::move(other[i]));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == N; }
+
+    T& operator[](size_t i) { return *m_data.ptr(wrap(m_head + i)); }
+    const T& operator[](size_t i) const
+    {
+        return *m_data.ptr(wrap(m_head + i));
+    }
+
+    T& front() { return *m_data.ptr(m_head); }
+    const T& front() const { return *m_data.ptr(m_head); }
+    T& back() { return (*this)[m_size - 1]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    /* Add an element at the end. Return false if the buffer is full. */
+    bool push(const T& v) { return emplace(v); }
+    bool push(T&& v) { return emplace(std::move(v)); }
+
+    /* Construct an element at the end. Return false if full. */
+    template <typename... Args>
+    bool emplace(Args&&... args)
+    {
+        if (m_size == N) {
+            return false;
+        }
+        new (m_data.ptr(wrap(m_head + m_size))) T(std::forward<Args>(args)...);
+        m_size++;
+        return true;
+    }
+
+    /*
+     * Move the oldest element to "v" and remove it.
+     * Return false if the buffer is empty.
+     */
+    bool pop(T& v)
+    {
+        if (m_size == 0) {
+            return false;
+        }
+        v = std::move(front());
+        pop_front();
+        return true;
+    }
+
+    /* Remove the oldest element. The buffer must not be empty. */
+    void pop_front()
+    {
+        m_data.ptr(m_head)->~T();
+        m_head = wrap(m_head + 1);
+        m_size--;
+    }
+
+    /* Remove all elements. */
+    void clear()
+    {
+        while (m_size > 0) {
+            pop_front();
+        }
+        m_head = 0;
+    }
+
+  private:
+    /* Reduce an index modulo N (cheap when N is a power of 2). */
+    static size_t wrap(size_t i)
+    {
+        if ((N & (N - 1)) == 0) {
+            return i & (N - 1);
+        } else {
+            return (i >= N) ? (i - N) : i;
+        }
+    }
+
+    raw_storage<T, N> m_data;
+    size_t m_head;
+    size_t m_size;
+};
+
+
+/*
+ * Link field for objects in an intrusive_list.
+ *
+ * Objects derive from list_node. An object can be in at most one list
+ * at a time. Copying an object does not copy its list membership.
+ * An object must be removed from its list before it is destroyed.
+ */
+class list_node
+{
+  public:
+    list_node() : m_prev(nullptr), m_next(nullptr) { }
+    list_node(const list_node&) : m_prev(nullptr), m_next(nullptr) { }
+    list_node& operator=(const list_node&) { return *this; }
+
+    /* Return true if this node is currently in a list. */
+    bool linked() const { return m_next != nullptr; }
+
+  private:
+    template <typename T> friend class intrusive_list;
+    list_node *m_prev;
+    list_node *m_next;
+};
+
+
+/*
+ * Doubly linked list of objects of type T, where T derives from list_node.
+ *
+ * The list does not own the objects; it only links them. Insertion and
+ * removal never allocate memory and take constant time.
+ */
+template <typename T>
+class intrusive_list
+{
+  public:
+    typedef T value_type;
+
+    class iterator
+    {
+      public:
+        explicit iterator(list_node *p) : m_p(p) { }
+        T& operator*() const { return *static_cast<T *>(m_p); }
+        T * operator->() const { return static_cast<T *>(m_p); }
+        iterator& operator++() { m_p = m_p->m_next; return *this; }
+        iterator& operator--() { m_p = m_p->m_prev; return *this; }
+        bool operator==(const iterator& o) const { return m_p == o.m_p; }
+        bool operator!=(const iterator& o) const { return m_p != o.m_p; }
+      private:
+        list_node *m_p;
+    };
+
+    intrusive_list() : m_size(0)
+    {
+        m_head.m_prev = &m_head;
+        m_head.m_next = &m_head;
+    }
+
+    intrusive_list(intrusive_list&& other) : intrusive_list()
+    {
+        take(other);
+    }
+
+    intrusive_list& operator=(intrusive_list&& other)
+    {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    intrusive_list(const intrusive_list&) = delete;
+    intrusive_list& operator=(const intrusive_list&) = delete;
+
+    ~intrusive_list() { clear(); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return iterator(m_head.m_next); }
+    iterator end() { return iterator(&m_head); }
+
+    T& front() { return *static_cast<T *>(m_head.m_next); }
+    T& back() { return *static_cast<T *>(m_head.m_prev); }
+
+    /* Insert "obj" before the element at "pos". */
+    void insert(iterator pos, T& obj)
+    {
+        list_node *n = &obj;
+        list_node *next = &*pos;
+        n->m_next = next;
+        n->m_prev = next->m_prev;
+        next->m_prev->m_next = n;
+        next->m_prev = n;
+        m_size++;
+    }
+
+    void push_front(T& obj) { insert(begin(), obj); }
+    void push_back(T& obj) { insert(end(), obj); }
+
+    /* Remove "obj" from the list. The object must be in this list. */
+    void remove(T& obj)
+    {
+        list_node *n = &obj;
+        n->m_prev->m_next = n->m_next;
+        n->m_next->m_prev = n->m_prev;
+        n->m_prev = nullptr;
+        n->m_next = nullptr;
+        m_size--;
+    }
+
+    /* Remove and return the first element. The list must not be empty. */
+    T& pop_front()
+    {
+        T& obj = front();
+        remove(obj);
+        return obj;
+    }
+
+    /* Unlink all elements. */
+    void clear()
+    {
+        while (m_size > 0) {
+            pop_front();
+        }
+    }
+
+  private:
+    /* Take over all elements of "other". This list must be empty. */
+    void take(intrusive_list& other)
+    {
+        if (other.m_size > 0) {
+            m_head.m_next = other.m_head.m_next;
+            m_head.m_prev = other.m_head.m_prev;
+            m_head.m_next->m_prev = &m_head;
+            m_head.m_prev->m_next = &m_head;
+            m_size = other.m_size;
+            other.m_head.m_next = &other.m_head;
+            other.m_head.m_prev = &other.m_head;
+            other.m_size = 0;
+        }
+    }
+
+    // Sentinel node: m_head.m_next is the first element.
+    list_node m_head;
+    size_t m_size;
+};
+
+
+/*
+ * String with at most N characters, stored inline.
+ *
+ * The string is always null-terminated. Appending beyond the capacity
+ * truncates the string and returns false.
+ */
+template <size_t N>
+class small_string
+{
+  public:
+    constexpr small_string() : m_len(0), m_buf{} { }
+
+    constexpr small_string(const char *s) : m_len(0), m_buf{}
+    {
+        append(s);
+    }
+
+    static constexpr size_t capacity() { return N; }
+    constexpr size_t size() const { return m_len; }
+    constexpr bool empty() const { return m_len == 0; }
+    constexpr const char * c_str() const { return m_buf; }
+
+    constexpr char operator[](size_t i) const { return m_buf[i]; }
+    char& operator[](size_t i) { return m_buf[i]; }
+
+    const char * begin() const { return m_buf; }
+    const char * end() const { return m_buf + m_len; }
+
+    constexpr void clear()
+    {
+        m_len = 0;
+        m_buf[0] = '\0';
+    }
+
+    /* Append a character. Return false if the string is full. */
+    constexpr bool append(char c)
+    {
+        if (m_len == N) {
+            return false;
+        }
+        m_buf[m_len] = c;
+        m_len++;
+        m_buf[m_len] = '\0';
+        return true;
+    }
+
+    /* Append a string. Return false if it was truncated. */
+    constexpr bool append(const char *s)
+    {
+        while (*s != '\0') {
+            if (!append(*s)) {
+                return false;
+            }
+            s++;
+        }
+        return true;
+    }
+
+    template <size_t M>
+    constexpr bool append(const small_string<M>& s)
+    {
+        return append(s.c_str());
+    }
+
+    constexpr small_string& operator+=(char c) { append(c); return *this; }
+    constexpr small_string& operator+=(const char *s)
+    {
+        append(s);
+        return *this;
+    }
+
+    constexpr bool operator==(const char *s) const
+    {
+        size_t i = 0;
+        while (i < m_len && s[i] == m_buf[i]) {
+            i++;
+        }
+        return i == m_len && s[i] == '\0';
+    }
+
+    template <size_t M>
+    constexpr bool operator==(const small_string<M>& s) const
+    {
+        return *this == s.c_str();
+    }
+
+    constexpr bool operator!=(const char *s) const { return !(*this == s); }
+
+    template <size_t M>
+    constexpr bool operator!=(const small_string<M>& s) const
+    {
+        return !(*this == s);
+    }
+
+  private:
+    size_t m_len;
+    char m_buf[N + 1];
+};
+
+
+/*
+ * Hash functions for hash_map.
+ *
+ * Integers and pointers use multiplicative (Fibonacci) hashing;
+ * strings use FNV-1a. Specialize rvlib::hash<K> for other key types.
+ */
+template <typename K, typename Enable = void>
+struct hash;
+
+template <typename K>
+struct hash<K, typename std::enable_if<std::is_integral<K>::value ||
+                                       std::is_enum<K>::value>::type>
+{
+    uint32_t operator()(K key) const
+    {
+        return (uint32_t)key * 0x9e3779b1U;
+    }
+};
+
+template <typename K>
+struct hash<K *>
+{
+    uint32_t operator()(const K *key) const
+    {
+        return (uint32_t)(uintptr_t)key * 0x9e3779b1U;
+    }
+};
+
+template <size_t N>
+struct hash<small_string<N>>
+{
+    uint32_t operator()(const small_string<N>& key) const
+    {
+        uint32_t h = 0x811c9dc5U;
+        for (char c : key) {
+            h = (h ^ (unsigned char)c) * 0x01000193U;
+        }
+        return h;
+    }
+};
+
+
+/*
+ * Hash map with N slots, using open addressing with linear probing.
+ *
+ * N must be a power of 2. The map can hold up to N entries, but
+ * lookups become slow when the map is more than about 75% full.
+ * Erased entries leave a tombstone which is reused by later inserts.
+ */
+template <typename K, typename V, size_t N, typename Hash = hash<K>>
+class hash_map
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0,
+                  "hash_map capacity must be a power of 2");
+
+  public:
+    struct entry {
+        K key;
+        V value;
+    };
+
+    class iterator
+    {
+      public:
+        iterator(hash_map *m, size_t i) : m_map(m), m_idx(i) { skip(); }
+        entry& operator*() const { return *m_map->m_slots.ptr(m_idx); }
+        entry * operator->() const { return m_map->m_slots.ptr(m_idx); }
+        iterator& operator++() { m_idx++; skip(); return *this; }
+        bool operator==(const iterator& o) const { return m_idx == o.m_idx; }
+        bool operator!=(const iterator& o) const { return m_idx != o.m_idx; }
+      private:
+        void skip()
+        {
+            while (m_idx < N && m_map->m_state[m_idx] != SLOT_USED) {
+                m_idx++;
+            }
+        }
+        hash_map *m_map;
+        size_t m_idx;
+    };
+
+    hash_map() : m_size(0), m_state{} { }
+
+    hash_map(const hash_map& other) : m_size(0), m_state{}
+    {
+        copy_from(other);
+    }
+
+    hash_map(hash_map&& other) : m_size(0), m_state{}
+    {
+        move_from(other);
+    }
+
+    ~hash_map() { clear(); }
+
+    hash_map& operator=(const hash_map& other)
+    {
+        if (this != &other) {
+            clear();
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    hash_map& operator=(hash_map&& other)
+    {
+        if (this != &other) {
+            clear();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, N); }
+
+    /* Return a pointer to the value for "key", or NULL if not found. */
+    V * find(const K& key)
+    {
+        size_t i = lookup(key);
+        return (i < N) ? &m_slots.ptr(i)->value : nullptr;
+    }
+
+    const V * find(const K& key) const
+    {
+        return const_cast<hash_map *>(this)->find(key);
+    }
+
+    bool contains(const K& key) const { return find(key) != nullptr; }
+
+    /*
+     * Insert or replace the value for "key".
+     * Return a pointer to the stored value, or NULL if the map is full.
+     */
+    V * insert(const K& key, V value)
+    {
+        size_t i = lookup(key);
+        if (i < N) {
+            m_slots.ptr(i)->value = std::move(value);
+            return &m_slots.ptr(i)->value;
+        }
+        i = free_slot(key);
+        if (i >= N) {
+            return nullptr;
+        }
+        new (m_slots.ptr(i)) entry{ key, std::move(value) };
+        m_state[i] = SLOT_USED;
+        m_size++;
+        return &m_slots.ptr(i)->value;
+    }
+
+    /*
+     * Return a reference to the value for "key", inserting
+     * a default-constructed value if the key is not present.
+     * The map must not be full.
+     */
+    V& operator[](const K& key)
+    {
+        V *p = find(key);
+        if (p == nullptr) {
+            p = insert(key, V());
+        }
+        return *p;
+    }
+
+    /* Remove "key" from the map. Return false if it was not found. */
+    bool erase(const K& key)
+    {
+        size_t i = lookup(key);
+        if (i >= N) {
+            return false;
+        }
+        m_slots.ptr(i)->~entry();
+        m_state[i] = SLOT_DELETED;
+        m_size--;
+        return true;
+    }
+
+    /* Remove all entries. */
+    void clear()
+    {
+        for (size_t i = 0; i < N; i++) {
+            if (m_state[i] == SLOT_USED) {
+                m_slots.ptr(i)->~entry();
+            }
+            m_state[i] = SLOT_EMPTY;
+        }
+        m_size = 0;
+    }
+
+  private:
+    enum { SLOT_EMPTY = 0, SLOT_USED = 1, SLOT_DELETED = 2 };
+
+    static size_t home_slot(const K& key)
+    {
+        // Use the high bits, which are best mixed by the hash function.
+        uint32_t h = Hash()(key);
+        return (N > 1) ? (h >> (32 - log2_n())) : 0;
+    }
+
+    static constexpr unsigned int log2_n()
+    {
+        unsigned int k = 0;
+        while ((size_t(1) << k) < N) {
+            k++;
+        }
+        return k;
+    }
+
+    /* Return the slot containing "key", or N if not found. */
+    size_t lookup(const K& key) const
+    {
+        size_t i = home_slot(key);
+        for (size_t n = 0; n < N; n++) {
+            if (m_state[i] == SLOT_EMPTY) {
+                break;
+            }
+            if (m_state[i] == SLOT_USED && m_slots.ptr(i)->key == key) {
+                return i;
+            }
+            i = (i + 1) & (N - 1);
+        }
+        return N;
+    }
+
+    /* Return a free slot for a new key, or N if the map is full. */
+    size_t free_slot(const K& key) const
+    {
+        size_t i = home_slot(key);
+        for (size_t n = 0; n < N; n++) {
+            if (m_state[i] != SLOT_USED) {
+                return i;
+            }
+            i = (i + 1) & (N - 1);
+        }
+        return N;
+    }
+
+    void copy_from(const hash_map& other)
+    {
+        for (size_t i = 0; i < N; i++) {
+            if (other.m_state[i] == SLOT_USED) {
+                new (m_slots.ptr(i)) entry(*other.m_slots.ptr(i));
+            }
+            m_state[i] = other.m_state[i];
+        }
+        m_size = other.m_size;
+    }
+
+    void move_from(hash_map& other)
+    {
+        for (size_t i = 0; i < N; i++) {
+            if (other.m_state[i] == SLOT_USED) {
+                new (m_slots.ptr(i)) entry(std::move(*other.m_slots.ptr(i)));
+            }
+            m_state[i] = other.m_state[i];
+        }
+        m_size = other.m_size;
+        other.clear();
+    }
+
+    size_t m_size;
+    uint8_t m_state[N];
+    raw_storage<entry, N> m_slots;
+};
+
+
+}  // namespace rvlib
+
+#endif  // RVLIB_CONTAINERS_H_
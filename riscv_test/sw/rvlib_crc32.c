@@ -0,0 +1,36 @@
+/*
+ * CRC-32 checksum.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include "rvlib_crc32.h"
+
+
+/* CRC-32 of each 4-bit value (reflected polynomial 0xedb88320). */
+static const uint32_t crc32_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+
+
+/* Update a CRC-32 checksum with the specified data. */
+uint32_t rvlib_crc32(uint32_t crc, const unsigned char *buf, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        crc = (crc >> 4) ^ crc32_table[crc & 0xf];
+        crc = (crc >> 4) ^ crc32_table[crc & 0xf];
+    }
+    return ~crc;
+}
+
+/* end */
@@ -0,0 +1,31 @@
+/*
+ * CRC-32 checksum.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_CRC32_H_
+#define RVLIB_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Update a CRC-32 checksum with the specified data.
+ *
+ * This is the standard CRC-32 as used by Ethernet, ZIP and zlib.
+ * Start with crc = 0 for the first block of data, then pass the result
+ * of each call to the next call to checksum data in several blocks.
+ *
+ * The implementation uses a 16-entry table; it is slower than
+ * a byte-wise table but takes only 64 bytes of memory.
+ */
+uint32_t rvlib_crc32(uint32_t crc, const unsigned char *buf, size_t len);
+
+#endif  // RVLIB_CRC32_H_
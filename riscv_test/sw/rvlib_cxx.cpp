@@ -0,0 +1,138 @@
+/*
+ * Minimal C++ runtime support for freestanding programs.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_cxx.h"
+
+extern "C" {
+#include "rvlib_heap.h"
+void abort(void) __attribute__ ((noreturn));
+}
+
+
+static rvlib_cxx_alloc_func cxx_alloc_func = rvlib_heap_alloc;
+static rvlib_cxx_free_func cxx_free_func = rvlib_heap_free;
+
+
+void rvlib_cxx_set_allocator(rvlib_cxx_alloc_func alloc_func,
+                             rvlib_cxx_free_func free_func)
+{
+    cxx_alloc_func = alloc_func;
+    cxx_free_func = free_func;
+}
+
+
+/*
+ * Allocation functions.
+ *
+ * Without exceptions, a failed allocation can not throw std::bad_alloc.
+ * Abort the program instead of returning NULL, since the compiler assumes
+ * that the result of operator new is never NULL.
+ */
+
+void * operator new(size_t size)
+{
+    void *p = cxx_alloc_func(size);
+    if (p == NULL) {
+        abort();
+    }
+    return p;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    cxx_free_func(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    cxx_free_func(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    cxx_free_func(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    cxx_free_func(ptr);
+}
+
+
+extern "C" {
+
+/* Called when a pure virtual function is invoked. */
+void __cxa_pure_virtual(void)
+{
+    abort();
+}
+
+/*
+ * Handle of the program image, passed by the compiler to __cxa_atexit().
+ */
+void *__dso_handle __attribute__ ((visibility ("hidden"))) = &__dso_handle;
+
+/*
+ * Called by static constructors to register the destructor.
+ * The program never exits, so the destructor is not recorded.
+ */
+int __cxa_atexit(void (*)(void *), void *, void *)
+{
+    return 0;
+}
+
+/*
+ * Guard functions for function-local static objects.
+ *
+ * The first byte of the guard variable is set to non-zero when
+ * the object is initialized (as required by the C++ ABI, since
+ * the compiler tests this byte inline). The second byte marks
+ * an initialization in progress.
+ */
+
+int __cxa_guard_acquire(uint64_t *guard)
+{
+    volatile uint8_t *g = (volatile uint8_t *)guard;
+    if (g[0] != 0) {
+        return 0;
+    }
+    if (g[1] != 0) {
+        // Recursive initialization of the same object.
+        abort();
+    }
+    g[1] = 1;
+    return 1;
+}
+
+void __cxa_guard_release(uint64_t *guard)
+{
+    volatile uint8_t *g = (volatile uint8_t *)guard;
+    g[1] = 0;
+    g[0] = 1;
+}
+
+void __cxa_guard_abort(uint64_t *guard)
+{
+    volatile uint8_t *g = (volatile uint8_t *)guard;
+    g[1] = 0;
+}
+
+}  // extern "C"
+
+/* end */
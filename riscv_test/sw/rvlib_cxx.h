@@ -0,0 +1,54 @@
+/*
+ * Minimal C++ runtime support for freestanding programs.
+ *
+ * Linking "rvlib_cxx.o" into a freestanding C++ program provides
+ * the parts of the C++ runtime that GCC expects, without PicoLibC
+ * and without libstdc++:
+ *  - operator new / delete (on top of a configurable allocator)
+ *  - __cxa_pure_virtual
+ *  - __cxa_atexit and __dso_handle
+ *  - guard functions for function-local static objects
+ *
+ * The program must be compiled with "-fno-exceptions -fno-rtti".
+ * Since exceptions are not available, operator new calls abort()
+ * when the allocator runs out of memory.
+ *
+ * Programs never exit (see _Exit()), therefore destructors of static
+ * objects are never needed. __cxa_atexit() does not register them,
+ * which saves RAM and code.
+ *
+ * Guard variables assume a single thread of execution. Initializing
+ * a function-local static object from an interrupt handler while the
+ * same object is being initialized by the main program calls abort().
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_CXX_H_
+#define RVLIB_CXX_H_
+
+#include <stddef.h>
+
+
+/* Allocator functions used by operator new and operator delete. */
+typedef void * (*rvlib_cxx_alloc_func)(size_t size);
+typedef void (*rvlib_cxx_free_func)(void *ptr);
+
+/*
+ * Select the allocator used by operator new and operator delete.
+ *
+ * The default allocator is rvlib_heap_alloc() / rvlib_heap_free()
+ * (see "rvlib_heap.h"). The allocator must be changed before the first
+ * object is allocated, otherwise the old allocator will be asked
+ * to free objects which it did not allocate.
+ */
+void rvlib_cxx_set_allocator(rvlib_cxx_alloc_func alloc_func,
+                             rvlib_cxx_free_func free_func);
+
+#endif  // RVLIB_CXX_H_
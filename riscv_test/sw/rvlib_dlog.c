@@ -0,0 +1,58 @@
+/*
+ * Deferred-formatting log messages.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include "rvlib_uart.h"
+#include "rvlib_dlog.h"
+
+
+/* Append an unsigned LEB128 number to the buffer. */
+static unsigned char * dlog_put_varint(unsigned char *p, uint32_t v)
+{
+    while (v >= 0x80) {
+        *p = (v & 0x7f) | 0x80;
+        p++;
+        v >>= 7;
+    }
+    *p = v;
+    return p + 1;
+}
+
+
+/* Send a deferred log record. */
+void rvlib_dlog_write(const uint32_t *words, unsigned int nargs)
+{
+    /* Marker byte plus up to 7 varints of up to 5 bytes. */
+    unsigned char buf[1 + 5 * (1 + RVLIB_DLOG_MAX_ARGS)];
+    unsigned char *p = buf;
+
+    *p = RVLIB_DLOG_MARKER + nargs;
+    p++;
+
+    for (unsigned int i = 0; i <= nargs; i++) {
+        p = dlog_put_varint(p, words[i]);
+    }
+
+    rvlib_dlog_output(buf, p - buf);
+}
+
+
+/* Output an encoded log record. */
+void
+__attribute__ ((weak))
+rvlib_dlog_output(const unsigned char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        rvlib_putchar(buf[i]);
+    }
+}
+
+/* end */
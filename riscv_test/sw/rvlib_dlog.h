@@ -0,0 +1,126 @@
+/*
+ * Deferred-formatting log messages.
+ *
+ * The RVLIB_DLOG() macro works like printf(), but does not format
+ * the message on the RISC-V. The format string is placed in the ELF
+ * section ".rvlib_dlog_fmt", which is not loaded into memory.
+ * Only the offset of the format string and the raw argument values
+ * are sent to the console. The host program "tools/dlog_decode"
+ * reconstructs the message text from the ELF file of the program.
+ *
+ * Each log record is encoded as follows:
+ *   1 byte:  0xf8 + number of arguments (0 to 6)
+ *   varint:  offset of the format string in ".rvlib_dlog_fmt"
+ *   varint:  each argument value as a 32-bit unsigned integer
+ *
+ * A varint is an unsigned LEB128 number (7 bits per byte, LSB first,
+ * bit 7 set in all but the last byte). Records can be mixed with
+ * normal text output, as long as that text is valid UTF-8.
+ *
+ * Restrictions:
+ *   - At most 6 arguments.
+ *   - Each argument is passed as a 32-bit word. 64-bit integers and
+ *     floating point values are not supported.
+ *   - "%s" only works for constant strings in the program image,
+ *     because the decoder reads the string from the ELF file.
+ *
+ * The linker script must contain an INFO output section
+ * for ".rvlib_dlog_fmt" at address 0.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_DLOG_H_
+#define RVLIB_DLOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Marker byte for a log record (plus number of arguments). */
+#define RVLIB_DLOG_MARKER   0xf8
+
+/* Maximum number of arguments per log record. */
+#define RVLIB_DLOG_MAX_ARGS 6
+
+
+/*
+ * Send a deferred log record.
+ *
+ * Parameters:
+ *     words:  Format string offset, followed by "nargs" argument values.
+ *     nargs:  Number of arguments.
+ *
+ * Applications should use RVLIB_DLOG() instead of calling this directly.
+ */
+void rvlib_dlog_write(const uint32_t *words, unsigned int nargs);
+
+/*
+ * Output an encoded log record.
+ *
+ * The default implementation sends each byte via rvlib_putchar().
+ * This function is implemented as a weak symbol, therefore
+ * it may be overridden by an application-specific implementation,
+ * for example to store records in a RAM buffer.
+ */
+void rvlib_dlog_output(const unsigned char *buf, size_t len);
+
+/* Dummy function which lets the compiler check format and arguments. */
+static inline void
+__attribute__ ((format (printf, 1, 2)))
+rvlib_dlog_check_format(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+
+/* Helper macros for counting and converting the arguments. */
+#define RVLIB_DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+#define RVLIB_DLOG_NARGS(...) \
+    RVLIB_DLOG_NARGS_(_0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define RVLIB_DLOG_ARG(x) ((uint32_t)(uintptr_t)(x))
+#define RVLIB_DLOG_ARGS_0()
+#define RVLIB_DLOG_ARGS_1(a) \
+    , RVLIB_DLOG_ARG(a)
+#define RVLIB_DLOG_ARGS_2(a, b) \
+    , RVLIB_DLOG_ARG(a), RVLIB_DLOG_ARG(b)
+#define RVLIB_DLOG_ARGS_3(a, b, c) \
+    , RVLIB_DLOG_ARG(a), RVLIB_DLOG_ARG(b), RVLIB_DLOG_ARG(c)
+#define RVLIB_DLOG_ARGS_4(a, b, c, d) \
+    RVLIB_DLOG_ARGS_3(a, b, c), RVLIB_DLOG_ARG(d)
+#define RVLIB_DLOG_ARGS_5(a, b, c, d, e) \
+    RVLIB_DLOG_ARGS_4(a, b, c, d), RVLIB_DLOG_ARG(e)
+#define RVLIB_DLOG_ARGS_6(a, b, c, d, e, f) \
+    RVLIB_DLOG_ARGS_5(a, b, c, d, e), RVLIB_DLOG_ARG(f)
+#define RVLIB_DLOG_CAT_(a, b) a ## b
+#define RVLIB_DLOG_CAT(a, b) RVLIB_DLOG_CAT_(a, b)
+#define RVLIB_DLOG_ARGS(...) \
+    RVLIB_DLOG_CAT(RVLIB_DLOG_ARGS_, RVLIB_DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+
+/*
+ * Send a log message with deferred formatting.
+ *
+ * Example:
+ *     RVLIB_DLOG("sensor %d: value 0x%08x\n", sensor, value);
+ */
+#define RVLIB_DLOG(fmt, ...)                                                \
+    do {                                                                    \
+        static const char rvlib_dlog_fmt_[]                                 \
+            __attribute__ ((section (".rvlib_dlog_fmt"), used)) = fmt;      \
+        if (0) {                                                            \
+            rvlib_dlog_check_format(fmt, ##__VA_ARGS__);                    \
+        }                                                                   \
+        const uint32_t rvlib_dlog_words_[] = {                              \
+            RVLIB_DLOG_ARG(rvlib_dlog_fmt_)                                 \
+            RVLIB_DLOG_ARGS(__VA_ARGS__) };                                 \
+        rvlib_dlog_write(rvlib_dlog_words_, RVLIB_DLOG_NARGS(__VA_ARGS__)); \
+    } while (0)
+
+#endif  // RVLIB_DLOG_H_
@@ -0,0 +1,395 @@
+/*
+ * Append-only data logger in SPI flash memory.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_crc32.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_flashlog.h"
+
+
+/* Magic value in the page header. */
+#define FLASHLOG_MAGIC          0x4c46
+
+/* Number of pages per erase sector. */
+#define FLASHLOG_SECTOR_PAGES   (RVLIB_SPIFLASH_SECTOR_SIZE / RVLIB_FLASHLOG_PAGE_SIZE)
+
+/*
+ * Number of sectors at the start of the region that are checked for
+ * a valid first page. At most 2 sectors can be without valid first page:
+ * the sector being written and the erased sector ahead of it.
+ */
+#define FLASHLOG_REF_SECTORS    4
+
+/* Result of checking a page. */
+#define FLASHLOG_PAGE_ERASED    0
+#define FLASHLOG_PAGE_VALID     1
+#define FLASHLOG_PAGE_BAD       2
+
+
+static void put_u16(unsigned char *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put_u32(unsigned char *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_u16(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+           | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+/* Return the flash address of page position "pos". */
+static uint32_t flashlog_page_addr(const struct rvlib_flashlog *log, uint32_t pos)
+{
+    return log->base_addr + pos * RVLIB_FLASHLOG_PAGE_SIZE;
+}
+
+
+/* Compute the CRC of a page with header and data in "page". */
+static uint32_t flashlog_page_crc(const unsigned char *page, uint32_t len)
+{
+    uint32_t crc = rvlib_crc32(0, page, 8);
+    return rvlib_crc32(crc, page + RVLIB_FLASHLOG_HEADER_SIZE, len);
+}
+
+
+/*
+ * Read the page at position "pos" and check its contents.
+ * On success, the page is in "page" and its sequence number in "seq".
+ */
+static int flashlog_check_page(const struct rvlib_flashlog *log,
+                               uint32_t pos,
+                               unsigned char *page,
+                               uint32_t *seq)
+{
+    uint32_t addr = flashlog_page_addr(log, pos);
+
+    rvlib_spiflash_read_mem(addr, page, RVLIB_FLASHLOG_HEADER_SIZE);
+
+    int erased = 1;
+    for (int i = 0; i < RVLIB_FLASHLOG_HEADER_SIZE; i++) {
+        if (page[i] != 0xff) {
+            erased = 0;
+        }
+    }
+    if (erased) {
+        return FLASHLOG_PAGE_ERASED;
+    }
+
+    uint32_t len = get_u16(page + 4);
+    *seq = get_u32(page);
+    if (get_u16(page + 6) != FLASHLOG_MAGIC
+        || len > RVLIB_FLASHLOG_PAGE_DATA
+        || *seq % log->num_pages != pos) {
+        return FLASHLOG_PAGE_BAD;
+    }
+
+    rvlib_spiflash_read_mem(addr + RVLIB_FLASHLOG_HEADER_SIZE,
+                            page + RVLIB_FLASHLOG_HEADER_SIZE,
+                            len);
+    if (flashlog_page_crc(page, len) != get_u32(page + 8)) {
+        return FLASHLOG_PAGE_BAD;
+    }
+
+    return FLASHLOG_PAGE_VALID;
+}
+
+
+/* Open the logger and find the write position. */
+int rvlib_flashlog_open(struct rvlib_flashlog *log,
+                        uint32_t addr,
+                        uint32_t size,
+                        void *bufmem,
+                        size_t bufsize)
+{
+    unsigned char page[RVLIB_FLASHLOG_PAGE_SIZE];
+    uint32_t num_sectors = size / RVLIB_SPIFLASH_SECTOR_SIZE;
+
+    if ((addr % RVLIB_SPIFLASH_SECTOR_SIZE) != 0
+        || (size % RVLIB_SPIFLASH_SECTOR_SIZE) != 0
+        || num_sectors < FLASHLOG_REF_SECTORS
+        || bufsize < 2 * RVLIB_FLASHLOG_PAGE_SIZE) {
+        return RVLIB_FLASHLOG_ERR_CONFIG;
+    }
+
+    log->base_addr      = addr;
+    log->num_pages      = num_sectors * FLASHLOG_SECTOR_PAGES;
+    log->next_seq       = 0;
+    log->erased_end     = 0;
+    log->erase_pending  = 0;
+    log->error          = 0;
+    log->bufs           = bufmem;
+    log->num_bufs       = bufsize / RVLIB_FLASHLOG_PAGE_SIZE;
+    log->buf_first      = 0;
+    log->buf_full       = 0;
+    log->buf_fill       = 0;
+    log->max_buf_full   = 0;
+    log->scan_reads     = 0;
+
+    // Find a sector with a valid first page. It is part of the sequence
+    // of written pages which ends at the write position.
+    uint32_t ref_sector = 0, ref_seq = 0;
+    int found = 0;
+    for (uint32_t s = 0; s < FLASHLOG_REF_SECTORS && !found; s++) {
+        log->scan_reads++;
+        if (flashlog_check_page(log, s * FLASHLOG_SECTOR_PAGES, page, &ref_seq)
+            == FLASHLOG_PAGE_VALID) {
+            ref_sector = s;
+            found = 1;
+        }
+    }
+    if (!found) {
+        // Empty region. Start at page 0 after erasing.
+        return 0;
+    }
+
+    // Find the last sector, counting from the reference sector, whose first
+    // page continues the sequence. Sectors after it are erased, or hold
+    // older pages with lower sequence numbers.
+    uint32_t lo = 0, hi = num_sectors;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t pos = ((ref_sector + mid) % num_sectors) * FLASHLOG_SECTOR_PAGES;
+        uint32_t seq;
+        log->scan_reads++;
+        if (flashlog_check_page(log, pos, page, &seq) == FLASHLOG_PAGE_VALID
+            && seq == ref_seq + mid * FLASHLOG_SECTOR_PAGES) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    uint32_t head_pos = ((ref_sector + lo) % num_sectors) * FLASHLOG_SECTOR_PAGES;
+    uint32_t head_seq = ref_seq + lo * FLASHLOG_SECTOR_PAGES;
+
+    // Find the last programmed page in this sector.
+    // Pages are programmed in order, so the erased pages come last.
+    lo = 0;
+    hi = FLASHLOG_SECTOR_PAGES;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t seq;
+        log->scan_reads++;
+        if (flashlog_check_page(log, head_pos + mid, page, &seq)
+            != FLASHLOG_PAGE_ERASED) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    log->next_seq = head_seq + lo + 1;
+
+    // The rest of this sector is erased. The next sector may be
+    // partially erased if power was lost during the erase.
+    if (log->next_seq % FLASHLOG_SECTOR_PAGES == 0) {
+        log->erased_end = log->next_seq;
+    } else {
+        log->erased_end = head_seq + FLASHLOG_SECTOR_PAGES;
+    }
+
+    return 0;
+}
+
+
+/* Mark the current page buffer as full. */
+static void flashlog_close_buf(struct rvlib_flashlog *log)
+{
+    unsigned int idx = (log->buf_first + log->buf_full) % log->num_bufs;
+    unsigned char *page = log->bufs + idx * RVLIB_FLASHLOG_PAGE_SIZE;
+    put_u16(page + 4, log->buf_fill);
+    log->buf_full++;
+    log->buf_fill = 0;
+    if (log->buf_full > log->max_buf_full) {
+        log->max_buf_full = log->buf_full;
+    }
+}
+
+
+/* Append data to the log. */
+int rvlib_flashlog_append(struct rvlib_flashlog *log,
+                          const void *data,
+                          size_t nbytes)
+{
+    const unsigned char *p = data;
+    size_t nfree = (log->num_bufs - log->buf_full) * RVLIB_FLASHLOG_PAGE_DATA
+                   - log->buf_fill;
+
+    if (nbytes > nfree) {
+        return RVLIB_FLASHLOG_ERR_FULL;
+    }
+
+    while (nbytes > 0) {
+        unsigned int idx = (log->buf_first + log->buf_full) % log->num_bufs;
+        unsigned char *page = log->bufs + idx * RVLIB_FLASHLOG_PAGE_SIZE;
+        size_t n = RVLIB_FLASHLOG_PAGE_DATA - log->buf_fill;
+        if (n > nbytes) {
+            n = nbytes;
+        }
+        memcpy(page + RVLIB_FLASHLOG_HEADER_SIZE + log->buf_fill, p, n);
+        log->buf_fill += n;
+        p += n;
+        nbytes -= n;
+        if (log->buf_fill == RVLIB_FLASHLOG_PAGE_DATA) {
+            flashlog_close_buf(log);
+        }
+    }
+
+    return 0;
+}
+
+
+/* Check whether the background erase has completed. */
+static int flashlog_erase_done(struct rvlib_flashlog *log)
+{
+    int status = rvlib_spiflash_erase_finish();
+    if (status == 1) {
+        return 0;
+    }
+    log->erase_pending = 0;
+    if (status < 0) {
+        log->error = status;
+    } else {
+        log->erased_end += FLASHLOG_SECTOR_PAGES;
+    }
+    return 1;
+}
+
+
+/* Do background work. */
+int rvlib_flashlog_poll(struct rvlib_flashlog *log)
+{
+    if (log->error != 0) {
+        return log->error;
+    }
+
+    if (log->erase_pending) {
+        if (!flashlog_erase_done(log)) {
+            return log->buf_full;
+        }
+        if (log->error != 0) {
+            return log->error;
+        }
+    }
+
+    // Keep the current sector and the next sector erased.
+    uint32_t sector_seq = log->next_seq - log->next_seq % FLASHLOG_SECTOR_PAGES;
+    if (log->erased_end - sector_seq < 2 * FLASHLOG_SECTOR_PAGES) {
+        uint32_t pos = log->erased_end % log->num_pages;
+        int status = rvlib_spiflash_sector_erase_start(flashlog_page_addr(log, pos));
+        if (status < 0) {
+            log->error = status;
+            return status;
+        }
+        log->erase_pending = 1;
+        return log->buf_full;
+    }
+
+    // Program the oldest full page buffer.
+    if (log->buf_full > 0 && log->next_seq != log->erased_end) {
+        unsigned char *page =
+            log->bufs + log->buf_first * RVLIB_FLASHLOG_PAGE_SIZE;
+        uint32_t len = get_u16(page + 4);
+        put_u32(page, log->next_seq);
+        put_u16(page + 6, FLASHLOG_MAGIC);
+        put_u32(page + 8, flashlog_page_crc(page, len));
+
+        uint32_t pos = log->next_seq % log->num_pages;
+        int status = rvlib_spiflash_page_program(flashlog_page_addr(log, pos),
+                                                 page,
+                                                 RVLIB_FLASHLOG_HEADER_SIZE + len);
+        if (status < 0) {
+            log->error = status;
+            return status;
+        }
+
+        log->next_seq++;
+        log->buf_first = (log->buf_first + 1) % log->num_bufs;
+        log->buf_full--;
+    }
+
+    return log->buf_full;
+}
+
+
+/* Write all buffered data to flash. */
+int rvlib_flashlog_flush(struct rvlib_flashlog *log)
+{
+    if (log->buf_fill > 0) {
+        flashlog_close_buf(log);
+    }
+
+    while (1) {
+        int status = rvlib_flashlog_poll(log);
+        if (status <= 0) {
+            return status;
+        }
+    }
+}
+
+
+/* Return the sequence number of the oldest page that may still be in flash. */
+uint32_t rvlib_flashlog_first_seq(const struct rvlib_flashlog *log)
+{
+    uint32_t end = log->erased_end;
+    if (log->erase_pending) {
+        end += FLASHLOG_SECTOR_PAGES;
+    }
+    return (end > log->num_pages) ? end - log->num_pages : 0;
+}
+
+
+/* Read the data of a page from flash. */
+int rvlib_flashlog_read_page(struct rvlib_flashlog *log,
+                             uint32_t seq,
+                             unsigned char *buf)
+{
+    unsigned char page[RVLIB_FLASHLOG_PAGE_SIZE];
+    uint32_t page_seq;
+
+    // The flash can not be read while it is erasing.
+    while (log->erase_pending) {
+        flashlog_erase_done(log);
+    }
+
+    if (seq >= log->next_seq || seq < rvlib_flashlog_first_seq(log)) {
+        return RVLIB_FLASHLOG_ERR_NODATA;
+    }
+
+    if (flashlog_check_page(log, seq % log->num_pages, page, &page_seq)
+            != FLASHLOG_PAGE_VALID
+        || page_seq != seq) {
+        return RVLIB_FLASHLOG_ERR_NODATA;
+    }
+
+    uint32_t len = get_u16(page + 4);
+    memcpy(buf, page + RVLIB_FLASHLOG_HEADER_SIZE, len);
+    return len;
+}
+
+/* end */
@@ -0,0 +1,184 @@
+/*
+ * Append-only data logger in SPI flash memory.
+ *
+ * The logger writes a continuous stream of bytes to a circular region
+ * of the flash memory. It is designed for data that arrives at a steady
+ * rate, for example sensor samples, where the producer must not stall
+ * while the flash memory is busy.
+ *
+ * rvlib_flashlog_append() only copies data into RAM page buffers.
+ * rvlib_flashlog_poll() does the flash work in the background: it programs
+ * one full page buffer per call and erases sectors ahead of the write
+ * position. The logger keeps at least one erased sector ahead of the
+ * sector it writes to. Erasing runs in the background through the auto-poll
+ * engine of the SPI controller; data that arrives during an erase is kept
+ * in the page buffers. When the write position enters a new sector,
+ * the logger starts erasing the next sector, which overwrites the oldest
+ * data in the region.
+ *
+ * Each flash page holds a 12-byte header and up to 244 bytes of data:
+ *
+ *   offset 0:  sequence number of the page (32 bits)
+ *   offset 4:  number of data bytes in the page (16 bits)
+ *   offset 6:  magic value 0x4c46 (16 bits)
+ *   offset 8:  CRC-32 of bytes 0 to 7 and the data bytes
+ *   offset 12: data
+ *
+ * Pages are numbered from 0 since the region was last empty. Page number
+ * "seq" is always stored at page position (seq % num_pages) in the region.
+ * rvlib_flashlog_open() uses this to find the write position with a binary
+ * search, first over the sectors, then over the pages of the last sector.
+ * It reads O(log n) pages, not the whole region.
+ *
+ * A page that was partially programmed when power was lost fails the
+ * CRC check and is skipped by rvlib_flashlog_read_page(). If the first
+ * page of a sector was affected, the sector is erased again before use.
+ *
+ * The region must be sector-aligned and hold at least 4 sectors.
+ * The logger functions are not reentrant; call them from a single context.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_FLASHLOG_H_
+#define RVLIB_FLASHLOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Error codes in addition to RVLIB_SPIFLASH_ERR_xxx. */
+#define RVLIB_FLASHLOG_ERR_FULL     (-4)
+#define RVLIB_FLASHLOG_ERR_NODATA   (-5)
+#define RVLIB_FLASHLOG_ERR_CONFIG   (-6)
+
+/* Size of a flash page and number of data bytes per page. */
+#define RVLIB_FLASHLOG_PAGE_SIZE    256
+#define RVLIB_FLASHLOG_HEADER_SIZE  12
+#define RVLIB_FLASHLOG_PAGE_DATA    (RVLIB_FLASHLOG_PAGE_SIZE - RVLIB_FLASHLOG_HEADER_SIZE)
+
+
+/*
+ * State of a flash logger.
+ *
+ * The application may read the fields marked (ro).
+ * All other fields are private to the logger.
+ */
+struct rvlib_flashlog {
+    uint32_t        base_addr;      // flash address of the region
+    uint32_t        num_pages;      // (ro) number of pages in the region
+    uint32_t        next_seq;       // (ro) sequence number of next page in flash
+    uint32_t        erased_end;     // pages before this are known to be erased
+    int             erase_pending;  // background erase is running
+    int             error;          // first flash error, or 0
+    unsigned char   *bufs;          // page buffers
+    unsigned int    num_bufs;       // (ro) number of page buffers
+    unsigned int    buf_first;      // index of oldest full page buffer
+    unsigned int    buf_full;       // (ro) number of full page buffers
+    unsigned int    buf_fill;       // data bytes in the current page buffer
+    unsigned int    max_buf_full;   // (ro) highest number of full page buffers
+    unsigned int    scan_reads;     // (ro) pages read by rvlib_flashlog_open()
+};
+
+
+/*
+ * Open the logger and find the write position.
+ *
+ * Parameters:
+ *     log:       Logger state to initialize.
+ *     addr:      Flash address of the log region (sector-aligned).
+ *     size:      Size of the log region in bytes (multiple of the
+ *                sector size, at least 4 sectors).
+ *     bufmem:    Memory for the page buffers.
+ *     bufsize:   Size of "bufmem" in bytes (at least 2 pages).
+ *
+ * New data will be appended after the newest valid page in the region.
+ * If the region holds no valid pages, the log starts at page 0.
+ *
+ * rvlib_spiflash_init() must have been called before. The auto-poll
+ * engine of the SPI controller is needed for background erase.
+ *
+ * Returns:
+ *     0 on success;
+ *     RVLIB_FLASHLOG_ERR_CONFIG if the parameters are invalid.
+ */
+int rvlib_flashlog_open(struct rvlib_flashlog *log,
+                        uint32_t addr,
+                        uint32_t size,
+                        void *bufmem,
+                        size_t bufsize);
+
+/*
+ * Append data to the log.
+ *
+ * The data is copied into the page buffers. This function does not
+ * access the flash memory. Either all bytes are appended, or none.
+ *
+ * Returns:
+ *     0 if the data was appended;
+ *     RVLIB_FLASHLOG_ERR_FULL if there is not enough free buffer space;
+ *       call rvlib_flashlog_poll() and try again.
+ */
+int rvlib_flashlog_append(struct rvlib_flashlog *log,
+                          const void *data,
+                          size_t nbytes);
+
+/*
+ * Do background work.
+ *
+ * This function checks for completion of a background erase, starts
+ * a new erase when needed, or programs one full page buffer to flash.
+ * Programming a page takes about 0.5 ms; the other steps do not wait.
+ * Call this function often, for example from the main loop.
+ *
+ * Returns:
+ *     the number of full page buffers still waiting to be written;
+ *     a negative error code if a flash operation failed.
+ *     After an error, the logger stops writing.
+ */
+int rvlib_flashlog_poll(struct rvlib_flashlog *log);
+
+/*
+ * Write all buffered data to flash.
+ *
+ * A partially filled page buffer is written as a short page.
+ * This function waits until all data is in flash.
+ *
+ * Returns:
+ *     0 on success;
+ *     a negative error code if a flash operation failed.
+ */
+int rvlib_flashlog_flush(struct rvlib_flashlog *log);
+
+/*
+ * Return the sequence number of the oldest page that may still be in flash.
+ *
+ * Pages from this number up to (but not including) log->next_seq
+ * can be read with rvlib_flashlog_read_page().
+ */
+uint32_t rvlib_flashlog_first_seq(const struct rvlib_flashlog *log);
+
+/*
+ * Read the data of a page from flash.
+ *
+ * Parameters:
+ *     seq:   Sequence number of the page.
+ *     buf:   Buffer for RVLIB_FLASHLOG_PAGE_DATA bytes.
+ *
+ * This function waits for a background erase to complete.
+ *
+ * Returns:
+ *     the number of data bytes in the page;
+ *     RVLIB_FLASHLOG_ERR_NODATA if the page is not in flash or invalid.
+ */
+int rvlib_flashlog_read_page(struct rvlib_flashlog *log,
+                             uint32_t seq,
+                             unsigned char *buf);
+
+#endif  // RVLIB_FLASHLOG_H_
@@ -0,0 +1,268 @@
+/*
+ * Minimal profiling runtime for profile-guided optimization.
+ *
+ * The data structures below must match the structures that GCC emits
+ * for instrumented code (see "libgcov.h" in the GCC sources).
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_uart.h"
+#include "rvlib_gcov.h"
+
+
+/* Number of counter types. GCC 14 added condition coverage counters. */
+#if __GNUC__ >= 14
+#define GCOV_COUNTERS       9
+#else
+#define GCOV_COUNTERS       8
+#endif
+
+/* GCC 12 added an object checksum and specifies tag lengths in bytes. */
+#if __GNUC__ >= 12
+#define GCOV_HAS_CHECKSUM   1
+#define GCOV_LENGTH(words)  (4 * (words))
+#else
+#define GCOV_HAS_CHECKSUM   0
+#define GCOV_LENGTH(words)  (words)
+#endif
+
+#define GCOV_DATA_MAGIC             0x67636461
+#define GCOV_TAG_FUNCTION           0x01000000
+#define GCOV_TAG_COUNTER_BASE       0x01a10000
+#define GCOV_TAG_OBJECT_SUMMARY     0xa1000000
+
+/* Number of data bytes per output line. */
+#define GCOV_LINE_BYTES     32
+
+typedef int64_t gcov_type;
+typedef void (*gcov_merge_fn)(gcov_type *, uint32_t);
+
+struct gcov_ctr_info {
+    uint32_t num;
+    gcov_type *values;
+};
+
+struct gcov_info;
+
+struct gcov_fn_info {
+    const struct gcov_info *key;
+    uint32_t ident;
+    uint32_t lineno_checksum;
+    uint32_t cfg_checksum;
+    struct gcov_ctr_info ctrs[1];
+};
+
+struct gcov_info {
+    uint32_t version;
+    struct gcov_info *next;
+    uint32_t stamp;
+#if GCOV_HAS_CHECKSUM
+    uint32_t checksum;
+#endif
+    const char *filename;
+    gcov_merge_fn merge[GCOV_COUNTERS];
+    unsigned int n_functions;
+    const struct gcov_fn_info * const *functions;
+};
+
+/* State of the output encoder. */
+struct gcov_writer {
+    int emit;
+    uint32_t size;
+    unsigned int linepos;
+};
+
+
+/* List of instrumented object files. */
+static struct gcov_info *gcov_list;
+
+/* Used by instrumented code for time profiling (not supported). */
+gcov_type __gcov_time_profiler_counter;
+
+
+/* Called by the constructor of each instrumented object file. */
+void __gcov_init(struct gcov_info *info)
+{
+    info->next = gcov_list;
+    gcov_list = info;
+}
+
+
+/* Called by the destructor of each instrumented object file. */
+void __gcov_exit(void)
+{
+}
+
+
+/* Merge function for arc counters (only used as a marker). */
+void __gcov_merge_add(gcov_type *counters, uint32_t n_counters)
+{
+    (void)counters;
+    (void)n_counters;
+}
+
+
+static void gcov_put_str(const char *s)
+{
+    while (*s != '\0') {
+        rvlib_putchar(*s);
+        s++;
+    }
+}
+
+
+static void gcov_put_dec(uint32_t v)
+{
+    char buf[12];
+    char *p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + (v % 10);
+        v /= 10;
+    } while (v != 0);
+    gcov_put_str(p);
+}
+
+
+/* Write a 32-bit word (little-endian) to the output. */
+static void gcov_write_word(struct gcov_writer *w, uint32_t v)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+
+    w->size += 4;
+    if (!w->emit) {
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        rvlib_putchar(hexdigits[(v >> 4) & 15]);
+        rvlib_putchar(hexdigits[v & 15]);
+        v >>= 8;
+    }
+
+    w->linepos += 4;
+    if (w->linepos == GCOV_LINE_BYTES) {
+        rvlib_putchar('\r');
+        rvlib_putchar('\n');
+        w->linepos = 0;
+    }
+}
+
+
+/* Write the ".gcda" data of one object file. */
+static void gcov_write_info(struct gcov_writer *w, const struct gcov_info *gi)
+{
+    gcov_write_word(w, GCOV_DATA_MAGIC);
+    gcov_write_word(w, gi->version);
+    gcov_write_word(w, gi->stamp);
+#if GCOV_HAS_CHECKSUM
+    gcov_write_word(w, gi->checksum);
+#endif
+
+    // Object summary: one run, no maximum counter value.
+    gcov_write_word(w, GCOV_TAG_OBJECT_SUMMARY);
+    gcov_write_word(w, GCOV_LENGTH(2));
+    gcov_write_word(w, 1);
+    gcov_write_word(w, 0);
+
+    for (unsigned int f = 0; f < gi->n_functions; f++) {
+        const struct gcov_fn_info *fn = gi->functions[f];
+
+        // Functions that were not emitted in this object have no data.
+        if (fn == NULL || fn->key != gi) {
+            gcov_write_word(w, GCOV_TAG_FUNCTION);
+            gcov_write_word(w, 0);
+            continue;
+        }
+
+        gcov_write_word(w, GCOV_TAG_FUNCTION);
+        gcov_write_word(w, GCOV_LENGTH(3));
+        gcov_write_word(w, fn->ident);
+        gcov_write_word(w, fn->lineno_checksum);
+        gcov_write_word(w, fn->cfg_checksum);
+
+        const struct gcov_ctr_info *ctr = fn->ctrs;
+        for (unsigned int t = 0; t < GCOV_COUNTERS; t++) {
+            if (gi->merge[t] == NULL) {
+                continue;
+            }
+            gcov_write_word(w, GCOV_TAG_COUNTER_BASE + (t << 17));
+            gcov_write_word(w, GCOV_LENGTH(2 * ctr->num));
+            for (uint32_t i = 0; i < ctr->num; i++) {
+                uint64_t v = ctr->values[i];
+                gcov_write_word(w, (uint32_t)v);
+                gcov_write_word(w, (uint32_t)(v >> 32));
+            }
+            ctr++;
+        }
+    }
+
+    gcov_write_word(w, 0);
+}
+
+
+/* Send profile data of all instrumented object files to the console. */
+void rvlib_gcov_dump(void)
+{
+    for (const struct gcov_info *gi = gcov_list; gi != NULL; gi = gi->next) {
+        struct gcov_writer w;
+
+        // First pass: determine the file size.
+        w.emit = 0;
+        w.size = 0;
+        w.linepos = 0;
+        gcov_write_info(&w, gi);
+
+        gcov_put_str("\r\nGCDA ");
+        gcov_put_str(gi->filename);
+        rvlib_putchar(' ');
+        gcov_put_dec(w.size);
+        gcov_put_str("\r\n");
+
+        // Second pass: send the data.
+        w.emit = 1;
+        w.linepos = 0;
+        gcov_write_info(&w, gi);
+        if (w.linepos != 0) {
+            gcov_put_str("\r\n");
+        }
+
+        gcov_put_str("GCDA END\r\n");
+    }
+}
+
+
+/* Reset all profile counters to zero. */
+void rvlib_gcov_reset(void)
+{
+    for (const struct gcov_info *gi = gcov_list; gi != NULL; gi = gi->next) {
+        for (unsigned int f = 0; f < gi->n_functions; f++) {
+            const struct gcov_fn_info *fn = gi->functions[f];
+            if (fn == NULL || fn->key != gi) {
+                continue;
+            }
+            const struct gcov_ctr_info *ctr = fn->ctrs;
+            for (unsigned int t = 0; t < GCOV_COUNTERS; t++) {
+                if (gi->merge[t] == NULL) {
+                    continue;
+                }
+                for (uint32_t i = 0; i < ctr->num; i++) {
+                    ctr->values[i] = 0;
+                }
+                ctr++;
+            }
+        }
+    }
+}
+
+/* end */
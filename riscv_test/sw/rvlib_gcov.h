@@ -0,0 +1,51 @@
+/*
+ * Minimal profiling runtime for profile-guided optimization.
+ *
+ * Programs compiled with "-fprofile-generate -fno-profile-values" count
+ * how often each branch of the program is taken. This module replaces
+ * the GCC library "libgcov": it keeps the counters in RAM and sends
+ * the profile data to the console in a text format.
+ * The host program "tools/gcov_recv" converts the output
+ * to ".gcda" files, which are then used with "-fprofile-use".
+ *
+ * See the Makefile and README for the complete workflow.
+ *
+ * Value profiling ("-fprofile-values") is not supported.
+ * Only GCC versions 10 and newer are supported.
+ *
+ * Output format:
+ *   "GCDA <filename> <size>" followed by the ".gcda" file contents
+ *   as hex-encoded lines of 32 bytes, then a line "GCDA END".
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_GCOV_H_
+#define RVLIB_GCOV_H_
+
+
+/*
+ * Send profile data of all instrumented object files to the console.
+ *
+ * Call this function at the end of the workload. Output is written
+ * via rvlib_putchar(); override rvlib_putchar() to send the data
+ * through the JTAG console instead of the serial port.
+ *
+ * This function does nothing if the program is not instrumented.
+ */
+void rvlib_gcov_dump(void);
+
+/*
+ * Reset all profile counters to zero.
+ *
+ * This can be used to exclude initialization code from the profile.
+ */
+void rvlib_gcov_reset(void);
+
+#endif  // RVLIB_GCOV_H_
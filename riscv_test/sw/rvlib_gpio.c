@@ -17,6 +17,15 @@
 #define RVLIB_GPIO_REG_INPUT      0
 #define RVLIB_GPIO_REG_OUTPUT     4
 #define RVLIB_GPIO_REG_DIRECTION  8
+#define RVLIB_GPIO_REG_SCHED_STAT 0x10
+#define RVLIB_GPIO_REG_SCHED_CTRL 0x14
+#define RVLIB_GPIO_REG_EVT_TIME   0x18
+#define RVLIB_GPIO_REG_EVT_TIMEH  0x1c
+#define RVLIB_GPIO_REG_EVT_MASK   0x20
+#define RVLIB_GPIO_REG_EVT_VALUE  0x24
+
+#define RVLIB_GPIO_SCHED_FLUSH    0x80000000
+#define RVLIB_GPIO_SCHED_IRQ_EN   0x80000000
 
 
 static inline uint32_t set_bit(uint32_t val, int bit, int state)
@@ -82,4 +91,88 @@ void rvlib_gpio_set_channel_output(uint32_t base_addr, int channel, int state)
     rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_OUTPUT, mask);
 }
 
+
+/* Return the capacity of the event queue. */
+unsigned int rvlib_gpio_sched_capacity(uint32_t base_addr)
+{
+    uint32_t status = rvlib_hw_read_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT);
+    return (status >> 8) & 0xff;
+}
+
+
+/* Return the number of events in the queue. */
+unsigned int rvlib_gpio_sched_level(uint32_t base_addr)
+{
+    uint32_t status = rvlib_hw_read_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT);
+    return status & 0xff;
+}
+
+
+/* Queue a sequence of events. */
+size_t rvlib_gpio_sched_queue(uint32_t base_addr,
+                              const struct rvlib_gpio_event *events,
+                              size_t num_events)
+{
+    uint32_t status = rvlib_hw_read_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT);
+    size_t nfree = ((status >> 8) & 0xff) - (status & 0xff);
+    if (num_events > nfree) {
+        num_events = nfree;
+    }
+
+    // The time and mask registers keep their value after an event
+    // is queued. Write them only when they change.
+    uint32_t time_hi = 0;
+    uint32_t mask = 0;
+    for (size_t i = 0; i < num_events; i++) {
+        uint32_t evt_time_hi = events[i].time >> 32;
+        if (i == 0 || evt_time_hi != time_hi) {
+            time_hi = evt_time_hi;
+            rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_EVT_TIMEH, time_hi);
+        }
+        if (i == 0 || events[i].mask != mask) {
+            mask = events[i].mask;
+            rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_EVT_MASK, mask);
+        }
+        rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_EVT_TIME,
+                           (uint32_t)events[i].time);
+        rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_EVT_VALUE,
+                           events[i].value);
+    }
+
+    return num_events;
+}
+
+
+/* Discard all queued events. */
+void rvlib_gpio_sched_flush(uint32_t base_addr)
+{
+    rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT,
+                       RVLIB_GPIO_SCHED_FLUSH);
+}
+
+
+/* Return the LATE and OVERFLOW flags, then clear them. */
+uint32_t rvlib_gpio_sched_get_flags(uint32_t base_addr)
+{
+    uint32_t status = rvlib_hw_read_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT);
+    uint32_t flags = status & (RVLIB_GPIO_SCHED_LATE | RVLIB_GPIO_SCHED_OVERFLOW);
+    if (flags != 0) {
+        rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_SCHED_STAT, flags);
+    }
+    return flags;
+}
+
+
+/* Enable or disable the event interrupt. */
+void rvlib_gpio_sched_set_interrupt(uint32_t base_addr,
+                                    int enable,
+                                    unsigned int threshold)
+{
+    uint32_t ctrl = threshold & 0xff;
+    if (enable) {
+        ctrl |= RVLIB_GPIO_SCHED_IRQ_EN;
+    }
+    rvlib_hw_write_reg(base_addr + RVLIB_GPIO_REG_SCHED_CTRL, ctrl);
+}
+
 /* end */
@@ -13,9 +13,29 @@
 #ifndef RVLIB_GPIO_H_
 #define RVLIB_GPIO_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 
+/* Bits in the event scheduler status (rvlib_gpio_sched_get_flags()). */
+#define RVLIB_GPIO_SCHED_LATE       0x10000
+#define RVLIB_GPIO_SCHED_OVERFLOW   0x20000
+
+
+/*
+ * Scheduled change of output channels.
+ *
+ * When the "mtime" counter reaches "time", the channels selected by "mask"
+ * take the corresponding bits of "value". The change happens in hardware
+ * on the exact clock cycle, independent of CPU activity.
+ */
+struct rvlib_gpio_event {
+    uint64_t    time;       // "mtime" value of the change
+    uint32_t    mask;       // channels to change
+    uint32_t    value;      // new state of the selected channels
+};
+
+
 /* Set the output driver enable flags of all channels. */
 void rvlib_gpio_set_drive(uint32_t base_addr, uint32_t drive_mask);
 
@@ -37,6 +57,57 @@ void rvlib_gpio_set_output(uint32_t base_addr, uint32_t mask);
 /* Set output state of one channel. */
 void rvlib_gpio_set_channel_output(uint32_t base_addr, int channel, int state);
 
+/*
+ * Return the capacity of the event queue of the GPIO controller,
+ * or 0 if the controller has no event scheduler.
+ */
+unsigned int rvlib_gpio_sched_capacity(uint32_t base_addr);
+
+/* Return the number of events in the queue. */
+unsigned int rvlib_gpio_sched_level(uint32_t base_addr);
+
+/*
+ * Queue a sequence of events.
+ *
+ * The events must be in order of increasing time, and later than
+ * all events already in the queue. Events that must happen at the same
+ * time must be combined into one event.
+ *
+ * This function queues as many events as fit in the queue and returns
+ * without waiting. The rest of the sequence can be queued later, for
+ * example from the external interrupt handler (see
+ * rvlib_gpio_sched_set_interrupt()).
+ *
+ * Return the number of events queued.
+ */
+size_t rvlib_gpio_sched_queue(uint32_t base_addr,
+                              const struct rvlib_gpio_event *events,
+                              size_t num_events);
+
+/* Discard all queued events. */
+void rvlib_gpio_sched_flush(uint32_t base_addr);
+
+/*
+ * Return the LATE and OVERFLOW flags, then clear them.
+ *
+ * RVLIB_GPIO_SCHED_LATE means that an event was applied after its time,
+ * because it was queued too late. RVLIB_GPIO_SCHED_OVERFLOW means that
+ * an event was dropped because the queue was full.
+ */
+uint32_t rvlib_gpio_sched_get_flags(uint32_t base_addr);
+
+/*
+ * Enable or disable the event interrupt.
+ *
+ * When enabled, the GPIO controller raises an external interrupt while
+ * the number of queued events is at most "threshold".
+ * The interrupt handler should queue more events, or disable the interrupt
+ * when the sequence is complete.
+ */
+void rvlib_gpio_sched_set_interrupt(uint32_t base_addr,
+                                    int enable,
+                                    unsigned int threshold);
+
 #ifdef RVSYS_ADDR_LEDS
 
 /* Turn the specified LED on or off. */
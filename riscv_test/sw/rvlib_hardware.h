@@ -24,11 +24,58 @@
 #define RVSYS_ADDR_SPIFLASH 0xf0004000
 #define RVSYS_ADDR_TIMER    0xf0008000
 #define RVSYS_ADDR_UART     0xf0010000
+#define RVSYS_ADDR_JTAGCON  0xf0020000
+#define RVSYS_ADDR_ICAP     0xf0040000
+#define RVSYS_ADDR_TRACE    0xf0080000
+#define RVSYS_ADDR_BUSMON   0xf0100000
+#define RVSYS_ADDR_MAC      0xf0200000
+#define RVSYS_ADDR_SHA256   0xf0400000
+#define RVSYS_ADDR_I2C      0xf0800000
+#define RVSYS_ADDR_ACCEL    0xf1000000
+
+/* Slave indices on the peripheral bus (as seen by the bus monitor). */
+#define RVSYS_DEVBUS_LEDS       0
+#define RVSYS_DEVBUS_GPIO1      1
+#define RVSYS_DEVBUS_GPIO2      2
+#define RVSYS_DEVBUS_UART       3
+#define RVSYS_DEVBUS_TIMER      4
+#define RVSYS_DEVBUS_SPIFLASH   5
+#define RVSYS_DEVBUS_JTAGCON    6
+#define RVSYS_DEVBUS_ICAP       7
+#define RVSYS_DEVBUS_TRACE      8
+#define RVSYS_DEVBUS_MAC        9
+#define RVSYS_DEVBUS_SHA256     10
+#define RVSYS_DEVBUS_I2C        11
+#define RVSYS_DEVBUS_ACCEL      12
 
 /* GPIO channels for LEDs */
 #define RVLIB_LED_RED_CHANNEL   0
 #define RVLIB_LED_GREEN_CHANNEL 1
 
+/*
+ * Layout of the configuration flash memory (8 MByte).
+ *
+ * The golden bitstream at address 0 (at most 2 MByte) is programmed via
+ * JTAG and never modified by software. The log area after it is used by
+ * rvlib_flashlog.h. An update bitstream can be stored in the update slot.
+ * The descriptor sector records size and CRC of a verified update image.
+ * The hibernate area holds a RAM snapshot (see rvlib_hibernate.h).
+ * The last sector is reserved for flash tests.
+ */
+#define RVSYS_FLASH_SIZE                0x800000
+#define RVSYS_FLASH_GOLDEN_ADDR         0x000000
+/* The golden bitstream must stay below this address. The XC7S25
+   bitstream is about 1.2 MByte uncompressed, which leaves room. */
+#define RVSYS_FLASH_LOG_ADDR            0x200000
+#define RVSYS_FLASH_LOG_SIZE            0x1f0000
+#define RVSYS_FLASH_UPDATE_DESC_ADDR    0x3f0000
+#define RVSYS_FLASH_UPDATE_ADDR         0x400000
+#define RVSYS_FLASH_UPDATE_MAX_SIZE     0x3d0000
+#define RVSYS_FLASH_HIBERNATE_ADDR      0x7d0000
+#define RVSYS_FLASH_HIBERNATE_SIZE      0x020000
+#define RVSYS_FLASH_TEST_ADDR           0x7f0000
+#define RVSYS_FLASH_TEST_SIZE           0x010000
+
 /* Select a default UART device */
 #define RVLIB_DEFAULT_UART_ADDR RVSYS_ADDR_UART
 
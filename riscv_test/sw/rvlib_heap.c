@@ -0,0 +1,122 @@
+/*
+ * Simple heap allocator for RISC-V embedded software.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_heap.h"
+
+
+/* Heap area defined by the linker script. */
+extern char __heap_start[];
+extern char __heap_end[];
+
+/*
+ * Each block starts with a 4-byte header containing the block size
+ * in bytes (including the header). Bit 0 of the header is set when
+ * the block is in use. Block sizes are multiples of 8 and the first
+ * header is placed 4 bytes before an 8-byte boundary, so all payloads
+ * are 8-byte aligned.
+ */
+#define HEAP_USED       1U
+#define HEAP_ALIGN      8U
+#define HEAP_MIN_SPLIT  16U
+
+static uint32_t *heap_first;
+static uint32_t *heap_last;
+
+
+static void heap_init(void)
+{
+    uintptr_t start = ((uintptr_t)__heap_start + 4 + HEAP_ALIGN - 1)
+                      & ~(uintptr_t)(HEAP_ALIGN - 1);
+    uintptr_t end = (uintptr_t)__heap_end & ~(uintptr_t)(HEAP_ALIGN - 1);
+    heap_first = (uint32_t *)(start - 4);
+    heap_last = (uint32_t *)(end - 4);
+    *heap_first = (end > start) ? (end - start) : 0;
+}
+
+
+static inline uint32_t *heap_next(uint32_t *blk)
+{
+    return (uint32_t *)((char *)blk + (*blk & ~HEAP_USED));
+}
+
+
+void * rvlib_heap_alloc(size_t size)
+{
+    if (heap_first == NULL) {
+        heap_init();
+    }
+
+    if (size > (size_t)((char *)heap_last - (char *)heap_first)) {
+        return NULL;
+    }
+
+    uint32_t need = (size + 4 + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+
+    uint32_t *blk = heap_first;
+    while (blk < heap_last && *blk != 0) {
+        uint32_t *next = heap_next(blk);
+        if ((*blk & HEAP_USED) == 0) {
+
+            // Merge following free blocks into this block.
+            while (next < heap_last && (*next & HEAP_USED) == 0
+                   && *next != 0) {
+                *blk += *next;
+                next = heap_next(blk);
+            }
+
+            if (*blk >= need) {
+                // Split off the remainder if it is large enough.
+                if (*blk - need >= HEAP_MIN_SPLIT) {
+                    uint32_t *rest = (uint32_t *)((char *)blk + need);
+                    *rest = *blk - need;
+                    *blk = need;
+                }
+                *blk |= HEAP_USED;
+                return blk + 1;
+            }
+        }
+        blk = next;
+    }
+
+    return NULL;
+}
+
+
+void rvlib_heap_free(void *ptr)
+{
+    if (ptr != NULL) {
+        uint32_t *blk = (uint32_t *)ptr - 1;
+        *blk &= ~HEAP_USED;
+    }
+}
+
+
+size_t rvlib_heap_free_bytes(void)
+{
+    if (heap_first == NULL) {
+        heap_init();
+    }
+
+    size_t nfree = 0;
+    uint32_t *blk = heap_first;
+    while (blk < heap_last && *blk != 0) {
+        if ((*blk & HEAP_USED) == 0) {
+            nfree += *blk - 4;
+        }
+        blk = heap_next(blk);
+    }
+    return nfree;
+}
+
+/* end */
@@ -0,0 +1,40 @@
+/*
+ * Simple heap allocator for RISC-V embedded software.
+ *
+ * The heap occupies the RAM area between the end of the program data
+ * and the stack, as defined by the symbols "__heap_start" and
+ * "__heap_end" in the linker script.
+ *
+ * This is a first-fit allocator with a 4-byte header per block.
+ * Adjacent free blocks are merged while searching for a free block.
+ * It is intended for programs that allocate a few objects at startup
+ * and rarely free them; it is not fast and it is not safe to call
+ * from interrupt handlers.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_HEAP_H_
+#define RVLIB_HEAP_H_
+
+#include <stddef.h>
+
+/*
+ * Allocate a block of at least "size" bytes, aligned to 8 bytes.
+ * Return NULL if there is not enough free space.
+ */
+void * rvlib_heap_alloc(size_t size);
+
+/* Release a block allocated by rvlib_heap_alloc(). NULL is ignored. */
+void rvlib_heap_free(void *ptr);
+
+/* Return the total number of bytes in free blocks. */
+size_t rvlib_heap_free_bytes(void);
+
+#endif  // RVLIB_HEAP_H_
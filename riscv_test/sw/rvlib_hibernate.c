@@ -0,0 +1,361 @@
+/*
+ * Hibernate to flash: save and restore RAM snapshots.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_crc32.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_hibernate.h"
+
+
+/* Memory areas defined by the linker script. */
+extern char _start[];
+extern char __data_start[];
+extern char __heap_end[];
+extern char __stack[];
+
+/* Assembler routines in rvlib_hibernate_entry.S. */
+int rvlib_hibernate_write(uint32_t saved_sp);
+void rvlib_hibernate_jump(uint32_t saved_sp) __attribute__((noreturn));
+void rvlib_hibernate_call_on_stack(void (*func)(void *),
+                                   void *arg,
+                                   uint32_t new_sp)
+    __attribute__((noreturn));
+
+/*
+ * Layout of the hibernate area in flash:
+ *
+ *   offset 0:   header (written last, marks the snapshot as valid)
+ *   offset 256: compressed data
+ *
+ * The compressed data is a sequence of 32-bit tokens. A token with
+ * bit 31 set stands for (token & 0x7fffffff) zero words. Otherwise the
+ * token is followed by that many literal words. The two saved memory
+ * ranges are compressed one after the other; no token spans both ranges.
+ */
+#define HIBERNATE_MAGIC         0x31424948      /* "HIB1" */
+#define HIBERNATE_DATA_OFFSET   256
+#define HIBERNATE_DATA_MAX      (RVSYS_FLASH_HIBERNATE_SIZE - HIBERNATE_DATA_OFFSET)
+#define HIBERNATE_PAGE_SIZE     256
+#define HIBERNATE_SECTOR_SIZE   0x10000
+#define HIBERNATE_ZERO_RUN      0x80000000U
+
+struct hibernate_header {
+    uint32_t magic;
+    uint32_t text_crc;          /* CRC of program code, _start to __data_start */
+    uint32_t data_start;        /* first saved range: __data_start ... */
+    uint32_t data_end;          /*   ... __heap_end */
+    uint32_t stack_ptr;         /* second saved range: saved stack pointer ... */
+    uint32_t stack_end;         /*   ... __stack */
+    uint32_t comp_size;         /* number of bytes of compressed data */
+    uint32_t comp_crc;          /* CRC of compressed data */
+    uint32_t header_crc;        /* CRC of all preceding header fields */
+};
+
+/* State of the compressed data writer. */
+struct hibernate_writer {
+    uint32_t flash_pos;
+    uint32_t page_fill;
+    uint32_t comp_crc;
+    int status;
+};
+
+/*
+ * Page buffer for writing compressed data. This buffer is part of the
+ * snapshot itself, but its contents do not matter after resume.
+ */
+static unsigned char hibernate_page_buf[HIBERNATE_PAGE_SIZE]
+    __attribute__((aligned(4)));
+
+
+/* Calculate the CRC of the program code. */
+static uint32_t hibernate_text_crc(void)
+{
+    return rvlib_crc32(0,
+                       (const unsigned char *)_start,
+                       __data_start - _start);
+}
+
+
+/* Write the page buffer to flash. */
+static void hibernate_flush(struct hibernate_writer *w)
+{
+    if (w->page_fill > 0 && w->status == 0) {
+        w->comp_crc = rvlib_crc32(w->comp_crc, hibernate_page_buf, w->page_fill);
+        int ret = rvlib_spiflash_page_program(
+                      RVSYS_FLASH_HIBERNATE_ADDR + w->flash_pos,
+                      hibernate_page_buf,
+                      w->page_fill);
+        if (ret < 0) {
+            w->status = ret;
+        }
+    }
+    w->flash_pos += w->page_fill;
+    w->page_fill = 0;
+}
+
+
+/* Append words to the compressed data stream. */
+static void hibernate_emit(struct hibernate_writer *w,
+                           const uint32_t *data,
+                           size_t nwords)
+{
+    while (nwords > 0 && w->status == 0) {
+        if (w->flash_pos + w->page_fill + 4 > RVSYS_FLASH_HIBERNATE_SIZE) {
+            w->status = RVLIB_HIBERNATE_ERR_NOSPACE;
+            break;
+        }
+        uint32_t word = *data;
+        memcpy(hibernate_page_buf + w->page_fill, &word, 4);
+        w->page_fill += 4;
+        if (w->page_fill == HIBERNATE_PAGE_SIZE) {
+            hibernate_flush(w);
+        }
+        data++;
+        nwords--;
+    }
+}
+
+
+/* Compress a range of memory words into the data stream. */
+static void hibernate_compress(struct hibernate_writer *w,
+                               const uint32_t *p,
+                               const uint32_t *end)
+{
+    while (p < end && w->status == 0) {
+        const uint32_t *q = p;
+        uint32_t token;
+
+        /* Run of zero words. */
+        while (q < end && *q == 0) {
+            q++;
+        }
+        if (q > p) {
+            token = HIBERNATE_ZERO_RUN | (uint32_t)(q - p);
+            hibernate_emit(w, &token, 1);
+            p = q;
+            continue;
+        }
+
+        /* Literal words up to the next pair of zero words. */
+        while (q < end && !(q[0] == 0 && (q + 1 == end || q[1] == 0))) {
+            q++;
+        }
+        token = q - p;
+        hibernate_emit(w, &token, 1);
+        hibernate_emit(w, p, q - p);
+        p = q;
+    }
+}
+
+
+/*
+ * Write the snapshot to flash.
+ * Called from rvlib_hibernate_save() after pushing the CPU registers.
+ */
+int rvlib_hibernate_write(uint32_t saved_sp)
+{
+    struct hibernate_writer w;
+    struct hibernate_header hdr;
+    int ret;
+
+    /* The resume code needs free stack space below saved_sp. */
+    if (saved_sp < (uint32_t)__heap_end + RVLIB_HIBERNATE_MIN_RESUME_STACK) {
+        return RVLIB_HIBERNATE_ERR_STACK;
+    }
+
+    /* Erase the hibernate area. This also invalidates the old snapshot. */
+    for (uint32_t ofs = 0;
+         ofs < RVSYS_FLASH_HIBERNATE_SIZE;
+         ofs += HIBERNATE_SECTOR_SIZE) {
+        ret = rvlib_spiflash_sector_erase(RVSYS_FLASH_HIBERNATE_ADDR + ofs);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    hdr.magic = HIBERNATE_MAGIC;
+    hdr.text_crc = hibernate_text_crc();
+    hdr.data_start = (uint32_t)__data_start;
+    hdr.data_end = (uint32_t)__heap_end;
+    hdr.stack_ptr = saved_sp;
+    hdr.stack_end = (uint32_t)__stack;
+
+    /* Write compressed data. */
+    w.flash_pos = HIBERNATE_DATA_OFFSET;
+    w.page_fill = 0;
+    w.comp_crc = 0;
+    w.status = 0;
+    hibernate_compress(&w,
+                       (const uint32_t *)hdr.data_start,
+                       (const uint32_t *)hdr.data_end);
+    hibernate_compress(&w,
+                       (const uint32_t *)hdr.stack_ptr,
+                       (const uint32_t *)hdr.stack_end);
+    hibernate_flush(&w);
+    if (w.status != 0) {
+        return w.status;
+    }
+
+    /* Write the header to mark the snapshot as valid. */
+    hdr.comp_size = w.flash_pos - HIBERNATE_DATA_OFFSET;
+    hdr.comp_crc = w.comp_crc;
+    hdr.header_crc = rvlib_crc32(0,
+                                 (const unsigned char *)&hdr,
+                                 offsetof(struct hibernate_header, header_crc));
+    return rvlib_spiflash_page_program(RVSYS_FLASH_HIBERNATE_ADDR,
+                                       (const unsigned char *)&hdr,
+                                       sizeof(hdr));
+}
+
+
+/* Return the CRC of the compressed data in flash. */
+static uint32_t hibernate_flash_crc(uint32_t nbytes)
+{
+    uint32_t buf[16];
+    uint32_t crc = 0;
+
+    rvlib_spiflash_read_start(RVSYS_FLASH_HIBERNATE_ADDR + HIBERNATE_DATA_OFFSET);
+    while (nbytes > 0) {
+        uint32_t n = (nbytes < sizeof(buf)) ? nbytes : sizeof(buf);
+        rvlib_spiflash_read_continue((unsigned char *)buf, n);
+        crc = rvlib_crc32(crc, (unsigned char *)buf, n);
+        nbytes -= n;
+    }
+    rvlib_spiflash_read_end();
+
+    return crc;
+}
+
+
+/*
+ * Read the next bytes of the compressed data.
+ *
+ * The decompressed data may have overwritten the variables of the
+ * SPI flash driver with their values at the time of the snapshot.
+ * Put back the driver state of the current read before each access.
+ */
+static void hibernate_read(const struct rvlib_spiflash_driver_state *drv,
+                           void *buf,
+                           size_t nbytes)
+{
+    rvlib_spiflash_restore_driver_state(drv);
+    rvlib_spiflash_read_continue((unsigned char *)buf, nbytes);
+}
+
+
+/* Decompress data from the current flash read into a range of memory words. */
+static void hibernate_decompress(const struct rvlib_spiflash_driver_state *drv,
+                                 uint32_t *p,
+                                 uint32_t *end)
+{
+    while (p < end) {
+        uint32_t token;
+        hibernate_read(drv, &token, 4);
+        uint32_t n = token & ~HIBERNATE_ZERO_RUN;
+        if (n > (uint32_t)(end - p)) {
+            n = end - p;
+        }
+        if ((token & HIBERNATE_ZERO_RUN) != 0) {
+            memzero_aligned(p, n * 4);
+        } else {
+            hibernate_read(drv, p, n * 4);
+        }
+        p += n;
+    }
+}
+
+
+/*
+ * Restore RAM from the snapshot, then continue in rvlib_hibernate_save().
+ * This runs on a stack in the unused area between the heap and the
+ * saved stack pointer, which is not part of the snapshot.
+ */
+static void hibernate_restore(void *arg)
+{
+    struct hibernate_header hdr = *(const struct hibernate_header *)arg;
+
+    /* Keep the start time of the current boot. */
+    uint32_t start_cycle = rvlib_start_cycle;
+
+    /*
+     * Keep the SPI flash driver state of the current boot on this stack.
+     * It matches the controller as set up by rvlib_spiflash_init()
+     * during resume, and it is left in place after the restore.
+     */
+    struct rvlib_spiflash_driver_state drv;
+    rvlib_spiflash_save_driver_state(&drv);
+
+    rvlib_spiflash_read_start(RVSYS_FLASH_HIBERNATE_ADDR + HIBERNATE_DATA_OFFSET);
+    hibernate_decompress(&drv, (uint32_t *)hdr.data_start, (uint32_t *)hdr.data_end);
+    hibernate_decompress(&drv, (uint32_t *)hdr.stack_ptr, (uint32_t *)hdr.stack_end);
+    rvlib_spiflash_restore_driver_state(&drv);
+    rvlib_spiflash_read_end();
+
+    rvlib_start_cycle = start_cycle;
+
+    rvlib_hibernate_jump(hdr.stack_ptr);
+}
+
+
+void rvlib_hibernate_resume(void)
+{
+    struct hibernate_header hdr;
+    uint32_t cur_sp, new_sp;
+
+    rvlib_spiflash_init();
+    rvlib_spiflash_read_mem(RVSYS_FLASH_HIBERNATE_ADDR,
+                            (unsigned char *)&hdr,
+                            sizeof(hdr));
+
+    /* Check that the snapshot is valid and belongs to this program. */
+    if (hdr.magic != HIBERNATE_MAGIC
+            || hdr.header_crc != rvlib_crc32(0,
+                                 (const unsigned char *)&hdr,
+                                 offsetof(struct hibernate_header, header_crc))
+            || hdr.data_start != (uint32_t)__data_start
+            || hdr.data_end != (uint32_t)__heap_end
+            || hdr.stack_end != (uint32_t)__stack
+            || hdr.comp_size > HIBERNATE_DATA_MAX
+            || hdr.text_crc != hibernate_text_crc()) {
+        return;
+    }
+
+    /*
+     * Choose a stack for the restore code below the current stack frame
+     * and below the saved stack pointer. It must not reach into the heap.
+     */
+    __asm__ ("mv %0, sp" : "=r" (cur_sp));
+    new_sp = (cur_sp < hdr.stack_ptr) ? cur_sp : hdr.stack_ptr;
+    new_sp &= ~15U;
+    if (new_sp < (uint32_t)__heap_end + RVLIB_HIBERNATE_MIN_RESUME_STACK) {
+        return;
+    }
+
+    /* Verify the compressed data before overwriting any RAM. */
+    if (hibernate_flash_crc(hdr.comp_size) != hdr.comp_crc) {
+        return;
+    }
+
+    rvlib_hibernate_call_on_stack(hibernate_restore, &hdr, new_sp);
+}
+
+
+int rvlib_hibernate_invalidate(void)
+{
+    return rvlib_spiflash_sector_erase(RVSYS_FLASH_HIBERNATE_ADDR);
+}
+
+/* end */
@@ -0,0 +1,96 @@
+/*
+ * Hibernate to flash: save a snapshot of RAM and CPU state in the
+ * SPI flash memory and resume from it at the next boot.
+ *
+ * rvlib_hibernate_save() writes a compressed copy of all program data
+ * (.data, .bss, heap and the used part of the stack) together with the
+ * callee-save CPU registers to the hibernate area of the flash memory.
+ * The program code itself is not saved; it must be identical at resume.
+ *
+ * A program that includes RVLIB_HIBERNATE_RESUME_AT_STARTUP checks the
+ * flash for a valid snapshot during startup, before static constructors
+ * and main(). If a snapshot of the same program is found, RAM is restored
+ * and execution continues by returning from rvlib_hibernate_save()
+ * with return value 1. Otherwise the program starts normally.
+ *
+ * Only RAM and CPU registers are restored. Peripheral registers,
+ * CSRs (mtvec, mie, mstatus) and the timer are in their reset state
+ * after resume; the application must re-initialize them when
+ * rvlib_hibernate_save() returns 1. Interrupts are disabled after resume.
+ * The SPI flash driver is an exception: its state is that of the
+ * rvlib_spiflash_init() done during resume, so it can be used directly.
+ *
+ * The snapshot stays valid until it is overwritten or invalidated,
+ * so the program resumes from the same point at every boot.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_HIBERNATE_H_
+#define RVLIB_HIBERNATE_H_
+
+#include <stdint.h>
+
+
+/* Error codes in addition to RVLIB_SPIFLASH_ERR_xxx. */
+#define RVLIB_HIBERNATE_ERR_NOSPACE     (-4)
+#define RVLIB_HIBERNATE_ERR_STACK       (-5)
+
+/*
+ * Minimum amount of free stack space below the stack pointer of
+ * rvlib_hibernate_save(). The resume code runs in this space.
+ */
+#define RVLIB_HIBERNATE_MIN_RESUME_STACK    256
+
+
+/*
+ * Save a snapshot of RAM and CPU registers to flash.
+ *
+ * This function erases the hibernate area of the flash, then writes
+ * the snapshot. It takes about as long as erasing 2 flash sectors.
+ * It must be called with interrupts disabled.
+ * rvlib_spiflash_init() must have been called before.
+ *
+ * Return:
+ *     0 if the snapshot was saved;
+ *     1 when returning from this call after resuming from the snapshot;
+ *     RVLIB_HIBERNATE_ERR_STACK if there is not enough free stack space;
+ *     RVLIB_HIBERNATE_ERR_NOSPACE if the snapshot does not fit in flash;
+ *     RVLIB_SPIFLASH_ERR_xxx if a flash operation failed.
+ */
+int rvlib_hibernate_save(void);
+
+/*
+ * Check for a valid snapshot and resume from it.
+ *
+ * This function does not return if a valid snapshot is found.
+ * Otherwise it returns without modifying any program data.
+ *
+ * It may only be called from startup code, before static constructors,
+ * as done by RVLIB_HIBERNATE_RESUME_AT_STARTUP.
+ */
+void rvlib_hibernate_resume(void);
+
+/*
+ * Invalidate the saved snapshot, if any.
+ *
+ * Return 0 on success or RVLIB_SPIFLASH_ERR_xxx on failure.
+ */
+int rvlib_hibernate_invalidate(void);
+
+/*
+ * Place this macro in one source file of the application (outside any
+ * function) to resume from a valid snapshot during program startup.
+ */
+#define RVLIB_HIBERNATE_RESUME_AT_STARTUP \
+    static void (* const rvlib_hibernate_preinit_)(void) \
+        __attribute__((section(".preinit_array"), used)) \
+        = rvlib_hibernate_resume
+
+#endif  // RVLIB_HIBERNATE_H_
@@ -0,0 +1,240 @@
+/*
+ * I2C master driver.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_i2c.h"
+
+
+/* Active transaction, or NULL. */
+static struct rvlib_i2c_xfer *i2c_xfer;
+
+/* Index of the next command of the active transaction to queue. */
+static size_t i2c_cmd_index;
+
+/* Number of bytes received for the active transaction. */
+static size_t i2c_read_pos;
+
+
+/* Return the number of commands of a transaction. */
+static size_t i2c_num_commands(const struct rvlib_i2c_xfer *xfer)
+{
+    size_t n = 2 + xfer->wlen + 1;      // START, address, data, STOP
+    if (xfer->wlen > 0 && xfer->rlen > 0) {
+        n += 2;                         // repeated START, address
+    }
+    return n + xfer->rlen;
+}
+
+
+/* Return command number "i" of a transaction. */
+static uint32_t i2c_command(const struct rvlib_i2c_xfer *xfer, size_t i)
+{
+    if (i == 0) {
+        return RVLIB_I2C_CMD_START;
+    }
+    if (i == 1) {
+        int rd = (xfer->wlen == 0 && xfer->rlen > 0);
+        return RVLIB_I2C_CMD_WRITE | (xfer->addr << 1) | rd;
+    }
+    i -= 2;
+    if (i < xfer->wlen) {
+        return RVLIB_I2C_CMD_WRITE | xfer->wbuf[i];
+    }
+    i -= xfer->wlen;
+    if (xfer->wlen > 0 && xfer->rlen > 0) {
+        if (i == 0) {
+            return RVLIB_I2C_CMD_START;
+        }
+        if (i == 1) {
+            return RVLIB_I2C_CMD_WRITE | (xfer->addr << 1) | 1;
+        }
+        i -= 2;
+    }
+    if (i < xfer->rlen) {
+        // Acknowledge all bytes except the last.
+        return (i + 1 < xfer->rlen) ? RVLIB_I2C_CMD_READ_ACK
+                                    : RVLIB_I2C_CMD_READ_NACK;
+    }
+    return RVLIB_I2C_CMD_STOP;
+}
+
+
+/* Initialize the I2C controller. */
+int rvlib_i2c_init(uint32_t scl_freq)
+{
+    i2c_xfer = NULL;
+
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_CTRL,
+                       RVLIB_I2C_CTRL_PIN_ENABLE);
+    if (rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_CTRL)
+        != RVLIB_I2C_CTRL_PIN_ENABLE) {
+        return RVLIB_I2C_ERR_NOTREADY;
+    }
+
+    // Round the quarter period up, such that SCL is never too fast.
+    uint32_t quarter = (RVLIB_CPU_FREQ_MHZ * 1000000UL + 4 * scl_freq - 1)
+                       / (4 * scl_freq);
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_CLOCK, quarter);
+
+    // Drop data left over from a previous program.
+    while ((rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_DATA) & 0x100) != 0) ;
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_STATUS,
+                       RVLIB_I2C_STATUS_DONE | RVLIB_I2C_STATUS_NACK);
+
+    return 0;
+}
+
+
+/* Start a transaction. */
+int rvlib_i2c_start(struct rvlib_i2c_xfer *xfer)
+{
+    if (i2c_xfer != NULL) {
+        return RVLIB_I2C_ERR_NOTREADY;
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_STATUS,
+                       RVLIB_I2C_STATUS_DONE | RVLIB_I2C_STATUS_NACK);
+
+    xfer->status = RVLIB_I2C_BUSY;
+    i2c_cmd_index = 0;
+    i2c_read_pos = 0;
+    i2c_xfer = xfer;
+
+    rvlib_i2c_poll();
+    return 0;
+}
+
+
+/* Make progress on the active transaction. */
+int rvlib_i2c_poll(void)
+{
+    struct rvlib_i2c_xfer *xfer = i2c_xfer;
+    if (xfer == NULL) {
+        return 0;
+    }
+
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_STATUS);
+
+    // Fetch received bytes.
+    size_t nread = (status >> 16) & 0xff;
+    while (nread > 0) {
+        uint32_t data = rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_DATA);
+        if (i2c_read_pos < xfer->rlen) {
+            xfer->rbuf[i2c_read_pos++] = data;
+        }
+        nread--;
+    }
+
+    // Queue commands while there is space in the command FIFO.
+    size_t ncmd = i2c_num_commands(xfer);
+    while (i2c_cmd_index < ncmd) {
+        status = rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_STATUS);
+        if ((status & RVLIB_I2C_STATUS_CMDRDY) == 0) {
+            break;
+        }
+        rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_DATA,
+                           i2c_command(xfer, i2c_cmd_index));
+        i2c_cmd_index++;
+    }
+
+    if ((status & RVLIB_I2C_STATUS_DONE) == 0) {
+        return RVLIB_I2C_BUSY;
+    }
+
+    // The STOP has completed; fetch the last bytes.
+    while (1) {
+        uint32_t data = rvlib_hw_read_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_DATA);
+        if ((data & 0x100) == 0) {
+            break;
+        }
+        if (i2c_read_pos < xfer->rlen) {
+            xfer->rbuf[i2c_read_pos++] = data;
+        }
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_STATUS,
+                       RVLIB_I2C_STATUS_DONE | RVLIB_I2C_STATUS_NACK);
+
+    i2c_xfer = NULL;
+    xfer->status = ((status & RVLIB_I2C_STATUS_NACK) != 0) ? RVLIB_I2C_ERR_NACK : 0;
+    return xfer->status;
+}
+
+
+/* Run a transaction and wait until it completes. */
+int rvlib_i2c_transfer(struct rvlib_i2c_xfer *xfer)
+{
+    int status = rvlib_i2c_start(xfer);
+    if (status != 0) {
+        return status;
+    }
+    while (xfer->status == RVLIB_I2C_BUSY) {
+        rvlib_i2c_poll();
+    }
+    return xfer->status;
+}
+
+
+/* Write to consecutive registers. */
+int rvlib_i2c_write_reg(uint8_t addr, uint8_t reg,
+                        const uint8_t *data, size_t len)
+{
+    uint8_t buf[16];
+    struct rvlib_i2c_xfer xfer;
+    int status = 0;
+
+    // Send the register address and data in chunks of limited size.
+    while (status == 0 && len > 0) {
+        size_t n = (len < sizeof(buf)) ? len : sizeof(buf) - 1;
+        buf[0] = reg;
+        for (size_t i = 0; i < n; i++) {
+            buf[i+1] = data[i];
+        }
+        xfer.addr = addr;
+        xfer.wbuf = buf;
+        xfer.wlen = n + 1;
+        xfer.rbuf = NULL;
+        xfer.rlen = 0;
+        status = rvlib_i2c_transfer(&xfer);
+        reg += n;
+        data += n;
+        len -= n;
+    }
+
+    return status;
+}
+
+
+/* Read from consecutive registers. */
+int rvlib_i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t *buf, size_t len)
+{
+    struct rvlib_i2c_xfer xfer;
+    xfer.addr = addr;
+    xfer.wbuf = &reg;
+    xfer.wlen = 1;
+    xfer.rbuf = buf;
+    xfer.rlen = len;
+    return rvlib_i2c_transfer(&xfer);
+}
+
+
+/* Enable or disable the interrupt of the I2C controller. */
+void rvlib_i2c_enable_interrupt(int enable)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_I2C + RVLIB_I2C_REG_CTRL,
+                       RVLIB_I2C_CTRL_PIN_ENABLE
+                       | (enable ? RVLIB_I2C_CTRL_IRQ_ENABLE : 0));
+}
+
+/* end */
@@ -0,0 +1,141 @@
+/*
+ * I2C master driver.
+ *
+ * The I2C controller executes START, WRITE, READ and STOP commands from
+ * a command FIFO. This driver turns a register transaction (write some
+ * bytes, then optionally read some bytes after a repeated START) into
+ * a command sequence and feeds it to the controller in the background.
+ *
+ * A transaction is started with rvlib_i2c_start(). It then progresses
+ * each time rvlib_i2c_poll() is called, either from the main loop or
+ * from the external interrupt handler (see rvlib_i2c_enable_interrupt()).
+ * Only one transaction can be active at a time.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_I2C_H_
+#define RVLIB_I2C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* I2C controller registers. */
+#define RVLIB_I2C_REG_STATUS        0x00
+#define RVLIB_I2C_REG_DATA          0x04
+#define RVLIB_I2C_REG_CLOCK         0x08
+#define RVLIB_I2C_REG_CTRL          0x0c
+
+/* Bits in the status register. */
+#define RVLIB_I2C_STATUS_BUSY       0x01
+#define RVLIB_I2C_STATUS_CMDRDY     0x02
+#define RVLIB_I2C_STATUS_READRDY    0x04
+#define RVLIB_I2C_STATUS_DONE       0x08
+#define RVLIB_I2C_STATUS_NACK       0x10
+#define RVLIB_I2C_STATUS_STALLED    0x20
+
+/* Command codes (bits 10-8 of the data register). */
+#define RVLIB_I2C_CMD_START         0x100
+#define RVLIB_I2C_CMD_STOP          0x200
+#define RVLIB_I2C_CMD_WRITE         0x300
+#define RVLIB_I2C_CMD_READ_ACK      0x400
+#define RVLIB_I2C_CMD_READ_NACK     0x500
+
+/* Bits in the control register. */
+#define RVLIB_I2C_CTRL_PIN_ENABLE   0x01
+#define RVLIB_I2C_CTRL_IRQ_ENABLE   0x02
+
+/* Standard bus speeds in Hz. */
+#define RVLIB_I2C_SPEED_STANDARD    100000
+#define RVLIB_I2C_SPEED_FAST        400000
+#define RVLIB_I2C_SPEED_FAST_PLUS   1000000
+
+/* Transaction status. */
+#define RVLIB_I2C_BUSY              1
+#define RVLIB_I2C_ERR_NACK          (-1)
+#define RVLIB_I2C_ERR_NOTREADY      (-2)
+
+
+/*
+ * Description of a transaction.
+ *
+ * The transaction writes "wlen" bytes from "wbuf" to the slave, then
+ * reads "rlen" bytes into "rbuf" after a repeated START. Either part may
+ * be empty. For a register read, "wbuf" holds the register address.
+ *
+ * The structure must remain valid until the transaction completes.
+ */
+struct rvlib_i2c_xfer {
+    uint8_t         addr;       // 7-bit slave address
+    const uint8_t   *wbuf;
+    size_t          wlen;
+    uint8_t         *rbuf;
+    size_t          rlen;
+    volatile int    status;     // RVLIB_I2C_BUSY, 0 or an error code
+};
+
+
+/*
+ * Initialize the I2C controller.
+ *
+ * Set the SCL frequency in Hz and connect the I2C pins to the controller.
+ *
+ * Return 0 on success, RVLIB_I2C_ERR_NOTREADY if the controller is not present.
+ */
+int rvlib_i2c_init(uint32_t scl_freq);
+
+/*
+ * Start a transaction.
+ *
+ * Queue the first commands of the transaction and return immediately.
+ * The transaction completes in subsequent calls to rvlib_i2c_poll().
+ *
+ * Return 0 if the transaction has started,
+ * RVLIB_I2C_ERR_NOTREADY if another transaction is still active.
+ */
+int rvlib_i2c_start(struct rvlib_i2c_xfer *xfer);
+
+/*
+ * Make progress on the active transaction.
+ *
+ * Queue further commands and fetch received bytes. When the transaction
+ * completes, set its status field and clear the interrupt condition.
+ * This function does not wait. It may be called from an interrupt handler.
+ *
+ * Return RVLIB_I2C_BUSY while the transaction is active,
+ * 0 when the transaction completed successfully (or none was active),
+ * or RVLIB_I2C_ERR_NACK if the slave did not acknowledge a byte.
+ */
+int rvlib_i2c_poll(void);
+
+/*
+ * Run a transaction and wait until it completes.
+ *
+ * Return 0 on success or a negative error code.
+ */
+int rvlib_i2c_transfer(struct rvlib_i2c_xfer *xfer);
+
+/* Write "len" bytes to consecutive registers, starting at "reg". */
+int rvlib_i2c_write_reg(uint8_t addr, uint8_t reg,
+                        const uint8_t *data, size_t len);
+
+/* Read "len" bytes from consecutive registers, starting at "reg". */
+int rvlib_i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t *buf, size_t len);
+
+/*
+ * Enable or disable the interrupt of the I2C controller.
+ *
+ * When enabled, the controller raises an external interrupt when
+ * a transaction completes or needs more commands. The interrupt handler
+ * must call rvlib_i2c_poll().
+ */
+void rvlib_i2c_enable_interrupt(int enable);
+
+#endif  // RVLIB_I2C_H_
@@ -0,0 +1,92 @@
+/*
+ * Driver for the ICAPE2 configuration port controller.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include "rvlib_hardware.h"
+#include "rvlib_time.h"
+#include "rvlib_icap.h"
+
+
+/* ICAP controller interface. */
+#define RVLIB_ICAP_REG_CTRL             0
+#define RVLIB_ICAP_REG_DATA             4
+#define RVLIB_ICAP_BIT_CTRL_READ        0
+#define RVLIB_ICAP_BIT_CTRL_SELECT      1
+
+/* Configuration packet words (see Xilinx UG470). */
+#define ICAP_DUMMY_WORD                 0xffffffff
+#define ICAP_SYNC_WORD                  0xaa995566
+#define ICAP_NOOP                       0x20000000
+#define ICAP_TYPE1_READ(reg, n)         (0x28000000 | ((reg) << 13) | (n))
+#define ICAP_TYPE1_WRITE(reg, n)        (0x30000000 | ((reg) << 13) | (n))
+#define ICAP_CFGREG_CMD                 0x04
+#define ICAP_CMD_IPROG                  0x0f
+#define ICAP_CMD_DESYNC                 0x0d
+
+
+/* Write a word to the ICAP. */
+static void icap_write(uint32_t w)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_DATA, w);
+}
+
+
+/* Read an FPGA configuration register. */
+uint32_t rvlib_icap_read_config_reg(unsigned int reg)
+{
+    /* Synchronize and request one word from the register. */
+    icap_write(ICAP_DUMMY_WORD);
+    icap_write(ICAP_SYNC_WORD);
+    icap_write(ICAP_NOOP);
+    icap_write(ICAP_NOOP);
+    icap_write(ICAP_TYPE1_READ(reg, 1));
+    icap_write(ICAP_NOOP);
+    icap_write(ICAP_NOOP);
+
+    /* Switch to read mode, then select the ICAP to read the word. */
+    rvlib_hw_write_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_CTRL,
+                       (1 << RVLIB_ICAP_BIT_CTRL_READ));
+    rvlib_hw_write_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_CTRL,
+                       (1 << RVLIB_ICAP_BIT_CTRL_READ) |
+                       (1 << RVLIB_ICAP_BIT_CTRL_SELECT));
+    usleep(1);
+    rvlib_hw_write_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_CTRL,
+                       (1 << RVLIB_ICAP_BIT_CTRL_READ));
+    uint32_t value = rvlib_hw_read_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_DATA);
+
+    /* Switch back to write mode and desynchronize. */
+    rvlib_hw_write_reg(RVSYS_ADDR_ICAP + RVLIB_ICAP_REG_CTRL, 0);
+    icap_write(ICAP_TYPE1_WRITE(ICAP_CFGREG_CMD, 1));
+    icap_write(ICAP_CMD_DESYNC);
+    icap_write(ICAP_NOOP);
+    icap_write(ICAP_NOOP);
+
+    return value;
+}
+
+
+/* Reconfigure the FPGA from the specified flash address. */
+_Noreturn void rvlib_icap_reboot(uint32_t flash_address)
+{
+    icap_write(ICAP_DUMMY_WORD);
+    icap_write(ICAP_SYNC_WORD);
+    icap_write(ICAP_NOOP);
+    icap_write(ICAP_TYPE1_WRITE(RVLIB_ICAP_CFGREG_WBSTAR, 1));
+    icap_write(flash_address);
+    icap_write(ICAP_TYPE1_WRITE(ICAP_CFGREG_CMD, 1));
+    icap_write(ICAP_CMD_IPROG);
+    icap_write(ICAP_NOOP);
+
+    /* The FPGA reconfigures within a few cycles. */
+    while (1) ;
+}
+
+/* end */
@@ -0,0 +1,60 @@
+/*
+ * Driver for the ICAPE2 configuration port controller.
+ *
+ * This driver can read FPGA configuration registers and trigger
+ * a reconfiguration from a different bitstream in the configuration
+ * flash memory (multiboot via IPROG).
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_ICAP_H_
+#define RVLIB_ICAP_H_
+
+#include <stdint.h>
+
+
+/* Configuration register addresses (see Xilinx UG470). */
+#define RVLIB_ICAP_CFGREG_STAT      0x07
+#define RVLIB_ICAP_CFGREG_WBSTAR    0x10
+#define RVLIB_ICAP_CFGREG_BOOTSTS   0x16
+
+/*
+ * Bits in the BOOTSTS register.
+ *
+ * Bits 7:0 describe the most recent configuration event.
+ * Bits 15:8 describe the configuration event before that.
+ */
+#define RVLIB_ICAP_BOOTSTS_VALID        0
+#define RVLIB_ICAP_BOOTSTS_FALLBACK     1
+#define RVLIB_ICAP_BOOTSTS_IPROG        2
+#define RVLIB_ICAP_BOOTSTS_WTO_ERROR    3
+#define RVLIB_ICAP_BOOTSTS_ID_ERROR     4
+#define RVLIB_ICAP_BOOTSTS_CRC_ERROR    5
+#define RVLIB_ICAP_BOOTSTS_WRAP_ERROR   6
+
+
+/* Read an FPGA configuration register. */
+uint32_t rvlib_icap_read_config_reg(unsigned int reg);
+
+/*
+ * Reconfigure the FPGA from the bitstream at the specified address
+ * in the configuration flash memory.
+ *
+ * This function sends an IPROG command. The FPGA then reloads its
+ * configuration, which also restarts the RISC-V system.
+ * This function does not return.
+ *
+ * If loading the new bitstream fails and configuration fallback is
+ * enabled in the bitstream settings, the FPGA loads the golden
+ * bitstream from address 0 instead.
+ */
+_Noreturn void rvlib_icap_reboot(uint32_t flash_address);
+
+#endif  // RVLIB_ICAP_H_
@@ -0,0 +1,45 @@
+/*
+ * Interrupt priorities for nested interrupt handling.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stdint.h>
+#include "rvlib_interrupt.h"
+
+
+/* Mask of "mie" bits that stay enabled while each handler runs. */
+uint32_t rvlib_interrupt_nest_mask[4];
+
+/* Priority of each interrupt source. */
+static unsigned int interrupt_priority[RVLIB_NUM_IRQ];
+
+
+/* Set the priority of an interrupt source. */
+void rvlib_interrupt_set_priority(unsigned int irq, unsigned int priority)
+{
+    if (irq >= RVLIB_NUM_IRQ) {
+        return;
+    }
+
+    interrupt_priority[irq] = priority;
+
+    // Recompute the nesting masks. The "mie" bit of source N is bit 4*N+3.
+    for (unsigned int i = 0; i < RVLIB_NUM_IRQ; i++) {
+        uint32_t mask = 0;
+        for (unsigned int k = 0; k < RVLIB_NUM_IRQ; k++) {
+            if (interrupt_priority[k] > interrupt_priority[i]) {
+                mask |= 1UL << (4 * k + 3);
+            }
+        }
+        rvlib_interrupt_nest_mask[i] = mask;
+    }
+}
+
+/* end */
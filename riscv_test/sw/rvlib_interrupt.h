@@ -14,6 +14,24 @@
 #define RVLIB_INTERRUPT_H_
 
 #include <stdint.h>
+#include "rvlib_hardware.h"
+
+
+/*
+ * Interrupt sources, numbered as (mcause code / 4).
+ * Used with rvlib_interrupt_set_priority().
+ */
+#define RVLIB_IRQ_SOFTWARE      0
+#define RVLIB_IRQ_TIMER         1
+#define RVLIB_IRQ_EXTERNAL      2
+#define RVLIB_NUM_IRQ           3
+
+/*
+ * Per-source mask of "mie" bits which remain enabled while the handler
+ * for that source runs in nested mode. Maintained by
+ * rvlib_interrupt_set_priority(); used by the nested trap vector.
+ */
+extern uint32_t rvlib_interrupt_nest_mask[4];
 
 
 /*
@@ -41,6 +59,42 @@ static inline void rvlib_interrupt_init(void)
 }
 
 
+/*
+ * Initialize interrupt handling with support for nested interrupts.
+ *
+ * Call this function instead of rvlib_interrupt_init() (never both;
+ * the linker script rejects programs that reference both).
+ * It selects a trap vector which re-enables interrupts while a handler
+ * runs, such that a handler can be interrupted by sources with a higher
+ * priority (see rvlib_interrupt_set_priority()). All sources have equal
+ * priority by default, so nothing nests until priorities are assigned.
+ *
+ * Nesting costs about 30 extra instructions per interrupt and 16 bytes
+ * of stack per nesting level.
+ *
+ * While a handler runs, the enable bits of its own source and of
+ * lower-priority sources are restored when the handler returns.
+ * A handler should therefore not enable or disable those sources.
+ */
+static inline void rvlib_interrupt_init_nested(void)
+{
+    void __trap_vector_nested(void);
+    asm volatile ( "" : : "r" (__trap_vector_nested) );
+}
+
+
+/*
+ * Set the priority of an interrupt source (RVLIB_IRQ_xxx).
+ *
+ * In nested mode, a handler can be interrupted by sources with a
+ * strictly higher priority. Priorities are small integers; the default
+ * priority of all sources is 0.
+ *
+ * Call this function while the affected interrupts are disabled.
+ */
+void rvlib_interrupt_set_priority(unsigned int irq, unsigned int priority);
+
+
 /* Enable interrupts. */
 static inline void rvlib_interrupt_enable(void)
 {
@@ -85,7 +139,7 @@ static inline void rvlib_enable_timer_interrupt(int enable)
     if (enable) {
         asm volatile ( "csrs mie, %0" : : "r" (MIE_MTIE) );
     } else {
-        asm volatile ( "csrs mie, %0" : : "r" (MIE_MTIE) );
+        asm volatile ( "csrc mie, %0" : : "r" (MIE_MTIE) );
     }
 }
 
@@ -102,8 +156,21 @@ static inline void rvlib_enable_external_interrupt(int enable)
     if (enable) {
         asm volatile ( "csrs mie, %0" : : "r" (MIE_MEIE) );
     } else {
-        asm volatile ( "csrs mie, %0" : : "r" (MIE_MEIE) );
+        asm volatile ( "csrc mie, %0" : : "r" (MIE_MEIE) );
     }
 }
 
+
+
+/*
+ * Set or clear the software interrupt request (MSIP register).
+ *
+ * The software interrupt stays pending until it is cleared, so the
+ * handler must call rvlib_set_software_interrupt(0).
+ */
+static inline void rvlib_set_software_interrupt(int pending)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_TIMER + 16, pending ? 1 : 0);
+}
+
 #endif  // RVLIB_INTERRUPT_H_
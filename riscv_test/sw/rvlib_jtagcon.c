@@ -0,0 +1,100 @@
+/*
+ * JTAG console driver.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include "rvlib_hardware.h"
+#include "rvlib_jtagcon.h"
+
+
+#define RVLIB_JTAGCON_REG_DATA          0
+#define RVLIB_JTAGCON_REG_STATUS        4
+#define RVLIB_JTAGCON_BIT_DATA_RXVALID  16
+#define RVLIB_JTAGCON_BIT_STATUS_ACTIVE 0
+#define RVLIB_JTAGCON_BIT_STATUS_TXFULL 14
+#define RVLIB_JTAGCON_BIT_STATUS_TXBUSY 15
+
+
+/* Return 1 if the host polled the JTAG console recently. */
+int rvlib_jtagcon_connected(void)
+{
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_STATUS);
+    return (status >> RVLIB_JTAGCON_BIT_STATUS_ACTIVE) & 1;
+}
+
+
+/* Send a byte through the JTAG console. */
+int rvlib_jtagcon_send_byte(uint8_t b)
+{
+    uint32_t status;
+
+    /* Wait until there is space in the transmit FIFO,
+       unless the host is not connected. */
+    while (1) {
+        status = rvlib_hw_read_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_STATUS);
+        if ((status & (1 << RVLIB_JTAGCON_BIT_STATUS_TXFULL)) == 0) {
+            break;
+        }
+        if ((status & (1 << RVLIB_JTAGCON_BIT_STATUS_ACTIVE)) == 0) {
+            return 0;
+        }
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_DATA, b);
+    return 1;
+}
+
+
+/* Send a block of bytes through the JTAG console. */
+size_t rvlib_jtagcon_write(const unsigned char *buf, size_t nbytes)
+{
+    size_t p = 0;
+    while (p < nbytes) {
+        uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_STATUS);
+        if ((status & (1 << RVLIB_JTAGCON_BIT_STATUS_TXFULL)) == 0) {
+            rvlib_hw_write_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_DATA, buf[p]);
+            p++;
+        } else if ((status & (1 << RVLIB_JTAGCON_BIT_STATUS_ACTIVE)) == 0) {
+            break;
+        }
+    }
+    return p;
+}
+
+
+/* Return received byte, or return -1 if no byte available. */
+int rvlib_jtagcon_recv_byte(void)
+{
+    uint32_t b = rvlib_hw_read_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_DATA);
+    if (b & (1 << RVLIB_JTAGCON_BIT_DATA_RXVALID)) {
+        return (b & 0xff);
+    } else {
+        return -1;
+    }
+}
+
+
+/* Return 1 if all bytes have been taken by the host. */
+int rvlib_jtagcon_tx_empty(void)
+{
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_JTAGCON + RVLIB_JTAGCON_REG_STATUS);
+    return ((status & (1 << RVLIB_JTAGCON_BIT_STATUS_TXBUSY)) == 0);
+}
+
+
+/* Write a byte to the JTAG console. */
+int rvlib_jtagcon_putchar(int c)
+{
+    c &= 0xff;
+    rvlib_jtagcon_send_byte(c);
+    return c;
+}
+
+/* end */
@@ -0,0 +1,67 @@
+/*
+ * JTAG console driver.
+ *
+ * The JTAG console is a byte stream channel between the processor and
+ * a host PC, through the same JTAG connection that is used for remote
+ * debugging. On the host side, the console is served by "jtagcon_bridge"
+ * (see the "tools" directory) via OpenOCD.
+ *
+ * To send all console output through the JTAG console, the application
+ * can override the default console functions:
+ *
+ *   int rvlib_putchar(int c) { return rvlib_jtagcon_putchar(c); }
+ *   int rvlib_getchar(void) { return rvlib_jtagcon_recv_byte(); }
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_JTAGCON_H_
+#define RVLIB_JTAGCON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * Return 1 if the host polled the JTAG console recently, 0 otherwise.
+ *
+ * The console is considered disconnected when the host has not polled
+ * for about 0.17 seconds.
+ */
+int rvlib_jtagcon_connected(void);
+
+/*
+ * Send a byte through the JTAG console.
+ *
+ * Wait while the transmit FIFO is full.
+ * If the host is not connected, the byte is discarded when the FIFO is full.
+ *
+ * Returns:
+ *     1 if the byte was queued, 0 if the byte was discarded.
+ */
+int rvlib_jtagcon_send_byte(uint8_t b);
+
+/*
+ * Send a block of bytes through the JTAG console.
+ *
+ * Returns:
+ *     Number of bytes queued for transmission.
+ */
+size_t rvlib_jtagcon_write(const unsigned char *buf, size_t nbytes);
+
+/* Return a received byte, or return -1 if no byte is available. */
+int rvlib_jtagcon_recv_byte(void);
+
+/* Return 1 if all bytes have been taken by the host, 0 otherwise. */
+int rvlib_jtagcon_tx_empty(void);
+
+/* Write a byte to the JTAG console. Same interface as rvlib_putchar(). */
+int rvlib_jtagcon_putchar(int c);
+
+#endif  // RVLIB_JTAGCON_H_
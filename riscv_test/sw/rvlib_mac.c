@@ -0,0 +1,166 @@
+/*
+ * Driver for the multiply-accumulate engine.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_mac.h"
+
+
+/* Number of FIR taps supported by the hardware, or 0 to use software. */
+static unsigned int mac_hw_taps;
+
+
+static inline void mac_write(uint32_t reg, uint32_t value)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_MAC + reg, value);
+}
+
+
+/* Read the accumulator. This waits until all pending operations finish. */
+static inline int64_t mac_read_acc(void)
+{
+    uint32_t lo = rvlib_hw_read_reg(RVSYS_ADDR_MAC + RVLIB_MAC_REG_ACC_LO);
+    uint32_t hi = rvlib_hw_read_reg(RVSYS_ADDR_MAC + RVLIB_MAC_REG_ACC_HI);
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+
+int rvlib_mac_init(int allow_hw)
+{
+    mac_hw_taps = 0;
+    if (allow_hw) {
+        uint32_t ctrl = rvlib_hw_read_reg(RVSYS_ADDR_MAC + RVLIB_MAC_REG_CTRL);
+        unsigned int bufbits = (ctrl >> RVLIB_MAC_CTRL_BUFBITS_SHIFT) & 0x1f;
+        if (bufbits != 0) {
+            mac_hw_taps = 1U << bufbits;
+        }
+    }
+    return (mac_hw_taps != 0);
+}
+
+
+int64_t rvlib_mac_mul64(int32_t a, int32_t b)
+{
+    if (mac_hw_taps == 0) {
+        return (int64_t)a * b;
+    }
+
+    mac_write(RVLIB_MAC_REG_A, a);
+    mac_write(RVLIB_MAC_REG_MUL, b);
+    return mac_read_acc();
+}
+
+
+int64_t rvlib_mac_dot32(const int32_t *a, const int32_t *b, size_t n)
+{
+    if (mac_hw_taps == 0) {
+        int64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += (int64_t)a[i] * b[i];
+        }
+        return sum;
+    }
+
+    mac_write(RVLIB_MAC_REG_CTRL, RVLIB_MAC_CTRL_CLEAR);
+    for (size_t i = 0; i < n; i++) {
+        mac_write(RVLIB_MAC_REG_A, a[i]);
+        mac_write(RVLIB_MAC_REG_MAC, b[i]);
+    }
+    return mac_read_acc();
+}
+
+
+int64_t rvlib_mac_dot16(const int16_t *a,
+                        const int16_t *b,
+                        size_t b_stride,
+                        size_t n)
+{
+    if (mac_hw_taps == 0) {
+        int64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += (int32_t)a[i] * b[i * b_stride];
+        }
+        return sum;
+    }
+
+    mac_write(RVLIB_MAC_REG_CTRL, RVLIB_MAC_CTRL_CLEAR);
+    for (size_t i = 0; i < n; i++) {
+        // Pack both operands in one write.
+        mac_write(RVLIB_MAC_REG_MAC16, (uint16_t)a[i] | ((uint32_t)*b << 16));
+        b += b_stride;
+    }
+    return mac_read_acc();
+}
+
+
+int rvlib_mac_fir_init(struct rvlib_mac_fir *fir,
+                       const int16_t *coef,
+                       int16_t *history,
+                       unsigned int ntaps)
+{
+    if (ntaps == 0) {
+        return -1;
+    }
+
+    fir->coef = coef;
+    fir->history = history;
+    fir->ntaps = ntaps;
+    fir->pos = 0;
+    fir->use_hw = (ntaps <= mac_hw_taps);
+
+    if (fir->use_hw) {
+        // Load coefficients and clear the sample history.
+        mac_write(RVLIB_MAC_REG_FIR_NTAPS, ntaps);
+        mac_write(RVLIB_MAC_REG_COEF_INDEX, 0);
+        for (unsigned int i = 0; i < ntaps; i++) {
+            mac_write(RVLIB_MAC_REG_COEF_DATA, (uint16_t)coef[i]);
+            mac_write(RVLIB_MAC_REG_FIR_PUSH, 0);
+        }
+    } else {
+        for (unsigned int i = 0; i < ntaps; i++) {
+            history[i] = 0;
+        }
+    }
+
+    return 0;
+}
+
+
+int64_t rvlib_mac_fir_sample(struct rvlib_mac_fir *fir, int16_t x)
+{
+    if (fir->use_hw) {
+        mac_write(RVLIB_MAC_REG_FIR_SAMPLE, (uint16_t)x);
+        return mac_read_acc();
+    }
+
+    // The history is a circular buffer; "pos" is the newest sample.
+    const int16_t *coef = fir->coef;
+    const int16_t *hist = fir->history;
+    unsigned int ntaps = fir->ntaps;
+    unsigned int pos = fir->pos + 1;
+    if (pos == ntaps) {
+        pos = 0;
+    }
+    fir->history[pos] = x;
+    fir->pos = pos;
+
+    int64_t sum = 0;
+    unsigned int k = pos;
+    for (unsigned int i = 0; i < ntaps; i++) {
+        sum += (int32_t)coef[i] * hist[k];
+        k = (k == 0) ? (ntaps - 1) : (k - 1);
+    }
+    return sum;
+}
+
+/* end */
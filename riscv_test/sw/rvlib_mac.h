@@ -0,0 +1,111 @@
+/*
+ * Driver for the multiply-accumulate engine.
+ *
+ * The processor has no multiply instruction. The MAC engine performs
+ * signed 32x32 -> 64 bit multiplications and 16x16 bit dot products
+ * with a 64-bit accumulator, and runs FIR filters of up to 256 taps
+ * on a sample buffer inside the peripheral.
+ *
+ * Every function also has a software implementation, which is used
+ * when the hardware is not present or disabled via rvlib_mac_init().
+ *
+ * The MAC engine has one accumulator and one FIR sample buffer.
+ * These functions must not be used from interrupt handlers while
+ * the main program also uses them.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_MAC_H_
+#define RVLIB_MAC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* MAC engine registers. */
+#define RVLIB_MAC_REG_CTRL          0x00
+#define RVLIB_MAC_REG_A             0x04
+#define RVLIB_MAC_REG_MAC           0x08
+#define RVLIB_MAC_REG_MUL           0x0c
+#define RVLIB_MAC_REG_MAC16         0x10
+#define RVLIB_MAC_REG_ACC_LO        0x14
+#define RVLIB_MAC_REG_ACC_HI        0x18
+#define RVLIB_MAC_REG_FIR_NTAPS     0x1c
+#define RVLIB_MAC_REG_COEF_INDEX    0x20
+#define RVLIB_MAC_REG_COEF_DATA     0x24
+#define RVLIB_MAC_REG_FIR_SAMPLE    0x28
+#define RVLIB_MAC_REG_FIR_PUSH      0x2c
+
+/* Bits in the control register. */
+#define RVLIB_MAC_CTRL_CLEAR        0x01
+#define RVLIB_MAC_CTRL_BUFBITS_SHIFT 8
+
+
+/* State of a FIR filter. */
+struct rvlib_mac_fir {
+    const int16_t *coef;        // coefficients, coef[0] applies to newest sample
+    int16_t *history;           // ntaps samples, used by the software version
+    unsigned int ntaps;
+    unsigned int pos;
+    int use_hw;
+};
+
+
+/*
+ * Detect the MAC engine.
+ *
+ * If "allow_hw" is zero, all functions use the software implementation.
+ * Otherwise they use the hardware if it is present.
+ *
+ * Return 1 if the hardware will be used, 0 otherwise.
+ * Without a call to this function, the software implementation is used.
+ */
+int rvlib_mac_init(int allow_hw);
+
+/* Return a * b as a signed 64-bit number. */
+int64_t rvlib_mac_mul64(int32_t a, int32_t b);
+
+/* Return the sum of a[i] * b[i] for i = 0 .. n-1. */
+int64_t rvlib_mac_dot32(const int32_t *a, const int32_t *b, size_t n);
+
+/*
+ * Return the sum of a[i] * b[i * b_stride] for i = 0 .. n-1.
+ *
+ * With b_stride > 1, this computes the product of a matrix row
+ * and a matrix column.
+ */
+int64_t rvlib_mac_dot16(const int16_t *a,
+                        const int16_t *b,
+                        size_t b_stride,
+                        size_t n);
+
+/*
+ * Initialize a FIR filter with "ntaps" coefficients.
+ *
+ * The "coef" and "history" arrays must remain valid while the filter
+ * is in use; "history" must have room for "ntaps" samples.
+ * The hardware holds only one filter at a time; initializing a new
+ * filter replaces the previous one. Filters with more taps than the
+ * hardware supports use the software implementation.
+ *
+ * Return 0 on success, -1 if ntaps is 0.
+ */
+int rvlib_mac_fir_init(struct rvlib_mac_fir *fir,
+                       const int16_t *coef,
+                       int16_t *history,
+                       unsigned int ntaps);
+
+/*
+ * Add a sample to the FIR filter and return the filter output
+ * sum(coef[i] * x[n-i]), where x[n] is the new sample.
+ */
+int64_t rvlib_mac_fir_sample(struct rvlib_mac_fir *fir, int16_t x);
+
+#endif  // RVLIB_MAC_H_
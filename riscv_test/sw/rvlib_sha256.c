@@ -0,0 +1,313 @@
+/*
+ * SHA-256 and HMAC-SHA256 with optional hardware acceleration.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_sha256.h"
+
+
+/* Non-zero if the hardware engine is used. */
+static int sha256_use_hw;
+
+static const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+
+static inline uint32_t rotr(uint32_t x, unsigned int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+
+/* Read a 32-bit word in memory byte order from a possibly unaligned pointer. */
+static inline uint32_t load_le32(const uint8_t *p)
+{
+    if (((uintptr_t)p & 3) == 0) {
+        return *(const uint32_t *)p;
+    }
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+           | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+           | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+
+/* Process "nblocks" 64-byte blocks in software. */
+static void sha256_blocks_sw(uint32_t *h, const uint8_t *data, size_t nblocks)
+{
+    uint32_t w[16];
+
+    while (nblocks > 0) {
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+        uint32_t e = h[4], f = h[5], g = h[6], hh = h[7];
+
+        for (int t = 0; t < 64; t++) {
+            uint32_t wt;
+            if (t < 16) {
+                wt = load_be32(data + 4 * t);
+            } else {
+                // Message schedule in a circular buffer of 16 words.
+                uint32_t w1 = w[(t - 15) & 15];
+                uint32_t w14 = w[(t - 2) & 15];
+                wt = (rotr(w14, 17) ^ rotr(w14, 19) ^ (w14 >> 10))
+                     + w[(t - 7) & 15]
+                     + (rotr(w1, 7) ^ rotr(w1, 18) ^ (w1 >> 3))
+                     + w[t & 15];
+            }
+            w[t & 15] = wt;
+
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25))
+                          + ((e & f) ^ (~e & g)) + sha256_k[t] + wt;
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22))
+                          + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+
+        data += RVLIB_SHA256_BLOCK_SIZE;
+        nblocks--;
+    }
+}
+
+
+/* Process "nblocks" 64-byte blocks in the hardware engine. */
+static void sha256_blocks_hw(uint32_t *h, const uint8_t *data, size_t nblocks)
+{
+    // Reset the word counter, then load the hash state of this context.
+    rvlib_hw_write_reg(RVSYS_ADDR_SHA256 + RVLIB_SHA256_REG_CTRL,
+                       RVLIB_SHA256_CTRL_INIT);
+    for (int i = 0; i < 8; i++) {
+        rvlib_hw_write_reg(RVSYS_ADDR_SHA256 + RVLIB_SHA256_REG_HASH(i), h[i]);
+    }
+
+    // Feed the message. The engine stalls the bus while it is busy.
+    size_t nwords = nblocks * (RVLIB_SHA256_BLOCK_SIZE / 4);
+    for (size_t i = 0; i < nwords; i++) {
+        rvlib_hw_write_reg(RVSYS_ADDR_SHA256 + RVLIB_SHA256_REG_DATA,
+                           load_le32(data));
+        data += 4;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        h[i] = rvlib_hw_read_reg(RVSYS_ADDR_SHA256 + RVLIB_SHA256_REG_HASH(i));
+    }
+}
+
+
+static void sha256_blocks(uint32_t *h, const uint8_t *data, size_t nblocks)
+{
+    if (sha256_use_hw) {
+        sha256_blocks_hw(h, data, nblocks);
+    } else {
+        sha256_blocks_sw(h, data, nblocks);
+    }
+}
+
+
+int rvlib_sha256_init_hw(int allow_hw)
+{
+    sha256_use_hw = 0;
+    if (allow_hw) {
+        uint32_t ctrl =
+            rvlib_hw_read_reg(RVSYS_ADDR_SHA256 + RVLIB_SHA256_REG_CTRL);
+        sha256_use_hw =
+            ((ctrl & RVLIB_SHA256_CTRL_ID_MASK) == RVLIB_SHA256_CTRL_ID);
+    }
+    return sha256_use_hw;
+}
+
+
+void rvlib_sha256_init(struct rvlib_sha256_ctx *ctx)
+{
+    memcpy(ctx->h, sha256_iv, sizeof(ctx->h));
+    ctx->total_len = 0;
+    ctx->buf_len = 0;
+}
+
+
+void rvlib_sha256_update(struct rvlib_sha256_ctx *ctx,
+                         const void *data,
+                         size_t len)
+{
+    const uint8_t *p = data;
+
+    ctx->total_len += len;
+
+    // Complete a partial block from a previous call.
+    if (ctx->buf_len > 0) {
+        size_t n = RVLIB_SHA256_BLOCK_SIZE - ctx->buf_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->buf + ctx->buf_len, p, n);
+        ctx->buf_len += n;
+        p += n;
+        len -= n;
+        if (ctx->buf_len < RVLIB_SHA256_BLOCK_SIZE) {
+            return;
+        }
+        sha256_blocks(ctx->h, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+
+    // Process whole blocks directly from the caller's buffer.
+    size_t nblocks = len / RVLIB_SHA256_BLOCK_SIZE;
+    if (nblocks > 0) {
+        sha256_blocks(ctx->h, p, nblocks);
+        p += nblocks * RVLIB_SHA256_BLOCK_SIZE;
+        len -= nblocks * RVLIB_SHA256_BLOCK_SIZE;
+    }
+
+    // Keep the remaining bytes for the next call.
+    memcpy(ctx->buf, p, len);
+    ctx->buf_len = len;
+}
+
+
+void rvlib_sha256_final(struct rvlib_sha256_ctx *ctx, uint8_t *digest)
+{
+    unsigned int n = ctx->buf_len;
+
+    // Append the "1" bit, zero padding and the message length in bits.
+    ctx->buf[n++] = 0x80;
+    if (n > RVLIB_SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->buf + n, 0, RVLIB_SHA256_BLOCK_SIZE - n);
+        sha256_blocks(ctx->h, ctx->buf, 1);
+        n = 0;
+    }
+    memset(ctx->buf + n, 0, RVLIB_SHA256_BLOCK_SIZE - 8 - n);
+    store_be32(ctx->buf + RVLIB_SHA256_BLOCK_SIZE - 8, ctx->total_len >> 29);
+    store_be32(ctx->buf + RVLIB_SHA256_BLOCK_SIZE - 4, ctx->total_len << 3);
+    sha256_blocks(ctx->h, ctx->buf, 1);
+
+    for (int i = 0; i < 8; i++) {
+        store_be32(digest + 4 * i, ctx->h[i]);
+    }
+}
+
+
+void rvlib_sha256(const void *data, size_t len, uint8_t *digest)
+{
+    struct rvlib_sha256_ctx ctx;
+    rvlib_sha256_init(&ctx);
+    rvlib_sha256_update(&ctx, data, len);
+    rvlib_sha256_final(&ctx, digest);
+}
+
+
+void rvlib_hmac_sha256_init(struct rvlib_hmac_sha256_ctx *ctx,
+                            const uint8_t *key,
+                            size_t keylen)
+{
+    uint8_t kbuf[RVLIB_SHA256_BLOCK_SIZE];
+
+    // Keys longer than one block are replaced by their digest.
+    memset(kbuf, 0, sizeof(kbuf));
+    if (keylen > RVLIB_SHA256_BLOCK_SIZE) {
+        rvlib_sha256(key, keylen, kbuf);
+    } else {
+        memcpy(kbuf, key, keylen);
+    }
+
+    for (int i = 0; i < RVLIB_SHA256_BLOCK_SIZE; i++) {
+        ctx->opad_key[i] = kbuf[i] ^ 0x5c;
+        kbuf[i] ^= 0x36;
+    }
+
+    rvlib_sha256_init(&ctx->inner);
+    rvlib_sha256_update(&ctx->inner, kbuf, sizeof(kbuf));
+}
+
+
+void rvlib_hmac_sha256_update(struct rvlib_hmac_sha256_ctx *ctx,
+                              const void *data,
+                              size_t len)
+{
+    rvlib_sha256_update(&ctx->inner, data, len);
+}
+
+
+void rvlib_hmac_sha256_final(struct rvlib_hmac_sha256_ctx *ctx,
+                             uint8_t *mac)
+{
+    uint8_t inner_digest[RVLIB_SHA256_DIGEST_SIZE];
+    rvlib_sha256_final(&ctx->inner, inner_digest);
+
+    // Reuse the inner context for the outer hash.
+    rvlib_sha256_init(&ctx->inner);
+    rvlib_sha256_update(&ctx->inner, ctx->opad_key, sizeof(ctx->opad_key));
+    rvlib_sha256_update(&ctx->inner, inner_digest, sizeof(inner_digest));
+    rvlib_sha256_final(&ctx->inner, mac);
+}
+
+
+int rvlib_sha256_compare(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+    for (int i = 0; i < RVLIB_SHA256_DIGEST_SIZE; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff;
+}
+
+/* end */
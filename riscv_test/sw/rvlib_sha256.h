@@ -0,0 +1,108 @@
+/*
+ * SHA-256 and HMAC-SHA256 with optional hardware acceleration.
+ *
+ * The SHA-256 engine computes the compression function on 64-byte
+ * blocks; the CPU feeds it the message one word at a time and takes
+ * care of buffering and padding. Every function also has a software
+ * implementation, which is used when the hardware is not present or
+ * disabled via rvlib_sha256_init_hw().
+ *
+ * The hash state is kept in the context structure and loaded into
+ * the engine for each call to rvlib_sha256_update(). Several contexts
+ * may therefore be used at the same time, but not from interrupt
+ * handlers while the main program also uses the engine.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_SHA256_H_
+#define RVLIB_SHA256_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* SHA-256 engine registers. */
+#define RVLIB_SHA256_REG_CTRL       0x00
+#define RVLIB_SHA256_REG_DATA       0x04
+#define RVLIB_SHA256_REG_HASH(n)    (0x20 + 4 * (n))
+
+/* Bits in the control register. */
+#define RVLIB_SHA256_CTRL_INIT      0x01
+#define RVLIB_SHA256_CTRL_ID_MASK   0xffff0000
+#define RVLIB_SHA256_CTRL_ID        0x53480000
+
+/* Size of a digest in bytes. */
+#define RVLIB_SHA256_DIGEST_SIZE    32
+
+/* Size of a message block in bytes. */
+#define RVLIB_SHA256_BLOCK_SIZE     64
+
+
+/* State of a SHA-256 computation. */
+struct rvlib_sha256_ctx {
+    uint32_t h[8];
+    uint32_t total_len;         // message length in bytes
+    unsigned int buf_len;
+    uint8_t buf[RVLIB_SHA256_BLOCK_SIZE];
+};
+
+/* State of an HMAC-SHA256 computation. */
+struct rvlib_hmac_sha256_ctx {
+    struct rvlib_sha256_ctx inner;
+    uint8_t opad_key[RVLIB_SHA256_BLOCK_SIZE];
+};
+
+
+/*
+ * Detect the SHA-256 engine.
+ *
+ * If "allow_hw" is zero, all functions use the software implementation.
+ * Otherwise they use the hardware if it is present.
+ *
+ * Return 1 if the hardware will be used, 0 otherwise.
+ * Without a call to this function, the software implementation is used.
+ */
+int rvlib_sha256_init_hw(int allow_hw);
+
+/* Start a new SHA-256 computation. */
+void rvlib_sha256_init(struct rvlib_sha256_ctx *ctx);
+
+/* Add "len" bytes to the message. */
+void rvlib_sha256_update(struct rvlib_sha256_ctx *ctx,
+                         const void *data,
+                         size_t len);
+
+/* Finish the computation and write the 32-byte digest. */
+void rvlib_sha256_final(struct rvlib_sha256_ctx *ctx, uint8_t *digest);
+
+/* Compute the SHA-256 digest of a buffer. */
+void rvlib_sha256(const void *data, size_t len, uint8_t *digest);
+
+/* Start a new HMAC-SHA256 computation with the specified key. */
+void rvlib_hmac_sha256_init(struct rvlib_hmac_sha256_ctx *ctx,
+                            const uint8_t *key,
+                            size_t keylen);
+
+/* Add "len" bytes to the message. */
+void rvlib_hmac_sha256_update(struct rvlib_hmac_sha256_ctx *ctx,
+                              const void *data,
+                              size_t len);
+
+/* Finish the computation and write the 32-byte authentication tag. */
+void rvlib_hmac_sha256_final(struct rvlib_hmac_sha256_ctx *ctx,
+                             uint8_t *mac);
+
+/*
+ * Compare two digests in constant time.
+ * Return 0 if they are equal, non-zero otherwise.
+ */
+int rvlib_sha256_compare(const uint8_t *a, const uint8_t *b);
+
+#endif  // RVLIB_SHA256_H_
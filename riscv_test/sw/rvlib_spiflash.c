@@ -12,6 +12,7 @@
 
 #include "rvlib_hardware.h"
 #include "rvlib_time.h"
+#include "rvlib_crc32.h"
 #include "rvlib_spiflash.h"
 
 
@@ -19,14 +20,49 @@
 #define RVLIB_SPIFLASH_REG_STATUS           0
 #define RVLIB_SPIFLASH_REG_SLAVESEL         4
 #define RVLIB_SPIFLASH_REG_DATA             8
+#define RVLIB_SPIFLASH_REG_POLL             0x0c
+#define RVLIB_SPIFLASH_REG_POLL_INTERVAL    0x10
+#define RVLIB_SPIFLASH_REG_IRQ_ENABLE       0x14
+#define RVLIB_SPIFLASH_REG_LEVELS           0x18
+#define RVLIB_SPIFLASH_REG_THRESHOLDS       0x1c
+#define RVLIB_SPIFLASH_REG_DATA32           0x20
+#define RVLIB_SPIFLASH_REG_BURST            0x24
+#define RVLIB_SPIFLASH_REG_CLOCK            0x28
 #define RVLIB_SPIFLASH_BIT_STATUS_BUSY      0
 #define RVLIB_SPIFLASH_BIT_STATUS_CMDRDY    1
 #define RVLIB_SPIFLASH_BIT_STATUS_READRDY   2
+#define RVLIB_SPIFLASH_BIT_POLL_ACTIVE      0
+#define RVLIB_SPIFLASH_BIT_POLL_DONE        1
+#define RVLIB_SPIFLASH_BIT_POLL_STOP        29
+#define RVLIB_SPIFLASH_BIT_POLL_CLEAR       30
+#define RVLIB_SPIFLASH_BIT_POLL_START       31
+#define RVLIB_SPIFLASH_BIT_IRQ_POLL_DONE    0
+#define RVLIB_SPIFLASH_BIT_IRQ_READ_HIGH    2
+#define RVLIB_SPIFLASH_SHIFT_READ_LEVEL     16
+#define RVLIB_SPIFLASH_SHIFT_READ_BITS      28
+#define RVLIB_SPIFLASH_SHIFT_READ_THRESHOLD 16
+#define RVLIB_SPIFLASH_SHIFT_SAMPLE_DELAY   8
+
+/* SPI clock half-period after reset (25 MHz SPI clock). */
+#define SPIFLASH_DEFAULT_HALF_PERIOD        2
+
+/* Flash area holding the pattern for calibration of the MISO sample delay.
+   This is the last subsector of the test sector. */
+#define SPIFLASH_CALIBRATE_ADDR             (RVSYS_FLASH_TEST_ADDR \
+                                             + RVSYS_FLASH_TEST_SIZE \
+                                             - RVLIB_SPIFLASH_SUBSECTOR_SIZE)
+#define SPIFLASH_CALIBRATE_SIZE             1024
+
+/* Maximum number of bytes added to the read burst count in one write. */
+#define SPIFLASH_MAX_BURST_WRITE            0x100000
 
 /* Properties of the flash device. */
 #define SPIFLASH_PROGRAM_TIMEOUT_US         5000
 #define SPIFLASH_ERASE_TIMEOUT_US           (3 * 1000 * 1000UL)
 
+/* Interval between status reads by the auto-poll engine (2 us). */
+#define SPIFLASH_POLL_INTERVAL_CYCLES       (2 * RVLIB_CPU_FREQ_MHZ)
+
 /* SPI flash commands. */
 #define SPIFLASH_CMD_READ_ID                0x9f
 #define SPIFLASH_CMD_READ                   0x03
@@ -35,6 +71,7 @@
 #define SPIFLASH_CMD_CLEAR_FLAGS            0x50
 #define SPIFLASH_CMD_PAGE_PROGRAM           0x02
 #define SPIFLASH_CMD_SECTOR_ERASE           0xd8
+#define SPIFLASH_CMD_SUBSECTOR_ERASE        0x20
 #define SPIFLASH_BIT_FLAGS_PROGRAM_ERROR    4
 #define SPIFLASH_BIT_FLAGS_ERASE_ERROR      5
 #define SPIFLASH_BIT_FLAGS_READY            7
@@ -56,9 +93,73 @@ static void spi_send_byte(uint8_t b)
 }
 
 
+/* Size of the read FIFO in bytes, or 0 to read without burst transfers. */
+static unsigned int spiflash_read_fifo_size;
+
+/* Number of requested bytes of a streaming read not yet fetched. */
+static size_t spiflash_read_pending;
+
+
+/* Let the SPI controller generate "nbytes" capture transfers. */
+static void spi_request_bytes(size_t nbytes)
+{
+    while (nbytes > 0) {
+        size_t n = nbytes;
+        if (n > SPIFLASH_MAX_BURST_WRITE) {
+            n = SPIFLASH_MAX_BURST_WRITE;
+        }
+        rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_BURST, n);
+        nbytes -= n;
+    }
+}
+
+
+/* Take up to "maxbytes" captured bytes from the read FIFO without waiting. */
+static size_t spi_fetch_bytes(unsigned char *buf, size_t maxbytes)
+{
+    uint32_t levels = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_LEVELS);
+    size_t n = (levels >> RVLIB_SPIFLASH_SHIFT_READ_LEVEL) & 0x3ff;
+    if (n > maxbytes) {
+        n = maxbytes;
+    }
+
+    /* Pop 4 bytes per bus transaction, then the remaining bytes. */
+    size_t p = 0;
+    if (((uintptr_t)buf & 3) == 0) {
+        for (; p + 4 <= n; p += 4) {
+            *(uint32_t *)(buf + p) =
+                rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_DATA32);
+        }
+    } else {
+        for (; p + 4 <= n; p += 4) {
+            uint32_t data = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_DATA32);
+            buf[p] = data;
+            buf[p+1] = data >> 8;
+            buf[p+2] = data >> 16;
+            buf[p+3] = data >> 24;
+        }
+    }
+    for (; p < n; p++) {
+        buf[p] = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_DATA);
+    }
+
+    return n;
+}
+
+
 /* Read data bytes from the SPI slave. */
 static void spi_read_bytes(unsigned char *buf, size_t nbytes)
 {
+    if (spiflash_read_fifo_size > 0) {
+        /* Let the controller generate the transfers; fetch in chunks. */
+        spi_request_bytes(nbytes);
+        size_t p = 0;
+        while (p < nbytes) {
+            p += spi_fetch_bytes(buf + p, nbytes - p);
+        }
+        return;
+    }
+
     size_t p = 0;
     size_t ncmd = nbytes;
     while (p < nbytes) {
@@ -145,6 +246,56 @@ static void spi_command_addr_write(uint8_t cmd,
 }
 
 
+/* Non-zero if the controller has a usable auto-poll engine. */
+static int spiflash_use_autopoll;
+
+/* State of an erase operation started by rvlib_spiflash_xxx_erase_start(). */
+static int spiflash_erase_pending;
+static int spiflash_erase_result;
+static uint64_t spiflash_erase_end_time;
+
+
+/* Return non-zero if the specified time has passed. */
+static int spiflash_time_passed(uint64_t end_time)
+{
+    uint64_t tremain = end_time - get_cycle_counter();
+    return (tremain >= (((uint64_t)1) << 63));
+}
+
+
+/* Start the auto-poll engine to wait for the READY flag. */
+static void spiflash_autopoll_start(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL,
+                       (1UL << RVLIB_SPIFLASH_BIT_POLL_START)
+                       | ((1UL << SPIFLASH_BIT_FLAGS_READY) << 16)
+                       | ((1UL << SPIFLASH_BIT_FLAGS_READY) << 8)
+                       | SPIFLASH_CMD_READ_FLAGS);
+}
+
+
+/* Stop the auto-poll engine and wait until it is idle. */
+static void spiflash_autopoll_stop(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL,
+                       1UL << RVLIB_SPIFLASH_BIT_POLL_STOP);
+    while (1) {
+        uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL);
+        if ((status & (1 << RVLIB_SPIFLASH_BIT_POLL_ACTIVE)) == 0) {
+            break;
+        }
+    }
+}
+
+
+/* Clear the done flag of the auto-poll engine. */
+static void spiflash_autopoll_clear(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL,
+                       1UL << RVLIB_SPIFLASH_BIT_POLL_CLEAR);
+}
+
+
 /* Wait until a program/erase operation completes. */
 static uint8_t spiflash_poll_completion(uint32_t timeout_us)
 {
@@ -153,15 +304,37 @@ static uint8_t spiflash_poll_completion(uint32_t timeout_us)
     uint64_t end_time = get_cycle_counter();
     end_time += RVLIB_CPU_FREQ_MHZ * (uint64_t)timeout_us;
 
+    if (spiflash_use_autopoll) {
+        /* Let the controller poll; read only its local status register.
+           Keep the interrupt disabled while waiting here. */
+        uint32_t irq_enable =
+            rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE);
+        rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE, 0);
+        spiflash_autopoll_start();
+        while (1) {
+            uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL);
+            if ((status & (1 << RVLIB_SPIFLASH_BIT_POLL_DONE)) != 0) {
+                flags = status >> 8;
+                break;
+            }
+            if (spiflash_time_passed(end_time)) {
+                spiflash_autopoll_stop();
+                flags = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL) >> 8;
+                break;
+            }
+        }
+        spiflash_autopoll_clear();
+        rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE,
+                           irq_enable);
+        return flags;
+    }
+
     while (1) {
         spi_command_read(SPIFLASH_CMD_READ_FLAGS, &flags, 1);
         if ((flags & (1 << SPIFLASH_BIT_FLAGS_READY)) != 0) {
             break;
         }
-
-        uint64_t time_now = get_cycle_counter();
-        uint64_t tremain = end_time - time_now;
-        if (tremain >= (((uint64_t)1) << 63)) {
+        if (spiflash_time_passed(end_time)) {
             break;
         }
     }
@@ -170,9 +343,125 @@ static uint8_t spiflash_poll_completion(uint32_t timeout_us)
 }
 
 
+/* Non-zero if the controller has a configurable SPI clock. */
+static int spiflash_has_clock_config;
+
+/* Function called before flash data is modified (see rvlib_spiflash.h). */
+static void (*spiflash_write_hook)(uint32_t address, size_t nbytes);
+
+/* Current SPI clock setting. */
+static unsigned int spiflash_half_period;
+static unsigned int spiflash_sample_delay;
+
+/* CRC of the device ID and calibration pattern,
+   or 0 if calibration is not possible. */
+static uint32_t spiflash_calibrate_ref;
+
+
+/*
+ * Generate part of the calibration pattern.
+ *
+ * The pattern is pseudo-random, so every MISO bit toggles often.
+ * A blank (0xff) or zero area never matches it.
+ */
+static void spiflash_calibrate_pattern(unsigned char *buf, size_t pos, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)(pos + i + 1) * 0x9e3779b1U;
+        buf[i] = (x >> 24) ^ (x >> 13);
+    }
+}
+
+
+/* Read the device ID and calibration area, return their CRC. */
+static uint32_t spiflash_calibrate_crc(void)
+{
+    unsigned char buf[64];
+    uint32_t crc;
+
+    spi_command_read(SPIFLASH_CMD_READ_ID, buf, 3);
+    crc = rvlib_crc32(0, buf, 3);
+
+    spi_send_byte(SPIFLASH_CMD_READ);
+    spi_send_byte((SPIFLASH_CALIBRATE_ADDR >> 16) & 0xff);
+    spi_send_byte((SPIFLASH_CALIBRATE_ADDR >> 8) & 0xff);
+    spi_send_byte(SPIFLASH_CALIBRATE_ADDR & 0xff);
+    for (size_t p = 0; p < SPIFLASH_CALIBRATE_SIZE; p += sizeof(buf)) {
+        spi_read_bytes(buf, sizeof(buf));
+        crc = rvlib_crc32(crc, buf, sizeof(buf));
+    }
+    spi_end_transaction();
+
+    return crc;
+}
+
+
+/* Return the expected CRC of the device ID and calibration pattern. */
+static uint32_t spiflash_calibrate_expected(const struct rvlib_spiflash_device_id *devid)
+{
+    unsigned char buf[256];
+    uint32_t crc;
+
+    buf[0] = devid->manufacturer_id;
+    buf[1] = devid->device_id >> 8;
+    buf[2] = devid->device_id;
+    crc = rvlib_crc32(0, buf, 3);
+    for (size_t p = 0; p < SPIFLASH_CALIBRATE_SIZE; p += sizeof(buf)) {
+        spiflash_calibrate_pattern(buf, p, sizeof(buf));
+        crc = rvlib_crc32(crc, buf, sizeof(buf));
+    }
+
+    return crc;
+}
+
+
+/*
+ * Detect the clock configuration register and select the default SPI clock.
+ * The faster clock is only used after rvlib_spiflash_calibrate().
+ */
+static void spiflash_clock_init(void)
+{
+    spiflash_has_clock_config = 0;
+    spiflash_half_period = SPIFLASH_DEFAULT_HALF_PERIOD;
+    spiflash_sample_delay = 0;
+    spiflash_calibrate_ref = 0;
+
+    /* Older controllers do not decode this address. */
+    uint32_t levels = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_LEVELS);
+    if ((levels >> RVLIB_SPIFLASH_SHIFT_READ_BITS) == 0) {
+        return;
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_CLOCK,
+                       SPIFLASH_DEFAULT_HALF_PERIOD - 1);
+    if (rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_CLOCK)
+        != SPIFLASH_DEFAULT_HALF_PERIOD - 1) {
+        return;
+    }
+    spiflash_has_clock_config = 1;
+}
+
+
 /* Initialize communication to the flash memory. */
 void rvlib_spiflash_init(void)
 {
+    /* Stop an auto-poll operation left over from a previous program. */
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE, 0);
+    spiflash_autopoll_stop();
+    spiflash_autopoll_clear();
+    spiflash_erase_pending = 0;
+
+    /* Detect the auto-poll engine via its interval register. */
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL_INTERVAL,
+                       SPIFLASH_POLL_INTERVAL_CYCLES);
+    spiflash_use_autopoll =
+        (rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL_INTERVAL)
+         == SPIFLASH_POLL_INTERVAL_CYCLES);
+
+    /* Detect the read FIFO via its level register. */
+    rvlib_spiflash_use_read_fifo(1);
+    spiflash_read_pending = 0;
+
     /* Wait until the SPI controller is idle and drain the read buffer. */
     while (1) {
         uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_STATUS);
@@ -195,6 +484,138 @@ void rvlib_spiflash_init(void)
 
     /* Wait until current operation ends. */
     spiflash_poll_completion(SPIFLASH_ERASE_TIMEOUT_US);
+
+    /* Select the SPI clock. */
+    spiflash_clock_init();
+}
+
+
+/* Set the SPI clock frequency and MISO sample delay. */
+int rvlib_spiflash_set_clock(unsigned int half_period, unsigned int sample_delay)
+{
+    if (!spiflash_has_clock_config
+        || half_period < 1 || half_period > 8 || sample_delay > 7) {
+        return RVLIB_SPIFLASH_ERR_FAILED;
+    }
+
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_CLOCK,
+                       (half_period - 1)
+                       | (sample_delay << RVLIB_SPIFLASH_SHIFT_SAMPLE_DELAY));
+    spiflash_half_period = half_period;
+    spiflash_sample_delay = sample_delay;
+    return 0;
+}
+
+
+/* Return the current SPI clock setting. */
+void rvlib_spiflash_get_clock(unsigned int *half_period, unsigned int *sample_delay)
+{
+    *half_period = spiflash_half_period;
+    *sample_delay = spiflash_sample_delay;
+}
+
+
+/* Program the calibration pattern if it is missing. */
+int rvlib_spiflash_calibrate_program(void)
+{
+    unsigned char buf[256];
+    struct rvlib_spiflash_device_id devid;
+    unsigned int old_half_period = spiflash_half_period;
+    unsigned int old_sample_delay = spiflash_sample_delay;
+    uint32_t crc;
+    int ret = 0;
+
+    /* Check and program the pattern at the default clock.
+       Older controllers without clock setting always run at that clock. */
+    rvlib_spiflash_set_clock(SPIFLASH_DEFAULT_HALF_PERIOD, 0);
+
+    rvlib_spiflash_read_id(&devid);
+    if (devid.manufacturer_id == 0x00 || devid.manufacturer_id == 0xff) {
+        ret = RVLIB_SPIFLASH_ERR_FAILED;
+    } else {
+        crc = spiflash_calibrate_expected(&devid);
+        if (spiflash_calibrate_crc() != crc) {
+            ret = rvlib_spiflash_subsector_erase(SPIFLASH_CALIBRATE_ADDR);
+            for (size_t p = 0;
+                 ret == 0 && p < SPIFLASH_CALIBRATE_SIZE;
+                 p += sizeof(buf)) {
+                spiflash_calibrate_pattern(buf, p, sizeof(buf));
+                ret = rvlib_spiflash_page_program(SPIFLASH_CALIBRATE_ADDR + p,
+                                                  buf, sizeof(buf));
+            }
+            if (ret == 0 && spiflash_calibrate_crc() != crc) {
+                ret = RVLIB_SPIFLASH_ERR_FAILED;
+            }
+        }
+    }
+
+    rvlib_spiflash_set_clock(old_half_period, old_sample_delay);
+    return ret;
+}
+
+
+/* Find working MISO sample delays for the specified SPI clock. */
+unsigned int rvlib_spiflash_calibrate(unsigned int half_period)
+{
+    unsigned int old_half_period = spiflash_half_period;
+    unsigned int old_sample_delay = spiflash_sample_delay;
+    unsigned int mask = 0;
+
+    if (spiflash_calibrate_ref == 0) {
+        /* Check the pattern at the default clock. Do not calibrate if
+           the flash does not respond or the pattern is missing. */
+        struct rvlib_spiflash_device_id devid;
+        if (rvlib_spiflash_set_clock(SPIFLASH_DEFAULT_HALF_PERIOD, 0) != 0) {
+            return 0;
+        }
+        rvlib_spiflash_read_id(&devid);
+        if (devid.manufacturer_id != 0x00 && devid.manufacturer_id != 0xff) {
+            uint32_t crc = spiflash_calibrate_expected(&devid);
+            if (spiflash_calibrate_crc() == crc) {
+                spiflash_calibrate_ref = crc;
+            }
+        }
+        if (spiflash_calibrate_ref == 0) {
+            rvlib_spiflash_set_clock(old_half_period, old_sample_delay);
+            return 0;
+        }
+    }
+
+    /* Try each sample delay. */
+    for (unsigned int d = 0; d < 8; d++) {
+        if (rvlib_spiflash_set_clock(half_period, d) != 0) {
+            return 0;
+        }
+        if (spiflash_calibrate_crc() == spiflash_calibrate_ref) {
+            mask |= (1U << d);
+        }
+    }
+
+    if (mask == 0) {
+        rvlib_spiflash_set_clock(old_half_period, old_sample_delay);
+        return 0;
+    }
+
+    /* Choose the middle of the longest run of working delays. */
+    unsigned int best_start = 0, best_len = 0;
+    unsigned int run_start = 0, run_len = 0;
+    for (unsigned int d = 0; d < 8; d++) {
+        if ((mask & (1U << d)) != 0) {
+            if (run_len == 0) {
+                run_start = d;
+            }
+            run_len++;
+            if (run_len > best_len) {
+                best_start = run_start;
+                best_len = run_len;
+            }
+        } else {
+            run_len = 0;
+        }
+    }
+    rvlib_spiflash_set_clock(half_period, best_start + (best_len - 1) / 2);
+
+    return mask;
 }
 
 
@@ -217,6 +638,106 @@ void rvlib_spiflash_read_mem(uint32_t address,
 }
 
 
+/* Start a streaming read from the flash memory. */
+void rvlib_spiflash_read_start(uint32_t address)
+{
+    spi_send_byte(SPIFLASH_CMD_READ);
+    spi_send_byte(address >> 16);
+    spi_send_byte(address >> 8);
+    spi_send_byte(address);
+}
+
+
+/* Read the next data bytes of a streaming read. */
+void rvlib_spiflash_read_continue(unsigned char *buf, size_t nbytes)
+{
+    spi_read_bytes(buf, nbytes);
+}
+
+
+/* Request the next data bytes of a streaming read without waiting. */
+void rvlib_spiflash_read_request(size_t nbytes)
+{
+    if (spiflash_read_fifo_size > 0) {
+        spi_request_bytes(nbytes);
+    }
+    spiflash_read_pending += nbytes;
+}
+
+
+/* Fetch requested data bytes that have arrived. */
+size_t rvlib_spiflash_read_fetch(unsigned char *buf, size_t maxbytes)
+{
+    if (maxbytes > spiflash_read_pending) {
+        maxbytes = spiflash_read_pending;
+    }
+
+    size_t n;
+    if (spiflash_read_fifo_size > 0) {
+        n = spi_fetch_bytes(buf, maxbytes);
+    } else {
+        /* Without read FIFO, read synchronously. */
+        spi_read_bytes(buf, maxbytes);
+        n = maxbytes;
+    }
+
+    spiflash_read_pending -= n;
+    return n;
+}
+
+
+/* End a streaming read. */
+void rvlib_spiflash_read_end(void)
+{
+    /* Drop requested data that was not fetched. */
+    unsigned char buf[16];
+    while (spiflash_read_pending > 0) {
+        rvlib_spiflash_read_fetch(buf, sizeof(buf));
+    }
+
+    spi_end_transaction();
+}
+
+
+/* Copy the driver state. */
+void rvlib_spiflash_save_driver_state(struct rvlib_spiflash_driver_state *st)
+{
+    st->read_fifo_size = spiflash_read_fifo_size;
+    st->read_pending = spiflash_read_pending;
+    st->use_autopoll = spiflash_use_autopoll;
+    st->erase_pending = spiflash_erase_pending;
+    st->erase_result = spiflash_erase_result;
+    st->erase_end_time = spiflash_erase_end_time;
+    st->has_clock_config = spiflash_has_clock_config;
+    st->half_period = spiflash_half_period;
+    st->sample_delay = spiflash_sample_delay;
+    st->calibrate_ref = spiflash_calibrate_ref;
+}
+
+
+/* Set the driver state. */
+void rvlib_spiflash_restore_driver_state(const struct rvlib_spiflash_driver_state *st)
+{
+    spiflash_read_fifo_size = st->read_fifo_size;
+    spiflash_read_pending = st->read_pending;
+    spiflash_use_autopoll = st->use_autopoll;
+    spiflash_erase_pending = st->erase_pending;
+    spiflash_erase_result = st->erase_result;
+    spiflash_erase_end_time = st->erase_end_time;
+    spiflash_has_clock_config = st->has_clock_config;
+    spiflash_half_period = st->half_period;
+    spiflash_sample_delay = st->sample_delay;
+    spiflash_calibrate_ref = st->calibrate_ref;
+}
+
+
+/* Register a function to call before flash data is modified. */
+void rvlib_spiflash_set_write_hook(void (*func)(uint32_t address, size_t nbytes))
+{
+    spiflash_write_hook = func;
+}
+
+
 /* Program bytes to the flash memory. */
 int rvlib_spiflash_page_program(uint32_t address,
                                 const unsigned char *data,
@@ -224,12 +745,21 @@ int rvlib_spiflash_page_program(uint32_t address,
 {
     unsigned char flags;
 
+    if (spiflash_erase_pending) {
+        return RVLIB_SPIFLASH_ERR_NOTREADY;
+    }
+
     /* Check if the device is ready. */
     spi_command_read(SPIFLASH_CMD_READ_FLAGS, &flags, 1);
     if ((flags & (1 << SPIFLASH_BIT_FLAGS_READY)) == 0) {
         return RVLIB_SPIFLASH_ERR_NOTREADY;
     }
 
+    /* Drop cached copies of the data that will be modified. */
+    if (spiflash_write_hook != NULL) {
+        spiflash_write_hook(address, nbytes);
+    }
+
     /* Clear previous errors. */
     spi_command_simple(SPIFLASH_CMD_CLEAR_FLAGS);
 
@@ -254,30 +784,42 @@ int rvlib_spiflash_page_program(uint32_t address,
 }
 
 
-/* Erase a single sector. */
-int rvlib_spiflash_sector_erase(uint32_t address)
+/* Send a (sub)sector erase command. */
+static int spiflash_erase_begin(uint8_t cmd, uint32_t address, uint32_t size)
 {
     unsigned char flags;
 
+    if (spiflash_erase_pending) {
+        return RVLIB_SPIFLASH_ERR_NOTREADY;
+    }
+
     /* Check if the device is ready. */
     spi_command_read(SPIFLASH_CMD_READ_FLAGS, &flags, 1);
     if ((flags & (1 << SPIFLASH_BIT_FLAGS_READY)) == 0) {
         return RVLIB_SPIFLASH_ERR_NOTREADY;
     }
 
+    /* Drop cached copies of the data that will be erased. */
+    if (spiflash_write_hook != NULL) {
+        spiflash_write_hook(address & ~(size - 1), size);
+    }
+
     /* Clear previous errors. */
     spi_command_simple(SPIFLASH_CMD_CLEAR_FLAGS);
 
     /* Enable write access. */
     spi_command_simple(SPIFLASH_CMD_WRITE_ENABLE);
 
-    /* Start the SECTOR ERASE operation. */
-    spi_command_addr_write(SPIFLASH_CMD_SECTOR_ERASE, address, 0, 0);
+    /* Start the (SUB)SECTOR ERASE operation. */
+    spi_command_addr_write(cmd, address, 0, 0);
 
-    /* Wait until the operation completes. */
-    flags = spiflash_poll_completion(SPIFLASH_ERASE_TIMEOUT_US);
+    return 0;
+}
 
-    /* Report result. */
+
+/* Report the result of an erase operation. */
+static int spiflash_erase_check(unsigned char flags)
+{
     if ((flags & (1 << SPIFLASH_BIT_FLAGS_READY)) == 0) {
         return RVLIB_SPIFLASH_ERR_TIMEOUT;
     }
@@ -288,4 +830,174 @@ int rvlib_spiflash_sector_erase(uint32_t address)
     return 0;
 }
 
+
+/* Erase a sector or subsector and wait until it completes. */
+static int spiflash_erase(uint8_t cmd, uint32_t address, uint32_t size)
+{
+    int status = spiflash_erase_begin(cmd, address, size);
+    if (status < 0) {
+        return status;
+    }
+
+    /* Wait until the operation completes. */
+    unsigned char flags = spiflash_poll_completion(SPIFLASH_ERASE_TIMEOUT_US);
+
+    /* Report result. */
+    return spiflash_erase_check(flags);
+}
+
+
+/* Start erasing a sector or subsector in the background. */
+static int spiflash_erase_start(uint8_t cmd, uint32_t address, uint32_t size)
+{
+    if (!spiflash_use_autopoll) {
+        /* No auto-poll engine: erase now and keep the result. */
+        int status = spiflash_erase(cmd, address, size);
+        if (status == RVLIB_SPIFLASH_ERR_NOTREADY) {
+            return status;
+        }
+        spiflash_erase_result = status;
+        spiflash_erase_pending = 1;
+        return 0;
+    }
+
+    int status = spiflash_erase_begin(cmd, address, size);
+    if (status < 0) {
+        return status;
+    }
+
+    spiflash_erase_end_time = get_cycle_counter()
+        + RVLIB_CPU_FREQ_MHZ * (uint64_t)SPIFLASH_ERASE_TIMEOUT_US;
+    spiflash_erase_result = 1;
+    spiflash_erase_pending = 1;
+    spiflash_autopoll_start();
+    return 0;
+}
+
+
+/* Erase a single sector. */
+int rvlib_spiflash_sector_erase(uint32_t address)
+{
+    return spiflash_erase(SPIFLASH_CMD_SECTOR_ERASE,
+                          address,
+                          RVLIB_SPIFLASH_SECTOR_SIZE);
+}
+
+
+/* Erase a single subsector. */
+int rvlib_spiflash_subsector_erase(uint32_t address)
+{
+    return spiflash_erase(SPIFLASH_CMD_SUBSECTOR_ERASE,
+                          address,
+                          RVLIB_SPIFLASH_SUBSECTOR_SIZE);
+}
+
+
+/* Start erasing a sector in the background. */
+int rvlib_spiflash_sector_erase_start(uint32_t address)
+{
+    return spiflash_erase_start(SPIFLASH_CMD_SECTOR_ERASE,
+                                address,
+                                RVLIB_SPIFLASH_SECTOR_SIZE);
+}
+
+
+/* Start erasing a subsector in the background. */
+int rvlib_spiflash_subsector_erase_start(uint32_t address)
+{
+    return spiflash_erase_start(SPIFLASH_CMD_SUBSECTOR_ERASE,
+                                address,
+                                RVLIB_SPIFLASH_SUBSECTOR_SIZE);
+}
+
+
+/* Check whether a background erase operation has completed. */
+int rvlib_spiflash_erase_finish(void)
+{
+    if (!spiflash_erase_pending) {
+        return 0;
+    }
+
+    if (spiflash_erase_result != 1) {
+        /* Erase was already done without auto-poll engine. */
+        spiflash_erase_pending = 0;
+        return spiflash_erase_result;
+    }
+
+    uint32_t status = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL);
+    if ((status & (1 << RVLIB_SPIFLASH_BIT_POLL_DONE)) == 0) {
+        if (!spiflash_time_passed(spiflash_erase_end_time)) {
+            return 1;
+        }
+        spiflash_autopoll_stop();
+        status = rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL);
+    }
+
+    spiflash_autopoll_clear();
+    spiflash_erase_pending = 0;
+    return spiflash_erase_check(status >> 8);
+}
+
+
+/* Enable or disable the erase completion interrupt. */
+void rvlib_spiflash_enable_interrupt(int enable)
+{
+    uint32_t irq_enable =
+        rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE) & 7;
+    irq_enable &= ~(1UL << RVLIB_SPIFLASH_BIT_IRQ_POLL_DONE);
+    if (enable) {
+        irq_enable |= (1UL << RVLIB_SPIFLASH_BIT_IRQ_POLL_DONE);
+    }
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE,
+                       irq_enable);
+}
+
+
+/* Enable or disable the read FIFO interrupt. */
+void rvlib_spiflash_enable_read_interrupt(unsigned int threshold)
+{
+    uint32_t irq_enable =
+        rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE) & 7;
+    irq_enable &= ~(1UL << RVLIB_SPIFLASH_BIT_IRQ_READ_HIGH);
+    if (threshold > 0 && spiflash_read_fifo_size > 0) {
+        if (threshold > spiflash_read_fifo_size) {
+            threshold = spiflash_read_fifo_size;
+        }
+        rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_THRESHOLDS,
+                           threshold << RVLIB_SPIFLASH_SHIFT_READ_THRESHOLD);
+        irq_enable |= (1UL << RVLIB_SPIFLASH_BIT_IRQ_READ_HIGH);
+    }
+    rvlib_hw_write_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_IRQ_ENABLE,
+                       irq_enable);
+}
+
+
+/* Enable or disable use of the auto-poll engine. */
+int rvlib_spiflash_use_autopoll(int enable)
+{
+    spiflash_use_autopoll = 0;
+    if (enable) {
+        spiflash_use_autopoll =
+            (rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_POLL_INTERVAL)
+             == SPIFLASH_POLL_INTERVAL_CYCLES);
+    }
+    return spiflash_use_autopoll;
+}
+
+
+/* Enable or disable use of the read FIFO and burst transfers. */
+unsigned int rvlib_spiflash_use_read_fifo(int enable)
+{
+    spiflash_read_fifo_size = 0;
+    if (enable) {
+        uint32_t levels =
+            rvlib_hw_read_reg(RVSYS_ADDR_SPIFLASH + RVLIB_SPIFLASH_REG_LEVELS);
+        unsigned int bits = (levels >> RVLIB_SPIFLASH_SHIFT_READ_BITS) & 0xf;
+        if (bits >= 2) {
+            spiflash_read_fifo_size = 1U << bits;
+        }
+    }
+    return spiflash_read_fifo_size;
+}
+
 /* end */
@@ -22,6 +22,10 @@
 #define RVLIB_SPIFLASH_ERR_TIMEOUT  (-2)
 #define RVLIB_SPIFLASH_ERR_NOTREADY (-3)
 
+/* Size of an erase sector and subsector in bytes. */
+#define RVLIB_SPIFLASH_SECTOR_SIZE      65536
+#define RVLIB_SPIFLASH_SUBSECTOR_SIZE   4096
+
 
 /* Data structure returned by READ ID operation. */
 struct rvlib_spiflash_device_id {
@@ -30,6 +34,25 @@ struct rvlib_spiflash_device_id {
 };
 
 
+/*
+ * Driver state that belongs to the hardware setup of the current boot.
+ * Only for use by rvlib_hibernate, which reads the flash while it
+ * overwrites the driver variables in RAM with snapshot data.
+ */
+struct rvlib_spiflash_driver_state {
+    unsigned int read_fifo_size;
+    size_t   read_pending;
+    int      use_autopoll;
+    int      erase_pending;
+    int      erase_result;
+    uint64_t erase_end_time;
+    int      has_clock_config;
+    unsigned int half_period;
+    unsigned int sample_delay;
+    uint32_t calibrate_ref;
+};
+
+
 /* Initialize communication to the flash memory. */
 void rvlib_spiflash_init(void);
 
@@ -41,6 +64,61 @@ void rvlib_spiflash_read_mem(uint32_t address,
                              unsigned char *buf,
                              size_t nbytes);
 
+/*
+ * Start a streaming read from the flash memory.
+ *
+ * This function sends a READ command for the specified address.
+ * The data must then be fetched by one or more calls to
+ * rvlib_spiflash_read_continue(), followed by rvlib_spiflash_read_end().
+ * No other flash operations may be started until the read is ended.
+ *
+ * A streaming read avoids the command overhead when consecutive data
+ * must be placed in separate buffers.
+ */
+void rvlib_spiflash_read_start(uint32_t address);
+
+/* Read the next data bytes of a streaming read. */
+void rvlib_spiflash_read_continue(unsigned char *buf, size_t nbytes);
+
+/*
+ * Request the next data bytes of a streaming read without waiting.
+ *
+ * The SPI controller reads the requested bytes into its read FIFO,
+ * pausing while the FIFO is full. Fetch them with rvlib_spiflash_read_fetch(),
+ * for example from the main loop or from an interrupt handler
+ * (see rvlib_spiflash_enable_read_interrupt()).
+ * Do not mix requested reads with rvlib_spiflash_read_continue().
+ */
+void rvlib_spiflash_read_request(size_t nbytes);
+
+/*
+ * Fetch requested data bytes of a streaming read.
+ *
+ * Copy up to "maxbytes" bytes which have already arrived into "buf".
+ * This function does not wait, except on a controller without read FIFO,
+ * where it reads the data synchronously.
+ *
+ * Return the number of bytes copied.
+ */
+size_t rvlib_spiflash_read_fetch(unsigned char *buf, size_t maxbytes);
+
+/*
+ * End a streaming read.
+ *
+ * Requested bytes that were not yet fetched are discarded.
+ */
+void rvlib_spiflash_read_end(void);
+
+/*
+ * Register a function that is called before data in the flash memory
+ * is programmed or erased, with the affected address range.
+ *
+ * The flash read cache registers itself here in rvlib_spiflash_cache_init(),
+ * so programs that do not use the cache do not link it.
+ * Pass NULL to remove the hook.
+ */
+void rvlib_spiflash_set_write_hook(void (*func)(uint32_t address, size_t nbytes));
+
 /*
  * Program bytes to the flash memory.
  *
@@ -51,6 +129,9 @@ void rvlib_spiflash_read_mem(uint32_t address,
  *
  * All programmed bytes must be located in the same flash page.
  *
+ * Cached copies of the affected data in the flash read cache
+ * (rvlib_spiflash_cache.h) are invalidated via the write hook.
+ *
  * Returns:
  *     0 if programming completes successfully;
  *     a negative error code if the operation failed:
@@ -69,6 +150,9 @@ int rvlib_spiflash_page_program(uint32_t address,
  *     address: Byte address of the sector to erase.
  *              Any address within the target sector can be used.
  *
+ * Cached copies of the affected data in the flash read cache
+ * (rvlib_spiflash_cache.h) are invalidated via the write hook.
+ *
  * Returns:
  *     0 if the erase operation completes successfully;
  *     a negative error code if the operation failed:
@@ -78,4 +162,152 @@ int rvlib_spiflash_page_program(uint32_t address,
  */
 int rvlib_spiflash_sector_erase(uint32_t address);
 
+/*
+ * Erase a single 4 kByte subsector.
+ *
+ * This works the same as rvlib_spiflash_sector_erase(), but erases
+ * only RVLIB_SPIFLASH_SUBSECTOR_SIZE bytes.
+ */
+int rvlib_spiflash_subsector_erase(uint32_t address);
+
+/*
+ * Start erasing a sector or subsector in the background.
+ *
+ * The SPI controller polls the flash device until the erase completes,
+ * so the processor is free to do other work in the meantime. Call
+ * rvlib_spiflash_erase_finish() to check for completion; this may be
+ * done from an interrupt handler (see rvlib_spiflash_enable_interrupt()).
+ * No other flash operations may be started until the erase is finished.
+ *
+ * If the SPI controller has no auto-poll engine, these functions erase
+ * synchronously and rvlib_spiflash_erase_finish() returns the result.
+ *
+ * Returns:
+ *     0 if the erase operation has started;
+ *     RVLIB_SPIFLASH_ERR_NOTREADY if a program/erase operation is still busy.
+ */
+int rvlib_spiflash_sector_erase_start(uint32_t address);
+int rvlib_spiflash_subsector_erase_start(uint32_t address);
+
+/*
+ * Check whether a background erase operation has completed.
+ *
+ * Returns:
+ *     1 if the erase operation is still in progress;
+ *     0 if the operation completed successfully, or if no erase was pending;
+ *     a negative error code as for rvlib_spiflash_sector_erase().
+ */
+int rvlib_spiflash_erase_finish(void);
+
+/*
+ * Enable or disable the interrupt of the SPI controller.
+ *
+ * When enabled, the controller raises an external interrupt when a
+ * background erase operation completes. The interrupt handler must call
+ * rvlib_spiflash_erase_finish() to clear the interrupt.
+ */
+void rvlib_spiflash_enable_interrupt(int enable);
+
+/*
+ * Enable or disable the read FIFO interrupt of the SPI controller.
+ *
+ * When "threshold" is non-zero, the controller raises an external interrupt
+ * while the read FIFO holds at least "threshold" bytes, or while it holds
+ * any bytes and all requested transfers have completed. The interrupt handler
+ * must call rvlib_spiflash_read_fetch() to drain the FIFO.
+ *
+ * A threshold of 0 disables the interrupt.
+ */
+void rvlib_spiflash_enable_read_interrupt(unsigned int threshold);
+
+/*
+ * Enable or disable use of the auto-poll engine of the SPI controller.
+ *
+ * The auto-poll engine is used by default if it is present.
+ * If disabled, software polls the flash status via SPI commands.
+ * Return 1 if the auto-poll engine will be used, 0 otherwise.
+ * Must be called after rvlib_spiflash_init().
+ */
+int rvlib_spiflash_use_autopoll(int enable);
+
+/*
+ * Set the SPI clock frequency and MISO sample delay.
+ *
+ * Parameters:
+ *     half_period:  SPI clock half-period in system clock cycles (1 to 8).
+ *                   The value 1 selects a 50 MHz SPI clock.
+ *     sample_delay: Delay of the MISO sample point in system clock cycles
+ *                   (0 to 7).
+ *
+ * Must not be called while a flash operation is in progress.
+ *
+ * Returns:
+ *     0 if the setting was applied;
+ *     RVLIB_SPIFLASH_ERR_FAILED if the controller does not support it.
+ */
+int rvlib_spiflash_set_clock(unsigned int half_period, unsigned int sample_delay);
+
+/* Return the current SPI clock setting. */
+void rvlib_spiflash_get_clock(unsigned int *half_period, unsigned int *sample_delay);
+
+/*
+ * Find working MISO sample delays for the specified SPI clock half-period.
+ *
+ * This function reads the flash device ID and a fixed pseudo-random
+ * pattern of 1 kByte with each sample delay, and compares the data to
+ * the expected values. The pattern is stored in the last subsector of
+ * the flash test sector (RVSYS_FLASH_TEST_ADDR) and must be programmed
+ * beforehand with rvlib_spiflash_calibrate_program(). This function
+ * does not write to the flash; if the pattern is missing, it fails.
+ * It then selects the middle of the longest range of working delays.
+ * If no delay works, the previous setting is restored.
+ *
+ * rvlib_spiflash_init() leaves the SPI clock at 25 MHz, which is
+ * covered by the timing constraints of the FPGA design. The 50 MHz
+ * SPI clock (half-period 1) is not covered by timing constraints and
+ * relies on this calibration. A program that wants the faster clock
+ * must call this function with half-period 1 after rvlib_spiflash_init().
+ * Must not be called while a flash operation is in progress.
+ *
+ * Returns:
+ *     a bit mask of working sample delays (bit N set if delay N works);
+ *     0 if no delay works or calibration is not possible.
+ */
+unsigned int rvlib_spiflash_calibrate(unsigned int half_period);
+
+/*
+ * Program the pattern for rvlib_spiflash_calibrate() if it is missing.
+ *
+ * This checks the pattern at the default SPI clock. If it is missing,
+ * for example after "spiflash writetest" in the boot monitor, this
+ * ERASES the last 4 kByte subsector of the flash test sector
+ * (RVSYS_FLASH_TEST_ADDR + 0xf000) and programs the pattern there.
+ * The SPI clock setting is restored afterwards.
+ * Must not be called while a flash operation is in progress.
+ *
+ * Returns:
+ *     0 if the pattern is present;
+ *     RVLIB_SPIFLASH_ERR_FAILED if the flash does not respond or
+ *         programming failed;
+ *     RVLIB_SPIFLASH_ERR_TIMEOUT if an operation timed out.
+ */
+int rvlib_spiflash_calibrate_program(void);
+
+/*
+ * Enable or disable use of the read FIFO of the SPI controller.
+ *
+ * With the read FIFO, the controller generates read transfers by itself
+ * and software fetches the data 4 bytes per bus transaction.
+ * The read FIFO is used by default if it is present.
+ * Return the size of the read FIFO in bytes, or 0 if it will not be used.
+ * Must be called after rvlib_spiflash_init().
+ */
+unsigned int rvlib_spiflash_use_read_fifo(int enable);
+
+/* Copy the driver state to "st" (see struct rvlib_spiflash_driver_state). */
+void rvlib_spiflash_save_driver_state(struct rvlib_spiflash_driver_state *st);
+
+/* Set the driver state from "st". The write hook is not affected. */
+void rvlib_spiflash_restore_driver_state(const struct rvlib_spiflash_driver_state *st);
+
 #endif  // RVLIB_SPIFLASH_H_
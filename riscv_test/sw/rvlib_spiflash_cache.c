@@ -0,0 +1,220 @@
+/*
+ * Block cache for SPI flash memory reads.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include "rvlib_std.h"
+#include "rvlib_time.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_spiflash_cache.h"
+
+
+/* Address of an unused cache line. */
+#define CACHE_INVALID_ADDRESS   0xffffffff
+
+/* Size of the flash address space (24-bit addresses). */
+#define SPIFLASH_ADDRESS_LIMIT  0x1000000
+
+
+/* Cache state. */
+static struct rvlib_spiflash_cache_line *cache_lines;
+static unsigned char *cache_data;
+static unsigned int cache_num_blocks;
+static uint32_t cache_block_size;
+static uint32_t cache_use_counter;
+static uint32_t cache_last_fetched;
+static struct rvlib_spiflash_cache_stats cache_stats;
+
+
+/* Return the index of the line holding the specified block, or -1. */
+static int cache_find_line(uint32_t block_addr)
+{
+    for (unsigned int i = 0; i < cache_num_blocks; i++) {
+        if (cache_lines[i].address == block_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/* Mark a line as most recently used. */
+static void cache_touch_line(unsigned int idx)
+{
+    cache_use_counter++;
+    if (cache_use_counter == 0) {
+        /* Counter wrapped around. Restart LRU ordering. */
+        for (unsigned int i = 0; i < cache_num_blocks; i++) {
+            cache_lines[i].last_used = 0;
+        }
+        cache_use_counter = 1;
+    }
+    cache_lines[idx].last_used = cache_use_counter;
+}
+
+
+/* Allocate a line for the specified block and return its index. */
+static unsigned int cache_alloc_line(uint32_t block_addr)
+{
+    unsigned int idx = 0;
+    for (unsigned int i = 1; i < cache_num_blocks; i++) {
+        if (cache_lines[i].last_used < cache_lines[idx].last_used) {
+            idx = i;
+        }
+    }
+    cache_lines[idx].address = block_addr;
+    cache_touch_line(idx);
+    return idx;
+}
+
+
+/* Initialize the flash read cache. */
+int rvlib_spiflash_cache_init(struct rvlib_spiflash_cache_line *lines,
+                              unsigned char *data,
+                              unsigned int num_blocks,
+                              unsigned int block_size)
+{
+    if (num_blocks < 2
+            || block_size < RVLIB_SPIFLASH_CACHE_MIN_BLOCK_SIZE
+            || block_size > RVLIB_SPIFLASH_CACHE_MAX_BLOCK_SIZE
+            || (block_size & (block_size - 1)) != 0) {
+        return -1;
+    }
+
+    cache_lines = lines;
+    cache_data = data;
+    cache_num_blocks = num_blocks;
+    cache_block_size = block_size;
+
+    rvlib_spiflash_cache_invalidate_all();
+    rvlib_spiflash_cache_reset_stats();
+
+    rvlib_spiflash_set_write_hook(rvlib_spiflash_cache_invalidate);
+
+    return 0;
+}
+
+
+/* Read data from the flash memory via the cache. */
+void rvlib_spiflash_cache_read(uint32_t address,
+                               unsigned char *buf,
+                               size_t nbytes)
+{
+    uint64_t t_start = get_cycle_counter();
+
+    cache_stats.read_calls++;
+    cache_stats.read_bytes += nbytes;
+
+    if (cache_num_blocks == 0) {
+        /* Cache not initialized. */
+        rvlib_spiflash_read_mem(address, buf, nbytes);
+        cache_stats.read_cycles += get_cycle_counter() - t_start;
+        return;
+    }
+
+    while (nbytes > 0) {
+
+        uint32_t block_addr = address & ~(cache_block_size - 1);
+        uint32_t offset = address - block_addr;
+        size_t n = cache_block_size - offset;
+        if (n > nbytes) {
+            n = nbytes;
+        }
+
+        int idx = cache_find_line(block_addr);
+        if (idx >= 0) {
+            cache_stats.block_hits++;
+            cache_touch_line(idx);
+        } else {
+            cache_stats.block_misses++;
+
+            /* Prefetch the next block if this miss continues
+               a sequential access pattern. */
+            uint32_t next_addr = block_addr + cache_block_size;
+            int prefetch = (block_addr == cache_last_fetched + cache_block_size)
+                           && (next_addr < SPIFLASH_ADDRESS_LIMIT)
+                           && (cache_find_line(next_addr) < 0);
+
+            /* Fetch the missing block (and the next block)
+               in a single flash transaction. */
+            idx = cache_alloc_line(block_addr);
+            rvlib_spiflash_read_start(block_addr);
+            rvlib_spiflash_read_continue(cache_data + idx * cache_block_size,
+                                         cache_block_size);
+            cache_last_fetched = block_addr;
+            if (prefetch) {
+                unsigned int pidx = cache_alloc_line(next_addr);
+                rvlib_spiflash_read_continue(cache_data + pidx * cache_block_size,
+                                             cache_block_size);
+                cache_last_fetched = next_addr;
+                cache_stats.prefetches++;
+            }
+            rvlib_spiflash_read_end();
+        }
+
+        memcpy(buf, cache_data + idx * cache_block_size + offset, n);
+
+        address += n;
+        buf += n;
+        nbytes -= n;
+    }
+
+    cache_stats.read_cycles += get_cycle_counter() - t_start;
+}
+
+
+/* Invalidate cached blocks that overlap the specified address range. */
+void rvlib_spiflash_cache_invalidate(uint32_t address, size_t nbytes)
+{
+    if (nbytes == 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < cache_num_blocks; i++) {
+        uint32_t block_addr = cache_lines[i].address;
+        if (block_addr != CACHE_INVALID_ADDRESS
+                && block_addr < address + nbytes
+                && block_addr + cache_block_size > address) {
+            cache_lines[i].address = CACHE_INVALID_ADDRESS;
+            cache_lines[i].last_used = 0;
+            cache_stats.invalidations++;
+        }
+    }
+
+    cache_last_fetched = CACHE_INVALID_ADDRESS;
+}
+
+
+/* Invalidate all cached blocks. */
+void rvlib_spiflash_cache_invalidate_all(void)
+{
+    for (unsigned int i = 0; i < cache_num_blocks; i++) {
+        cache_lines[i].address = CACHE_INVALID_ADDRESS;
+        cache_lines[i].last_used = 0;
+    }
+    cache_use_counter = 0;
+    cache_last_fetched = CACHE_INVALID_ADDRESS;
+}
+
+
+/* Get cache statistics. */
+void rvlib_spiflash_cache_get_stats(struct rvlib_spiflash_cache_stats *stats)
+{
+    *stats = cache_stats;
+}
+
+
+/* Reset cache statistics to zero. */
+void rvlib_spiflash_cache_reset_stats(void)
+{
+    memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
+/* end */
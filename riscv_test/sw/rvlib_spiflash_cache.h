@@ -0,0 +1,110 @@
+/*
+ * Block cache for SPI flash memory reads.
+ *
+ * The cache keeps copies of recently read flash blocks in RAM.
+ * This speeds up programs that do many small reads from the same
+ * areas of the flash memory, for example configuration lookups.
+ *
+ * The application provides the RAM for the cache.
+ * Blocks are replaced in least-recently-used order.
+ * When a read misses the cache on the block directly following the
+ * previous miss, the cache also fetches the next block in the same
+ * flash transaction (sequential prefetch).
+ *
+ * Cached blocks are invalidated automatically by
+ * rvlib_spiflash_page_program() and the erase functions, through the
+ * write hook that rvlib_spiflash_cache_init() registers with
+ * rvlib_spiflash_set_write_hook().
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_SPIFLASH_CACHE_H_
+#define RVLIB_SPIFLASH_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Supported range of block sizes. */
+#define RVLIB_SPIFLASH_CACHE_MIN_BLOCK_SIZE  256
+#define RVLIB_SPIFLASH_CACHE_MAX_BLOCK_SIZE  4096
+
+
+/* Bookkeeping for one cached block. */
+struct rvlib_spiflash_cache_line {
+    uint32_t address;
+    uint32_t last_used;
+};
+
+
+/* Cache statistics. */
+struct rvlib_spiflash_cache_stats {
+    uint32_t read_calls;        /* number of calls to cache_read */
+    uint32_t read_bytes;        /* number of bytes returned by cache_read */
+    uint32_t block_hits;        /* block lookups served from the cache */
+    uint32_t block_misses;      /* block lookups that read the flash */
+    uint32_t prefetches;        /* blocks fetched ahead of their use */
+    uint32_t invalidations;     /* blocks dropped due to program/erase */
+    uint64_t read_cycles;       /* total CPU cycles spent in cache_read */
+};
+
+
+/*
+ * Initialize the flash read cache.
+ *
+ * Parameters:
+ *     lines:       Array of "num_blocks" bookkeeping structures.
+ *     data:        Buffer of "num_blocks * block_size" bytes.
+ *     num_blocks:  Number of blocks in the cache (at least 2).
+ *     block_size:  Size of each block in bytes.
+ *                  Must be a power of two from 256 to 4096.
+ *
+ * The buffers must remain valid as long as the cache is used.
+ * The flash memory must already be initialized (rvlib_spiflash_init).
+ *
+ * Returns:
+ *     0 if the cache is initialized;
+ *     -1 if the parameters are invalid.
+ */
+int rvlib_spiflash_cache_init(struct rvlib_spiflash_cache_line *lines,
+                              unsigned char *data,
+                              unsigned int num_blocks,
+                              unsigned int block_size);
+
+/*
+ * Read data from the flash memory via the cache.
+ *
+ * This is equivalent to rvlib_spiflash_read_mem(), but serves data
+ * from the cache when possible. If the cache is not initialized,
+ * this function reads directly from the flash memory.
+ */
+void rvlib_spiflash_cache_read(uint32_t address,
+                               unsigned char *buf,
+                               size_t nbytes);
+
+/*
+ * Invalidate cached blocks that overlap the specified address range.
+ *
+ * This function is called automatically by the flash program and erase
+ * functions. It must be called explicitly if the flash memory is modified
+ * by other means.
+ */
+void rvlib_spiflash_cache_invalidate(uint32_t address, size_t nbytes);
+
+/* Invalidate all cached blocks. */
+void rvlib_spiflash_cache_invalidate_all(void);
+
+/* Get cache statistics. */
+void rvlib_spiflash_cache_get_stats(struct rvlib_spiflash_cache_stats *stats);
+
+/* Reset cache statistics to zero. */
+void rvlib_spiflash_cache_reset_stats(void);
+
+#endif  // RVLIB_SPIFLASH_CACHE_H_
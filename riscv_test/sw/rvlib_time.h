@@ -24,6 +24,13 @@ int usleep(unsigned long usec);
  */
 uint64_t get_cycle_counter(void);
 
+/*
+ * Low 32 bits of the "rdcycle" counter at the start of the program,
+ * captured by the startup code before initializing data and calling
+ * static constructors.
+ */
+extern uint32_t rvlib_start_cycle;
+
 /*
  * Return the current value of the "mtime" register.
  * This register increments at the rate of the CPU frequency.
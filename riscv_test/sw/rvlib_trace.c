@@ -0,0 +1,136 @@
+/*
+ * Driver for the instruction trace buffer.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stdint.h>
+#include "rvlib_hardware.h"
+#include "rvlib_uart.h"
+#include "rvlib_trace.h"
+
+
+static uint32_t trace_read_reg(uint32_t reg)
+{
+    return rvlib_hw_read_reg(RVSYS_ADDR_TRACE + reg);
+}
+
+
+/* Return the capacity of the trace buffer (number of records). */
+unsigned int rvlib_trace_capacity(void)
+{
+    uint32_t ctrl = trace_read_reg(RVLIB_TRACE_REG_CTRL);
+    return 1U << ((ctrl >> 8) & 0x1f);
+}
+
+
+/*
+ * Stop tracing and position the read index at the oldest record.
+ * Return the number of records in the buffer.
+ */
+static unsigned int trace_prepare_read(uint32_t *status)
+{
+    rvlib_trace_stop();
+
+    uint32_t ctrl = trace_read_reg(RVLIB_TRACE_REG_CTRL);
+    uint32_t wrindex = trace_read_reg(RVLIB_TRACE_REG_WRINDEX);
+    unsigned int nrec;
+
+    if ((ctrl & RVLIB_TRACE_CTRL_FULL) != 0) {
+        // Buffer wrapped around; oldest record is at the write index.
+        nrec = 1U << ((ctrl >> 8) & 0x1f);
+        rvlib_hw_write_reg(RVSYS_ADDR_TRACE + RVLIB_TRACE_REG_RDINDEX, wrindex);
+    } else {
+        nrec = wrindex;
+        rvlib_hw_write_reg(RVSYS_ADDR_TRACE + RVLIB_TRACE_REG_RDINDEX, 0);
+    }
+
+    *status = ctrl;
+    return nrec;
+}
+
+
+/* Stop tracing and copy the recorded history to "buf". */
+unsigned int rvlib_trace_read(struct rvlib_trace_record *buf,
+                              unsigned int maxrec)
+{
+    uint32_t status;
+    unsigned int nrec = trace_prepare_read(&status);
+
+    if (nrec > maxrec) {
+        nrec = maxrec;
+    }
+
+    for (unsigned int i = 0; i < nrec; i++) {
+        buf[i].word0 = trace_read_reg(RVLIB_TRACE_REG_WORD0);
+        // Reading word 1 advances the read index.
+        buf[i].timestamp = trace_read_reg(RVLIB_TRACE_REG_WORD1);
+    }
+
+    return nrec;
+}
+
+
+static void trace_put_str(const char *s)
+{
+    while (*s != '\0') {
+        rvlib_putchar(*s);
+        s++;
+    }
+}
+
+
+static void trace_put_hex(uint32_t v)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    for (int i = 28; i >= 0; i -= 4) {
+        rvlib_putchar(hexdigits[(v >> i) & 15]);
+    }
+}
+
+
+static void trace_put_dec(uint32_t v)
+{
+    char buf[12];
+    char *p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + (v % 10);
+        v /= 10;
+    } while (v != 0);
+    trace_put_str(p);
+}
+
+
+/* Stop tracing and send the recorded history to the console. */
+void rvlib_trace_dump(void)
+{
+    uint32_t status;
+    unsigned int nrec = trace_prepare_read(&status);
+
+    trace_put_str("\r\nTRACE ");
+    trace_put_dec(nrec);
+    rvlib_putchar(' ');
+    trace_put_hex(status);
+    trace_put_str("\r\n");
+
+    for (unsigned int i = 0; i < nrec; i++) {
+        uint32_t w0 = trace_read_reg(RVLIB_TRACE_REG_WORD0);
+        uint32_t w1 = trace_read_reg(RVLIB_TRACE_REG_WORD1);
+        trace_put_hex(w0);
+        rvlib_putchar(' ');
+        trace_put_hex(w1);
+        trace_put_str("\r\n");
+    }
+
+    trace_put_str("TRACE END\r\n");
+}
+
+/* end */
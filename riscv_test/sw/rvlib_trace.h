@@ -0,0 +1,107 @@
+/*
+ * Driver for the instruction trace buffer.
+ *
+ * The trace buffer records a compressed history of the instructions
+ * executed by the processor: one bit per conditional branch, the target
+ * of each indirect jump and the location of each trap, all with
+ * timestamps in clock cycles. The host program "tools/trace_decode"
+ * reconstructs the complete instruction flow from these records and
+ * the ELF file of the program.
+ *
+ * Records can be read by the program itself (rvlib_trace_dump() sends
+ * them to the console), or by the host via JTAG while the processor
+ * is halted (see "trace_decode -j").
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef RVLIB_TRACE_H_
+#define RVLIB_TRACE_H_
+
+#include <stdint.h>
+#include "rvlib_hardware.h"
+
+
+/* Trace buffer registers. */
+#define RVLIB_TRACE_REG_CTRL            0x00
+#define RVLIB_TRACE_REG_WRINDEX         0x04
+#define RVLIB_TRACE_REG_RDINDEX         0x08
+#define RVLIB_TRACE_REG_WORD0           0x0c
+#define RVLIB_TRACE_REG_WORD1           0x10
+#define RVLIB_TRACE_REG_TIME            0x14
+
+/* Bits in the control register. */
+#define RVLIB_TRACE_CTRL_ENABLE         0x01
+#define RVLIB_TRACE_CTRL_STOP_FULL      0x02
+#define RVLIB_TRACE_CTRL_CLEAR          0x04
+#define RVLIB_TRACE_CTRL_FULL           0x08
+#define RVLIB_TRACE_CTRL_OVERFLOW       0x10
+
+/* Record types (bits 1:0 of word 0). */
+#define RVLIB_TRACE_REC_TARGET          0
+#define RVLIB_TRACE_REC_BRANCH          1
+#define RVLIB_TRACE_REC_TRAP            2
+#define RVLIB_TRACE_REC_SYNC            3
+
+
+/* Trace record. */
+struct rvlib_trace_record {
+    uint32_t word0;         // record type and address or branch history
+    uint32_t timestamp;     // clock cycles since the buffer was cleared
+};
+
+
+/*
+ * Clear the buffer and start tracing.
+ *
+ * If "stop_when_full" is non-zero, tracing stops when the buffer
+ * is full. Otherwise the oldest records are overwritten, such that
+ * the buffer keeps the most recent history.
+ *
+ * This function is inline to keep the trace free of call overhead.
+ */
+static inline void rvlib_trace_start(int stop_when_full)
+{
+    uint32_t ctrl = RVLIB_TRACE_CTRL_ENABLE | RVLIB_TRACE_CTRL_CLEAR;
+    if (stop_when_full) {
+        ctrl |= RVLIB_TRACE_CTRL_STOP_FULL;
+    }
+    rvlib_hw_write_reg(RVSYS_ADDR_TRACE + RVLIB_TRACE_REG_CTRL, ctrl);
+}
+
+/* Stop tracing. Records in the buffer are kept. */
+static inline void rvlib_trace_stop(void)
+{
+    rvlib_hw_write_reg(RVSYS_ADDR_TRACE + RVLIB_TRACE_REG_CTRL, 0);
+}
+
+/* Return the capacity of the trace buffer (number of records). */
+unsigned int rvlib_trace_capacity(void);
+
+/*
+ * Stop tracing and copy the recorded history to "buf",
+ * starting with the oldest record.
+ *
+ * Return the number of records copied (at most "maxrec").
+ */
+unsigned int rvlib_trace_read(struct rvlib_trace_record *buf,
+                              unsigned int maxrec);
+
+/*
+ * Stop tracing and send the recorded history to the console.
+ *
+ * Output format:
+ *   "TRACE <nrec> <status>" followed by one line per record
+ *   with two hex words, then a line "TRACE END".
+ *
+ * Output is written via rvlib_putchar().
+ */
+void rvlib_trace_dump(void);
+
+#endif  // RVLIB_TRACE_H_
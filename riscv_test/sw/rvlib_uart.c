@@ -16,8 +16,14 @@
 
 #define RVLIB_UART_REG_DATA         0
 #define RVLIB_UART_REG_CTRL         4
+#define RVLIB_UART_REG_BITPERIOD    8
+#define RVLIB_UART_REG_DEBUG        12
 #define RVLIB_UART_BIT_DATA_RXVALID 16
+#define RVLIB_UART_BIT_CTRL_FLOWCTL 2
 #define RVLIB_UART_BIT_CTRL_TXBUSY  15
+#define RVLIB_UART_SHIFT_CTRL_FIFOBITS 28
+#define RVLIB_UART_BIT_DEBUG_ENABLE 0
+#define RVLIB_UART_BIT_DEBUG_LOCK   1
 
 
 /* Send character through UART. */
@@ -46,14 +52,90 @@ int rvlib_uart_recv_byte(uint32_t base_addr)
 }
 
 
+/* Set the UART baud rate. */
+void rvlib_uart_set_baud_rate(uint32_t base_addr, uint32_t baud_rate)
+{
+    uint32_t bit_period = (RVLIB_CPU_FREQ_MHZ * 1000000UL + baud_rate / 2)
+                          / baud_rate;
+    rvlib_hw_write_reg(base_addr + RVLIB_UART_REG_BITPERIOD, bit_period);
+}
+
+
+/* Enable or disable RTS/CTS hardware flow control. */
+int rvlib_uart_set_flow_control(uint32_t base_addr, int enable)
+{
+    uint32_t ctrl = rvlib_hw_read_reg(base_addr + RVLIB_UART_REG_CTRL);
+
+    // Older UARTs without receive FIFO do not support flow control.
+    if ((ctrl >> RVLIB_UART_SHIFT_CTRL_FIFOBITS) == 0) {
+        return -1;
+    }
+
+    ctrl &= 3;  // keep interrupt enable bits
+    if (enable) {
+        ctrl |= (1 << RVLIB_UART_BIT_CTRL_FLOWCTL);
+    }
+    rvlib_hw_write_reg(base_addr + RVLIB_UART_REG_CTRL, ctrl);
+    return 0;
+}
+
+
+/* Enable or disable the UART debug bridge. */
+int rvlib_uart_set_debug_bridge(uint32_t base_addr, int enable)
+{
+    uint32_t ctrl = rvlib_hw_read_reg(base_addr + RVLIB_UART_REG_CTRL);
+
+    // Older UARTs do not have the debug register.
+    if ((ctrl >> RVLIB_UART_SHIFT_CTRL_FIFOBITS) == 0) {
+        return -1;
+    }
+
+    uint32_t want = (enable) ? (1 << RVLIB_UART_BIT_DEBUG_ENABLE) : 0;
+    rvlib_hw_write_reg(base_addr + RVLIB_UART_REG_DEBUG, want);
+
+    // UARTs without debug register read back the bit period here.
+    // A locked bridge reads back as disabled.
+    uint32_t v = rvlib_hw_read_reg(base_addr + RVLIB_UART_REG_DEBUG);
+    if ((v & ~(uint32_t)3) != 0
+        || (v & (1 << RVLIB_UART_BIT_DEBUG_ENABLE)) != want) {
+        return -1;
+    }
+    return 0;
+}
+
+
+/* Disable the UART debug bridge and lock it until the next reset. */
+void rvlib_uart_lock_debug_bridge(uint32_t base_addr)
+{
+    uint32_t ctrl = rvlib_hw_read_reg(base_addr + RVLIB_UART_REG_CTRL);
+    if ((ctrl >> RVLIB_UART_SHIFT_CTRL_FIFOBITS) != 0) {
+        rvlib_hw_write_reg(base_addr + RVLIB_UART_REG_DEBUG,
+                           1 << RVLIB_UART_BIT_DEBUG_LOCK);
+        // Read back, so the write has arrived before we return.
+        rvlib_hw_read_reg(base_addr + RVLIB_UART_REG_DEBUG);
+    }
+}
+
+
 #ifdef RVLIB_DEFAULT_UART_ADDR
 /* Write a byte to the default UART. */
-int rvlib_putchar(int c)
+int
+__attribute__ ((weak))
+rvlib_putchar(int c)
 {
     c &= 0xff;
     rvlib_uart_send_byte(RVLIB_DEFAULT_UART_ADDR, c);
     return c;
 }
+
+
+/* Return a byte from the default UART, or -1 if no byte is available. */
+int
+__attribute__ ((weak))
+rvlib_getchar(void)
+{
+    return rvlib_uart_recv_byte(RVLIB_DEFAULT_UART_ADDR);
+}
 #endif
 
 /* end */
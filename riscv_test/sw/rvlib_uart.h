@@ -21,7 +21,65 @@ void rvlib_uart_send_byte(uint32_t base_addr, uint8_t b);
 /* Return a received character, or return -1 if no character is available. */
 int rvlib_uart_recv_byte(uint32_t base_addr);
 
-/* Write a byte to the default UART. */
+/*
+ * Set the UART baud rate.
+ *
+ * The bit period is rounded to the nearest number of CPU clock cycles.
+ * Wait until the transmitter is idle before changing the baud rate.
+ */
+void rvlib_uart_set_baud_rate(uint32_t base_addr, uint32_t baud_rate);
+
+/*
+ * Enable or disable RTS/CTS hardware flow control.
+ *
+ * When enabled, the UART deasserts RTS when its receive FIFO is almost full
+ * and does not start transmitting a byte while CTS is deasserted.
+ * The remote side must also use RTS/CTS flow control, otherwise
+ * transmission stops forever.
+ *
+ * Return 0 on success, or -1 if the UART does not support flow control.
+ */
+int rvlib_uart_set_flow_control(uint32_t base_addr, int enable);
+
+/*
+ * Enable or disable the UART debug bridge.
+ *
+ * While enabled, a host can switch the serial port to the debug bridge
+ * by sending an escape sequence, and then read and write the whole
+ * system bus without authentication. The bridge is disabled after reset.
+ * Enable it only while the UART carries text; disable it before binary
+ * transfers, because binary data may contain the escape sequence.
+ *
+ * Return 0 on success, or -1 if the bridge is locked or the UART
+ * does not have a debug bridge control register.
+ */
+int rvlib_uart_set_debug_bridge(uint32_t base_addr, int enable);
+
+/*
+ * Disable the UART debug bridge and lock it until the next reset.
+ *
+ * Call this before loading a program that must be verified,
+ * so that the host can not modify it through the bridge.
+ */
+void rvlib_uart_lock_debug_bridge(uint32_t base_addr);
+
+/*
+ * Write a byte to the console.
+ *
+ * The default implementation writes to the default UART.
+ * This function is implemented as a weak symbol, therefore
+ * it may be overridden by an application-specific implementation,
+ * for example to send console output through the JTAG console.
+ */
 int rvlib_putchar(int c);
 
+/*
+ * Return a byte from the console, or return -1 if no byte is available.
+ *
+ * The default implementation reads from the default UART.
+ * This function is implemented as a weak symbol, therefore
+ * it may be overridden by an application-specific implementation.
+ */
+int rvlib_getchar(void);
+
 #endif  // RVLIB_UART_H_
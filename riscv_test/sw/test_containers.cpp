@@ -0,0 +1,278 @@
+/*
+ * Test and benchmark of the fixed-capacity containers in rvlib.
+ *
+ * This program first runs a few functional checks of the containers
+ * in "rvlib_containers.h". It then compares the number of CPU cycles
+ * of typical operations against std::vector, std::map and std::deque.
+ *
+ * This program is designed to be linked with PicoLibC, because the
+ * standard containers need the general heap.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+#include "rvlib_containers.h"
+
+extern "C" {
+#include "rvlib_time.h"
+}
+
+using namespace rvlib;
+
+
+/* Number of repetitions per benchmark. */
+#define NUM_ROUNDS      10
+
+#define VEC_SIZE        256
+#define MAP_SIZE        128
+#define RING_OPS        1024
+
+
+static int num_errors;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        num_errors++;
+    }
+}
+
+
+struct Item : public list_node {
+    int value;
+    explicit Item(int v) : value(v) { }
+};
+
+
+static void test_static_vector()
+{
+    static_vector<int, 4> v;
+    for (int i = 0; i < 4; i++) {
+        check(v.push_back(i), "static_vector push_back");
+    }
+    check(!v.push_back(4), "static_vector full");
+    v.erase(v.begin() + 1);
+    check(v.size() == 3 && v[1] == 2, "static_vector erase");
+    static_vector<int, 4> w(std::move(v));
+    check(v.empty() && w.size() == 3 && w.back() == 3, "static_vector move");
+}
+
+
+static void test_ring_buffer()
+{
+    ring_buffer<int, 3> r;
+    int x = 0;
+    for (int i = 0; i < 10; i++) {
+        check(r.push(i), "ring_buffer push");
+        if (r.full()) {
+            check(r.pop(x) && x == i - 2, "ring_buffer pop");
+        }
+    }
+    check(r.size() == 2 && r[0] == 8 && r[1] == 9, "ring_buffer order");
+}
+
+
+static void test_intrusive_list()
+{
+    Item a(1), b(2), c(3);
+    intrusive_list<Item> l;
+    l.push_back(a);
+    l.push_back(b);
+    l.push_front(c);
+    l.remove(a);
+    int s = 0;
+    for (Item& it : l) {
+        s = s * 10 + it.value;
+    }
+    check(s == 32 && !a.linked(), "intrusive_list");
+    l.clear();
+}
+
+
+static void test_hash_map()
+{
+    hash_map<uint32_t, int, 16> h;
+    for (int i = 0; i < 12; i++) {
+        check(h.insert(i * 7, i) != nullptr, "hash_map insert");
+    }
+    check(h.erase(14), "hash_map erase");
+    check(h.find(14) == nullptr, "hash_map find erased");
+    check(h.find(21) != nullptr && *h.find(21) == 3, "hash_map find");
+    check(h.size() == 11, "hash_map size");
+
+    hash_map<small_string<8>, int, 8> hs;
+    hs.insert("red", 1);
+    hs.insert("green", 2);
+    check(hs["green"] == 2 && !hs.contains("blue"), "hash_map strings");
+}
+
+
+static void test_small_string()
+{
+    small_string<6> s("abc");
+    s += "def";
+    check(s == "abcdef", "small_string append");
+    check(!s.append('g') && s.size() == 6, "small_string truncate");
+}
+
+
+static uint32_t rng_state;
+
+static uint32_t rng_next()
+{
+    // xorshift32
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+
+static uint32_t bench_std_vector()
+{
+    uint32_t sum = 0;
+    std::vector<uint32_t> v;
+    for (int i = 0; i < VEC_SIZE; i++) {
+        v.push_back(i);
+    }
+    for (uint32_t x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+
+static uint32_t bench_static_vector()
+{
+    uint32_t sum = 0;
+    static_vector<uint32_t, VEC_SIZE> v;
+    for (int i = 0; i < VEC_SIZE; i++) {
+        v.push_back(i);
+    }
+    for (uint32_t x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+
+static uint32_t bench_std_map()
+{
+    uint32_t sum = 0;
+    std::map<uint32_t, uint32_t> m;
+    rng_state = 1;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        m[rng_next()] = i;
+    }
+    rng_state = 1;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        sum += m.find(rng_next())->second;
+    }
+    return sum;
+}
+
+
+static uint32_t bench_hash_map()
+{
+    uint32_t sum = 0;
+    hash_map<uint32_t, uint32_t, 2 * MAP_SIZE> m;
+    rng_state = 1;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        m.insert(rng_next(), i);
+    }
+    rng_state = 1;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        sum += *m.find(rng_next());
+    }
+    return sum;
+}
+
+
+static uint32_t bench_std_deque()
+{
+    uint32_t sum = 0;
+    std::deque<uint32_t> q;
+    for (int i = 0; i < RING_OPS; i++) {
+        q.push_back(i);
+        if (q.size() > 16) {
+            sum += q.front();
+            q.pop_front();
+        }
+    }
+    return sum;
+}
+
+
+static uint32_t bench_ring_buffer()
+{
+    uint32_t sum = 0;
+    ring_buffer<uint32_t, 32> q;
+    for (int i = 0; i < RING_OPS; i++) {
+        q.push(i);
+        if (q.size() > 16) {
+            sum += q.front();
+            q.pop_front();
+        }
+    }
+    return sum;
+}
+
+
+struct benchmark {
+    const char *name;
+    uint32_t (*func)();
+};
+
+static const benchmark benchmarks[] = {
+    { "std::vector append", bench_std_vector },
+    { "static_vector append", bench_static_vector },
+    { "std::map insert+find", bench_std_map },
+    { "hash_map insert+find", bench_hash_map },
+    { "std::deque fifo", bench_std_deque },
+    { "ring_buffer fifo", bench_ring_buffer } };
+
+
+int main()
+{
+    printf("\nTest of rvlib fixed-capacity containers\n\n");
+
+    test_static_vector();
+    test_ring_buffer();
+    test_intrusive_list();
+    test_hash_map();
+    test_small_string();
+    printf("functional checks: %s\n\n", (num_errors == 0) ? "OK" : "FAILED");
+
+    printf("benchmark               cycles/round    checksum\n");
+    for (const benchmark& b : benchmarks) {
+        uint32_t check = 0;
+        uint64_t t0 = get_cycle_counter();
+        for (int r = 0; r < NUM_ROUNDS; r++) {
+            check += b.func();
+        }
+        uint64_t t1 = get_cycle_counter();
+        printf("%-22s %12lu %12lu\n",
+               b.name,
+               (unsigned long)((t1 - t0) / NUM_ROUNDS),
+               (unsigned long)check);
+    }
+
+    printf("done\n");
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,151 @@
+/*
+ * Compare deferred-formatting log messages against printf.
+ *
+ * This program sends the same log messages via printf() and via
+ * RVLIB_DLOG(), and reports the number of bytes sent and the number
+ * of CPU cycles per call. During the measurement, console output is
+ * counted but not sent, so that the UART speed does not affect
+ * the cycle count.
+ *
+ * Afterwards, the program sends a few deferred log records to the
+ * console. Decode them on the host with:
+ *   dlog_decode test_dlog.elf < /dev/ttyUSB0
+ *
+ * This program is designed to be linked with PicoLibC.
+ * It runs on a bare-metal RISC-V system, using rvlib to access
+ * system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "rvlib_hardware.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+#include "rvlib_dlog.h"
+
+
+/* Number of calls per measurement. */
+#define NUM_CALLS   100
+
+/* Number of message types. */
+#define NUM_TESTS   3
+
+static const char * const test_names[NUM_TESTS] = {
+    "constant text",
+    "two integers",
+    "four arguments" };
+
+/* When set, console output is counted but not sent. */
+static int sink_mode;
+static uint32_t sink_bytes;
+
+
+/* Override console output to support counting. */
+int rvlib_putchar(int c)
+{
+    c &= 0xff;
+    if (sink_mode) {
+        sink_bytes++;
+    } else {
+        rvlib_uart_send_byte(RVLIB_DEFAULT_UART_ADDR, c);
+    }
+    return c;
+}
+
+
+/* Send one log message of the specified type via printf. */
+static void log_printf(int test, int i)
+{
+    switch (test) {
+        case 0:
+            printf("periodic tick\n");
+            break;
+        case 1:
+            printf("channel %d: count %d\n", i, 1000 + i);
+            break;
+        default:
+            printf("sensor %d: temp %d.%02d C, status 0x%08x\n",
+                   i & 7, (2000 + i) / 100, (2000 + i) % 100, 0x1000 + i);
+            break;
+    }
+}
+
+
+/* Send one log message of the specified type via RVLIB_DLOG. */
+static void log_dlog(int test, int i)
+{
+    switch (test) {
+        case 0:
+            RVLIB_DLOG("periodic tick\n");
+            break;
+        case 1:
+            RVLIB_DLOG("channel %d: count %d\n", i, 1000 + i);
+            break;
+        default:
+            RVLIB_DLOG("sensor %d: temp %d.%02d C, status 0x%08x\n",
+                       i & 7, (2000 + i) / 100, (2000 + i) % 100, 0x1000 + i);
+            break;
+    }
+}
+
+
+/* Measure bytes and cycles for one type of log message. */
+static void measure(int test, int use_dlog, uint32_t *nbytes, uint32_t *ncycles)
+{
+    sink_bytes = 0;
+    sink_mode = 1;
+
+    uint64_t t0 = get_cycle_counter();
+    for (int i = 0; i < NUM_CALLS; i++) {
+        if (use_dlog) {
+            log_dlog(test, i);
+        } else {
+            log_printf(test, i);
+        }
+    }
+    uint64_t t1 = get_cycle_counter();
+
+    sink_mode = 0;
+    *nbytes = sink_bytes;
+    *ncycles = t1 - t0;
+}
+
+
+int main(void)
+{
+    printf("\nDeferred logging vs printf (%d calls each)\n\n", NUM_CALLS);
+    printf("%-16s %14s %14s %14s %14s\n",
+           "message", "printf bytes", "dlog bytes",
+           "printf cycles", "dlog cycles");
+
+    for (int test = 0; test < NUM_TESTS; test++) {
+        uint32_t pf_bytes, pf_cycles, dl_bytes, dl_cycles;
+        measure(test, 0, &pf_bytes, &pf_cycles);
+        measure(test, 1, &dl_bytes, &dl_cycles);
+        printf("%-16s %14lu %14lu %14lu %14lu\n",
+               test_names[test],
+               (unsigned long)(pf_bytes / NUM_CALLS),
+               (unsigned long)(dl_bytes / NUM_CALLS),
+               (unsigned long)(pf_cycles / NUM_CALLS),
+               (unsigned long)(dl_cycles / NUM_CALLS));
+    }
+
+    printf("\n(values per call)\n\nSending deferred log records:\n");
+    for (int i = 0; i < 4; i++) {
+        log_dlog(0, i);
+        log_dlog(1, i);
+        log_dlog(2, i);
+    }
+    RVLIB_DLOG("%s done after %u cycles\n", "test_dlog",
+               (unsigned int)get_cycle_counter());
+
+    return 0;
+}
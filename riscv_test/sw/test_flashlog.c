@@ -0,0 +1,325 @@
+/*
+ * Test of the append-only flash logger.
+ *
+ * This program writes sample records to the log area of the flash memory
+ * (RVSYS_FLASH_LOG_ADDR) through rvlib_flashlog:
+ *  - at full speed, to find the sustained ingest rate including the
+ *    background sector erases;
+ *  - at a fixed sample rate, to find the worst-case delay between
+ *    the moment a sample is due and the moment it is in the log.
+ * It then reads the fixed-rate records back and checks them, and opens
+ * the log again to check that the recovery scan finds the same write
+ * position.
+ *
+ * Each sample record is 32 bytes. The test overwrites old data in the
+ * log area.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_flashlog.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Number of 32-bit words per sample record. */
+#define SAMPLE_WORDS        8
+
+/* Amount of data written in the full-speed test (4 sectors). */
+#define BURST_BYTES         (4 * RVLIB_SPIFLASH_SECTOR_SIZE)
+
+/* Sample interval and duration of the fixed-rate test. */
+#define RATE_INTERVAL_US    2000
+#define RATE_NUM_SAMPLES    4000
+
+/* Page buffers (16 kByte). */
+#define NUM_PAGE_BUFS       64
+
+static unsigned char page_bufs[NUM_PAGE_BUFS * RVLIB_FLASHLOG_PAGE_SIZE];
+
+static struct rvlib_flashlog flog;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Fill a sample record with a pattern derived from its index. */
+static void make_sample(uint32_t *rec, uint32_t index)
+{
+    uint32_t x = index * 2654435761U;
+    rec[0] = index;
+    for (int i = 1; i < SAMPLE_WORDS; i++) {
+        x = x * 1664525 + 1013904223;
+        rec[i] = x;
+    }
+}
+
+
+/* Open the log and report the result of the recovery scan. */
+static int open_log(void)
+{
+    uint64_t t0 = get_cycle_counter();
+    int status = rvlib_flashlog_open(&flog,
+                                     RVSYS_FLASH_LOG_ADDR,
+                                     RVSYS_FLASH_LOG_SIZE,
+                                     page_bufs,
+                                     sizeof(page_bufs));
+    uint64_t t1 = get_cycle_counter();
+
+    if (status != 0) {
+        print_str("ERROR: rvlib_flashlog_open failed\r\n");
+        return status;
+    }
+
+    print_str("  recovery scan:     ");
+    print_uint((t1 - t0) / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us, ");
+    print_uint(flog.scan_reads);
+    print_str(" page reads\r\n  write position:    page ");
+    print_uint(flog.next_seq);
+    print_str(" (oldest page ");
+    print_uint(rvlib_flashlog_first_seq(&flog));
+    print_str(")\r\n");
+    return 0;
+}
+
+
+/* Write samples as fast as possible. */
+static int test_full_speed(void)
+{
+    uint32_t rec[SAMPLE_WORDS];
+    uint32_t max_append = 0, max_poll = 0;
+    unsigned int num_full = 0;
+
+    print_str("\r\nfull-speed test:\r\n");
+
+    uint64_t t_start = get_cycle_counter();
+    for (uint32_t i = 0; i < BURST_BYTES / sizeof(rec); i++) {
+        make_sample(rec, i);
+
+        while (1) {
+            uint64_t t0 = get_cycle_counter();
+            int status = rvlib_flashlog_append(&flog, rec, sizeof(rec));
+            uint64_t t1 = get_cycle_counter();
+            if (t1 - t0 > max_append) {
+                max_append = t1 - t0;
+            }
+            if (status == 0) {
+                break;
+            }
+            num_full++;
+            status = rvlib_flashlog_poll(&flog);
+            if (status < 0) {
+                print_str("ERROR: flash error\r\n");
+                return status;
+            }
+        }
+
+        uint64_t t0 = get_cycle_counter();
+        int status = rvlib_flashlog_poll(&flog);
+        uint64_t t1 = get_cycle_counter();
+        if (status < 0) {
+            print_str("ERROR: flash error\r\n");
+            return status;
+        }
+        if (t1 - t0 > max_poll) {
+            max_poll = t1 - t0;
+        }
+    }
+
+    int status = rvlib_flashlog_flush(&flog);
+    uint64_t t_end = get_cycle_counter();
+    if (status < 0) {
+        print_str("ERROR: flash error\r\n");
+        return status;
+    }
+
+    uint32_t ms = (t_end - t_start) / (RVLIB_CPU_FREQ_MHZ * 1000);
+    print_str("  bytes:             ");
+    print_uint(BURST_BYTES);
+    print_str("\r\n  time:              ");
+    print_uint(ms);
+    print_str(" ms\r\n  ingest rate:       ");
+    print_uint((uint64_t)BURST_BYTES * 1000 / 1024 / (ms ? ms : 1));
+    print_str(" kB/s\r\n  max append call:   ");
+    print_uint(max_append / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n  max poll call:     ");
+    print_uint(max_poll / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n  buffers full:      ");
+    print_uint(num_full);
+    print_str(" times\r\n");
+    return 0;
+}
+
+
+/* Write samples at a fixed rate. */
+static int test_fixed_rate(void)
+{
+    uint32_t rec[SAMPLE_WORDS];
+    uint32_t max_latency = 0;
+    unsigned int num_dropped = 0;
+
+    print_str("\r\nfixed-rate test (");
+    print_uint(sizeof(rec) * 1000000 / RATE_INTERVAL_US / 1024);
+    print_str(" kB/s):\r\n");
+
+    flog.max_buf_full = 0;
+
+    uint64_t t_due = get_cycle_counter();
+    for (uint32_t i = 0; i < RATE_NUM_SAMPLES; i++) {
+        t_due += RATE_INTERVAL_US * RVLIB_CPU_FREQ_MHZ;
+
+        // Do background work until the next sample is due.
+        while (get_cycle_counter() < t_due) {
+            int status = rvlib_flashlog_poll(&flog);
+            if (status < 0) {
+                print_str("ERROR: flash error\r\n");
+                return status;
+            }
+        }
+
+        make_sample(rec, i);
+        if (rvlib_flashlog_append(&flog, rec, sizeof(rec)) != 0) {
+            num_dropped++;
+        }
+        uint64_t t_done = get_cycle_counter();
+        if (t_done - t_due > max_latency) {
+            max_latency = t_done - t_due;
+        }
+    }
+
+    int status = rvlib_flashlog_flush(&flog);
+    if (status < 0) {
+        print_str("ERROR: flash error\r\n");
+        return status;
+    }
+
+    print_str("  samples:           ");
+    print_uint(RATE_NUM_SAMPLES);
+    print_str("\r\n  dropped:           ");
+    print_uint(num_dropped);
+    print_str("\r\n  max latency:       ");
+    print_uint(max_latency / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n  max buffered:      ");
+    print_uint(flog.max_buf_full);
+    print_str(" pages\r\n");
+    return 0;
+}
+
+
+/* Read back the records of the fixed-rate test. */
+static int check_log(uint32_t first_seq)
+{
+    unsigned char page[RVLIB_FLASHLOG_PAGE_DATA];
+    uint32_t rec[SAMPLE_WORDS];
+    uint32_t expect[SAMPLE_WORDS];
+    unsigned char *recp = (unsigned char *)rec;
+    unsigned int rec_fill = 0;
+    uint32_t num_rec = 0;
+    int32_t last_index = -1;
+    unsigned int num_errors = 0;
+
+    for (uint32_t seq = first_seq; seq < flog.next_seq; seq++) {
+        int len = rvlib_flashlog_read_page(&flog, seq, page);
+        if (len < 0) {
+            num_errors++;
+            continue;
+        }
+        for (int k = 0; k < len; k++) {
+            recp[rec_fill++] = page[k];
+            if (rec_fill == sizeof(rec)) {
+                make_sample(expect, rec[0]);
+                if (memcmp(rec, expect, sizeof(rec)) != 0
+                    || (int32_t)rec[0] <= last_index) {
+                    num_errors++;
+                }
+                last_index = rec[0];
+                num_rec++;
+                rec_fill = 0;
+            }
+        }
+    }
+
+    print_str("\r\nread back:\r\n  records:           ");
+    print_uint(num_rec);
+    print_str("\r\n  errors:            ");
+    print_uint(num_errors);
+    print_str("\r\n");
+    return (num_errors == 0) ? 0 : -1;
+}
+
+
+int main(void)
+{
+    print_str("\r\nFlash logger test\r\n\r\n");
+
+    rvlib_spiflash_init();
+
+    print_str("open log:\r\n");
+    if (open_log() != 0) {
+        return 0;
+    }
+
+    if (test_full_speed() != 0) {
+        return 0;
+    }
+
+    uint32_t rate_seq = flog.next_seq;
+    if (test_fixed_rate() != 0) {
+        return 0;
+    }
+
+    int ok = (check_log(rate_seq) == 0);
+
+    uint32_t next_seq = flog.next_seq;
+    print_str("\r\nreopen log:\r\n");
+    if (open_log() != 0) {
+        return 0;
+    }
+    if (flog.next_seq != next_seq) {
+        print_str("ERROR: expected write position ");
+        print_uint(next_seq);
+        print_str("\r\n");
+        ok = 0;
+    }
+
+    print_str(ok ? "\r\nOK\r\n" : "\r\nFAILED\r\n");
+    return 0;
+}
+
+/* end */
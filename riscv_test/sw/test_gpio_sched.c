@@ -0,0 +1,207 @@
+/*
+ * Test of the GPIO event scheduler.
+ *
+ * This program toggles PORT_A pin 0 in a square wave of 200 edges,
+ * in two ways:
+ *  - in software, waiting for each edge time in a busy loop and then
+ *    writing the GPIO output register;
+ *  - with the event scheduler of GPIO1, refilling the event queue from
+ *    the external interrupt handler.
+ * For the software method it reports the largest difference between
+ * the intended and the actual time of an edge. For the scheduler it
+ * reports whether any edge was late (LATE flag), the number of refill
+ * interrupts, and the CPU time spent in the interrupt handler.
+ * The scheduled waveform is played at several edge intervals, to find
+ * the shortest interval that the interrupt-driven refill can sustain.
+ *
+ * The waveform can be checked with an oscilloscope on PORT_A pin 0.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_gpio.h"
+#include "rvlib_interrupt.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Number of edges in the test waveform. */
+#define NUM_EDGES       200
+
+/* Output channel of the waveform (PORT_A pin 0). */
+#define TEST_CHANNEL    0
+
+/* Delay before the first edge, in timer cycles. */
+#define START_DELAY     (100 * RVLIB_CPU_FREQ_MHZ)
+
+static struct rvlib_gpio_event edges[NUM_EDGES];
+
+/* Refill state, shared with the interrupt handler. */
+static volatile size_t edges_queued;
+static volatile unsigned int num_interrupts;
+static volatile uint32_t handler_cycles;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Fill the edge table with a square wave starting at "t0". */
+static void make_edges(uint64_t t0, uint32_t interval)
+{
+    for (int i = 0; i < NUM_EDGES; i++) {
+        edges[i].time  = t0 + (uint64_t)i * interval;
+        edges[i].mask  = 1UL << TEST_CHANNEL;
+        edges[i].value = (i % 2 == 0) ? edges[i].mask : 0;
+    }
+}
+
+
+void handle_external_interrupt(void)
+{
+    uint64_t t0 = get_cycle_counter();
+
+    size_t n = edges_queued;
+    n += rvlib_gpio_sched_queue(RVSYS_ADDR_GPIO1, edges + n, NUM_EDGES - n);
+    edges_queued = n;
+    if (n == NUM_EDGES) {
+        rvlib_gpio_sched_set_interrupt(RVSYS_ADDR_GPIO1, 0, 0);
+    }
+
+    num_interrupts++;
+    handler_cycles += get_cycle_counter() - t0;
+}
+
+
+/* Toggle the output in software at the edge times. */
+static void test_software(uint32_t interval)
+{
+    uint32_t max_error = 0;
+
+    print_str("software, interval ");
+    print_uint(interval / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us:\r\n");
+
+    make_edges(rvlib_timer_get_counter() + START_DELAY, interval);
+
+    for (int i = 0; i < NUM_EDGES; i++) {
+        while (rvlib_timer_get_counter() < edges[i].time) ;
+        rvlib_gpio_set_output(RVSYS_ADDR_GPIO1, edges[i].value);
+        uint64_t t = rvlib_timer_get_counter();
+        if (t - edges[i].time > max_error) {
+            max_error = t - edges[i].time;
+        }
+    }
+
+    print_str("  max edge error:    ");
+    print_uint(max_error);
+    print_str(" cycles\r\n");
+}
+
+
+/* Play the edges through the event scheduler. */
+static void test_scheduler(uint32_t interval)
+{
+    unsigned int capacity = rvlib_gpio_sched_capacity(RVSYS_ADDR_GPIO1);
+
+    print_str("scheduler, interval ");
+    print_uint(interval / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us:\r\n");
+
+    rvlib_gpio_sched_flush(RVSYS_ADDR_GPIO1);
+    rvlib_gpio_sched_get_flags(RVSYS_ADDR_GPIO1);
+
+    make_edges(rvlib_timer_get_counter() + START_DELAY, interval);
+    edges_queued = 0;
+    num_interrupts = 0;
+    handler_cycles = 0;
+
+    // The handler queues the first events, then refills the queue
+    // when it is half empty.
+    rvlib_gpio_sched_set_interrupt(RVSYS_ADDR_GPIO1, 1, capacity / 2);
+
+    while (edges_queued < NUM_EDGES
+           || rvlib_gpio_sched_level(RVSYS_ADDR_GPIO1) > 0) ;
+
+    uint32_t flags = rvlib_gpio_sched_get_flags(RVSYS_ADDR_GPIO1);
+
+    print_str("  late edges:        ");
+    print_str((flags & RVLIB_GPIO_SCHED_LATE) ? "yes" : "no");
+    print_str("\r\n  overflow:          ");
+    print_str((flags & RVLIB_GPIO_SCHED_OVERFLOW) ? "yes" : "no");
+    print_str("\r\n  interrupts:        ");
+    print_uint(num_interrupts);
+    print_str("\r\n  handler time:      ");
+    print_uint(handler_cycles / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n");
+}
+
+
+int main(void)
+{
+    print_str("\r\nGPIO event scheduler test\r\n\r\n");
+
+    unsigned int capacity = rvlib_gpio_sched_capacity(RVSYS_ADDR_GPIO1);
+    if (capacity == 0) {
+        print_str("ERROR: GPIO1 has no event scheduler\r\n");
+        return 0;
+    }
+    print_str("queue capacity:      ");
+    print_uint(capacity);
+    print_str(" events\r\n\r\n");
+
+    rvlib_interrupt_init();
+    rvlib_interrupt_enable();
+    rvlib_enable_external_interrupt(1);
+
+    rvlib_gpio_set_output(RVSYS_ADDR_GPIO1, 0);
+    rvlib_gpio_set_channel_drive(RVSYS_ADDR_GPIO1, TEST_CHANNEL, 1);
+
+    test_software(20 * RVLIB_CPU_FREQ_MHZ);
+    test_scheduler(20 * RVLIB_CPU_FREQ_MHZ);
+    test_scheduler(5 * RVLIB_CPU_FREQ_MHZ);
+    test_scheduler(2 * RVLIB_CPU_FREQ_MHZ);
+    test_scheduler(1 * RVLIB_CPU_FREQ_MHZ);
+
+    rvlib_enable_external_interrupt(0);
+    rvlib_gpio_set_channel_drive(RVSYS_ADDR_GPIO1, TEST_CHANNEL, 0);
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,137 @@
+/*
+ * Test of hibernate to flash: compare cold boot against resume.
+ *
+ * At a cold boot, the program runs a slow initialization phase, reports
+ * the number of cycles from reset until ready, and saves a snapshot to
+ * flash. When the program is restarted (reload via GDB or hexboot, or
+ * power-cycle a board whose bitstream contains this program), it resumes
+ * from the snapshot and reports the cycles from reset until ready again.
+ *
+ * The initialization phase computes a table of primes and then waits
+ * for a fixed delay, standing in for the setup of external hardware.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_hibernate.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Check for a snapshot during startup. */
+RVLIB_HIBERNATE_RESUME_AT_STARTUP;
+
+/* Size of the table of primes in bits. */
+#define SIEVE_BITS      65536
+
+/* Simulated hardware setup delay in microseconds. */
+#define INIT_DELAY_US   200000
+
+static uint32_t sieve[SIEVE_BITS / 32];
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Slow application initialization. Return the number of primes found. */
+static unsigned int app_init(void)
+{
+    unsigned int nprimes = 0;
+
+    // Sieve of Eratosthenes; a set bit marks a composite number.
+    for (uint32_t i = 2; i < SIEVE_BITS; i++) {
+        if ((sieve[i / 32] & (1U << (i % 32))) == 0) {
+            nprimes++;
+            for (uint32_t k = 2 * i; k < SIEVE_BITS; k += i) {
+                sieve[k / 32] |= 1U << (k % 32);
+            }
+        }
+    }
+
+    usleep(INIT_DELAY_US);
+
+    return nprimes;
+}
+
+
+int main(void)
+{
+    unsigned int nprimes;
+    uint32_t t_ready, t_save;
+    int ret;
+
+    rvlib_spiflash_init();
+
+    nprimes = app_init();
+    t_ready = (uint32_t)get_cycle_counter() - rvlib_start_cycle;
+
+    ret = rvlib_hibernate_save();
+    t_save = (uint32_t)get_cycle_counter() - rvlib_start_cycle - t_ready;
+
+    if (ret == 1) {
+        // We get here after resuming from the snapshot.
+        t_ready = (uint32_t)get_cycle_counter() - rvlib_start_cycle;
+        print_str("\r\nHibernate test: resumed from snapshot\r\n");
+        print_str("resume to ready:    ");
+        print_uint(t_ready);
+        print_str(" cycles\r\n");
+    } else {
+        print_str("\r\nHibernate test: cold boot\r\n");
+        print_str("cold boot to ready: ");
+        print_uint(t_ready);
+        print_str(" cycles\r\n");
+        if (ret == 0) {
+            print_str("snapshot saved in   ");
+            print_uint(t_save);
+            print_str(" cycles\r\n");
+            print_str("restart the program to resume from the snapshot\r\n");
+        } else {
+            print_str("ERROR: saving snapshot failed, code -");
+            print_uint(-ret);
+            print_str("\r\n");
+        }
+    }
+
+    print_str("number of primes:   ");
+    print_uint(nprimes);
+    print_str("\r\n");
+
+    return 0;
+}
+
+/* end */
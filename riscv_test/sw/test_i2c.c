@@ -0,0 +1,212 @@
+/*
+ * Test of the I2C master.
+ *
+ * This program scans the I2C bus for devices, then reads a block of
+ * registers from one device in three ways:
+ *  - blocking register read at standard and fast speed;
+ *  - background register read, driven by the I2C interrupt.
+ * For each case, it reports the transaction time, the number of
+ * bus transactions to the I2C controller, and the data read.
+ *
+ * The I2C bus is on PORT_H pins 6 (SCL) and 7 (SDA).
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_busmon.h"
+#include "rvlib_i2c.h"
+#include "rvlib_interrupt.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Device to read from (default address of a 24Cxx EEPROM). */
+#define TEST_DEVICE     0x50
+#define TEST_REG        0x00
+#define TEST_SIZE       64
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+static void print_hex8(unsigned int val)
+{
+    rvlib_putchar("0123456789abcdef"[(val >> 4) & 15]);
+    rvlib_putchar("0123456789abcdef"[val & 15]);
+}
+
+
+void handle_external_interrupt(void)
+{
+    rvlib_i2c_poll();
+}
+
+
+static void report(const char *name,
+                   uint64_t cycles,
+                   int status,
+                   const uint8_t *buf)
+{
+    struct rvlib_busmon_counters ctr;
+    rvlib_busmon_enable(0);
+    rvlib_busmon_read(RVSYS_DEVBUS_I2C, &ctr);
+
+    print_str(name);
+    if (status != 0) {
+        print_str(" ERROR -");
+        print_uint(-status);
+        print_str("\r\n");
+        return;
+    }
+    print_str("\r\n  time:              ");
+    print_uint(cycles / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n");
+    if (rvlib_busmon_present()) {
+        print_str("  bus transactions:  ");
+        print_uint(ctr.reads + ctr.writes);
+        print_str("\r\n");
+    }
+    print_str("  data:              ");
+    for (int i = 0; i < 16; i++) {
+        print_hex8(buf[i]);
+        rvlib_putchar(' ');
+    }
+    print_str("...\r\n");
+}
+
+
+/* Address every device on the bus and report those that acknowledge. */
+static void scan_bus(void)
+{
+    struct rvlib_i2c_xfer xfer;
+
+    print_str("devices found:");
+    for (unsigned int addr = 0x08; addr < 0x78; addr++) {
+        xfer.addr = addr;
+        xfer.wbuf = NULL;
+        xfer.wlen = 0;
+        xfer.rbuf = NULL;
+        xfer.rlen = 0;
+        if (rvlib_i2c_transfer(&xfer) == 0) {
+            print_str(" 0x");
+            print_hex8(addr);
+        }
+    }
+    print_str("\r\n");
+}
+
+
+/* Read registers via the blocking API. */
+static void test_blocking(const char *name, uint32_t scl_freq)
+{
+    uint8_t buf[TEST_SIZE];
+
+    rvlib_i2c_init(scl_freq);
+
+    rvlib_busmon_reset();
+    uint64_t t0 = get_cycle_counter();
+    int status = rvlib_i2c_read_reg(TEST_DEVICE, TEST_REG, buf, TEST_SIZE);
+    uint64_t t1 = get_cycle_counter();
+
+    report(name, t1 - t0, status, buf);
+}
+
+
+/* Read registers in the background and count idle loops until done. */
+static void test_interrupt(const char *name)
+{
+    uint8_t reg = TEST_REG;
+    uint8_t buf[TEST_SIZE];
+    struct rvlib_i2c_xfer xfer;
+    uint32_t idle_loops = 0;
+
+    rvlib_i2c_init(RVLIB_I2C_SPEED_FAST);
+    rvlib_i2c_enable_interrupt(1);
+    rvlib_enable_external_interrupt(1);
+
+    xfer.addr = TEST_DEVICE;
+    xfer.wbuf = &reg;
+    xfer.wlen = 1;
+    xfer.rbuf = buf;
+    xfer.rlen = TEST_SIZE;
+
+    rvlib_busmon_reset();
+    uint64_t t0 = get_cycle_counter();
+    int status = rvlib_i2c_start(&xfer);
+    if (status == 0) {
+        // The CPU is free; this loop stands in for useful work.
+        while (xfer.status == RVLIB_I2C_BUSY) {
+            idle_loops++;
+        }
+        status = xfer.status;
+    }
+    uint64_t t1 = get_cycle_counter();
+
+    rvlib_enable_external_interrupt(0);
+    rvlib_i2c_enable_interrupt(0);
+
+    report(name, t1 - t0, status, buf);
+    print_str("  idle loops:        ");
+    print_uint(idle_loops);
+    print_str("\r\n");
+}
+
+
+int main(void)
+{
+    print_str("\r\nI2C master test\r\n\r\n");
+
+    rvlib_interrupt_init();
+    rvlib_interrupt_enable();
+
+    if (rvlib_i2c_init(RVLIB_I2C_SPEED_STANDARD) != 0) {
+        print_str("ERROR: I2C controller not found\r\n");
+        return 0;
+    }
+
+    scan_bus();
+
+    test_blocking("blocking read, 100 kHz:", RVLIB_I2C_SPEED_STANDARD);
+    test_blocking("blocking read, 400 kHz:", RVLIB_I2C_SPEED_FAST);
+    test_interrupt("background read, 400 kHz, interrupt:");
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,178 @@
+/*
+ * Measure timer interrupt latency with and without nested interrupts.
+ *
+ * A low-priority software interrupt handler runs for a long time.
+ * While it runs, a timer interrupt becomes due. Without nesting, the
+ * timer handler has to wait until the software handler finishes.
+ * With nesting and a higher priority for the timer, the timer handler
+ * preempts the software handler.
+ *
+ * The latency is measured from the moment "mtime" reaches "mtimecmp"
+ * until the timer handler reads "mtime".
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_interrupt.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Duration of the low-priority handler in clock cycles. */
+#define LONG_HANDLER_CYCLES     50000
+
+/* Number of measurements per test. */
+#define NUM_TRIALS              16
+
+static volatile uint64_t timer_due;
+static volatile uint32_t timer_latency;
+static volatile int timer_done;
+static volatile int timer_preempted;
+static volatile int soft_active;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Low-priority handler: busy for a long time. */
+void handle_software_interrupt(void)
+{
+    rvlib_set_software_interrupt(0);
+    soft_active = 1;
+    uint64_t t_end = get_cycle_counter() + LONG_HANDLER_CYCLES;
+    while (get_cycle_counter() < t_end) ;
+    soft_active = 0;
+}
+
+
+/* High-priority handler: measure latency and cancel the timer. */
+void handle_timer_interrupt(void)
+{
+    uint64_t now = rvlib_timer_get_counter();
+    timer_latency = now - timer_due;
+    timer_preempted = soft_active;
+    rvlib_timer_set_timecmp(UINT64_MAX);
+    timer_done = 1;
+}
+
+
+/*
+ * Run one test. If "with_load" is non-zero, the timer interrupt becomes
+ * due while the long software interrupt handler runs.
+ */
+static void run_test(const char *name, int with_load)
+{
+    uint32_t lat_min = UINT32_MAX, lat_max = 0;
+    uint64_t lat_sum = 0;
+    int npreempt = 0;
+
+    for (int i = 0; i < NUM_TRIALS; i++) {
+        timer_done = 0;
+
+        // Vary the moment of the timer interrupt within the long handler.
+        uint64_t due = rvlib_timer_get_counter() + 2000 + 2917 * i;
+        timer_due = due;
+        rvlib_timer_set_timecmp(due);
+
+        if (with_load) {
+            rvlib_set_software_interrupt(1);
+        }
+
+        while (!timer_done) ;
+
+        uint32_t lat = timer_latency;
+        lat_sum += lat;
+        if (lat < lat_min) {
+            lat_min = lat;
+        }
+        if (lat > lat_max) {
+            lat_max = lat;
+        }
+        npreempt += timer_preempted;
+    }
+
+    print_str(name);
+    print_str(": latency min=");
+    print_uint(lat_min);
+    print_str(" avg=");
+    print_uint((uint32_t)(lat_sum / NUM_TRIALS));
+    print_str(" max=");
+    print_uint(lat_max);
+    print_str(" cycles, preempted ");
+    print_uint(npreempt);
+    print_str("/");
+    print_uint(NUM_TRIALS);
+    print_str("\r\n");
+}
+
+
+int main(void)
+{
+    print_str("\r\nTimer interrupt latency test\r\n");
+    print_str("long handler: ");
+    print_uint(LONG_HANDLER_CYCLES);
+    print_str(" cycles\r\n\r\n");
+
+    rvlib_interrupt_init_nested();
+    rvlib_timer_set_timecmp(UINT64_MAX);
+    rvlib_set_software_interrupt(0);
+    rvlib_enable_timer_interrupt(1);
+    rvlib_enable_software_interrupt(1);
+    rvlib_interrupt_enable();
+
+    // All sources at equal priority: no nesting.
+    rvlib_interrupt_set_priority(RVLIB_IRQ_SOFTWARE, 0);
+    rvlib_interrupt_set_priority(RVLIB_IRQ_TIMER, 0);
+    run_test("idle             ", 0);
+    run_test("flat, with load  ", 1);
+
+    // Timer has higher priority than the software interrupt.
+    rvlib_interrupt_disable();
+    rvlib_interrupt_set_priority(RVLIB_IRQ_TIMER, 1);
+    rvlib_interrupt_enable();
+    run_test("nested, with load", 1);
+
+    rvlib_interrupt_disable();
+    rvlib_enable_timer_interrupt(0);
+    rvlib_enable_software_interrupt(0);
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
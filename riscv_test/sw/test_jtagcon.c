@@ -0,0 +1,150 @@
+/*
+ * Test throughput of the JTAG console channel.
+ *
+ * This program sends a block of text through the UART and the same
+ * amount of text through the JTAG console, and reports the achieved
+ * throughput of each channel. Afterwards, it echoes any bytes received
+ * from the JTAG console back to the JTAG console.
+ *
+ * Results are reported on the UART. Start "jtagcon_bridge" on the host
+ * before running this program.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+#include "rvlib_jtagcon.h"
+
+
+/* Number of bytes to send through each channel. */
+#define TEST_UART_BYTES     8192
+#define TEST_JTAG_BYTES     65536
+
+static const char test_line[64] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\r\n";
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_uart_send_byte(RVSYS_ADDR_UART, *msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Print the number of cycles and bytes per second for a transfer. */
+static void print_rate(uint32_t nbytes, uint64_t cycles)
+{
+    uint64_t rate = (uint64_t)nbytes * RVLIB_CPU_FREQ_MHZ * 1000000 / cycles;
+    print_uint(nbytes);
+    print_str(" bytes in ");
+    print_uint((unsigned int)cycles);
+    print_str(" cycles = ");
+    print_uint((unsigned int)rate);
+    print_str(" bytes/s\r\n");
+}
+
+
+/* Send test data through the UART. */
+static void test_uart(void)
+{
+    print_str("Sending data through UART ...\r\n");
+    usleep(100000);
+
+    uint64_t t0 = get_cycle_counter();
+    for (uint32_t p = 0; p < TEST_UART_BYTES; p++) {
+        rvlib_uart_send_byte(RVSYS_ADDR_UART, test_line[p % sizeof(test_line)]);
+    }
+    uint64_t t1 = get_cycle_counter();
+
+    print_str("\r\nUART: ");
+    print_rate(TEST_UART_BYTES, t1 - t0);
+}
+
+
+/* Send test data through the JTAG console. */
+static void test_jtagcon(void)
+{
+    print_str("Waiting for JTAG console host ...\r\n");
+    while (!rvlib_jtagcon_connected()) ;
+
+    print_str("Sending data through JTAG console ...\r\n");
+
+    uint64_t t0 = get_cycle_counter();
+    uint32_t nsent = 0;
+    for (uint32_t p = 0; p < TEST_JTAG_BYTES; p += sizeof(test_line)) {
+        nsent += rvlib_jtagcon_write((const unsigned char *)test_line,
+                                     sizeof(test_line));
+    }
+
+    /* Wait until the host has taken all data. */
+    while (!rvlib_jtagcon_tx_empty() && rvlib_jtagcon_connected()) ;
+    uint64_t t1 = get_cycle_counter();
+
+    print_str("JTAG console: ");
+    print_rate(nsent, t1 - t0);
+    if (nsent != TEST_JTAG_BYTES) {
+        print_str("ERROR: host disconnected during test\r\n");
+    }
+}
+
+
+/* Echo bytes received through the JTAG console. */
+static void echo_jtagcon(void)
+{
+    print_str("Echoing JTAG console input ...\r\n");
+    while (1) {
+        int c = rvlib_jtagcon_recv_byte();
+        if (c >= 0) {
+            rvlib_jtagcon_send_byte(c);
+            if (c == '\r') {
+                rvlib_jtagcon_send_byte('\n');
+            }
+        }
+    }
+}
+
+
+/*
+ * Main program.
+ */
+int main(void)
+{
+    print_str("\r\nTesting JTAG console\r\n");
+
+    test_uart();
+    test_jtagcon();
+    echo_jtagcon();
+
+    return 0;
+}
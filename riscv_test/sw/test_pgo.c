@@ -0,0 +1,247 @@
+/*
+ * Benchmark workloads for profile-guided optimization.
+ *
+ * This program runs a few small, branch-heavy workloads and reports
+ * the number of CPU cycles for each workload. Build and run it three
+ * times to see the effect of profile-guided optimization:
+ *
+ *   make clean && make test_pgo.hex                (baseline)
+ *   make clean && make PGO=generate test_pgo.hex   (collect profile)
+ *   make clean && make PGO=use test_pgo.hex        (optimized)
+ *
+ * When the program is built with PGO=generate, it sends the profile
+ * data to the console at the end. Use "tools/gcov_recv" to store it
+ * in ".gcda" files (see README).
+ *
+ * Cycle counts of the instrumented build include the counting overhead
+ * and are not representative.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+#include "rvlib_crc32.h"
+#include "rvlib_gcov.h"
+
+
+/* Number of repetitions per workload. */
+#define NUM_ROUNDS      20
+
+#define SORT_SIZE       256
+#define CRC_SIZE        4096
+
+static uint32_t sort_buf[SORT_SIZE];
+static unsigned char crc_buf[CRC_SIZE];
+
+static const char parse_text[] =
+    "set speed 1200; set mode fast, wait 250ms\n"
+    "# comment line, ignored by the parser\n"
+    "move x=120 y=-45 z=0.5; move x=0 y=0\n"
+    "led green on; led red off; delay 1000\n"
+    "read adc 3 -> r1; if r1 > 512 then stop\n";
+
+static uint32_t rng_state;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val, unsigned int width)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+        if (width > 0) {
+            width--;
+        }
+    } while (val != 0);
+    while (width > 0) {
+        rvlib_putchar(' ');
+        width--;
+    }
+    print_str(p);
+}
+
+
+static void print_str_padded(const char *msg, unsigned int width)
+{
+    print_str(msg);
+    for (size_t n = strnlen_s(msg, width); n < width; n++) {
+        rvlib_putchar(' ');
+    }
+}
+
+
+static uint32_t rng_next(void)
+{
+    // xorshift32
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+
+/* Workload: insertion sort of pseudo-random numbers. */
+static uint32_t workload_sort(void)
+{
+    for (int i = 0; i < SORT_SIZE; i++) {
+        sort_buf[i] = rng_next() & 0xffff;
+    }
+    for (int i = 1; i < SORT_SIZE; i++) {
+        uint32_t v = sort_buf[i];
+        int k = i;
+        while (k > 0 && sort_buf[k-1] > v) {
+            sort_buf[k] = sort_buf[k-1];
+            k--;
+        }
+        sort_buf[k] = v;
+    }
+    return sort_buf[SORT_SIZE / 2];
+}
+
+
+/* Workload: CRC-32 of a buffer. */
+static uint32_t workload_crc(void)
+{
+    return rvlib_crc32(0, crc_buf, CRC_SIZE);
+}
+
+
+/* Workload: tokenize a text buffer. */
+static uint32_t workload_parse(void)
+{
+    uint32_t words = 0, numbers = 0, symbols = 0, comments = 0;
+    const char *p = parse_text;
+
+    while (*p != '\0') {
+        char c = *p;
+        if (c == ' ' || c == '\n') {
+            p++;
+        } else if (c == '#') {
+            comments++;
+            while (*p != '\0' && *p != '\n') {
+                p++;
+            }
+        } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            words++;
+            while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')
+                   || (*p >= '0' && *p <= '9')) {
+                p++;
+            }
+        } else if ((c >= '0' && c <= '9') || c == '-') {
+            numbers++;
+            p++;
+            while ((*p >= '0' && *p <= '9') || *p == '.') {
+                p++;
+            }
+        } else {
+            symbols++;
+            p++;
+        }
+    }
+
+    return words + (numbers << 8) + (symbols << 16) + (comments << 24);
+}
+
+
+/* Workload: count primes by trial division. */
+static uint32_t workload_primes(void)
+{
+    uint32_t count = 0;
+    for (uint32_t n = 2; n < 2000; n++) {
+        int prime = 1;
+        for (uint32_t d = 2; d * d <= n; d++) {
+            if (n % d == 0) {
+                prime = 0;
+                break;
+            }
+        }
+        count += prime;
+    }
+    return count;
+}
+
+
+struct workload {
+    const char *name;
+    uint32_t (*func)(void);
+};
+
+static const struct workload workloads[] = {
+    { "insertion sort", workload_sort },
+    { "crc32",          workload_crc },
+    { "tokenizer",      workload_parse },
+    { "primes",         workload_primes } };
+
+#define NUM_WORKLOADS   (sizeof(workloads) / sizeof(workloads[0]))
+
+
+int main(void)
+{
+    print_str("\r\nPGO benchmark (");
+    print_uint(NUM_ROUNDS, 0);
+    print_str(" rounds per workload)\r\n\r\n");
+    print_str("workload        cycles/round    checksum\r\n");
+
+    for (int i = 0; i < CRC_SIZE; i++) {
+        crc_buf[i] = i ^ (i >> 8);
+    }
+
+    uint64_t total = 0;
+    for (unsigned int w = 0; w < NUM_WORKLOADS; w++) {
+        uint32_t check = 0;
+        rng_state = 1;
+
+        uint64_t t0 = get_cycle_counter();
+        for (int r = 0; r < NUM_ROUNDS; r++) {
+            check += workloads[w].func();
+        }
+        uint64_t t1 = get_cycle_counter();
+
+        uint32_t cycles = (t1 - t0) / NUM_ROUNDS;
+        total += cycles;
+
+        print_str_padded(workloads[w].name, 16);
+        print_uint(cycles, 12);
+        print_uint(check, 12);
+        print_str("\r\n");
+    }
+
+    print_str_padded("total", 16);
+    print_uint(total, 12);
+    print_str("\r\n");
+
+    // Send profile data (only when built with PGO=generate).
+    rvlib_gcov_dump();
+
+    return 0;
+}
+
+/* end */
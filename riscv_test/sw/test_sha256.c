@@ -0,0 +1,223 @@
+/*
+ * Test and benchmark of the SHA-256 engine.
+ *
+ * This program checks the hardware and software versions of SHA-256
+ * and HMAC-SHA256 against known test vectors, then measures
+ *  - hash throughput on a buffer in RAM;
+ *  - the time to verify an image in flash memory the way the boot
+ *    monitor does before "fpga boot update": CRC only, CRC plus
+ *    HMAC in software, and CRC plus HMAC in hardware.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_crc32.h"
+#include "rvlib_sha256.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Size of the RAM buffer for the throughput test. */
+#define BENCH_BUF_SIZE  16384
+
+/* Size of the flash area for the verification test (size of a bitstream). */
+#define FLASH_TEST_SIZE 0x100000
+
+static uint8_t bench_buf[BENCH_BUF_SIZE];
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Check against test vectors from FIPS 180-2 and RFC 4231. */
+static int check_vectors(void)
+{
+    static const uint8_t sha_abc[32] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+        0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+        0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad };
+    static const uint8_t sha_2block[32] = {
+        0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+        0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+        0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+        0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 };
+    static const uint8_t hmac_key[4] = { 'J', 'e', 'f', 'e' };
+    static const uint8_t hmac_tag[32] = {
+        0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e,
+        0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83,
+        0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43 };
+    static const char msg_2block[] =
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    static const char msg_hmac[] = "what do ya want for nothing?";
+
+    struct rvlib_hmac_sha256_ctx hmac;
+    uint8_t digest[32];
+    int ok = 1;
+
+    rvlib_sha256("abc", 3, digest);
+    ok = ok && (memcmp(digest, sha_abc, 32) == 0);
+
+    rvlib_sha256(msg_2block, sizeof(msg_2block) - 1, digest);
+    ok = ok && (memcmp(digest, sha_2block, 32) == 0);
+
+    rvlib_hmac_sha256_init(&hmac, hmac_key, sizeof(hmac_key));
+    rvlib_hmac_sha256_update(&hmac, msg_hmac, sizeof(msg_hmac) - 1);
+    rvlib_hmac_sha256_final(&hmac, digest);
+    ok = ok && (memcmp(digest, hmac_tag, 32) == 0);
+
+    return ok;
+}
+
+
+/* Hash the RAM buffer. Return elapsed cycles. */
+static uint32_t bench_ram(uint8_t *digest)
+{
+    uint64_t t0 = get_cycle_counter();
+    rvlib_sha256(bench_buf, sizeof(bench_buf), digest);
+    uint64_t t1 = get_cycle_counter();
+    return t1 - t0;
+}
+
+
+/* Read a flash area and calculate CRC and optionally HMAC. Return cycles. */
+static uint64_t bench_flash(int with_hmac)
+{
+    static const uint8_t key[32] = { 1 };
+    struct rvlib_hmac_sha256_ctx hmac;
+    uint8_t buf[256];
+    uint8_t tag[32];
+    uint32_t crc = 0;
+
+    uint64_t t0 = get_cycle_counter();
+
+    if (with_hmac) {
+        rvlib_hmac_sha256_init(&hmac, key, sizeof(key));
+    }
+
+    rvlib_spiflash_read_start(RVSYS_FLASH_GOLDEN_ADDR);
+    for (uint32_t p = 0; p < FLASH_TEST_SIZE; p += sizeof(buf)) {
+        rvlib_spiflash_read_continue(buf, sizeof(buf));
+        crc = rvlib_crc32(crc, buf, sizeof(buf));
+        if (with_hmac) {
+            rvlib_hmac_sha256_update(&hmac, buf, sizeof(buf));
+        }
+    }
+    rvlib_spiflash_read_end();
+
+    if (with_hmac) {
+        rvlib_hmac_sha256_final(&hmac, tag);
+    }
+
+    uint64_t t1 = get_cycle_counter();
+    return t1 - t0;
+}
+
+
+static void report_ram(const char *name, uint32_t cycles)
+{
+    print_str(name);
+    print_uint(cycles / (BENCH_BUF_SIZE / 64));
+    print_str(" cycles per block, ");
+    print_uint((uint64_t)BENCH_BUF_SIZE * RVLIB_CPU_FREQ_MHZ * 1000000
+               / cycles / 1024);
+    print_str(" kB/s\r\n");
+}
+
+
+static void report_flash(const char *name, uint64_t cycles)
+{
+    print_str(name);
+    print_uint(cycles / (RVLIB_CPU_FREQ_MHZ * 1000));
+    print_str(" ms\r\n");
+}
+
+
+int main(void)
+{
+    uint8_t digest[2][32];
+    uint32_t sw_cycles, hw_cycles;
+
+    print_str("\r\nSHA-256 engine test\r\n\r\n");
+
+    for (int i = 0; i < BENCH_BUF_SIZE; i++) {
+        bench_buf[i] = i * 7 + (i >> 8);
+    }
+
+    rvlib_sha256_init_hw(0);
+    print_str(check_vectors() ? "software vectors: OK\r\n"
+                              : "software vectors: MISMATCH\r\n");
+
+    if (!rvlib_sha256_init_hw(1)) {
+        print_str("ERROR: SHA-256 engine not found\r\n");
+        return 0;
+    }
+    print_str(check_vectors() ? "hardware vectors: OK\r\n"
+                              : "hardware vectors: MISMATCH\r\n");
+
+    // Throughput on data in RAM.
+    rvlib_sha256_init_hw(0);
+    sw_cycles = bench_ram(digest[0]);
+    rvlib_sha256_init_hw(1);
+    hw_cycles = bench_ram(digest[1]);
+    print_str("\r\nSHA-256 of ");
+    print_uint(BENCH_BUF_SIZE);
+    print_str(" bytes in RAM:\r\n");
+    report_ram("  software: ", sw_cycles);
+    report_ram("  hardware: ", hw_cycles);
+    print_str(memcmp(digest[0], digest[1], 32) == 0 ?
+              "  results OK\r\n" : "  results MISMATCH\r\n");
+
+    // Verification delay of an image in flash.
+    rvlib_spiflash_init();
+    print_str("\r\nVerify ");
+    print_uint(FLASH_TEST_SIZE);
+    print_str(" bytes in flash:\r\n");
+    report_flash("  CRC only:            ", bench_flash(0));
+    rvlib_sha256_init_hw(0);
+    report_flash("  CRC + HMAC software: ", bench_flash(1));
+    rvlib_sha256_init_hw(1);
+    report_flash("  CRC + HMAC hardware: ", bench_flash(1));
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,218 @@
+/*
+ * Test the SPI flash read cache on a synthetic workload.
+ *
+ * This program runs several read patterns against the flash memory,
+ * first without cache and then with cache, and reports the average
+ * read latency and cache hit rates. It also checks that cached reads
+ * return the same data as uncached reads.
+ *
+ * The flash memory is only read, not modified.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_spiflash_cache.h"
+
+
+/* Flash area used by the test workloads. */
+#define TEST_AREA_BASE      0x000000
+#define TEST_AREA_SIZE      0x100000
+
+/* Workload types. */
+#define WORKLOAD_CONFIG     0
+#define WORKLOAD_TABLE      1
+#define WORKLOAD_STREAM     2
+#define NUM_WORKLOADS       3
+
+static const char * const workload_names[NUM_WORKLOADS] = {
+    "config lookups",
+    "table lookups",
+    "sequential stream" };
+
+/* Cache storage, sized for the largest test configuration. */
+#define CACHE_MAX_BLOCKS    16
+#define CACHE_DATA_SIZE     16384
+
+static struct rvlib_spiflash_cache_line cache_lines[CACHE_MAX_BLOCKS];
+static uint32_t cache_data[CACHE_DATA_SIZE / 4];
+
+static uint32_t rng_state;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+/* Simple xorshift random number generator. */
+static uint32_t rng_next(void)
+{
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+
+/*
+ * Run a read workload and return a checksum of the data.
+ *
+ * Reads go through the cache if "use_cache" is non-zero.
+ * The number of read calls is returned via "ncalls".
+ */
+static uint32_t run_workload(int workload, int use_cache, uint32_t *ncalls)
+{
+    unsigned char buf[64];
+    uint32_t checksum = 0;
+    uint32_t nreads = 0;
+
+    rng_state = 0x12345678;
+
+    for (int i = 0; i < 2048; i++) {
+        uint32_t addr;
+        size_t len;
+
+        switch (workload) {
+            case WORKLOAD_CONFIG:
+                /* Small records, mostly from a few hot areas. */
+                len = 16;
+                if ((rng_next() & 7) != 0) {
+                    addr = (rng_next() & 0x3) * 0x40000 + (rng_next() & 0xf0);
+                } else {
+                    addr = rng_next() & (TEST_AREA_SIZE - 16);
+                }
+                break;
+            case WORKLOAD_TABLE:
+                /* Random 4-byte entries from an 8 kByte table. */
+                len = 4;
+                addr = 0x80000 + (rng_next() & 0x1ffc);
+                break;
+            default:
+                /* Sequential 64-byte chunks. */
+                len = 64;
+                addr = 0x20000 + i * 64;
+                break;
+        }
+
+        addr += TEST_AREA_BASE;
+        if (use_cache) {
+            rvlib_spiflash_cache_read(addr, buf, len);
+        } else {
+            rvlib_spiflash_read_mem(addr, buf, len);
+        }
+        nreads++;
+
+        for (size_t k = 0; k < len; k++) {
+            checksum = (checksum << 5) + (checksum >> 27) + buf[k];
+        }
+    }
+
+    *ncalls = nreads;
+    return checksum;
+}
+
+
+/* Run all workloads with the specified cache configuration. */
+static void test_config(unsigned int num_blocks, unsigned int block_size)
+{
+    print_str("\r\nCache: ");
+    print_uint(num_blocks);
+    print_str(" blocks of ");
+    print_uint(block_size);
+    print_str(" bytes\r\n");
+
+    if (rvlib_spiflash_cache_init(cache_lines,
+                                  (unsigned char *)cache_data,
+                                  num_blocks,
+                                  block_size) != 0) {
+        print_str("ERROR: cache_init failed\r\n");
+        return;
+    }
+
+    for (int w = 0; w < NUM_WORKLOADS; w++) {
+        uint32_t ncalls;
+        struct rvlib_spiflash_cache_stats stats;
+
+        uint64_t t0 = get_cycle_counter();
+        uint32_t sum_direct = run_workload(w, 0, &ncalls);
+        uint64_t t1 = get_cycle_counter();
+
+        rvlib_spiflash_cache_invalidate_all();
+        rvlib_spiflash_cache_reset_stats();
+        uint32_t sum_cached = run_workload(w, 1, &ncalls);
+        rvlib_spiflash_cache_get_stats(&stats);
+
+        uint32_t nlookup = stats.block_hits + stats.block_misses;
+
+        print_str("  ");
+        print_str(workload_names[w]);
+        print_str(": direct ");
+        print_uint((unsigned int)((t1 - t0) / ncalls));
+        print_str(" cycles/read, cached ");
+        print_uint((unsigned int)(stats.read_cycles / stats.read_calls));
+        print_str(" cycles/read, hit rate ");
+        print_uint(stats.block_hits * 100 / nlookup);
+        print_str("%, prefetches ");
+        print_uint(stats.prefetches);
+        print_str("\r\n");
+
+        if (sum_direct != sum_cached) {
+            print_str("ERROR: cached data does not match flash data\r\n");
+        }
+    }
+}
+
+
+/*
+ * Main program.
+ */
+int main(void)
+{
+    print_str("\r\nTesting SPI flash read cache\r\n");
+
+    rvlib_spiflash_init();
+
+    test_config(16, 256);
+    test_config(4, 4096);
+
+    print_str("\r\nDone\r\n");
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Test of flash erase with software polling and with the auto-poll engine.
+ *
+ * This program erases a 4 kByte subsector in the area reserved for
+ * "spiflash writetest" in three ways:
+ *  - blocking erase, software polls the flash status via SPI commands;
+ *  - blocking erase, the SPI controller polls the flash status;
+ *  - background erase, completion reported via external interrupt.
+ * For each case, it reports the total erase time, the number of
+ * bus transactions to the SPI controller, and the CPU cycles spent
+ * in the flash driver.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_busmon.h"
+#include "rvlib_interrupt.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Flash address to erase (area reserved for "spiflash writetest"). */
+#define TEST_ADDR       0x7f0000
+
+/* Number of erase operations per test case. */
+#define NUM_ERASE       4
+
+/* Set by the interrupt handler. */
+static volatile int erase_status;
+static volatile uint32_t irq_cycles;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+void handle_external_interrupt(void)
+{
+    uint64_t t0 = get_cycle_counter();
+    if (erase_status == 1) {
+        int status = rvlib_spiflash_erase_finish();
+        if (status != 1) {
+            erase_status = status;
+        }
+    }
+    uint64_t t1 = get_cycle_counter();
+    irq_cycles += t1 - t0;
+}
+
+
+static void report(const char *name,
+                   uint64_t total_cycles,
+                   uint64_t driver_cycles,
+                   int status)
+{
+    struct rvlib_busmon_counters ctr;
+    rvlib_busmon_enable(0);
+    rvlib_busmon_read(RVSYS_DEVBUS_SPIFLASH, &ctr);
+
+    print_str(name);
+    if (status != 0) {
+        print_str(" ERROR -");
+        print_uint(-status);
+        print_str("\r\n");
+        return;
+    }
+    print_str("\r\n  time per erase:    ");
+    print_uint(total_cycles / NUM_ERASE / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us\r\n");
+    if (rvlib_busmon_present()) {
+        print_str("  bus transactions:  ");
+        print_uint((ctr.reads + ctr.writes) / NUM_ERASE);
+        print_str(" per erase\r\n");
+    }
+    print_str("  driver CPU cycles: ");
+    print_uint(driver_cycles / NUM_ERASE);
+    print_str(" per erase\r\n");
+}
+
+
+/* Erase via the blocking API. */
+static void test_blocking(const char *name)
+{
+    int status = 0;
+
+    rvlib_busmon_reset();
+    uint64_t t0 = get_cycle_counter();
+    for (int i = 0; i < NUM_ERASE && status == 0; i++) {
+        status = rvlib_spiflash_subsector_erase(TEST_ADDR);
+    }
+    uint64_t t1 = get_cycle_counter();
+
+    // The CPU is busy in the driver during the whole erase.
+    report(name, t1 - t0, t1 - t0, status);
+}
+
+
+/* Erase in the background and count idle loops until done. */
+static void test_background(const char *name)
+{
+    uint64_t total = 0;
+    uint64_t driver = 0;
+    uint32_t idle_loops = 0;
+    int status = 0;
+
+    rvlib_spiflash_enable_interrupt(1);
+    rvlib_enable_external_interrupt(1);
+
+    rvlib_busmon_reset();
+    irq_cycles = 0;
+    for (int i = 0; i < NUM_ERASE && status == 0; i++) {
+        erase_status = 1;
+        uint64_t t0 = get_cycle_counter();
+        status = rvlib_spiflash_subsector_erase_start(TEST_ADDR);
+        uint64_t t1 = get_cycle_counter();
+        if (status == 0) {
+            // The CPU is free; this loop stands in for useful work.
+            while (erase_status == 1) {
+                idle_loops++;
+            }
+            status = erase_status;
+        }
+        uint64_t t2 = get_cycle_counter();
+        total += t2 - t0;
+        driver += t1 - t0;
+    }
+    driver += irq_cycles;
+
+    rvlib_enable_external_interrupt(0);
+    rvlib_spiflash_enable_interrupt(0);
+
+    report(name, total, driver, status);
+    print_str("  idle loops:        ");
+    print_uint(idle_loops / NUM_ERASE);
+    print_str(" per erase\r\n");
+}
+
+
+int main(void)
+{
+    print_str("\r\nSPI flash erase test\r\n\r\n");
+
+    rvlib_interrupt_init();
+    rvlib_interrupt_enable();
+    rvlib_spiflash_init();
+
+    rvlib_spiflash_use_autopoll(0);
+    test_blocking("blocking erase, software polling:");
+
+    if (!rvlib_spiflash_use_autopoll(1)) {
+        print_str("ERROR: auto-poll engine not found\r\n");
+        return 0;
+    }
+    test_blocking("blocking erase, auto-poll:");
+    test_background("background erase, interrupt:");
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
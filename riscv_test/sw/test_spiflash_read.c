@@ -0,0 +1,257 @@
+/*
+ * Test of bulk flash reads with and without the read FIFO.
+ *
+ * This program reads 64 kByte from flash memory in three ways:
+ *  - one capture command and one bus read per byte;
+ *  - read burst with 4 bytes per bus read;
+ *  - read burst, serviced in chunks from the read FIFO interrupt.
+ * For each case, it reports the total read time, the number of
+ * bus transactions to the SPI controller, and the CRC of the data.
+ *
+ * It then calibrates the MISO sample delay for several SPI clock
+ * frequencies and reports the read throughput at each setting.
+ * If the calibration pattern is missing from the flash, the program
+ * writes it to the last subsector of the flash test sector.
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_std.h"
+#include "rvlib_hardware.h"
+#include "rvlib_busmon.h"
+#include "rvlib_crc32.h"
+#include "rvlib_interrupt.h"
+#include "rvlib_spiflash.h"
+#include "rvlib_time.h"
+#include "rvlib_uart.h"
+
+
+/* Flash area to read (start of the golden bitstream). */
+#define TEST_ADDR       RVSYS_FLASH_GOLDEN_ADDR
+#define TEST_SIZE       65536
+
+/* Read FIFO interrupt threshold in bytes. */
+#define IRQ_THRESHOLD   256
+
+/* Set by the interrupt handler. */
+static volatile uint32_t irq_remaining;
+static volatile uint32_t irq_crc;
+static volatile uint32_t irq_count;
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+static void print_uint(unsigned int val)
+{
+    char msg[12];
+    char *p = msg + sizeof(msg) - 1;
+    *p = '\0';
+    do {
+        p--;
+        *p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    print_str(p);
+}
+
+
+static void print_hex32(uint32_t val)
+{
+    for (int i = 7; i >= 0; i--) {
+        rvlib_putchar("0123456789abcdef"[(val >> (4 * i)) & 15]);
+    }
+}
+
+
+void handle_external_interrupt(void)
+{
+    uint32_t buf[IRQ_THRESHOLD / 4];
+    size_t n = rvlib_spiflash_read_fetch((unsigned char *)buf, sizeof(buf));
+    irq_crc = rvlib_crc32(irq_crc, (unsigned char *)buf, n);
+    irq_remaining -= n;
+    irq_count++;
+}
+
+
+static void report(const char *name, uint64_t cycles, uint32_t crc)
+{
+    struct rvlib_busmon_counters ctr;
+    rvlib_busmon_enable(0);
+    rvlib_busmon_read(RVSYS_DEVBUS_SPIFLASH, &ctr);
+
+    print_str(name);
+    print_str("\r\n  time:              ");
+    print_uint(cycles / RVLIB_CPU_FREQ_MHZ);
+    print_str(" us, ");
+    print_uint((uint64_t)TEST_SIZE * RVLIB_CPU_FREQ_MHZ * 1000000
+               / cycles / 1024);
+    print_str(" kB/s\r\n");
+    if (rvlib_busmon_present()) {
+        print_str("  bus transactions:  ");
+        print_uint(ctr.reads + ctr.writes);
+        print_str("\r\n");
+    }
+    print_str("  CRC:               ");
+    print_hex32(crc);
+    print_str("\r\n");
+}
+
+
+/* Read via the blocking streaming API. */
+static void test_blocking(const char *name)
+{
+    uint32_t buf[64];
+    uint32_t crc = 0;
+
+    rvlib_busmon_reset();
+    uint64_t t0 = get_cycle_counter();
+    rvlib_spiflash_read_start(TEST_ADDR);
+    for (uint32_t p = 0; p < TEST_SIZE; p += sizeof(buf)) {
+        rvlib_spiflash_read_continue((unsigned char *)buf, sizeof(buf));
+        crc = rvlib_crc32(crc, (unsigned char *)buf, sizeof(buf));
+    }
+    rvlib_spiflash_read_end();
+    uint64_t t1 = get_cycle_counter();
+
+    report(name, t1 - t0, crc);
+}
+
+
+/* Read in the background and fetch data from the interrupt handler. */
+static void test_interrupt(const char *name)
+{
+    uint32_t idle_loops = 0;
+
+    irq_remaining = TEST_SIZE;
+    irq_crc = 0;
+    irq_count = 0;
+
+    rvlib_busmon_reset();
+    uint64_t t0 = get_cycle_counter();
+    rvlib_spiflash_read_start(TEST_ADDR);
+    rvlib_spiflash_read_request(TEST_SIZE);
+    rvlib_spiflash_enable_read_interrupt(IRQ_THRESHOLD);
+    rvlib_enable_external_interrupt(1);
+
+    // The CPU is free; this loop stands in for useful work.
+    while (irq_remaining > 0) {
+        idle_loops++;
+    }
+
+    rvlib_enable_external_interrupt(0);
+    rvlib_spiflash_enable_read_interrupt(0);
+    rvlib_spiflash_read_end();
+    uint64_t t1 = get_cycle_counter();
+
+    report(name, t1 - t0, irq_crc);
+    print_str("  interrupts:        ");
+    print_uint(irq_count);
+    print_str("\r\n  idle loops:        ");
+    print_uint(idle_loops);
+    print_str("\r\n");
+}
+
+
+/* Calibrate and measure read throughput for several SPI clock settings. */
+static void test_clock_settings(void)
+{
+    if (rvlib_spiflash_calibrate_program() != 0) {
+        print_str("\r\nERROR: can not program calibration pattern\r\n");
+        return;
+    }
+
+    print_str("\r\nthroughput per SPI clock setting:\r\n");
+
+    for (unsigned int half_period = 1; half_period <= 4; half_period++) {
+        unsigned int mask = rvlib_spiflash_calibrate(half_period);
+
+        print_str("  ");
+        print_uint(RVLIB_CPU_FREQ_MHZ * 1000 / (2 * half_period));
+        print_str(" kHz: working sample delays ");
+        for (int d = 0; d < 8; d++) {
+            rvlib_putchar((mask & (1U << d)) ? '0' + d : '-');
+        }
+
+        if (mask != 0) {
+            unsigned int hp, delay;
+            uint32_t buf[64];
+            rvlib_spiflash_get_clock(&hp, &delay);
+
+            uint64_t t0 = get_cycle_counter();
+            rvlib_spiflash_read_start(TEST_ADDR);
+            for (uint32_t p = 0; p < TEST_SIZE; p += sizeof(buf)) {
+                rvlib_spiflash_read_continue((unsigned char *)buf, sizeof(buf));
+            }
+            rvlib_spiflash_read_end();
+            uint64_t t1 = get_cycle_counter();
+
+            print_str(", using ");
+            print_uint(delay);
+            print_str(", ");
+            print_uint((uint64_t)TEST_SIZE * RVLIB_CPU_FREQ_MHZ * 1000000
+                       / (t1 - t0) / 1024);
+            print_str(" kB/s");
+        }
+        print_str("\r\n");
+    }
+
+    // Leave the fastest working setting selected (opt-in for this test).
+    rvlib_spiflash_calibrate(1);
+}
+
+
+int main(void)
+{
+    print_str("\r\nSPI flash read test\r\n\r\n");
+
+    rvlib_interrupt_init();
+    rvlib_interrupt_enable();
+    rvlib_spiflash_init();
+
+    rvlib_spiflash_use_read_fifo(0);
+    test_blocking("byte reads:");
+
+    unsigned int fifo_size = rvlib_spiflash_use_read_fifo(1);
+    if (fifo_size == 0) {
+        print_str("ERROR: read FIFO not found\r\n");
+        return 0;
+    }
+    unsigned int half_period, delay;
+    rvlib_spiflash_get_clock(&half_period, &delay);
+    print_str("read FIFO size: ");
+    print_uint(fifo_size);
+    print_str(" bytes\r\nSPI clock half-period: ");
+    print_uint(half_period);
+    print_str(", sample delay: ");
+    print_uint(delay);
+    print_str("\r\n");
+
+    test_blocking("burst, 4 bytes per bus read:");
+    test_interrupt("burst, interrupt-driven:");
+    test_clock_settings();
+
+    print_str("done\r\n");
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,99 @@
+/*
+ * Test program for the instruction trace buffer.
+ *
+ * This program records the instruction flow of a small workload
+ * and sends the trace records to the console. Decode the output
+ * with "tools/trace_decode":
+ *
+ *   trace_decode -s test_trace.elf < captured_output.txt
+ *
+ * This program is designed to be compiled in freestanding mode
+ * (without libc). It runs on a bare-metal RISC-V system,
+ * using rvlib to access system peripherals.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rvlib_uart.h"
+#include "rvlib_trace.h"
+
+
+#define SORT_SIZE       32
+
+static uint32_t sort_buf[SORT_SIZE];
+
+
+static void print_str(const char *msg)
+{
+    while (*msg != '\0') {
+        rvlib_putchar(*msg);
+        msg++;
+    }
+}
+
+
+/* Insertion sort (conditional branches and a hot inner loop). */
+static void __attribute__((noinline)) insertion_sort(uint32_t *buf, int n)
+{
+    for (int i = 1; i < n; i++) {
+        uint32_t v = buf[i];
+        int k = i;
+        while (k > 0 && buf[k-1] > v) {
+            buf[k] = buf[k-1];
+            k--;
+        }
+        buf[k] = v;
+    }
+}
+
+
+static uint32_t op_add(uint32_t a, uint32_t b) { return a + b; }
+static uint32_t op_xor(uint32_t a, uint32_t b) { return a ^ b; }
+static uint32_t op_max(uint32_t a, uint32_t b) { return (a > b) ? a : b; }
+
+/* Calls through a function pointer table (indirect jumps). */
+static uint32_t __attribute__((noinline)) dispatch(const uint32_t *buf, int n)
+{
+    static uint32_t (* const ops[3])(uint32_t, uint32_t) = {
+        op_add, op_xor, op_max };
+    uint32_t acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc = ops[buf[i] % 3](acc, buf[i]);
+    }
+    return acc;
+}
+
+
+int main(void)
+{
+    print_str("\r\nInstruction trace test\r\n");
+
+    uint32_t x = 12345;
+    for (int i = 0; i < SORT_SIZE; i++) {
+        x = x * 1103515245 + 12345;
+        sort_buf[i] = (x >> 16) & 0xff;
+    }
+
+    rvlib_trace_start(1);
+
+    insertion_sort(sort_buf, SORT_SIZE);
+    uint32_t check = dispatch(sort_buf, SORT_SIZE);
+
+    rvlib_trace_stop();
+
+    print_str(check != 0 ? "workload done\r\n" : "workload done (zero)\r\n");
+
+    rvlib_trace_dump();
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,372 @@
+/*
+ * Decoder for deferred-formatting log messages.
+ *
+ * This program reads console output of a RISC-V program that uses
+ * RVLIB_DLOG() (see "sw/rvlib_dlog.h"). It reconstructs the log messages
+ * from the format strings in the ELF file of the program, and passes
+ * all other output through unchanged.
+ *
+ * Usage: dlog_decode program.elf [inputfile]
+ *
+ * Input is read from stdin if no input file is specified.
+ * For example:
+ *   stty -F /dev/ttyUSB0 115200 raw
+ *   dlog_decode test_dlog.elf < /dev/ttyUSB0
+ * or, via the JTAG console:
+ *   jtagcon_bridge | dlog_decode test_dlog.elf
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+/* Must match the definitions in "rvlib_dlog.h". */
+static const unsigned int DLOG_MARKER = 0xf8;
+static const unsigned int DLOG_MAX_ARGS = 6;
+static const char DLOG_SECTION_NAME[] = ".rvlib_dlog_fmt";
+
+
+/* A section of the program image, used to look up "%s" arguments. */
+struct ImageSection {
+    uint32_t addr;
+    std::vector<unsigned char> data;
+};
+
+
+/* Format strings and program image extracted from the ELF file. */
+class ElfInfo
+{
+public:
+    std::vector<unsigned char> fmt_data;
+    std::vector<ImageSection> image;
+
+    bool load(const char *fname);
+
+    /* Return format string at the specified offset, or NULL. */
+    const char * get_format(uint32_t offset) const;
+
+    /* Return a string from the program image at the specified address. */
+    bool get_image_string(uint32_t addr, std::string& s) const;
+};
+
+
+static uint32_t get_u16(const std::vector<unsigned char>& buf, size_t pos)
+{
+    return buf[pos] | (buf[pos+1] << 8);
+}
+
+
+static uint32_t get_u32(const std::vector<unsigned char>& buf, size_t pos)
+{
+    return buf[pos] | (buf[pos+1] << 8) | (buf[pos+2] << 16)
+           | ((uint32_t)buf[pos+3] << 24);
+}
+
+
+bool ElfInfo::load(const char *fname)
+{
+    const uint32_t SHT_PROGBITS = 1;
+    const uint32_t SHF_ALLOC = 2;
+
+    FILE *f = fopen(fname, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", fname, strerror(errno));
+        return false;
+    }
+    std::vector<unsigned char> elf;
+    unsigned char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        elf.insert(elf.end(), buf, buf + n);
+    }
+    fclose(f);
+
+    // Check for 32-bit little-endian ELF file.
+    if (elf.size() < 52 || memcmp(elf.data(), "\x7f" "ELF", 4) != 0
+            || elf[4] != 1 || elf[5] != 1) {
+        fprintf(stderr, "ERROR: %s is not a 32-bit little-endian ELF file\n", fname);
+        return false;
+    }
+
+    uint32_t shoff = get_u32(elf, 32);
+    uint32_t shentsize = get_u16(elf, 46);
+    uint32_t shnum = get_u16(elf, 48);
+    uint32_t shstrndx = get_u16(elf, 50);
+    if (shentsize < 40 || shstrndx >= shnum
+            || shoff + (uint64_t)shnum * shentsize > elf.size()) {
+        fprintf(stderr, "ERROR: invalid section table in %s\n", fname);
+        return false;
+    }
+
+    uint32_t strtab_off = get_u32(elf, shoff + shstrndx * shentsize + 16);
+    uint32_t strtab_size = get_u32(elf, shoff + shstrndx * shentsize + 20);
+    if (strtab_off + (uint64_t)strtab_size > elf.size()) {
+        fprintf(stderr, "ERROR: invalid string table in %s\n", fname);
+        return false;
+    }
+
+    bool found = false;
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t sh = shoff + i * shentsize;
+        uint32_t name = get_u32(elf, sh);
+        uint32_t type = get_u32(elf, sh + 4);
+        uint32_t flags = get_u32(elf, sh + 8);
+        uint32_t addr = get_u32(elf, sh + 12);
+        uint32_t offset = get_u32(elf, sh + 16);
+        uint32_t size = get_u32(elf, sh + 20);
+
+        if (name >= strtab_size || type != SHT_PROGBITS
+                || offset + (uint64_t)size > elf.size()) {
+            continue;
+        }
+
+        std::string secname((const char *)elf.data() + strtab_off + name,
+                            strnlen((const char *)elf.data() + strtab_off + name,
+                                    strtab_size - name));
+
+        if (secname == DLOG_SECTION_NAME) {
+            fmt_data.assign(elf.begin() + offset, elf.begin() + offset + size);
+            found = true;
+        } else if ((flags & SHF_ALLOC) != 0) {
+            ImageSection sec;
+            sec.addr = addr;
+            sec.data.assign(elf.begin() + offset, elf.begin() + offset + size);
+            image.push_back(sec);
+        }
+    }
+
+    if (!found) {
+        fprintf(stderr, "WARNING: no section %s in %s\n", DLOG_SECTION_NAME, fname);
+    }
+    return true;
+}
+
+
+const char * ElfInfo::get_format(uint32_t offset) const
+{
+    if (offset >= fmt_data.size()) {
+        return NULL;
+    }
+    // Check that the string is terminated within the section.
+    if (memchr(fmt_data.data() + offset, 0, fmt_data.size() - offset) == NULL) {
+        return NULL;
+    }
+    return (const char *)fmt_data.data() + offset;
+}
+
+
+bool ElfInfo::get_image_string(uint32_t addr, std::string& s) const
+{
+    for (const ImageSection& sec : image) {
+        if (addr >= sec.addr && addr - sec.addr < sec.data.size()) {
+            size_t p = addr - sec.addr;
+            const void *end = memchr(sec.data.data() + p, 0, sec.data.size() - p);
+            if (end == NULL) {
+                return false;
+            }
+            s.assign((const char *)sec.data.data() + p, (const char *)end);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/* Format a log message. */
+static std::string format_message(const ElfInfo& elf,
+                                  const char *fmt,
+                                  const std::vector<uint32_t>& args)
+{
+    std::string out;
+    size_t argp = 0;
+    char buf[256];
+
+    while (*fmt != '\0') {
+        if (*fmt != '%') {
+            out += *fmt;
+            fmt++;
+            continue;
+        }
+
+        // Parse conversion specification.
+        std::string spec = "%";
+        fmt++;
+        while (*fmt != '\0' && strchr("-+ #0", *fmt) != NULL) {
+            spec += *fmt;
+            fmt++;
+        }
+        if (*fmt == '*') {
+            int w = (argp < args.size()) ? (int32_t)args[argp++] : 0;
+            spec += std::to_string(w);
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            spec += *fmt;
+            fmt++;
+        }
+        if (*fmt == '.') {
+            spec += *fmt;
+            fmt++;
+            if (*fmt == '*') {
+                int p = (argp < args.size()) ? (int32_t)args[argp++] : 0;
+                spec += std::to_string(p);
+                fmt++;
+            }
+            while (*fmt >= '0' && *fmt <= '9') {
+                spec += *fmt;
+                fmt++;
+            }
+        }
+        // Ignore length modifiers; all arguments are 32-bit words.
+        while (*fmt != '\0' && strchr("hljztL", *fmt) != NULL) {
+            fmt++;
+        }
+
+        char conv = *fmt;
+        if (conv == '\0') {
+            break;
+        }
+        fmt++;
+
+        if (conv == '%') {
+            out += '%';
+            continue;
+        }
+
+        uint32_t v = 0;
+        if (argp < args.size()) {
+            v = args[argp];
+        } else {
+            out += "<missing argument>";
+            continue;
+        }
+        argp++;
+
+        spec += conv;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                snprintf(buf, sizeof(buf), spec.c_str(), (int)(int32_t)v);
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                snprintf(buf, sizeof(buf), spec.c_str(), (unsigned int)v);
+                break;
+            case 'c':
+                snprintf(buf, sizeof(buf), spec.c_str(), (int)(v & 0xff));
+                break;
+            case 'p':
+                snprintf(buf, sizeof(buf), "0x%08x", (unsigned int)v);
+                break;
+            case 's': {
+                std::string s;
+                if (!elf.get_image_string(v, s)) {
+                    snprintf(buf, sizeof(buf), "<string at 0x%08x>", (unsigned int)v);
+                } else {
+                    snprintf(buf, sizeof(buf), spec.c_str(), s.c_str());
+                }
+                break;
+            }
+            default:
+                snprintf(buf, sizeof(buf), "<%%%c unsupported>", conv);
+                break;
+        }
+        out += buf;
+    }
+
+    return out;
+}
+
+
+/* Read an unsigned LEB128 number. Return false at end of input. */
+static bool read_varint(FILE *f, uint32_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) {
+            return false;
+        }
+        v |= (uint32_t)(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: dlog_decode program.elf [inputfile]\n");
+        return 1;
+    }
+
+    ElfInfo elf;
+    if (!elf.load(argv[1])) {
+        return 1;
+    }
+
+    FILE *inp = stdin;
+    if (argc > 2) {
+        inp = fopen(argv[2], "rb");
+        if (inp == NULL) {
+            fprintf(stderr, "ERROR: can not open %s (%s)\n", argv[2], strerror(errno));
+            return 1;
+        }
+    }
+
+    while (true) {
+        int c = fgetc(inp);
+        if (c == EOF) {
+            break;
+        }
+
+        if ((unsigned int)c < DLOG_MARKER
+                || (unsigned int)c > DLOG_MARKER + DLOG_MAX_ARGS) {
+            // Pass through normal output.
+            putchar(c);
+            if (c == '\n') {
+                fflush(stdout);
+            }
+            continue;
+        }
+
+        // Decode log record.
+        unsigned int nargs = c - DLOG_MARKER;
+        uint32_t fmt_id;
+        std::vector<uint32_t> args(nargs);
+        bool ok = read_varint(inp, fmt_id);
+        for (unsigned int i = 0; ok && i < nargs; i++) {
+            ok = read_varint(inp, args[i]);
+        }
+        if (!ok) {
+            break;
+        }
+
+        const char *fmt = elf.get_format(fmt_id);
+        if (fmt == NULL) {
+            printf("<dlog: unknown format id %u>\n", (unsigned int)fmt_id);
+        } else {
+            fputs(format_message(elf, fmt, args).c_str(), stdout);
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,601 @@
+/*
+ * Send an FPGA update bitstream to the boot monitor via the serial port.
+ *
+ * This program runs the "fpga update" command of the boot monitor,
+ * streams the bitstream file in chunks as requested by the boot monitor,
+ * and reports the total update time. Optionally it then reboots
+ * the FPGA into the new image.
+ *
+ * With "-s", the program runs the "fpga sync" command instead. The boot
+ * monitor reports a CRC-32 for each 4 kByte block of the image currently
+ * in flash, and only blocks that differ from the new image are sent.
+ * This only helps with uncompressed bitstreams; the program warns if
+ * the image is compressed.
+ *
+ * With "-c old.bin", the program does not talk to the boot monitor.
+ * It reports how many 4 kByte blocks "fpga sync" would send to replace
+ * "old.bin" by the new image.
+ *
+ * The program signs the image with HMAC-SHA256 using the binary key in
+ * the key file given with "-k". The key must match the key built into
+ * the boot monitor (sw/bootmon.key, generated by the Makefile in sw/).
+ * The boot monitor rejects update images without a valid tag.
+ *
+ * The bitstream file must be a raw binary file (".bin") as produced by
+ * "write_bitstream -bin_file" in Vivado.
+ *
+ * Usage: fpga_update [-b] [-s] -k keyfile /dev/ttyUSBn image.bin
+ *        fpga_update -c old.bin image.bin
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+/* Chunk size used by the boot monitor. */
+static const size_t UPDATE_CHUNK_SIZE = 4096;
+
+/* Give up if the boot monitor is silent for this long. */
+static const int RECV_TIMEOUT_MS = 30000;
+
+
+/* Calculate standard CRC-32 (same as rvlib_crc32). */
+static uint32_t crc32(const unsigned char *data, size_t len)
+{
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        }
+    }
+    return ~crc;
+}
+
+
+/* SHA-256 round constants. */
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+
+static inline uint32_t rotr(uint32_t x, unsigned int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+
+/* Calculate SHA-256 (same as rvlib_sha256). */
+static std::vector<unsigned char> sha256(const std::vector<unsigned char>& data)
+{
+    uint32_t h[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    // Append padding and message length in bits.
+    std::vector<unsigned char> msg(data);
+    uint64_t nbits = (uint64_t)data.size() * 8;
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    for (int i = 7; i >= 0; i--) {
+        msg.push_back((unsigned char)(nbits >> (8 * i)));
+    }
+
+    for (size_t pos = 0; pos < msg.size(); pos += 64) {
+        uint32_t w[64];
+        for (int t = 0; t < 16; t++) {
+            const unsigned char *p = msg.data() + pos + 4 * t;
+            w[t] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+                   | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = rotr(w[t-15], 7) ^ rotr(w[t-15], 18) ^ (w[t-15] >> 3);
+            uint32_t s1 = rotr(w[t-2], 17) ^ rotr(w[t-2], 19) ^ (w[t-2] >> 10);
+            w[t] = w[t-16] + s0 + w[t-7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+        uint32_t e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int t = 0; t < 64; t++) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25))
+                          + ((e & f) ^ (~e & g)) + sha256_k[t] + w[t];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22))
+                          + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    std::vector<unsigned char> digest;
+    for (int i = 0; i < 8; i++) {
+        for (int k = 3; k >= 0; k--) {
+            digest.push_back((unsigned char)(h[i] >> (8 * k)));
+        }
+    }
+    return digest;
+}
+
+
+/* Calculate HMAC-SHA256 (same as rvlib_hmac_sha256). */
+static std::vector<unsigned char> hmac_sha256(
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> k = (key.size() > 64) ? sha256(key) : key;
+    k.resize(64, 0);
+
+    std::vector<unsigned char> inner(64), outer(64);
+    for (int i = 0; i < 64; i++) {
+        inner[i] = k[i] ^ 0x36;
+        outer[i] = k[i] ^ 0x5c;
+    }
+    inner.insert(inner.end(), data.begin(), data.end());
+    std::vector<unsigned char> inner_digest = sha256(inner);
+    outer.insert(outer.end(), inner_digest.begin(), inner_digest.end());
+    return sha256(outer);
+}
+
+
+static bool read_file(const char *fname, std::vector<unsigned char>& data)
+{
+    FILE *f = fopen(fname, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", fname, strerror(errno));
+        return false;
+    }
+    unsigned char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "ERROR: can not read %s\n", fname);
+    }
+    return ok;
+}
+
+
+static int open_serial(const char *devname)
+{
+    int fd = open(devname, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", devname, strerror(errno));
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        perror("ERROR: tcgetattr");
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        perror("ERROR: tcsetattr");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+static bool write_all(int fd, const unsigned char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("ERROR: write");
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+
+static bool write_str(int fd, const std::string& s)
+{
+    return write_all(fd, (const unsigned char *)s.data(), s.size());
+}
+
+
+/* Read one byte from the serial port with timeout. Return -1 on failure. */
+static int read_byte(int fd)
+{
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, RECV_TIMEOUT_MS);
+    if (ret <= 0) {
+        fprintf(stderr, "\nERROR: timeout waiting for boot monitor\n");
+        return -1;
+    }
+    unsigned char c;
+    if (read(fd, &c, 1) != 1) {
+        perror("\nERROR: read");
+        return -1;
+    }
+    return c;
+}
+
+
+/*
+ * Follow boot monitor output until a line "OK" or "ERROR...".
+ * Send image chunks when requested.
+ */
+static bool run_update(int fd, const std::vector<unsigned char>& image)
+{
+    std::string line;
+    bool sending = false;
+    size_t pos = 0;
+
+    while (true) {
+        int c = read_byte(fd);
+        if (c < 0) {
+            return false;
+        }
+
+        if (sending && c == '+') {
+            // Boot monitor requests the next chunk.
+            size_t n = std::min(UPDATE_CHUNK_SIZE, image.size() - pos);
+            if (!write_all(fd, image.data() + pos, n)) {
+                return false;
+            }
+            pos += n;
+            fprintf(stderr, "\r%zu / %zu bytes", pos, image.size());
+            continue;
+        }
+
+        if (c == '\n') {
+            if (line == "Send data") {
+                sending = true;
+            }
+            if (line == "OK") {
+                return true;
+            }
+            if (line.compare(0, 5, "ERROR") == 0) {
+                return false;
+            }
+            line.clear();
+        } else if (c != '\r') {
+            line += (char)c;
+        }
+        putchar(c);
+        fflush(stdout);
+    }
+}
+
+
+/*
+ * Return true if the bitstream uses compression.
+ * A compressed bitstream writes identical frames via the multi-frame
+ * write register (MFWR, register address 01010). Walk the configuration
+ * packets after the sync word and look for a write to that register.
+ */
+static bool is_compressed_bitstream(const std::vector<unsigned char>& image)
+{
+    auto word_at = [&image](size_t p) {
+        return ((uint32_t)image[p] << 24) | ((uint32_t)image[p+1] << 16)
+               | ((uint32_t)image[p+2] << 8) | image[p+3];
+    };
+
+    // Find the sync word.
+    size_t p = 0;
+    while (p + 4 <= image.size() && word_at(p) != 0xaa995566) {
+        p++;
+    }
+    p += 4;
+
+    while (p + 4 <= image.size()) {
+        uint32_t w = word_at(p);
+        p += 4;
+        if ((w >> 29) == 1) {
+            // Type 1 packet: opcode, register address, word count.
+            if (((w >> 27) & 3) == 2 && ((w >> 13) & 0x1f) == 0x0a) {
+                return true;
+            }
+            p += 4 * (size_t)(w & 0x7ff);
+        } else if ((w >> 29) == 2) {
+            // Type 2 packet: large word count for the preceding register.
+            p += 4 * (size_t)(w & 0x7ffffff);
+        } else {
+            break;
+        }
+    }
+    return false;
+}
+
+
+/* Report how many blocks "fpga sync" would send to replace "old_image". */
+static void compare_images(const std::vector<unsigned char>& old_image,
+                           const std::vector<unsigned char>& image)
+{
+    size_t nblocks = (image.size() + UPDATE_CHUNK_SIZE - 1) / UPDATE_CHUNK_SIZE;
+    size_t ndiff = 0;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t pos = blk * UPDATE_CHUNK_SIZE;
+        size_t n = std::min(UPDATE_CHUNK_SIZE, image.size() - pos);
+        if (pos + n > old_image.size()
+            || memcmp(image.data() + pos, old_image.data() + pos, n) != 0) {
+            ndiff++;
+        }
+    }
+    printf("%zu of %zu blocks differ: sync sends %zu kByte, update sends %zu kByte\n",
+           ndiff, nblocks, ndiff * UPDATE_CHUNK_SIZE / 1024,
+           nblocks * UPDATE_CHUNK_SIZE / 1024);
+}
+
+
+/* Send a 32-bit little-endian word. */
+static bool write_word(int fd, uint32_t v)
+{
+    unsigned char buf[4] = {
+        (unsigned char)v, (unsigned char)(v >> 8),
+        (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    return write_all(fd, buf, 4);
+}
+
+
+/*
+ * Follow boot monitor output of the "fpga sync" command.
+ * Collect the block CRCs, then send the blocks that differ.
+ */
+static bool run_sync(int fd, const std::vector<unsigned char>& image)
+{
+    std::string line;
+    std::vector<uint32_t> flash_crcs;
+    std::vector<uint32_t> todo;
+    size_t nblocks = 0;
+    bool collecting = false;
+    bool sending = false;
+    size_t next = 0;
+
+    while (true) {
+        int c = read_byte(fd);
+        if (c < 0) {
+            return false;
+        }
+
+        if (sending && c == '+') {
+            // Boot monitor requests the next block.
+            if (next == todo.size()) {
+                if (!write_word(fd, 0xffffffff)) {
+                    return false;
+                }
+                continue;
+            }
+            uint32_t blk = todo[next++];
+            size_t pos = blk * UPDATE_CHUNK_SIZE;
+            size_t n = std::min(UPDATE_CHUNK_SIZE, image.size() - pos);
+            if (!write_word(fd, blk) || !write_all(fd, image.data() + pos, n)) {
+                return false;
+            }
+            fprintf(stderr, "\r%zu / %zu blocks", next, todo.size());
+            continue;
+        }
+
+        if (c == '\n') {
+            bool echoed = !collecting;
+            if (line == "Send blocks") {
+                collecting = false;
+                if (flash_crcs.size() != nblocks) {
+                    fprintf(stderr, "\nERROR: got %zu block CRCs, expected %zu\n",
+                            flash_crcs.size(), nblocks);
+                    return false;
+                }
+                for (size_t blk = 0; blk < nblocks; blk++) {
+                    size_t pos = blk * UPDATE_CHUNK_SIZE;
+                    size_t n = std::min(UPDATE_CHUNK_SIZE, image.size() - pos);
+                    if (crc32(image.data() + pos, n) != flash_crcs[blk]) {
+                        todo.push_back(blk);
+                    }
+                }
+                fprintf(stderr, "%zu of %zu blocks differ\n", todo.size(), nblocks);
+                sending = true;
+            } else if (collecting) {
+                // Parse a line of block CRCs.
+                const char *p = line.c_str();
+                char *endp;
+                while (flash_crcs.size() < nblocks) {
+                    unsigned long v = strtoul(p, &endp, 16);
+                    if (endp == p) {
+                        break;
+                    }
+                    flash_crcs.push_back(v);
+                    p = endp;
+                }
+            } else if (line.compare(0, 11, "Block CRCs ") == 0) {
+                nblocks = strtoul(line.c_str() + 11, NULL, 10);
+                collecting = true;
+            }
+            if (line == "OK") {
+                return true;
+            }
+            if (line.compare(0, 5, "ERROR") == 0) {
+                return false;
+            }
+            line.clear();
+            if (echoed) {
+                putchar(c);
+                fflush(stdout);
+            }
+            continue;
+        }
+
+        if (c != '\r') {
+            line += (char)c;
+        }
+        if (!collecting) {
+            putchar(c);
+            fflush(stdout);
+        }
+    }
+}
+
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: fpga_update [-b] [-s] -k keyfile /dev/ttyUSBn image.bin\n"
+        "       fpga_update -c old.bin image.bin\n"
+        "\n"
+        "  -b   reboot the FPGA into the new image after updating\n"
+        "  -s   send only 4 kByte blocks that differ from the image in flash\n"
+        "  -k   sign the image with HMAC-SHA256 using the key in keyfile\n"
+        "  -c   only report how many blocks differ from old.bin\n"
+        "\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    bool do_boot = false;
+    bool do_sync = false;
+    const char *keyfile = NULL;
+    const char *old_file = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "bsk:c:h")) != -1) {
+        switch (opt) {
+            case 'b': do_boot = true; break;
+            case 's': do_sync = true; break;
+            case 'k': keyfile = optarg; break;
+            case 'c': old_file = optarg; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if (old_file != NULL) {
+        if (argc - optind != 1) {
+            usage();
+            return 1;
+        }
+        std::vector<unsigned char> old_image, image;
+        if (!read_file(old_file, old_image) || !read_file(argv[optind], image)) {
+            return 1;
+        }
+        compare_images(old_image, image);
+        return 0;
+    }
+
+    if (argc - optind != 2 || keyfile == NULL) {
+        usage();
+        return 1;
+    }
+
+    std::vector<unsigned char> image;
+    if (!read_file(argv[optind + 1], image)) {
+        return 1;
+    }
+    uint32_t crc = crc32(image.data(), image.size());
+    fprintf(stderr, "Image: %zu bytes, CRC 0x%08x\n", image.size(), crc);
+    if (do_sync && is_compressed_bitstream(image)) {
+        fprintf(stderr,
+                "WARNING: compressed bitstream, most blocks will differ.\n"
+                "         Use an uncompressed update image"
+                " (vivado/write_update_bitstream.tcl).\n");
+    }
+
+    // Calculate the authentication tag.
+    std::vector<unsigned char> key;
+    if (!read_file(keyfile, key)) {
+        return 1;
+    }
+    if (key.empty()) {
+        fprintf(stderr, "ERROR: empty key file\n");
+        return 1;
+    }
+    std::string tag;
+    std::vector<unsigned char> mac = hmac_sha256(key, image);
+    for (unsigned char b : mac) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", b);
+        tag += hex;
+    }
+    fprintf(stderr, "Tag:   %s\n", tag.c_str());
+
+    int fd = open_serial(argv[optind]);
+    if (fd < 0) {
+        return 1;
+    }
+
+    // Clear any partial command and discard old output.
+    write_str(fd, "\r");
+    usleep(200000);
+    tcflush(fd, TCIFLUSH);
+
+    auto t_start = std::chrono::steady_clock::now();
+
+    char cmd[160];
+    snprintf(cmd, sizeof(cmd), "fpga %s %zu 0x%08x %s\r",
+             do_sync ? "sync" : "update", image.size(), crc, tag.c_str());
+    bool ok = write_str(fd, cmd);
+    if (ok) {
+        ok = do_sync ? run_sync(fd, image) : run_update(fd, image);
+    }
+    if (!ok) {
+        fprintf(stderr, "\nUpdate FAILED\n");
+        close(fd);
+        return 1;
+    }
+
+    double dt = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t_start).count();
+    fprintf(stderr, "\nUpdate completed in %.1f seconds\n", dt);
+
+    if (do_boot) {
+        write_str(fd, "fpga boot update\r");
+        usleep(500000);
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Receive profile data from a RISC-V program and write ".gcda" files.
+ *
+ * This program reads console output of a RISC-V program that was built
+ * with "make PGO=generate" and calls rvlib_gcov_dump() (see
+ * "sw/rvlib_gcov.h"). It writes the profile data of each object file
+ * to the ".gcda" file named by the compiler, and passes all other
+ * output through unchanged.
+ *
+ * Usage: gcov_recv [-d dir] [inputfile]
+ *
+ *   -d dir   write all ".gcda" files to this directory instead of
+ *            the path recorded by the compiler
+ *
+ * Input is read from stdin if no input file is specified.
+ * For example:
+ *   stty -F /dev/ttyUSB0 115200 raw
+ *   gcov_recv < /dev/ttyUSB0
+ * or, via the JTAG console:
+ *   jtagcon_bridge | gcov_recv
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+
+static int hexval(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else {
+        return -1;
+    }
+}
+
+
+/* Read one line without line terminator. Return false at end of input. */
+static bool read_line(FILE *f, std::string& line)
+{
+    line.clear();
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') {
+            return true;
+        }
+        if (c != '\r') {
+            line += (char)c;
+        }
+    }
+    return !line.empty();
+}
+
+
+/* Decode hex data and append it to the buffer. */
+static bool decode_hex(const std::string& line, std::vector<unsigned char>& data)
+{
+    if (line.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < line.size(); i += 2) {
+        int h1 = hexval(line[i]);
+        int h2 = hexval(line[i+1]);
+        if (h1 < 0 || h2 < 0) {
+            return false;
+        }
+        data.push_back((h1 << 4) | h2);
+    }
+    return true;
+}
+
+
+static bool write_file(const std::string& fname,
+                       const std::vector<unsigned char>& data)
+{
+    FILE *f = fopen(fname.c_str(), "wb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not create %s (%s)\n",
+                fname.c_str(), strerror(errno));
+        return false;
+    }
+    bool ok = (fwrite(data.data(), 1, data.size(), f) == data.size());
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "ERROR: can not write %s\n", fname.c_str());
+    }
+    return ok;
+}
+
+
+/*
+ * Receive the data of one ".gcda" file after a "GCDA" header line.
+ * Return false if the data is incomplete or invalid.
+ */
+static bool receive_gcda(FILE *inp,
+                         size_t expect_size,
+                         std::vector<unsigned char>& data)
+{
+    std::string line;
+    while (read_line(inp, line)) {
+        if (line == "GCDA END") {
+            if (data.size() != expect_size) {
+                fprintf(stderr, "ERROR: expected %zu bytes, got %zu\n",
+                        expect_size, data.size());
+                return false;
+            }
+            return true;
+        }
+        if (!decode_hex(line, data)) {
+            fprintf(stderr, "ERROR: invalid data line '%s'\n", line.c_str());
+            return false;
+        }
+    }
+    fprintf(stderr, "ERROR: unexpected end of input\n");
+    return false;
+}
+
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: gcov_recv [-d dir] [inputfile]\n"
+        "\n"
+        "  -d dir   write .gcda files to this directory\n"
+        "\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string outdir;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:h")) != -1) {
+        switch (opt) {
+            case 'd': outdir = optarg; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (argc - optind > 1) {
+        usage();
+        return 1;
+    }
+
+    FILE *inp = stdin;
+    if (optind < argc) {
+        inp = fopen(argv[optind], "rb");
+        if (inp == NULL) {
+            fprintf(stderr, "ERROR: can not open %s (%s)\n",
+                    argv[optind], strerror(errno));
+            return 1;
+        }
+    }
+
+    int nfiles = 0;
+    int nerrors = 0;
+    std::string line;
+
+    while (read_line(inp, line)) {
+
+        if (line.compare(0, 5, "GCDA ") != 0) {
+            // Pass through normal output.
+            puts(line.c_str());
+            fflush(stdout);
+            continue;
+        }
+
+        // Parse "GCDA <filename> <size>".
+        size_t p = line.rfind(' ');
+        std::string fname = line.substr(5, p - 5);
+        char *endp;
+        unsigned long size = strtoul(line.c_str() + p + 1, &endp, 10);
+        if (p <= 5 || *endp != '\0') {
+            fprintf(stderr, "ERROR: invalid header '%s'\n", line.c_str());
+            nerrors++;
+            continue;
+        }
+
+        std::vector<unsigned char> data;
+        if (!receive_gcda(inp, size, data)) {
+            nerrors++;
+            continue;
+        }
+
+        if (!outdir.empty()) {
+            size_t q = fname.rfind('/');
+            if (q != std::string::npos) {
+                fname = fname.substr(q + 1);
+            }
+            fname = outdir + "/" + fname;
+        }
+
+        if (write_file(fname, data)) {
+            fprintf(stderr, "Wrote %s (%zu bytes)\n", fname.c_str(), data.size());
+            nfiles++;
+        } else {
+            nerrors++;
+        }
+    }
+
+    fprintf(stderr, "%d profile files written, %d errors\n", nfiles, nerrors);
+    return (nerrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,389 @@
+/*
+ * Host side bridge for the JTAG console channel.
+ *
+ * This program connects to the TCL server port of OpenOCD and
+ * repeatedly runs console transfer operations on the JTAG data register
+ * of the RISC-V system. Data received from the JTAG console is written
+ * to stdout. Data read from stdin is sent to the JTAG console.
+ *
+ * OpenOCD must be running with the configuration from
+ * "riscv_test/vexriscv/openocd.cfg". Remote debugging with GDB
+ * can continue while the bridge is running.
+ *
+ * Usage: jtagcon_bridge [-H host] [-p port] [-t tapname] [-s]
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+/* JTAG instruction code of the USER1 register on Spartan-7. */
+static const unsigned int JTAG_IR_USER1 = 0x02;
+
+/* Console transfer header and data register layout. */
+static const unsigned int CONSOLE_HEADER = 0x2;
+static const unsigned int CONSOLE_DATA_BITS = 142;
+static const unsigned int CONSOLE_MAX_BYTES = 16;
+
+static volatile sig_atomic_t stop_flag = 0;
+
+
+static void handle_signal(int)
+{
+    stop_flag = 1;
+}
+
+
+/* Connection to the TCL server of OpenOCD. */
+class OpenOcdTcl
+{
+public:
+    OpenOcdTcl() : m_fd(-1) { }
+
+    ~OpenOcdTcl()
+    {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    /* Connect to OpenOCD. Return true if successful. */
+    bool connect_to(const std::string& host, const std::string& port)
+    {
+        struct addrinfo hints;
+        struct addrinfo *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        int ret = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+        if (ret != 0) {
+            fprintf(stderr, "ERROR: can not resolve %s (%s)\n",
+                    host.c_str(), gai_strerror(ret));
+            return false;
+        }
+        for (struct addrinfo *p = res; p != NULL; p = p->ai_next) {
+            m_fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+            if (m_fd < 0) {
+                continue;
+            }
+            if (connect(m_fd, p->ai_addr, p->ai_addrlen) == 0) {
+                break;
+            }
+            close(m_fd);
+            m_fd = -1;
+        }
+        freeaddrinfo(res);
+        if (m_fd < 0) {
+            fprintf(stderr, "ERROR: can not connect to %s:%s\n",
+                    host.c_str(), port.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /* Run a TCL command and return its result. */
+    bool command(const std::string& cmd, std::string& result)
+    {
+        std::string msg = cmd + '\x1a';
+        size_t p = 0;
+        while (p < msg.size()) {
+            ssize_t n = send(m_fd, msg.data() + p, msg.size() - p, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("ERROR: send");
+                return false;
+            }
+            p += n;
+        }
+
+        result.clear();
+        while (true) {
+            char buf[256];
+            ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("ERROR: recv");
+                return false;
+            }
+            if (n == 0) {
+                fprintf(stderr, "ERROR: OpenOCD closed the connection\n");
+                return false;
+            }
+            result.append(buf, n);
+            if (buf[n-1] == '\x1a') {
+                result.resize(result.size() - 1);
+                return true;
+            }
+        }
+    }
+
+private:
+    int m_fd;
+};
+
+
+/* Format a bit vector as hexadecimal string, MSB first. */
+static std::string bits_to_hex(const std::vector<bool>& bits)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    std::string s = "0x";
+    size_t ndigits = (bits.size() + 3) / 4;
+    for (size_t i = ndigits; i > 0; i--) {
+        unsigned int d = 0;
+        for (unsigned int k = 0; k < 4; k++) {
+            size_t b = 4 * (i - 1) + k;
+            if (b < bits.size() && bits[b]) {
+                d |= (1 << k);
+            }
+        }
+        s += hexdigits[d];
+    }
+    return s;
+}
+
+
+/* Parse a hexadecimal string (MSB first) into a bit vector. */
+static bool hex_to_bits(const std::string& s, std::vector<bool>& bits)
+{
+    size_t ndigits = s.size();
+    bits.assign(4 * ndigits, false);
+    for (size_t i = 0; i < ndigits; i++) {
+        char c = s[ndigits - 1 - i];
+        unsigned int d;
+        if (c >= '0' && c <= '9') {
+            d = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            d = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            d = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        for (unsigned int k = 0; k < 4; k++) {
+            bits[4 * i + k] = (d >> k) & 1;
+        }
+    }
+    return true;
+}
+
+
+static unsigned int get_bits(const std::vector<bool>& bits,
+                             size_t pos,
+                             unsigned int nbits)
+{
+    unsigned int v = 0;
+    for (unsigned int k = 0; k < nbits; k++) {
+        if (pos + k < bits.size() && bits[pos + k]) {
+            v |= (1U << k);
+        }
+    }
+    return v;
+}
+
+
+static void put_bits(std::vector<bool>& bits,
+                     size_t pos,
+                     unsigned int nbits,
+                     unsigned int v)
+{
+    for (unsigned int k = 0; k < nbits; k++) {
+        bits[pos + k] = (v >> k) & 1;
+    }
+}
+
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: jtagcon_bridge [-H host] [-p port] [-t tapname] [-s]\n"
+        "\n"
+        "  -H host     OpenOCD host (default localhost)\n"
+        "  -p port     OpenOCD TCL server port (default 6666)\n"
+        "  -t tapname  JTAG TAP name (default xc7s25.fpga)\n"
+        "  -s          print throughput statistics every 5 seconds\n"
+        "\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string host = "localhost";
+    std::string port = "6666";
+    std::string tapname = "xc7s25.fpga";
+    bool show_stats = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:t:sh")) != -1) {
+        switch (opt) {
+            case 'H': host = optarg; break;
+            case 'p': port = optarg; break;
+            case 't': tapname = optarg; break;
+            case 's': show_stats = true; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    OpenOcdTcl ocd;
+    if (!ocd.connect_to(host, port)) {
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    char irscan_cmd[80];
+    snprintf(irscan_cmd, sizeof(irscan_cmd), "irscan %s 0x%02x; ",
+             tapname.c_str(), JTAG_IR_USER1);
+
+    std::deque<unsigned char> txqueue;
+    bool stdin_open = true;
+
+    // Remaining number of bytes that the RISC-V can accept.
+    int budget = 0;
+    // Bytes sent since the last valid status report was taken.
+    int sent_since_report = 0;
+
+    uint64_t total_rx = 0, total_tx = 0, total_ops = 0;
+    uint64_t stat_rx = 0, stat_tx = 0, stat_ops = 0;
+    auto t_start = std::chrono::steady_clock::now();
+    auto t_stat = t_start;
+
+    while (!stop_flag) {
+
+        // Read available data from stdin.
+        if (stdin_open && txqueue.size() < 4096) {
+            struct pollfd pfd;
+            pfd.fd = STDIN_FILENO;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, 0) > 0) {
+                unsigned char buf[1024];
+                ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+                if (n > 0) {
+                    txqueue.insert(txqueue.end(), buf, buf + n);
+                } else if (n == 0) {
+                    stdin_open = false;
+                }
+            }
+        }
+
+        // Prepare console transfer.
+        unsigned int nsend = CONSOLE_MAX_BYTES;
+        if ((int)nsend > budget) {
+            nsend = (budget > 0) ? budget : 0;
+        }
+        if (nsend > txqueue.size()) {
+            nsend = txqueue.size();
+        }
+
+        std::vector<bool> tdi(CONSOLE_DATA_BITS, false);
+        put_bits(tdi, 0, 5, nsend);
+        for (unsigned int i = 0; i < nsend; i++) {
+            put_bits(tdi, 5 + 8 * i, 8, txqueue[i]);
+        }
+
+        std::string cmd = irscan_cmd;
+        cmd += "drscan " + tapname + " 2 " + std::to_string(CONSOLE_HEADER) +
+               " " + std::to_string(CONSOLE_DATA_BITS) + " " + bits_to_hex(tdi);
+
+        std::string result;
+        if (!ocd.command(cmd, result)) {
+            return 1;
+        }
+
+        // The result contains two hex strings, one per field.
+        size_t sep = result.find_last_of(' ');
+        std::vector<bool> tdo;
+        if (sep == std::string::npos ||
+                !hex_to_bits(result.substr(sep + 1), tdo)) {
+            fprintf(stderr, "ERROR: unexpected drscan result: %s\n",
+                    result.c_str());
+            return 1;
+        }
+
+        txqueue.erase(txqueue.begin(), txqueue.begin() + nsend);
+        total_tx += nsend;
+        stat_tx += nsend;
+        total_ops++;
+        stat_ops++;
+
+        // Decode status and received data.
+        sent_since_report += nsend;
+        budget -= nsend;
+        unsigned int nrecv = 0;
+        if (get_bits(tdo, 0, 1)) {
+            nrecv = get_bits(tdo, 1, 5);
+            unsigned int nfree = get_bits(tdo, 6, 8);
+            budget = (int)nfree - sent_since_report;
+            sent_since_report = nsend;
+            if (nrecv > CONSOLE_MAX_BYTES) {
+                nrecv = CONSOLE_MAX_BYTES;
+            }
+            unsigned char buf[CONSOLE_MAX_BYTES];
+            for (unsigned int i = 0; i < nrecv; i++) {
+                buf[i] = get_bits(tdo, 14 + 8 * i, 8);
+            }
+            if (nrecv > 0) {
+                fwrite(buf, 1, nrecv, stdout);
+                fflush(stdout);
+            }
+        }
+        total_rx += nrecv;
+        stat_rx += nrecv;
+
+        // Back off a little when the channel is idle.
+        if (nrecv == 0 && nsend == 0) {
+            usleep(1000);
+        }
+
+        // Report throughput.
+        auto t_now = std::chrono::steady_clock::now();
+        double dt = std::chrono::duration<double>(t_now - t_stat).count();
+        if (show_stats && dt >= 5.0) {
+            fprintf(stderr,
+                    "[jtagcon: rx %.0f bytes/s, tx %.0f bytes/s, %.0f ops/s]\n",
+                    stat_rx / dt, stat_tx / dt, stat_ops / dt);
+            stat_rx = stat_tx = stat_ops = 0;
+            t_stat = t_now;
+        }
+    }
+
+    double dt = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t_start).count();
+    fprintf(stderr,
+            "\n[jtagcon: %llu bytes received, %llu bytes sent, "
+            "%llu operations in %.1f seconds]\n",
+            (unsigned long long)total_rx,
+            (unsigned long long)total_tx,
+            (unsigned long long)total_ops,
+            dt);
+
+    return 0;
+}
@@ -0,0 +1,519 @@
+/*
+ * Host test of the fixed-capacity containers in "sw/rvlib_containers.h".
+ *
+ * This program runs random sequences of operations on each container
+ * and on an equivalent standard container, and checks after every step
+ * that both hold the same elements:
+ *   static_vector  against std::vector
+ *   ring_buffer    against std::deque
+ *   intrusive_list against std::list
+ *   hash_map       against std::map
+ *   small_string   against std::string
+ *
+ * Elements are objects that count their own constructions and
+ * destructions, so that a missing or duplicate destructor call is
+ * detected. Run "make test" to build and run this test
+ * with AddressSanitizer and UndefinedBehaviorSanitizer enabled.
+ *
+ * Usage: test_containers_host [rounds]
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../sw/rvlib_containers.h"
+
+using namespace rvlib;
+
+
+/* Number of random operations per container per round. */
+static const int NUM_OPS = 2000;
+
+static int num_errors;
+static std::mt19937 rng(1);
+
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        if (num_errors < 20) {
+            printf("FAILED: %s\n", what);
+        }
+        num_errors++;
+    }
+}
+
+
+static unsigned int random_below(unsigned int n)
+{
+    return std::uniform_int_distribution<unsigned int>(0, n - 1)(rng);
+}
+
+
+/* Element type that keeps track of the number of live objects. */
+class Tracked
+{
+public:
+    static int live;
+
+    Tracked() : m_value(0), m_alive(MAGIC) { live++; }
+    explicit Tracked(int v) : m_value(v), m_alive(MAGIC) { live++; }
+
+    Tracked(const Tracked& other) : m_value(other.value()), m_alive(MAGIC)
+    {
+        live++;
+    }
+
+    Tracked(Tracked&& other) : m_value(other.value()), m_alive(MAGIC)
+    {
+        other.m_value = -1;
+        live++;
+    }
+
+    ~Tracked()
+    {
+        check(m_alive == MAGIC, "destructor of dead object");
+        m_alive = 0;
+        live--;
+    }
+
+    Tracked& operator=(const Tracked& other)
+    {
+        m_value = other.value();
+        return *this;
+    }
+
+    Tracked& operator=(Tracked&& other)
+    {
+        m_value = other.value();
+        other.m_value = -1;
+        return *this;
+    }
+
+    int value() const
+    {
+        check(m_alive == MAGIC, "access to dead object");
+        return m_value;
+    }
+
+    bool operator==(const Tracked& other) const
+    {
+        return value() == other.value();
+    }
+
+private:
+    static const uint32_t MAGIC = 0x600dcafe;
+    int m_value;
+    uint32_t m_alive;
+};
+
+int Tracked::live = 0;
+
+
+template <size_t N>
+static bool same(const static_vector<Tracked, N>& v, const std::vector<int>& ref)
+{
+    if (v.size() != ref.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+        if (v[i].value() != ref[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void test_static_vector()
+{
+    const size_t N = 16;
+    static_vector<Tracked, N> v;
+    std::vector<int> ref;
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        int x = (int)random_below(1000);
+        switch (random_below(7)) {
+            case 0:
+            case 1:
+                check(v.push_back(Tracked(x)) == (ref.size() < N),
+                      "static_vector push_back result");
+                if (ref.size() < N) {
+                    ref.push_back(x);
+                }
+                break;
+            case 2:
+                if (!ref.empty()) {
+                    v.pop_back();
+                    ref.pop_back();
+                }
+                break;
+            case 3:
+                if (!ref.empty()) {
+                    size_t i = random_below(ref.size());
+                    Tracked *p = v.erase(v.begin() + i);
+                    check(p == v.begin() + i, "static_vector erase result");
+                    ref.erase(ref.begin() + i);
+                }
+                break;
+            case 4:
+                if (!ref.empty()) {
+                    // Unordered erase moves the last element into the gap.
+                    size_t i = random_below(ref.size());
+                    v.erase_unordered(v.begin() + i);
+                    ref[i] = ref.back();
+                    ref.pop_back();
+                }
+                break;
+            case 5: {
+                static_vector<Tracked, N> w(v);
+                check(same(w, ref), "static_vector copy");
+                static_vector<Tracked, N> m(std::move(w));
+                check(w.empty() && same(m, ref), "static_vector move");
+                v = m;
+                break;
+            }
+            case 6:
+                if (random_below(20) == 0) {
+                    v.clear();
+                    ref.clear();
+                }
+                break;
+        }
+        check(same(v, ref), "static_vector contents");
+    }
+}
+
+
+template <size_t N>
+static bool same(const ring_buffer<Tracked, N>& r, const std::deque<int>& ref)
+{
+    if (r.size() != ref.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+        if (r[i].value() != ref[i]) {
+            return false;
+        }
+    }
+    return ref.empty() || (r.front().value() == ref.front()
+                           && r.back().value() == ref.back());
+}
+
+
+static void test_ring_buffer()
+{
+    const size_t N = 7;
+    ring_buffer<Tracked, N> r;
+    std::deque<int> ref;
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        int x = (int)random_below(1000);
+        switch (random_below(5)) {
+            case 0:
+            case 1:
+                check(r.push(Tracked(x)) == (ref.size() < N),
+                      "ring_buffer push result");
+                if (ref.size() < N) {
+                    ref.push_back(x);
+                }
+                break;
+            case 2: {
+                Tracked t;
+                check(r.pop(t) == !ref.empty(), "ring_buffer pop result");
+                if (!ref.empty()) {
+                    check(t.value() == ref.front(), "ring_buffer pop value");
+                    ref.pop_front();
+                }
+                break;
+            }
+            case 3: {
+                ring_buffer<Tracked, N> w(r);
+                check(same(w, ref), "ring_buffer copy");
+                ring_buffer<Tracked, N> m;
+                m = std::move(w);
+                check(w.empty() && same(m, ref), "ring_buffer move");
+                r = std::move(m);
+                break;
+            }
+            case 4:
+                if (random_below(20) == 0) {
+                    r.clear();
+                    ref.clear();
+                } else if (!ref.empty()) {
+                    r.pop_front();
+                    ref.pop_front();
+                }
+                break;
+        }
+        check(same(r, ref), "ring_buffer contents");
+    }
+}
+
+
+struct Node : public list_node {
+    int id;
+};
+
+
+static bool same(intrusive_list<Node>& l, const std::list<int>& ref)
+{
+    if (l.size() != ref.size()) {
+        return false;
+    }
+    auto it = ref.begin();
+    for (Node& n : l) {
+        if (n.id != *it) {
+            return false;
+        }
+        ++it;
+    }
+    return true;
+}
+
+
+static void test_intrusive_list()
+{
+    const int N = 12;
+    Node nodes[N];
+    for (int i = 0; i < N; i++) {
+        nodes[i].id = i;
+    }
+
+    intrusive_list<Node> l;
+    std::list<int> ref;
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        Node& n = nodes[random_below(N)];
+        switch (random_below(5)) {
+            case 0:
+                if (!n.linked()) {
+                    l.push_back(n);
+                    ref.push_back(n.id);
+                }
+                break;
+            case 1:
+                if (!n.linked()) {
+                    l.push_front(n);
+                    ref.push_front(n.id);
+                }
+                break;
+            case 2:
+                if (n.linked()) {
+                    l.remove(n);
+                    ref.remove(n.id);
+                }
+                break;
+            case 3:
+                if (!ref.empty()) {
+                    Node& f = l.pop_front();
+                    check(f.id == ref.front() && !f.linked(),
+                          "intrusive_list pop_front");
+                    ref.pop_front();
+                }
+                break;
+            case 4: {
+                intrusive_list<Node> m(std::move(l));
+                check(l.empty() && same(m, ref), "intrusive_list move");
+                l = std::move(m);
+                break;
+            }
+        }
+        check(same(l, ref), "intrusive_list contents");
+        for (int i = 0; i < N; i++) {
+            bool in_ref = false;
+            for (int id : ref) {
+                in_ref = in_ref || (id == i);
+            }
+            check(nodes[i].linked() == in_ref, "intrusive_list linked()");
+        }
+    }
+
+    l.clear();
+}
+
+
+template <typename K, size_t N>
+static bool same(hash_map<K, Tracked, N>& h, const std::map<K, int>& ref)
+{
+    if (h.size() != ref.size()) {
+        return false;
+    }
+    size_t count = 0;
+    for (auto& e : h) {
+        auto it = ref.find(e.key);
+        if (it == ref.end() || it->second != e.value.value()) {
+            return false;
+        }
+        count++;
+    }
+    for (auto& kv : ref) {
+        const Tracked *p = h.find(kv.first);
+        if (p == nullptr || p->value() != kv.second) {
+            return false;
+        }
+    }
+    return count == ref.size();
+}
+
+
+template <typename K, size_t N, typename KeyFunc>
+static void test_hash_map_keys(KeyFunc make_key, unsigned int num_keys)
+{
+    hash_map<K, Tracked, N> h;
+    std::map<K, int> ref;
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        K key = make_key(random_below(num_keys));
+        int x = (int)random_below(1000);
+        switch (random_below(6)) {
+            case 0:
+            case 1: {
+                bool fits = (ref.size() < N) || (ref.count(key) != 0);
+                Tracked *p = h.insert(key, Tracked(x));
+                check((p != nullptr) == fits, "hash_map insert result");
+                if (fits) {
+                    check(p->value() == x, "hash_map insert value");
+                    ref[key] = x;
+                }
+                break;
+            }
+            case 2:
+                check(h.erase(key) == (ref.erase(key) != 0),
+                      "hash_map erase result");
+                break;
+            case 3:
+                check(h.contains(key) == (ref.count(key) != 0),
+                      "hash_map contains");
+                if (ref.size() < N || ref.count(key) != 0) {
+                    h[key] = Tracked(x);
+                    ref[key] = x;
+                }
+                break;
+            case 4: {
+                hash_map<K, Tracked, N> w(h);
+                check(same(w, ref), "hash_map copy");
+                hash_map<K, Tracked, N> m(std::move(w));
+                check(w.empty() && same(m, ref), "hash_map move");
+                h = std::move(m);
+                break;
+            }
+            case 5:
+                if (random_below(30) == 0) {
+                    h.clear();
+                    ref.clear();
+                }
+                break;
+        }
+        check(same(h, ref), "hash_map contents");
+    }
+}
+
+
+static void test_hash_map()
+{
+    // Many more keys than slots, so the map often fills up and
+    // probe sequences run through tombstones.
+    test_hash_map_keys<uint32_t, 16>(
+        [](unsigned int i) { return (uint32_t)i * 16; }, 40);
+    test_hash_map_keys<int, 64>(
+        [](unsigned int i) { return (int)i - 50; }, 100);
+    test_hash_map_keys<small_string<8>, 32>(
+        [](unsigned int i) {
+            small_string<8> s("k");
+            for (; i != 0; i /= 7) {
+                s += (char)('a' + i % 7);
+            }
+            return s;
+        }, 60);
+}
+
+
+/* small_string has no operator< for std::map, so compare on the characters. */
+namespace rvlib {
+template <size_t N>
+static bool operator<(const small_string<N>& a, const small_string<N>& b)
+{
+    return std::string(a.c_str()) < std::string(b.c_str());
+}
+}
+
+
+static void test_small_string()
+{
+    const size_t N = 10;
+    small_string<N> s;
+    std::string ref;
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        switch (random_below(4)) {
+            case 0: {
+                char c = (char)('a' + random_below(26));
+                check(s.append(c) == (ref.size() < N), "small_string append char");
+                if (ref.size() < N) {
+                    ref += c;
+                }
+                break;
+            }
+            case 1: {
+                std::string t(random_below(5), 'x');
+                t += "yz";
+                bool fits = (ref.size() + t.size() <= N);
+                check(s.append(t.c_str()) == fits, "small_string append string");
+                ref = (ref + t).substr(0, N);
+                break;
+            }
+            case 2: {
+                small_string<N> t(ref.c_str());
+                check(t == s && !(t != s), "small_string compare");
+                check(s == ref.c_str(), "small_string compare with char *");
+                break;
+            }
+            case 3:
+                if (random_below(4) == 0) {
+                    s.clear();
+                    ref.clear();
+                }
+                break;
+        }
+        check(s.size() == ref.size() && ref == s.c_str(),
+              "small_string contents");
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    int rounds = (argc > 1) ? atoi(argv[1]) : 5;
+
+    for (int r = 0; r < rounds; r++) {
+        test_static_vector();
+        test_ring_buffer();
+        test_intrusive_list();
+        test_hash_map();
+        test_small_string();
+        check(Tracked::live == 0, "objects leaked or destroyed twice");
+    }
+
+    if (num_errors != 0) {
+        printf("%d checks FAILED\n", num_errors);
+        return 1;
+    }
+
+    printf("test_containers_host: %d rounds OK\n", rounds);
+    return 0;
+}
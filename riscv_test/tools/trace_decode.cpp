@@ -0,0 +1,1014 @@
+/*
+ * Decoder for the instruction trace buffer.
+ *
+ * This program reads the records of the instruction trace buffer
+ * (see "sw/rvlib_trace.h" and "rtl/trace_buf.vhd") and reconstructs
+ * the sequence of executed instructions from the ELF file of the program.
+ *
+ * The records are either read from console output of a program that
+ * calls rvlib_trace_dump(), or directly from the trace buffer via JTAG.
+ * In JTAG mode, this program connects to the TCL server of OpenOCD,
+ * halts the processor and reads the buffer through the debug interface.
+ * This works even when the program has crashed. The processor remains
+ * halted afterwards.
+ *
+ * Usage: trace_decode [-i] [-s] [-t addr] program.elf [inputfile]
+ *        trace_decode -j [-H host] [-p port] [-i] [-s] [-t addr] program.elf
+ *
+ *   -i        list every instruction instead of one line per basic block
+ *   -s        print a summary of the most frequently executed code
+ *   -t addr   trap vector address (default 0x80000020)
+ *   -j        read the trace buffer via OpenOCD
+ *   -H host   OpenOCD host (default localhost)
+ *   -p port   OpenOCD TCL server port (default 6666)
+ *
+ * Input is read from stdin if no input file is specified.
+ * For example:
+ *   stty -F /dev/ttyUSB0 115200 raw
+ *   trace_decode test_trace.elf < /dev/ttyUSB0
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+/* Must match the definitions in "rvlib_trace.h". */
+static const uint32_t TRACE_BASE_ADDR = 0xf0080000;
+static const uint32_t TRACE_REG_CTRL = 0x00;
+static const uint32_t TRACE_REG_WRINDEX = 0x04;
+static const uint32_t TRACE_REG_RDINDEX = 0x08;
+static const uint32_t TRACE_REG_WORD0 = 0x0c;
+static const uint32_t TRACE_CTRL_STOP_FULL = 0x02;
+static const uint32_t TRACE_CTRL_FULL = 0x08;
+static const uint32_t TRACE_CTRL_OVERFLOW = 0x10;
+
+enum RecordType {
+    REC_TARGET = 0,
+    REC_BRANCH = 1,
+    REC_TRAP = 2,
+    REC_SYNC = 3
+};
+
+/* Stop walking through straight-line code after this many instructions. */
+static const unsigned int MAX_WALK = 100000;
+
+
+struct TraceRecord {
+    uint32_t word0;
+    uint32_t timestamp;
+};
+
+
+/* A section of the program image. */
+struct ImageSection {
+    uint32_t addr;
+    std::vector<unsigned char> data;
+};
+
+
+/* Program image and symbols extracted from the ELF file. */
+class ElfInfo
+{
+public:
+    std::vector<ImageSection> image;
+    std::map<uint32_t, std::string> symbols;
+
+    bool load(const char *fname);
+
+    /* Read an instruction word from the program image. */
+    bool get_insn(uint32_t addr, uint32_t& insn) const;
+
+    /* Return "symbol+offset" for an address. */
+    std::string symbolize(uint32_t addr) const;
+
+    /* Return the start address of the symbol containing an address. */
+    uint32_t symbol_start(uint32_t addr) const;
+};
+
+
+static uint32_t get_u16(const std::vector<unsigned char>& buf, size_t pos)
+{
+    return buf[pos] | (buf[pos+1] << 8);
+}
+
+
+static uint32_t get_u32(const std::vector<unsigned char>& buf, size_t pos)
+{
+    return buf[pos] | (buf[pos+1] << 8) | (buf[pos+2] << 16)
+           | ((uint32_t)buf[pos+3] << 24);
+}
+
+
+bool ElfInfo::load(const char *fname)
+{
+    const uint32_t SHT_PROGBITS = 1;
+    const uint32_t SHT_SYMTAB = 2;
+    const uint32_t SHF_ALLOC = 2;
+    const uint32_t SHF_EXECINSTR = 4;
+    const unsigned int STT_NOTYPE = 0;
+    const unsigned int STT_FUNC = 2;
+
+    FILE *f = fopen(fname, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", fname, strerror(errno));
+        return false;
+    }
+    std::vector<unsigned char> elf;
+    unsigned char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        elf.insert(elf.end(), buf, buf + n);
+    }
+    fclose(f);
+
+    // Check for 32-bit little-endian ELF file.
+    if (elf.size() < 52 || memcmp(elf.data(), "\x7f" "ELF", 4) != 0
+            || elf[4] != 1 || elf[5] != 1) {
+        fprintf(stderr, "ERROR: %s is not a 32-bit little-endian ELF file\n", fname);
+        return false;
+    }
+
+    uint32_t shoff = get_u32(elf, 32);
+    uint32_t shentsize = get_u16(elf, 46);
+    uint32_t shnum = get_u16(elf, 48);
+    if (shentsize < 40 || shoff + (uint64_t)shnum * shentsize > elf.size()) {
+        fprintf(stderr, "ERROR: invalid section table in %s\n", fname);
+        return false;
+    }
+
+    // Collect executable sections.
+    std::vector<bool> exec_section(shnum, false);
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t sh = shoff + i * shentsize;
+        uint32_t type = get_u32(elf, sh + 4);
+        uint32_t flags = get_u32(elf, sh + 8);
+        uint32_t addr = get_u32(elf, sh + 12);
+        uint32_t offset = get_u32(elf, sh + 16);
+        uint32_t size = get_u32(elf, sh + 20);
+
+        if (type == SHT_PROGBITS
+                && (flags & (SHF_ALLOC | SHF_EXECINSTR)) == (SHF_ALLOC | SHF_EXECINSTR)
+                && offset + (uint64_t)size <= elf.size()) {
+            ImageSection sec;
+            sec.addr = addr;
+            sec.data.assign(elf.begin() + offset, elf.begin() + offset + size);
+            image.push_back(sec);
+            exec_section[i] = true;
+        }
+    }
+
+    // Collect symbols in executable sections.
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t sh = shoff + i * shentsize;
+        uint32_t type = get_u32(elf, sh + 4);
+        uint32_t offset = get_u32(elf, sh + 16);
+        uint32_t size = get_u32(elf, sh + 20);
+        uint32_t link = get_u32(elf, sh + 24);
+        uint32_t entsize = get_u32(elf, sh + 36);
+
+        if (type != SHT_SYMTAB || link >= shnum || entsize < 16
+                || offset + (uint64_t)size > elf.size()) {
+            continue;
+        }
+
+        size_t strsh = shoff + link * shentsize;
+        uint32_t stroff = get_u32(elf, strsh + 16);
+        uint32_t strsize = get_u32(elf, strsh + 20);
+        if (stroff + (uint64_t)strsize > elf.size()) {
+            continue;
+        }
+
+        for (uint32_t p = offset; p + entsize <= offset + size; p += entsize) {
+            uint32_t name = get_u32(elf, p);
+            uint32_t value = get_u32(elf, p + 4);
+            unsigned int info = elf[p + 12];
+            unsigned int shndx = get_u16(elf, p + 14);
+            unsigned int stype = info & 15;
+
+            if ((stype != STT_FUNC && stype != STT_NOTYPE)
+                    || shndx >= shnum || !exec_section[shndx]
+                    || name == 0 || name >= strsize) {
+                continue;
+            }
+
+            const char *s = (const char *)elf.data() + stroff + name;
+            std::string symname(s, strnlen(s, strsize - name));
+
+            // Skip local labels and mapping symbols.
+            if (symname.compare(0, 2, ".L") == 0 || symname[0] == '$') {
+                continue;
+            }
+
+            // Prefer function symbols over other labels.
+            auto it = symbols.find(value);
+            if (it == symbols.end() || stype == STT_FUNC) {
+                symbols[value] = symname;
+            }
+        }
+    }
+
+    if (image.empty()) {
+        fprintf(stderr, "ERROR: no code sections in %s\n", fname);
+        return false;
+    }
+    return true;
+}
+
+
+bool ElfInfo::get_insn(uint32_t addr, uint32_t& insn) const
+{
+    for (const ImageSection& sec : image) {
+        if (addr >= sec.addr && addr - sec.addr + 4 <= sec.data.size()) {
+            insn = get_u32(sec.data, addr - sec.addr);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+std::string ElfInfo::symbolize(uint32_t addr) const
+{
+    char buf[32];
+    auto it = symbols.upper_bound(addr);
+    if (it == symbols.begin()) {
+        snprintf(buf, sizeof(buf), "0x%08x", addr);
+        return buf;
+    }
+    --it;
+    if (addr == it->first) {
+        return it->second;
+    }
+    snprintf(buf, sizeof(buf), "+0x%x", addr - it->first);
+    return it->second + buf;
+}
+
+
+uint32_t ElfInfo::symbol_start(uint32_t addr) const
+{
+    auto it = symbols.upper_bound(addr);
+    if (it == symbols.begin()) {
+        return 0;
+    }
+    --it;
+    return it->first;
+}
+
+
+/* Classification of RV32I instructions by their effect on control flow. */
+enum InsnClass {
+    INSN_OTHER,
+    INSN_BRANCH,
+    INSN_JAL,
+    INSN_INDIRECT
+};
+
+
+/* Must match the classification in "trace_buf.vhd". */
+static InsnClass classify_insn(uint32_t insn)
+{
+    switch (insn & 0x7f) {
+        case 0x63: return INSN_BRANCH;
+        case 0x6f: return INSN_JAL;
+        case 0x67: return INSN_INDIRECT;
+        case 0x73: return ((insn >> 12) & 7) == 0 ? INSN_INDIRECT : INSN_OTHER;
+        default:   return INSN_OTHER;
+    }
+}
+
+
+static uint32_t branch_target(uint32_t pc, uint32_t insn)
+{
+    uint32_t imm = ((insn >> 19) & 0x1000)
+                   | ((insn << 4) & 0x800)
+                   | ((insn >> 20) & 0x7e0)
+                   | ((insn >> 7) & 0x1e);
+    if (imm & 0x1000) {
+        imm |= 0xffffe000;
+    }
+    return pc + imm;
+}
+
+
+static uint32_t jal_target(uint32_t pc, uint32_t insn)
+{
+    uint32_t imm = ((insn >> 11) & 0x100000)
+                   | (insn & 0xff000)
+                   | ((insn >> 9) & 0x800)
+                   | ((insn >> 20) & 0x7fe);
+    if (imm & 0x100000) {
+        imm |= 0xffe00000;
+    }
+    return pc + imm;
+}
+
+
+/* Execution statistics of a basic block. */
+struct BlockStats {
+    uint32_t end;
+    uint64_t count;
+    uint64_t ninsn;
+};
+
+
+/* Reconstructs the instruction flow from trace records. */
+class TraceDecoder
+{
+public:
+    TraceDecoder(const ElfInfo& elf, uint32_t trap_vector, bool list_insns)
+      : m_elf(elf),
+        m_trap_vector(trap_vector),
+        m_list_insns(list_insns),
+        m_valid(false),
+        m_pc(0),
+        m_trap_depth(0),
+        m_block_start(0),
+        m_block_insns(0),
+        m_total_insns(0),
+        m_first_time(0),
+        m_last_time(0),
+        m_have_time(false),
+        m_errors(0)
+    { }
+
+    void decode(const std::vector<TraceRecord>& records);
+    void print_summary() const;
+
+private:
+    enum WalkResult {
+        WALK_DECISION,  // stopped at a branch or indirect jump
+        WALK_REACHED,   // executed the requested stop address
+        WALK_ERROR
+    };
+
+    WalkResult walk(bool stop_at_addr, uint32_t stop_addr,
+                    uint32_t& decision_pc, uint32_t& decision_insn);
+    void end_block(uint32_t end, const std::string& note,
+                   bool have_time, uint32_t timestamp);
+    void execute(uint32_t pc, uint32_t insn);
+    void note_time(uint32_t timestamp);
+    void lose_sync(const char *msg);
+
+    const ElfInfo& m_elf;
+    uint32_t m_trap_vector;
+    bool m_list_insns;
+
+    bool m_valid;
+    uint32_t m_pc;
+    unsigned int m_trap_depth;
+
+    // Current basic block.
+    uint32_t m_block_start;
+    unsigned int m_block_insns;
+
+    // Statistics.
+    std::map<uint32_t, BlockStats> m_blocks;
+    std::map<uint32_t, uint64_t> m_func_insns;
+    uint64_t m_total_insns;
+    uint32_t m_first_time;
+    uint32_t m_last_time;
+    bool m_have_time;
+    unsigned int m_errors;
+};
+
+
+void TraceDecoder::note_time(uint32_t timestamp)
+{
+    if (!m_have_time) {
+        m_first_time = timestamp;
+        m_have_time = true;
+    }
+    m_last_time = timestamp;
+}
+
+
+void TraceDecoder::lose_sync(const char *msg)
+{
+    printf("  *** %s at 0x%08x, waiting for next address record\n", msg, m_pc);
+    m_valid = false;
+    m_errors++;
+}
+
+
+/* Account for one executed instruction. */
+void TraceDecoder::execute(uint32_t pc, uint32_t insn)
+{
+    if (m_block_insns == 0) {
+        m_block_start = pc;
+    }
+    m_block_insns++;
+    m_total_insns++;
+    m_func_insns[m_elf.symbol_start(pc)]++;
+
+    if (m_list_insns) {
+        printf("            %08x  %08x  %s\n",
+               pc, insn, m_elf.symbolize(pc).c_str());
+    }
+}
+
+
+/* Finish the current basic block and print it. */
+void TraceDecoder::end_block(uint32_t end,
+                             const std::string& note,
+                             bool have_time,
+                             uint32_t timestamp)
+{
+    char tbuf[16] = "";
+    if (have_time) {
+        snprintf(tbuf, sizeof(tbuf), "%10" PRIu32, timestamp);
+    }
+
+    if (m_block_insns == 0) {
+        if (!note.empty()) {
+            printf("%10s  %s\n", tbuf, note.c_str());
+        }
+        return;
+    }
+
+    BlockStats& st = m_blocks[m_block_start];
+    st.end = end;
+    st.count++;
+    st.ninsn += m_block_insns;
+
+    if (m_list_insns) {
+        if (!note.empty()) {
+            printf("%10s  %s\n", tbuf, note.c_str());
+        }
+    } else {
+        printf("%10s  %08x-%08x %4u  %-28s %s\n",
+               tbuf, m_block_start, end, m_block_insns,
+               m_elf.symbolize(m_block_start).c_str(), note.c_str());
+    }
+
+    m_block_insns = 0;
+}
+
+
+/*
+ * Execute straight-line code and direct jumps, starting at the current
+ * program counter, until reaching a branch or indirect jump.
+ * If "stop_at_addr" is set, also stop after executing "stop_addr".
+ */
+TraceDecoder::WalkResult TraceDecoder::walk(bool stop_at_addr,
+                                            uint32_t stop_addr,
+                                            uint32_t& decision_pc,
+                                            uint32_t& decision_insn)
+{
+    for (unsigned int n = 0; n < MAX_WALK; n++) {
+        uint32_t insn;
+        if (!m_elf.get_insn(m_pc, insn)) {
+            lose_sync("address outside program image");
+            return WALK_ERROR;
+        }
+
+        InsnClass cls = classify_insn(insn);
+        if (cls == INSN_BRANCH || cls == INSN_INDIRECT) {
+            decision_pc = m_pc;
+            decision_insn = insn;
+            return WALK_DECISION;
+        }
+
+        uint32_t pc = m_pc;
+        execute(pc, insn);
+        if (cls == INSN_JAL) {
+            m_pc = jal_target(pc, insn);
+            end_block(pc, "jal", false, 0);
+        } else {
+            m_pc = pc + 4;
+        }
+
+        if (stop_at_addr && pc == stop_addr) {
+            return WALK_REACHED;
+        }
+    }
+
+    lose_sync("no branch found");
+    return WALK_ERROR;
+}
+
+
+void TraceDecoder::decode(const std::vector<TraceRecord>& records)
+{
+    char buf[80];
+
+    m_valid = false;
+    m_trap_depth = 0;
+    m_block_insns = 0;
+
+    for (const TraceRecord& rec : records) {
+
+        RecordType type = (RecordType)(rec.word0 & 3);
+        uint32_t addr = rec.word0 & 0xfffffffc;
+        note_time(rec.timestamp);
+
+        if (type == REC_SYNC) {
+            if (m_valid) {
+                end_block(m_pc - 4, "", false, 0);
+            }
+            snprintf(buf, sizeof(buf), "--- sync at %s", m_elf.symbolize(addr).c_str());
+            end_block(0, buf, true, rec.timestamp);
+            m_pc = addr;
+            m_valid = true;
+            continue;
+        }
+
+        if (!m_valid) {
+            // Start decoding at the first record with an absolute address.
+            if (type == REC_TARGET) {
+                m_pc = addr;
+                m_valid = true;
+                snprintf(buf, sizeof(buf), "--- start at %s", m_elf.symbolize(addr).c_str());
+                end_block(0, buf, true, rec.timestamp);
+            } else if (type == REC_TRAP) {
+                m_pc = m_trap_vector;
+                m_valid = true;
+                snprintf(buf, sizeof(buf), "--- trap after %s", m_elf.symbolize(addr).c_str());
+                end_block(0, buf, true, rec.timestamp);
+            }
+            continue;
+        }
+
+        uint32_t dpc, dinsn;
+
+        if (type == REC_BRANCH) {
+            unsigned int nbranch = (rec.word0 >> 2) & 0x1f;
+            for (unsigned int i = 0; i < nbranch && m_valid; i++) {
+                bool taken = ((rec.word0 >> (7 + i)) & 1) != 0;
+                if (walk(false, 0, dpc, dinsn) != WALK_DECISION) {
+                    break;
+                }
+                if (classify_insn(dinsn) != INSN_BRANCH) {
+                    lose_sync("expected indirect jump target");
+                    break;
+                }
+                execute(dpc, dinsn);
+                m_pc = taken ? branch_target(dpc, dinsn) : dpc + 4;
+                end_block(dpc, taken ? "taken" : "not taken",
+                          i + 1 == nbranch, rec.timestamp);
+            }
+
+        } else if (type == REC_TARGET) {
+            if (walk(false, 0, dpc, dinsn) != WALK_DECISION) {
+                continue;
+            }
+            if (classify_insn(dinsn) != INSN_INDIRECT) {
+                lose_sync("expected branch outcome");
+                continue;
+            }
+            execute(dpc, dinsn);
+            bool is_mret = ((dinsn & 0x7f) == 0x73);
+            if (addr == m_trap_vector) {
+                snprintf(buf, sizeof(buf), "-> trap");
+                m_trap_depth++;
+            } else if (is_mret) {
+                snprintf(buf, sizeof(buf), "mret -> %s", m_elf.symbolize(addr).c_str());
+                if (m_trap_depth > 0) {
+                    m_trap_depth--;
+                }
+            } else {
+                snprintf(buf, sizeof(buf), "-> %s", m_elf.symbolize(addr).c_str());
+            }
+            end_block(dpc, buf, true, rec.timestamp);
+            m_pc = addr;
+
+        } else if (type == REC_TRAP) {
+            WalkResult res = walk(true, addr, dpc, dinsn);
+            if (res == WALK_DECISION && dpc == addr) {
+                // Trap after a branch or jump; its outcome is not recorded.
+                execute(dpc, dinsn);
+                res = WALK_REACHED;
+            }
+            if (res == WALK_REACHED) {
+                end_block(addr, "-> trap", true, rec.timestamp);
+            } else {
+                if (res == WALK_DECISION) {
+                    lose_sync("trap record does not match program flow");
+                }
+                end_block(m_pc - 4, "", false, 0);
+                end_block(0, "--- trap", true, rec.timestamp);
+            }
+            m_pc = m_trap_vector;
+            m_valid = true;
+            m_trap_depth++;
+        }
+    }
+
+    if (m_valid) {
+        end_block(m_pc - 4, "", false, 0);
+        snprintf(buf, sizeof(buf), "--- end of trace at %s",
+                 m_elf.symbolize(m_pc).c_str());
+        end_block(0, buf, false, 0);
+    }
+}
+
+
+void TraceDecoder::print_summary() const
+{
+    printf("\nSummary:\n");
+    printf("  instructions executed: %" PRIu64 "\n", m_total_insns);
+    if (m_have_time) {
+        uint32_t cycles = m_last_time - m_first_time;
+        printf("  clock cycles:          %" PRIu32 "\n", cycles);
+        if (m_total_insns > 0 && cycles > 0) {
+            printf("  cycles/instruction:    %.2f\n", (double)cycles / m_total_insns);
+        }
+    }
+    if (m_errors > 0) {
+        printf("  decoding errors:       %u\n", m_errors);
+    }
+
+    // Functions sorted by executed instructions.
+    std::vector<std::pair<uint64_t, uint32_t>> funcs;
+    for (const auto& it : m_func_insns) {
+        funcs.push_back(std::make_pair(it.second, it.first));
+    }
+    std::sort(funcs.rbegin(), funcs.rend());
+
+    printf("\n  instructions  %%     function\n");
+    for (size_t i = 0; i < funcs.size() && i < 20; i++) {
+        printf("  %12" PRIu64 "  %5.1f %s\n",
+               funcs[i].first,
+               100.0 * funcs[i].first / m_total_insns,
+               m_elf.symbolize(funcs[i].second).c_str());
+    }
+
+    // Basic blocks sorted by executed instructions.
+    std::vector<std::pair<uint64_t, uint32_t>> blocks;
+    for (const auto& it : m_blocks) {
+        blocks.push_back(std::make_pair(it.second.ninsn, it.first));
+    }
+    std::sort(blocks.rbegin(), blocks.rend());
+
+    printf("\n  instructions  count     block\n");
+    for (size_t i = 0; i < blocks.size() && i < 20; i++) {
+        const BlockStats& st = m_blocks.at(blocks[i].second);
+        printf("  %12" PRIu64 "  %8" PRIu64 "  %08x-%08x %s\n",
+               st.ninsn, st.count, blocks[i].second, st.end,
+               m_elf.symbolize(blocks[i].second).c_str());
+    }
+}
+
+
+/* Read one line without line terminator. Return false at end of input. */
+static bool read_line(FILE *f, std::string& line)
+{
+    line.clear();
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') {
+            return true;
+        }
+        if (c != '\r') {
+            line += (char)c;
+        }
+    }
+    return !line.empty();
+}
+
+
+static void print_status(uint32_t status, size_t nrec)
+{
+    printf("Trace buffer: %zu records%s%s\n", nrec,
+           (status & TRACE_CTRL_FULL) ? ", buffer full" : "",
+           (status & TRACE_CTRL_OVERFLOW) ? ", RECORDS LOST" : "");
+    if ((status & TRACE_CTRL_FULL) && !(status & TRACE_CTRL_STOP_FULL)) {
+        printf("Oldest records were overwritten; decoding starts "
+               "at the first address record.\n");
+    }
+}
+
+
+/* Read trace dumps from console output and decode them. */
+static int decode_console(FILE *inp, TraceDecoder& decoder)
+{
+    int ndumps = 0;
+    std::string line;
+
+    while (read_line(inp, line)) {
+
+        if (line.compare(0, 6, "TRACE ") != 0 || line == "TRACE END") {
+            continue;
+        }
+
+        unsigned long nrec;
+        uint32_t status;
+        if (sscanf(line.c_str() + 6, "%lu %" SCNx32, &nrec, &status) != 2) {
+            fprintf(stderr, "ERROR: invalid header '%s'\n", line.c_str());
+            continue;
+        }
+
+        std::vector<TraceRecord> records;
+        bool complete = false;
+        while (read_line(inp, line)) {
+            if (line == "TRACE END") {
+                complete = true;
+                break;
+            }
+            TraceRecord rec;
+            if (sscanf(line.c_str(), "%" SCNx32 " %" SCNx32,
+                       &rec.word0, &rec.timestamp) != 2) {
+                fprintf(stderr, "ERROR: invalid record '%s'\n", line.c_str());
+                break;
+            }
+            records.push_back(rec);
+        }
+
+        if (!complete || records.size() != nrec) {
+            fprintf(stderr, "ERROR: incomplete trace (expected %lu records, got %zu)\n",
+                    nrec, records.size());
+        }
+
+        print_status(status, records.size());
+        decoder.decode(records);
+        ndumps++;
+    }
+
+    if (ndumps == 0) {
+        fprintf(stderr, "ERROR: no trace data found in input\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Connection to the TCL server of OpenOCD. */
+class OpenOcdTcl
+{
+public:
+    OpenOcdTcl() : m_fd(-1) { }
+
+    ~OpenOcdTcl()
+    {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    /* Connect to OpenOCD. Return true if successful. */
+    bool connect_to(const std::string& host, const std::string& port)
+    {
+        struct addrinfo hints;
+        struct addrinfo *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        int ret = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+        if (ret != 0) {
+            fprintf(stderr, "ERROR: can not resolve %s (%s)\n",
+                    host.c_str(), gai_strerror(ret));
+            return false;
+        }
+        for (struct addrinfo *p = res; p != NULL; p = p->ai_next) {
+            m_fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+            if (m_fd < 0) {
+                continue;
+            }
+            if (connect(m_fd, p->ai_addr, p->ai_addrlen) == 0) {
+                break;
+            }
+            close(m_fd);
+            m_fd = -1;
+        }
+        freeaddrinfo(res);
+        if (m_fd < 0) {
+            fprintf(stderr, "ERROR: can not connect to %s:%s\n",
+                    host.c_str(), port.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /* Run a TCL command and return its result. */
+    bool command(const std::string& cmd, std::string& result)
+    {
+        std::string msg = cmd + '\x1a';
+        size_t p = 0;
+        while (p < msg.size()) {
+            ssize_t n = send(m_fd, msg.data() + p, msg.size() - p, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("ERROR: send");
+                return false;
+            }
+            p += n;
+        }
+
+        result.clear();
+        while (true) {
+            char buf[256];
+            ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("ERROR: recv");
+                return false;
+            }
+            if (n == 0) {
+                fprintf(stderr, "ERROR: OpenOCD closed the connection\n");
+                return false;
+            }
+            result.append(buf, n);
+            if (buf[n-1] == '\x1a') {
+                result.resize(result.size() - 1);
+                return true;
+            }
+        }
+    }
+
+    /* Write a 32-bit word to target memory. */
+    bool write_word(uint32_t addr, uint32_t value)
+    {
+        char cmd[64];
+        std::string result;
+        snprintf(cmd, sizeof(cmd), "mww 0x%08x 0x%08x", addr, value);
+        return command(cmd, result);
+    }
+
+    /* Read 32-bit words from target memory. */
+    bool read_words(uint32_t addr, unsigned int count, uint32_t *values)
+    {
+        char cmd[64];
+        std::string result;
+        snprintf(cmd, sizeof(cmd), "mdw 0x%08x %u", addr, count);
+        if (!command(cmd, result)) {
+            return false;
+        }
+
+        // Parse "0xADDR: WORD WORD ...".
+        size_t p = result.find(':');
+        unsigned int n = 0;
+        while (p != std::string::npos && n < count) {
+            const char *s = result.c_str() + p + 1;
+            char *endp;
+            values[n] = strtoul(s, &endp, 16);
+            if (endp == s) {
+                break;
+            }
+            n++;
+            p = endp - result.c_str();
+        }
+        if (n != count) {
+            fprintf(stderr, "ERROR: unexpected response to '%s': %s\n",
+                    cmd, result.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    int m_fd;
+};
+
+
+/* Halt the processor and read the trace buffer via OpenOCD. */
+static bool read_via_jtag(const std::string& host,
+                          const std::string& port,
+                          std::vector<TraceRecord>& records,
+                          uint32_t& status)
+{
+    OpenOcdTcl ocd;
+    if (!ocd.connect_to(host, port)) {
+        return false;
+    }
+
+    std::string result;
+    if (!ocd.command("halt", result)) {
+        return false;
+    }
+
+    // Stop tracing, then read the buffer state.
+    uint32_t wrindex;
+    if (!ocd.write_word(TRACE_BASE_ADDR + TRACE_REG_CTRL, 0)
+            || !ocd.read_words(TRACE_BASE_ADDR + TRACE_REG_CTRL, 1, &status)
+            || !ocd.read_words(TRACE_BASE_ADDR + TRACE_REG_WRINDEX, 1, &wrindex)) {
+        return false;
+    }
+
+    unsigned int size = 1U << ((status >> 8) & 0x1f);
+    unsigned int nrec = wrindex;
+    unsigned int start = 0;
+    if (status & TRACE_CTRL_FULL) {
+        nrec = size;
+        start = wrindex;
+    }
+
+    fprintf(stderr, "Reading %u trace records ...\n", nrec);
+    for (unsigned int i = 0; i < nrec; i++) {
+        uint32_t w[2];
+        if (!ocd.write_word(TRACE_BASE_ADDR + TRACE_REG_RDINDEX, (start + i) % size)
+                || !ocd.read_words(TRACE_BASE_ADDR + TRACE_REG_WORD0, 2, w)) {
+            return false;
+        }
+        TraceRecord rec;
+        rec.word0 = w[0];
+        rec.timestamp = w[1];
+        records.push_back(rec);
+    }
+
+    fprintf(stderr, "Processor remains halted.\n");
+    return true;
+}
+
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: trace_decode [-i] [-s] [-t addr] program.elf [inputfile]\n"
+        "       trace_decode -j [-H host] [-p port] [-i] [-s] [-t addr] program.elf\n"
+        "\n"
+        "  -i        list every instruction\n"
+        "  -s        print summary of most executed code\n"
+        "  -t addr   trap vector address (default 0x80000020)\n"
+        "  -j        read trace buffer via OpenOCD (halts the processor)\n"
+        "  -H host   OpenOCD host (default localhost)\n"
+        "  -p port   OpenOCD TCL server port (default 6666)\n"
+        "\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    bool list_insns = false;
+    bool summary = false;
+    bool use_jtag = false;
+    uint32_t trap_vector = 0x80000020;
+    std::string host = "localhost";
+    std::string port = "6666";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ist:jH:p:h")) != -1) {
+        switch (opt) {
+            case 'i': list_insns = true; break;
+            case 's': summary = true; break;
+            case 't': trap_vector = strtoul(optarg, NULL, 0); break;
+            case 'j': use_jtag = true; break;
+            case 'H': host = optarg; break;
+            case 'p': port = optarg; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (argc - optind < 1 || argc - optind > (use_jtag ? 1 : 2)) {
+        usage();
+        return 1;
+    }
+
+    ElfInfo elf;
+    if (!elf.load(argv[optind])) {
+        return 1;
+    }
+
+    TraceDecoder decoder(elf, trap_vector, list_insns);
+    int ret = 0;
+
+    if (use_jtag) {
+        std::vector<TraceRecord> records;
+        uint32_t status;
+        if (!read_via_jtag(host, port, records, status)) {
+            return 1;
+        }
+        print_status(status, records.size());
+        decoder.decode(records);
+    } else {
+        FILE *inp = stdin;
+        if (optind + 1 < argc) {
+            inp = fopen(argv[optind+1], "rb");
+            if (inp == NULL) {
+                fprintf(stderr, "ERROR: can not open %s (%s)\n",
+                        argv[optind+1], strerror(errno));
+                return 1;
+            }
+        }
+        ret = decode_console(inp, decoder);
+    }
+
+    if (summary) {
+        decoder.print_summary();
+    }
+
+    return ret;
+}
@@ -0,0 +1,248 @@
+/*
+ * Access the RISC-V system bus via the UART debug bridge.
+ *
+ * This program reads and writes memory and peripheral registers of the
+ * RISC-V system through the hardware debug bridge on the serial port.
+ * It does not need any help from the software on the RISC-V processor.
+ *
+ * Commands:
+ *   read ADDR [N]          read N words (default 1) and print them
+ *   write ADDR VALUE...    write one or more words
+ *   dump ADDR NBYTES FILE  read NBYTES bytes into a binary file
+ *   load ADDR FILE         write a binary file into memory
+ *
+ * Add "-f" to keep the address fixed during the burst (for example to
+ * read all entries of a FIFO register).
+ *
+ * The dump and load commands report the transfer rate.
+ *
+ * Usage: uart_dbg [-f] /dev/ttyUSBn command [args...]
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "uart_dbg_host.h"
+
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: uart_dbg [-f] /dev/ttyUSBn command [args...]\n"
+        "\n"
+        "Commands:\n"
+        "  read ADDR [N]          read N words (default 1)\n"
+        "  write ADDR VALUE...    write one or more words\n"
+        "  dump ADDR NBYTES FILE  read memory into a binary file\n"
+        "  load ADDR FILE         write a binary file into memory\n"
+        "\n"
+        "  -f   keep the address fixed during the burst\n"
+        "\n");
+}
+
+
+static bool parse_uint(const char *s, uint32_t& value)
+{
+    char *endp;
+    errno = 0;
+    unsigned long v = strtoul(s, &endp, 0);
+    if (errno != 0 || endp == s || *endp != '\0' || v > 0xffffffffUL) {
+        fprintf(stderr, "ERROR: invalid number '%s'\n", s);
+        return false;
+    }
+    value = v;
+    return true;
+}
+
+
+static void report_rate(const char *what, size_t nbytes,
+                        std::chrono::steady_clock::time_point t_start)
+{
+    double dt = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t_start).count();
+    fprintf(stderr, "%s %zu bytes in %.2f seconds (%.1f kByte/s)\n",
+            what, nbytes, dt, (dt > 0) ? nbytes / dt / 1000.0 : 0.0);
+}
+
+
+static int cmd_read(UartDbg& dbg, bool fixed, int argc, char **argv)
+{
+    uint32_t addr, n = 1;
+    if (argc < 1 || argc > 2 || !parse_uint(argv[0], addr)
+        || (argc == 2 && !parse_uint(argv[1], n))) {
+        usage();
+        return 1;
+    }
+    std::vector<uint32_t> data(n);
+    if (!dbg.read(addr, data.data(), n, fixed)) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (i % 4 == 0) {
+            printf("%08x:", fixed ? addr : addr + 4 * i);
+        }
+        printf(" %08x", data[i]);
+        if (i % 4 == 3 || i == n - 1) {
+            printf("\n");
+        }
+    }
+    return 0;
+}
+
+
+static int cmd_write(UartDbg& dbg, bool fixed, int argc, char **argv)
+{
+    uint32_t addr;
+    if (argc < 2 || !parse_uint(argv[0], addr)) {
+        usage();
+        return 1;
+    }
+    std::vector<uint32_t> data;
+    for (int i = 1; i < argc; i++) {
+        uint32_t v;
+        if (!parse_uint(argv[i], v)) {
+            return 1;
+        }
+        data.push_back(v);
+    }
+    return dbg.write(addr, data.data(), data.size(), fixed) ? 0 : 1;
+}
+
+
+static int cmd_dump(UartDbg& dbg, bool fixed, int argc, char **argv)
+{
+    uint32_t addr, nbytes;
+    if (argc != 3 || !parse_uint(argv[0], addr) || !parse_uint(argv[1], nbytes)) {
+        usage();
+        return 1;
+    }
+
+    auto t_start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> data((nbytes + 3) / 4);
+    if (!dbg.read(addr, data.data(), data.size(), fixed)) {
+        return 1;
+    }
+    report_rate("Read", 4 * data.size(), t_start);
+
+    FILE *f = fopen(argv[2], "wb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", argv[2], strerror(errno));
+        return 1;
+    }
+    std::vector<unsigned char> buf(4 * data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        for (int k = 0; k < 4; k++) {
+            buf[4 * i + k] = (unsigned char)(data[i] >> (8 * k));
+        }
+    }
+    bool ok = (fwrite(buf.data(), 1, nbytes, f) == nbytes);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "ERROR: can not write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
+
+
+static int cmd_load(UartDbg& dbg, bool fixed, int argc, char **argv)
+{
+    uint32_t addr;
+    if (argc != 2 || !parse_uint(argv[0], addr)) {
+        usage();
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", argv[1], strerror(errno));
+        return 1;
+    }
+    std::vector<unsigned char> buf;
+    unsigned char tmp[65536];
+    size_t n;
+    while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0) {
+        buf.insert(buf.end(), tmp, tmp + n);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "ERROR: can not read %s\n", argv[1]);
+        return 1;
+    }
+
+    // Pad to a whole number of words.
+    buf.resize((buf.size() + 3) & ~(size_t)3, 0);
+    std::vector<uint32_t> data(buf.size() / 4);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (uint32_t)buf[4*i] | ((uint32_t)buf[4*i+1] << 8)
+                  | ((uint32_t)buf[4*i+2] << 16) | ((uint32_t)buf[4*i+3] << 24);
+    }
+
+    auto t_start = std::chrono::steady_clock::now();
+    if (!dbg.write(addr, data.data(), data.size(), fixed)) {
+        return 1;
+    }
+    report_rate("Wrote", buf.size(), t_start);
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    bool fixed = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "fh")) != -1) {
+        switch (opt) {
+            case 'f': fixed = true; break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (argc - optind < 2) {
+        usage();
+        return 1;
+    }
+
+    std::string cmd = argv[optind + 1];
+    int cmd_argc = argc - optind - 2;
+    char **cmd_argv = argv + optind + 2;
+
+    UartDbg dbg;
+    if (!dbg.open(argv[optind])) {
+        return 1;
+    }
+
+    int ret;
+    if (cmd == "read") {
+        ret = cmd_read(dbg, fixed, cmd_argc, cmd_argv);
+    } else if (cmd == "write") {
+        ret = cmd_write(dbg, fixed, cmd_argc, cmd_argv);
+    } else if (cmd == "dump") {
+        ret = cmd_dump(dbg, fixed, cmd_argc, cmd_argv);
+    } else if (cmd == "load") {
+        ret = cmd_load(dbg, fixed, cmd_argc, cmd_argv);
+    } else {
+        usage();
+        ret = 1;
+    }
+
+    dbg.close();
+    return ret;
+}
@@ -0,0 +1,309 @@
+/*
+ * Host-side access to the UART debug bridge.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "uart_dbg_host.h"
+
+
+/* Escape sequence that switches the bridge to bridge mode. */
+static const unsigned char ESCAPE_SEQ[6] = { 0x1b, 0x00, 0x44, 0x42, 0x47, 0x00 };
+
+/* Command bytes. */
+static const unsigned char CMD_NOP   = 0x00;
+static const unsigned char CMD_WRITE = 0x01;
+static const unsigned char CMD_READ  = 0x02;
+static const unsigned char CMD_EXIT  = 0x03;
+static const unsigned char CMD_FIXED = 0x10;
+
+/* Maximum number of words per burst. */
+static const size_t MAX_BURST = 65536;
+
+/*
+ * The bridge returns to normal mode after 2**27 idle clock cycles (1.3 s).
+ * Check again whether it is still in bridge mode after a shorter idle time.
+ */
+static const double ACTIVE_HOLD_SECONDS = 0.5;
+
+/* Give up if the bridge is silent for this long. */
+static const int RECV_TIMEOUT_MS = 2000;
+
+
+UartDbg::UartDbg()
+  : m_fd(-1), m_active(false)
+{ }
+
+
+UartDbg::~UartDbg()
+{
+    close();
+}
+
+
+bool UartDbg::open(const char *devname)
+{
+    close();
+
+    int fd = ::open(devname, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: can not open %s (%s)\n", devname, strerror(errno));
+        return false;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        perror("ERROR: tcgetattr");
+        ::close(fd);
+        return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        perror("ERROR: tcsetattr");
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_active = false;
+    return true;
+}
+
+
+void UartDbg::close()
+{
+    if (m_fd < 0) {
+        return;
+    }
+    if (m_active) {
+        unsigned char cmd = CMD_EXIT;
+        if (send(&cmd, 1)) {
+            expect(0x80 | CMD_EXIT);
+        }
+    }
+    tcdrain(m_fd);
+    ::close(m_fd);
+    m_fd = -1;
+    m_active = false;
+}
+
+
+bool UartDbg::send(const unsigned char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = ::write(m_fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("ERROR: write");
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+
+/* Read one byte with timeout. Return -1 on timeout or error. */
+int UartDbg::recv_byte(int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, timeout_ms);
+    if (ret <= 0) {
+        return -1;
+    }
+    unsigned char c;
+    if (::read(m_fd, &c, 1) != 1) {
+        perror("ERROR: read");
+        return -1;
+    }
+    return c;
+}
+
+
+/* Receive one byte and check its value. */
+bool UartDbg::expect(unsigned char b)
+{
+    int c = recv_byte(RECV_TIMEOUT_MS);
+    if (c < 0) {
+        fprintf(stderr, "ERROR: timeout waiting for debug bridge\n");
+        m_active = false;
+        return false;
+    }
+    if (c != b) {
+        fprintf(stderr, "ERROR: expected 0x%02x from debug bridge, got 0x%02x\n",
+                b, c);
+        m_active = false;
+        return false;
+    }
+    m_last_activity = std::chrono::steady_clock::now();
+    return true;
+}
+
+
+/* Make sure the bridge is in bridge mode. */
+bool UartDbg::enter()
+{
+    if (m_fd < 0) {
+        fprintf(stderr, "ERROR: serial port not open\n");
+        return false;
+    }
+
+    if (m_active) {
+        double idle = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_last_activity).count();
+        if (idle < ACTIVE_HOLD_SECONDS) {
+            return true;
+        }
+    }
+
+    // Drop console output from the RISC-V software.
+    tcflush(m_fd, TCIFLUSH);
+
+    // If the bridge is still in bridge mode, a NOP gets a quick answer.
+    // Otherwise the NOP byte goes to the software UART.
+    unsigned char cmd = CMD_NOP;
+    if (!send(&cmd, 1)) {
+        return false;
+    }
+    while (true) {
+        int c = recv_byte(50);
+        if (c < 0) {
+            break;
+        }
+        if (c == (0x80 | CMD_NOP)) {
+            m_active = true;
+            m_last_activity = std::chrono::steady_clock::now();
+            return true;
+        }
+    }
+
+    // Send the escape sequence and wait for the acknowledge byte.
+    // Skip console output that the software sent before the bridge
+    // took over the TX line.
+    if (!send(ESCAPE_SEQ, sizeof(ESCAPE_SEQ))) {
+        return false;
+    }
+    while (true) {
+        int c = recv_byte(RECV_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "ERROR: no response from debug bridge\n");
+            return false;
+        }
+        if (c == 0xa5) {
+            break;
+        }
+    }
+
+    // Confirm with a NOP.
+    if (!send(&cmd, 1)) {
+        return false;
+    }
+    m_active = true;
+    return expect(0x80 | CMD_NOP);
+}
+
+
+/* Build the header of a READ or WRITE command. */
+static void make_header(unsigned char *hdr, unsigned char cmd,
+                        uint32_t addr, size_t nwords)
+{
+    hdr[0] = cmd;
+    hdr[1] = (unsigned char)addr;
+    hdr[2] = (unsigned char)(addr >> 8);
+    hdr[3] = (unsigned char)(addr >> 16);
+    hdr[4] = (unsigned char)(addr >> 24);
+    hdr[5] = (unsigned char)(nwords - 1);
+    hdr[6] = (unsigned char)((nwords - 1) >> 8);
+}
+
+
+bool UartDbg::read(uint32_t addr, uint32_t *data, size_t nwords, bool fixed)
+{
+    while (nwords > 0) {
+        if (!enter()) {
+            return false;
+        }
+
+        size_t n = std::min(nwords, MAX_BURST);
+        unsigned char hdr[7];
+        make_header(hdr, CMD_READ | (fixed ? CMD_FIXED : 0), addr, n);
+        if (!send(hdr, sizeof(hdr)) || !expect(0x80 | CMD_READ)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            uint32_t w = 0;
+            for (int k = 0; k < 4; k++) {
+                int c = recv_byte(RECV_TIMEOUT_MS);
+                if (c < 0) {
+                    fprintf(stderr, "ERROR: timeout reading from debug bridge\n");
+                    m_active = false;
+                    return false;
+                }
+                w |= (uint32_t)c << (8 * k);
+            }
+            data[i] = w;
+        }
+        m_last_activity = std::chrono::steady_clock::now();
+
+        data += n;
+        nwords -= n;
+        if (!fixed) {
+            addr += 4 * n;
+        }
+    }
+    return true;
+}
+
+
+bool UartDbg::write(uint32_t addr, const uint32_t *data, size_t nwords, bool fixed)
+{
+    while (nwords > 0) {
+        if (!enter()) {
+            return false;
+        }
+
+        size_t n = std::min(nwords, MAX_BURST);
+        std::vector<unsigned char> buf(7 + 4 * n);
+        make_header(buf.data(), CMD_WRITE | (fixed ? CMD_FIXED : 0), addr, n);
+        for (size_t i = 0; i < n; i++) {
+            for (int k = 0; k < 4; k++) {
+                buf[7 + 4 * i + k] = (unsigned char)(data[i] >> (8 * k));
+            }
+        }
+        if (!send(buf.data(), buf.size()) || !expect(0x80 | CMD_WRITE)) {
+            return false;
+        }
+
+        data += n;
+        nwords -= n;
+        if (!fixed) {
+            addr += 4 * n;
+        }
+    }
+    return true;
+}
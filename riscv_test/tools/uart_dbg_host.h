@@ -0,0 +1,83 @@
+/*
+ * Host-side access to the UART debug bridge.
+ *
+ * The UART debug bridge (rtl/uart_dbg.vhd) gives the host direct
+ * read/write access to the system bus of the RISC-V system via the
+ * serial port. It works without help from the software on the
+ * RISC-V processor.
+ *
+ * This class switches the bridge into bridge mode when needed and runs
+ * read and write bursts. The bridge returns to normal mode by itself
+ * after a period of inactivity (about 1.3 seconds), or when close()
+ * is called.
+ *
+ * Written in 2026.
+ *
+ * To the extent possible under law, the author has dedicated all copyright
+ * and related and neighboring rights to this software to the public domain
+ * worldwide. This software is distributed without any warranty.
+ *
+ * See <http://creativecommons.org/publicdomain/zero/1.0/>
+ */
+
+#ifndef UART_DBG_HOST_H_
+#define UART_DBG_HOST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+
+class UartDbg
+{
+public:
+    UartDbg();
+    ~UartDbg();
+
+    /* Open the serial port. Return false on error. */
+    bool open(const char *devname);
+
+    /* Return the bridge to normal mode and close the serial port. */
+    void close();
+
+    /*
+     * Read "nwords" 32-bit words starting at "addr".
+     * If "fixed" is true, read all words from the same address.
+     * Return false on error.
+     */
+    bool read(uint32_t addr, uint32_t *data, size_t nwords, bool fixed = false);
+
+    /*
+     * Write "nwords" 32-bit words starting at "addr".
+     * If "fixed" is true, write all words to the same address.
+     * Return false on error.
+     */
+    bool write(uint32_t addr, const uint32_t *data, size_t nwords, bool fixed = false);
+
+    /* Read a single word. */
+    bool read_word(uint32_t addr, uint32_t& value)
+    {
+        return read(addr, &value, 1);
+    }
+
+    /* Write a single word. */
+    bool write_word(uint32_t addr, uint32_t value)
+    {
+        return write(addr, &value, 1);
+    }
+
+private:
+    UartDbg(const UartDbg&) = delete;
+    UartDbg& operator=(const UartDbg&) = delete;
+
+    bool enter();
+    bool send(const unsigned char *buf, size_t len);
+    int recv_byte(int timeout_ms);
+    bool expect(unsigned char b);
+
+    int m_fd;
+    bool m_active;
+    std::chrono::steady_clock::time_point m_last_activity;
+};
+
+#endif  // UART_DBG_HOST_H_
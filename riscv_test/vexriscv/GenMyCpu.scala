@@ -5,7 +5,8 @@
  * Features:   static branch prediction,
  *             full barrel shifter,
  *             bypassed pipeline,
- *             rdcycle instruction.
+ *             rdcycle instruction,
+ *             retirement port for the instruction trace buffer.
  * Timing:     125 MHz on Spartan-7
  * Dhrystone:  1.01 DMIPS/MHz
  *
@@ -21,6 +22,34 @@ import vexriscv.plugin._
 import vexriscv.{plugin, VexRiscv, VexRiscvConfig}
 import spinal.core._
 
+/*
+ * Export the program counter and instruction word of each instruction
+ * that retires in the writeBack stage (used by the trace buffer).
+ */
+class RetirePortPlugin extends Plugin[VexRiscv] {
+  var retireValid: Bool = null
+  var retirePc: UInt = null
+  var retireInsn: Bits = null
+
+  override def setup(pipeline: VexRiscv): Unit = {
+    retireValid = out(Bool()).setName("retire_valid")
+    retirePc = out(UInt(32 bits)).setName("retire_pc")
+    retireInsn = out(Bits(32 bits)).setName("retire_insn")
+  }
+
+  override def build(pipeline: VexRiscv): Unit = {
+    import pipeline._
+    import pipeline.config._
+
+    writeBack plug new Area {
+      import writeBack._
+      retireValid := arbitration.isFiring
+      retirePc := input(PC)
+      retireInsn := input(INSTRUCTION)
+    }
+  }
+}
+
 object GenMyCpu extends App {
 
   def cpu() = new VexRiscv(
@@ -73,6 +102,7 @@ object GenMyCpu extends App {
           debugClockDomain = ClockDomain.current.clone(reset = Bool().setName("debugReset")),
           hardwareBreakpointCount = 0
         ),
+        new RetirePortPlugin,
         new YamlPlugin("cpu0.yaml")
       )
     )
@@ -680,6 +680,9 @@ entity VexRiscv is
     debug_bus_cmd_payload_data : in std_logic_vector(31 downto 0);
     debug_bus_rsp_data : out std_logic_vector(31 downto 0);
     debug_resetOut : out std_logic;
+    retire_valid : out std_logic;
+    retire_pc : out unsigned(31 downto 0);
+    retire_insn : out std_logic_vector(31 downto 0);
     dBus_cmd_valid : out std_logic;
     dBus_cmd_ready : in std_logic;
     dBus_cmd_payload_wr : out std_logic;
@@ -1991,6 +1994,9 @@ begin
 
   lastStageInstruction <= writeBack_INSTRUCTION;
   lastStagePc <= writeBack_PC;
+  retire_valid <= writeBack_arbitration_isFiring;
+  retire_pc <= writeBack_PC;
+  retire_insn <= writeBack_INSTRUCTION;
   lastStageIsValid <= writeBack_arbitration_isValid;
   lastStageIsFiring <= writeBack_arbitration_isFiring;
   process(CsrPlugin_exceptionPortCtrl_exceptionValids_writeBack,CsrPlugin_exceptionPortCtrl_exceptionValids_memory,CsrPlugin_exceptionPortCtrl_exceptionValids_execute,CsrPlugin_exceptionPortCtrl_exceptionValids_decode,zz_167,zz_168,zz_165,zz_166,DebugPlugin_haltIt,zz_169)
@@ -0,0 +1,26 @@
+# Write an uncompressed update bitstream for "fpga sync".
+#
+# The project builds compressed bitstreams (see project.xdc). That suits
+# the golden image, but a small design change shifts all following data
+# of a compressed bitstream, so "fpga sync" would resend nearly every
+# block. This script writes the implemented design once more without
+# compression, as riscv_test_update.bin in the project directory.
+#
+# Usage: after implementation, in the Vivado Tcl console:
+#   source write_update_bitstream.tcl
+#
+# Written in 2026.
+#
+# To the extent possible under law, the author has dedicated all copyright
+# and related and neighboring rights to this software to the public domain
+# worldwide. This software is distributed without any warranty.
+#
+# You should have received a copy of the CC0 Public Domain Dedication
+# along with this software. If not, see
+# <http://creativecommons.org/publicdomain/zero/1.0/>.
+#
+
+open_run impl_1
+set_property BITSTREAM.GENERAL.COMPRESS FALSE [current_design]
+write_bitstream -force -bin_file \
+    [file join [get_property DIRECTORY [current_project]] riscv_test_update.bit]